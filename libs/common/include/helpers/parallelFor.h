@@ -0,0 +1,78 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace helpers {
+/// Return the number of threads to use for parallel work (at least 1)
+inline unsigned getNumWorkerThreads()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/// Call func(i) for all i in [0, count) distributing the calls over up to numThreads threads (0 = number of cores)
+/// The calling thread takes part in the work. func must be safe to be called concurrently for different indices.
+/// If a call throws no new calls are started and the first exception is rethrown after all threads finished
+template<typename T_Func>
+void parallelFor(size_t count, T_Func&& func, unsigned numThreads = 0)
+{
+    if(numThreads == 0)
+        numThreads = getNumWorkerThreads();
+    if(count < numThreads)
+        numThreads = static_cast<unsigned>(count);
+    if(numThreads <= 1)
+    {
+        for(size_t i = 0; i < count; i++)
+            func(i);
+        return;
+    }
+
+    std::atomic<size_t> nextIdx(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    const auto worker = [&]() {
+        try
+        {
+            for(size_t i = nextIdx++; i < count; i = nextIdx++)
+                func(i);
+        } catch(...)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if(!error)
+                error = std::current_exception();
+            nextIdx = count;
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for(unsigned i = 1; i < numThreads; i++)
+        threads.emplace_back(worker);
+    worker();
+    for(std::thread& thread : threads)
+        thread.join();
+    if(error)
+        std::rethrow_exception(error);
+}
+} // namespace helpers
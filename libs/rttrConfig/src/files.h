@@ -26,6 +26,7 @@ RTTR_IGNORE_DIAGNOSTIC("-Wunused-variable")
 
 namespace s25 {
 namespace folders {
+    constexpr auto cache = "<RTTR_USERDATA>/CACHE"; // generated data which can be recreated any time
     constexpr auto config = "<RTTR_CONFIG>";
     constexpr auto data = "<RTTR_GAME>/DATA"; // S2 game data
     constexpr auto driver = "<RTTR_DRIVER>";
@@ -366,10 +366,11 @@ bool InitDirectories()
     LOG.write("Starting in %s\n", LogTarget::Stdout) % curPath;
 
     // diverse dirs anlegen
-    const std::array<std::string, 10> dirs = {{s25::folders::config, s25::folders::mapsOwn, s25::folders::logs,
+    const std::array<std::string, 11> dirs = {{s25::folders::config, s25::folders::mapsOwn, s25::folders::logs,
                                                s25::folders::mapsPlayed, s25::folders::replays, s25::folders::save,
                                                s25::folders::lstsUser, s25::folders::gameLstsUser,
-                                               s25::folders::screenshots, s25::folders::playlists}};
+                                               s25::folders::screenshots, s25::folders::playlists,
+                                               s25::folders::cache}};
 
     if(!MigrateFilesAndDirectories())
         return false;
@@ -471,6 +472,8 @@ int RunProgram(po::variables_map& options)
 
         if(options.count("map") && !QuickStartGame(options["map"].as<std::string>()))
             return 1;
+        if(options.count("spectate") && !QuickSpectateGame(options["spectate"].as<std::string>()))
+            return 1;
 
         // Hauptschleife
 
@@ -520,6 +523,7 @@ int main(int argc, char** argv)
         ("map,m", po::value<std::string>(),"Map to load")
         ("version", "Show version information and exit")
         ("convert-sounds", "Convert sounds and exit")
+        ("spectate", po::value<std::string>(), "Watch a game live from the spectator port of a server (host:port)")
         ;
     // clang-format on
     po::positional_options_description positionalOptions;
@@ -23,11 +23,14 @@
 #include "random/Random.h"
 #include "s25util/Serializer.h"
 
-AsyncChecksum::AsyncChecksum() : randChecksum(0), objCt(0), objIdCt(0), eventCt(0), evInstanceCt(0) {}
+AsyncChecksum::AsyncChecksum()
+    : randChecksum(0), objCt(0), objIdCt(0), eventCt(0), evInstanceCt(0), isHashOnly_(false), hash_(0)
+{}
 
 AsyncChecksum::AsyncChecksum(unsigned randChecksum, unsigned objCt, unsigned objIdCt, unsigned eventCt,
                              unsigned evInstanceCt)
-    : randChecksum(randChecksum), objCt(objCt), objIdCt(objIdCt), eventCt(eventCt), evInstanceCt(evInstanceCt)
+    : randChecksum(randChecksum), objCt(objCt), objIdCt(objIdCt), eventCt(eventCt), evInstanceCt(evInstanceCt),
+      isHashOnly_(false), hash_(0)
 {}
 
 void AsyncChecksum::Serialize(Serializer& ser) const
@@ -46,10 +49,31 @@ void AsyncChecksum::Deserialize(Serializer& ser)
     objIdCt = ser.PopUnsignedInt();
     eventCt = ser.PopUnsignedInt();
     evInstanceCt = ser.PopUnsignedInt();
+    isHashOnly_ = false;
+}
+
+void AsyncChecksum::SerializeHash(Serializer& ser) const
+{
+    // Empty checksums are stored as 0 so they stay distinguishable
+    ser.PushUnsignedInt(isValid() ? getHash() : 0u);
+}
+
+void AsyncChecksum::DeserializeHash(Serializer& ser)
+{
+    *this = AsyncChecksum();
+    hash_ = ser.PopUnsignedInt();
+    isHashOnly_ = hash_ != 0u;
+}
+
+bool AsyncChecksum::isValid() const
+{
+    return isHashOnly_ || *this != AsyncChecksum();
 }
 
 unsigned AsyncChecksum::getHash() const
 {
+    if(isHashOnly_)
+        return hash_;
     Serializer ser;
     Serialize(ser);
     return CalcChecksumOfBuffer(ser.GetData(), ser.GetLength());
@@ -21,6 +21,7 @@ class Game;
 class Serializer;
 
 /// Checksum of the game before the game commands of any player is executed
+/// Usually only the hash is transmitted in which case the individual values are unknown (zero)
 struct AsyncChecksum
 {
     unsigned randChecksum;
@@ -28,19 +29,33 @@ struct AsyncChecksum
     unsigned eventCt, evInstanceCt;
     AsyncChecksum();
     AsyncChecksum(unsigned randChecksum, unsigned objCt, unsigned objIdCt, unsigned eventCt, unsigned evInstanceCt);
+    /// Serialize all values
     void Serialize(Serializer& ser) const;
     void Deserialize(Serializer& ser);
+    /// Serialize only the hash
+    void SerializeHash(Serializer& ser) const;
+    void DeserializeHash(Serializer& ser);
     /// Get a hash for this checksum
     unsigned getHash() const;
+    /// True if only the hash of the checksum is known
+    bool isHashOnly() const { return isHashOnly_; }
+    /// True if this is not a default constructed (empty) checksum
+    bool isValid() const;
 
     static AsyncChecksum create(const Game& game);
 
     bool operator==(const AsyncChecksum& rhs) const;
     bool operator!=(const AsyncChecksum& rhs) const;
+
+private:
+    bool isHashOnly_;
+    unsigned hash_;
 };
 
 inline bool AsyncChecksum::operator==(const AsyncChecksum& rhs) const
 {
+    if(isHashOnly_ || rhs.isHashOnly_)
+        return getHash() == rhs.getHash();
     return randChecksum == rhs.randChecksum && objCt == rhs.objCt && objIdCt == rhs.objIdCt && eventCt == rhs.eventCt
            && evInstanceCt == rhs.evInstanceCt;
 }
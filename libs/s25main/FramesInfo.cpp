@@ -33,6 +33,42 @@ void FramesInfo::Clear()
     isPaused = false;
 }
 
+unsigned FramesInfo::runDueGFs(const UsedClock::time_point currentTime, const unsigned maxGFs,
+                               const std::function<bool()>& executeGF)
+{
+    // The GF timeline advances in steps of exactly 1 GF (and not to the current time) so a slow frame (e.g. rendering
+    // stall) does not slow down the game but is compensated in the next call.
+    unsigned numGFsRun = 0;
+    while(currentTime - lastTime >= gf_length)
+    {
+        // We are too far behind (e.g. after loading or a very slow machine): Drop the backlog instead of trying to
+        // catch up which would only make each frame slower. In multiplayer the other players will wait for us anyway.
+        if(numGFsRun == maxGFs)
+        {
+            lastTime = currentTime;
+            break;
+        }
+        if(!executeGF())
+        {
+            // Lagging player or game stopped: The time waited must not be caught up later by a burst of GFs.
+            // So keep the interpolation state and let the timeline start at it again.
+            if(numGFsRun > 0)
+                frameTime = milliseconds32_t::zero();
+            lastTime = currentTime - frameTime;
+            return numGFsRun;
+        }
+        ++numGFsRun;
+        lastTime += gf_length;
+        if(isPaused)
+            break;
+    }
+    // Time since the last GF for drawing (interpolation of animations)
+    if(currentTime - lastTime >= gf_length)
+        lastTime = currentTime; // Paused during catch-up
+    frameTime = std::chrono::duration_cast<milliseconds32_t>(currentTime - lastTime);
+    return numGFsRun;
+}
+
 FramesInfoClient::FramesInfoClient()
 {
     Clear();
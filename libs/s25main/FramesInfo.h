@@ -18,6 +18,7 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 
 /// Struct that stores information about the frames, like GF status...
 struct FramesInfo
@@ -27,6 +28,9 @@ struct FramesInfo
 
     FramesInfo();
     void Clear();
+    /// Run all GFs that are due at currentTime, at most maxGFs. executeGF returns false if a GF could not be executed.
+    /// Updates lastTime and frameTime and returns the number of executed GFs
+    unsigned runDueGFs(UsedClock::time_point currentTime, unsigned maxGFs, const std::function<bool()>& executeGF);
 
     /// Length of one GF in ms (~ 1/speed of the game)
     milliseconds32_t gf_length;
@@ -67,8 +67,13 @@ unsigned getNumAlivePlayers(const GameWorldBase& world)
 void Game::RunGF()
 {
     unsigned numPlayersAlive = getNumAlivePlayers(world_);
-    //  EventManager Bescheid sagen
-    em_->ExecuteNextGF();
+    {
+        // Merge the territory changes of this GF, e.g. from many captures in a big battle
+        GameWorldGame::TerritoryChangeBatch territoryChanges(world_);
+        //  EventManager Bescheid sagen
+        em_->ExecuteNextGF();
+        territoryChanges.Finish();
+    }
     // Notfallprogramm durchlaufen lassen
     for(unsigned i = 0; i < world_.GetNumPlayers(); ++i)
     {
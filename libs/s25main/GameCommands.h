@@ -62,6 +62,7 @@ public:
         ser.PushUnsignedShort(pt_.x);
         ser.PushUnsignedShort(pt_.y);
     }
+    MapPoint GetPos() const { return pt_; }
 };
 
 /// Flagge setzen
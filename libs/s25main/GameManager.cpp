@@ -36,6 +36,7 @@
 #include "s25util//dynamicUniqueCast.h"
 #include "s25util/Log.h"
 #include "s25util/error.h"
+#include <algorithm>
 
 GameManager::GameManager(Log& log, Settings& settings, VideoDriverWrapper& videoDriver, AudioDriverWrapper& audioDriver,
                          WindowManager& windowManager)
@@ -119,25 +120,25 @@ bool GameManager::Run()
 
     if(targetSkipGF)
     {
-        // if we skip drawing write a comment every 5k gf
+        // if we skip drawing write a comment from time to time (independent of the GF rate)
+        constexpr unsigned skipReportInterval = 5000; // ms
         unsigned current_time = videoDriver_.GetTickCount();
         const unsigned curGF = GAMECLIENT.GetGFNumber();
         if(targetSkipGF > curGF)
         {
-            if(curGF % 5000 == 0)
+            if(!lastSkipReport)
             {
-                if(lastSkipReport)
-                {
-                    // Elapsed time in ms
-                    const auto timeDiff = static_cast<double>(current_time - lastSkipReport->time);
-                    const unsigned numGFPassed = curGF - lastSkipReport->gf;
-                    log_.write(_("jumping to gf %i, now at gf %i, time for last 5k gf: %.3f s, avg gf time %.3f ms \n"))
-                      % targetSkipGF % curGF % (timeDiff / 1000) % (timeDiff / numGFPassed);
-                } else
-                    log_.write(_("jumping to gf %i, now at gf %i \n")) % targetSkipGF % curGF;
+                log_.write(_("jumping to gf %i, now at gf %i \n")) % targetSkipGF % curGF;
                 lastSkipReport = SkipReport{current_time, curGF};
-            } else if(!lastSkipReport)
+            } else if(current_time - lastSkipReport->time >= skipReportInterval)
+            {
+                // Elapsed time in ms
+                const auto timeDiff = static_cast<double>(current_time - lastSkipReport->time);
+                const unsigned numGFPassed = curGF - lastSkipReport->gf;
+                log_.write(_("jumping to gf %i, now at gf %i, %i gf in last %.3f s, avg gf time %.3f ms \n"))
+                  % targetSkipGF % curGF % numGFPassed % (timeDiff / 1000) % (timeDiff / std::max(numGFPassed, 1u));
                 lastSkipReport = SkipReport{current_time, curGF};
+            }
         } else
         {
             // Jump just completed
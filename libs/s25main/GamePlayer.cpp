@@ -31,6 +31,7 @@
 #include "buildings/nobUsual.h"
 #include "figures/nofCarrier.h"
 #include "figures/nofFlagWorker.h"
+#include "helpers/EnumRange.h"
 #include "helpers/containerUtils.h"
 #include "helpers/mathFuncs.h"
 #include "lua/LuaInterfaceGame.h"
@@ -55,10 +56,12 @@
 #include "gameData/ShieldConsts.h"
 #include "gameData/ToolConsts.h"
 #include "s25util/Log.h"
+#include <algorithm>
 #include <limits>
+#include <tuple>
 
 GamePlayer::GamePlayer(unsigned playerId, const PlayerInfo& playerInfo, GameWorldGame& gwg)
-    : GamePlayerInfo(playerId, playerInfo), gwg(gwg), hqPos(MapPoint::Invalid()), emergency(false)
+    : GamePlayerInfo(playerId, playerInfo), gwg(gwg), nextJobSeqNr(0), hqPos(MapPoint::Invalid()), emergency(false)
 {
     std::fill(building_enabled.begin(), building_enabled.end(), true);
 
@@ -183,11 +186,19 @@ void GamePlayer::Serialize(SerializedGameData& sgd) const
 
     sgd.PushObjectContainer(roads, true);
 
-    sgd.PushUnsignedInt(jobs_wanted.size());
-    for(JobNeeded job : jobs_wanted)
+    // Store the requests in the order they are served
+    std::vector<std::tuple<unsigned, Job, noRoadNode*>> jobs;
+    for(const auto job : helpers::EnumRange<Job>{})
     {
-        sgd.PushUnsignedChar(job.job);
-        sgd.PushObject(job.workplace, false);
+        for(const JobNeeded& jn : jobs_wanted[job])
+            jobs.emplace_back(jn.seqNr, job, jn.workplace);
+    }
+    std::sort(jobs.begin(), jobs.end());
+    sgd.PushUnsignedInt(jobs.size());
+    for(const auto& job : jobs)
+    {
+        sgd.PushUnsignedChar(std::get<1>(job));
+        sgd.PushObject(std::get<2>(job), false);
     }
 
     sgd.PushObjectContainer(ware_list, true);
@@ -281,19 +292,32 @@ void GamePlayer::Deserialize(SerializedGameData& sgd)
     buildings.Deserialize(sgd);
 
     sgd.PopObjectContainer(roads, GOT_ROADSEGMENT);
+    roadComponents.Invalidate();
+    wareRouteTables.Clear();
 
+    for(auto& jobs : jobs_wanted)
+        jobs.clear();
     unsigned list_size = sgd.PopUnsignedInt();
-    for(unsigned i = 0; i < list_size; ++i)
+    for(nextJobSeqNr = 0; nextJobSeqNr < list_size; ++nextJobSeqNr)
     {
+        const Job job = Job(sgd.PopUnsignedChar());
+        if(job >= NUM_JOB_TYPES)
+            throw SerializedGameData::Error("Invalid job");
         JobNeeded nj;
-        nj.job = Job(sgd.PopUnsignedChar());
+        nj.seqNr = nextJobSeqNr;
         nj.workplace = sgd.PopObject<noRoadNode>(GOT_UNKNOWN);
-        jobs_wanted.push_back(nj);
+        jobs_wanted[job].push_back(nj);
     }
 
     buildings.Deserialize2(sgd);
 
     sgd.PopObjectContainer(ware_list, GOT_WARE);
+    lostWares.clear();
+    for(Ware* ware : ware_list)
+    {
+        if(ware->IsLostWare())
+            lostWares.insert(ware);
+    }
     sgd.PopObjectContainer(flagworkers, GOT_UNKNOWN);
     sgd.PopObjectContainer(ships, GOT_SHIP);
 
@@ -492,6 +516,8 @@ void GamePlayer::NewRoadConnection(RoadSegment* rs)
 {
     // Zu den Straßen hinzufgen, da's ja ne neue ist
     roads.push_back(rs);
+    roadComponents.Connect(*rs);
+    wareRouteTables.Clear();
 
     // Alle Straßen müssen nun gucken, ob sie einen Weg zu einem Warehouse finden
     FindCarrierForAllRoads();
@@ -519,32 +545,47 @@ void GamePlayer::NewRoadConnection(RoadSegment* rs)
     }
 }
 
-void GamePlayer::AddRoad(RoadSegment* rs)
+void GamePlayer::RoadSplit(const RoadSegment& oldRoad, RoadSegment* newRoad)
 {
-    roads.push_back(rs);
+    roads.push_back(newRoad);
+    roadComponents.Connect(*newRoad);
+    wareRouteTables.Clear();
+    // Routes using the old road may now use the new part as well
+    for(Ware* ware : ware_list)
+        ware->RoadSplit(oldRoad.GetObjId(), newRoad->GetObjId());
 }
 
 void GamePlayer::DeleteRoad(RoadSegment* rs)
 {
     RTTR_Assert(helpers::contains(roads, rs));
     roads.remove(rs);
+    roadComponents.Invalidate();
+    wareRouteTables.Clear();
 }
 
 void GamePlayer::FindClientForLostWares()
 {
     // Alle Lost-Wares müssen gucken, ob sie ein Lagerhaus finden
-    for(Ware* ware : ware_list)
+    for(auto it = lostWares.begin(); it != lostWares.end();)
     {
+        Ware* ware = *it;
         if(ware->IsLostWare())
         {
             if(ware->FindRouteToWarehouse() && ware->IsWaitingAtFlag())
                 ware->CallCarrier();
         }
+        if(ware->IsLostWare())
+            ++it;
+        else
+            it = lostWares.erase(it);
     }
 }
 
-void GamePlayer::RoadDestroyed()
+void GamePlayer::RoadDestroyed(const unsigned segmentId)
 {
+    // Also required for roads to buildings which are not in the road list
+    wareRouteTables.Clear();
+
     // Alle Waren, die an Flagge liegen und in Lagerhäusern, müssen gucken, ob sie ihr Ziel noch erreichen können, jetzt
     // wo eine Straße fehlt
     for(auto it = ware_list.begin(); it != ware_list.end();)
@@ -552,6 +593,13 @@ void GamePlayer::RoadDestroyed()
         Ware* ware = *it;
         if(ware->IsWaitingAtFlag()) // Liegt die Flagge an einer Flagge, muss ihr Weg neu berechnet werden
         {
+            // Routes not using the road are still valid.
+            // Wares going into the building at their flag are always checked for the special case below
+            if(!ware->IsRouteAffectedBy(segmentId) && ware->GetNextDir() != RoadPathDirection::NorthWest)
+            {
+                ++it;
+                continue;
+            }
             RoadPathDirection last_next_dir = ware->GetNextDir();
             ware->RecalcRoute();
             // special case: ware was lost some time ago and the new goal is at this flag and not a warehouse,hq,harbor
@@ -608,6 +656,7 @@ void GamePlayer::RoadDestroyed()
                 ware->NotifyGoalAboutLostWare();
                 // Ware aus der Liste raus
                 it = ware_list.erase(it);
+                lostWares.erase(ware);
                 // And trash it
                 deletePtr(ware);
                 continue;
@@ -615,7 +664,8 @@ void GamePlayer::RoadDestroyed()
         } else if(ware->IsWaitingForShip())
         {
             // Weg neu berechnen
-            ware->RecalcRoute();
+            if(ware->IsRouteAffectedBy(segmentId))
+                ware->RecalcRoute();
         }
 
         ++it;
@@ -628,6 +678,11 @@ void GamePlayer::RoadDestroyed()
     }
 }
 
+bool GamePlayer::AreConnectedByRoads(const noRoadNode& node1, const noRoadNode& node2) const
+{
+    return roadComponents.AreConnected(node1, node2, roads);
+}
+
 bool GamePlayer::FindCarrierForRoad(RoadSegment* rs) const
 {
     RTTR_Assert(rs->GetF1() != nullptr && rs->GetF2() != nullptr);
@@ -742,33 +797,41 @@ void GamePlayer::AddJobWanted(const Job job, noRoadNode* workplace)
     // Und gleich suchen
     if(!FindWarehouseForJob(job, workplace))
     {
-        JobNeeded jn = {job, workplace};
-        jobs_wanted.push_back(jn);
+        JobNeeded jn = {nextJobSeqNr++, workplace};
+        jobs_wanted[job].push_back(jn);
     }
 }
 
 void GamePlayer::JobNotWanted(noRoadNode* workplace, bool all)
 {
-    for(auto it = jobs_wanted.begin(); it != jobs_wanted.end();)
+    if(all)
     {
-        if(it->workplace == workplace)
-        {
-            it = jobs_wanted.erase(it);
-            if(!all)
-                return;
-        } else
+        for(auto& jobs : jobs_wanted)
+            jobs.remove_if([workplace](const JobNeeded& jn) { return jn.workplace == workplace; });
+        return;
+    }
+    // Remove only the oldest request
+    std::list<JobNeeded>* oldestJobs = nullptr;
+    std::list<JobNeeded>::iterator oldestIt;
+    for(auto& jobs : jobs_wanted)
+    {
+        const auto it = helpers::find_if(jobs, [workplace](const JobNeeded& jn) { return jn.workplace == workplace; });
+        if(it != jobs.end() && (!oldestJobs || it->seqNr < oldestIt->seqNr))
         {
-            ++it;
+            oldestJobs = &jobs;
+            oldestIt = it;
         }
     }
+    if(oldestJobs)
+        oldestJobs->erase(oldestIt);
 }
 
 void GamePlayer::OneJobNotWanted(const Job job, noRoadNode* workplace)
 {
-    const auto it = helpers::find_if(
-      jobs_wanted, [workplace, job](const auto& it) { return it.workplace == workplace && it.job == job; });
-    if(it != jobs_wanted.end())
-        jobs_wanted.erase(it);
+    std::list<JobNeeded>& jobs = jobs_wanted[job];
+    const auto it = helpers::find_if(jobs, [workplace](const JobNeeded& jn) { return jn.workplace == workplace; });
+    if(it != jobs.end())
+        jobs.erase(it);
 }
 
 void GamePlayer::SendPostMessage(std::unique_ptr<PostMsg> msg)
@@ -829,28 +892,51 @@ bool GamePlayer::FindWarehouseForJob(const Job job, noRoadNode* goal) const
     return false;
 }
 
+bool GamePlayer::IsJobAvailable(const Job job) const
+{
+    const FW::HasFigure hasFigure(job, true);
+    for(const nobBaseWarehouse* wh : buildings.GetStorehouses())
+    {
+        if(hasFigure(*wh))
+            return true;
+    }
+    return false;
+}
+
 void GamePlayer::FindWarehouseForAllJobs()
 {
-    for(auto it = jobs_wanted.begin(); it != jobs_wanted.end();)
+    // Only requests for jobs some warehouse can provide might be satisfied.
+    // Those are served in the order they were made
+    std::vector<std::tuple<unsigned, Job, std::list<JobNeeded>::iterator>> candidates;
+    for(const auto job : helpers::EnumRange<Job>{})
     {
-        if(FindWarehouseForJob(it->job, it->workplace))
-            it = jobs_wanted.erase(it);
-        else
-            ++it;
+        std::list<JobNeeded>& jobs = jobs_wanted[job];
+        if(jobs.empty() || !IsJobAvailable(job))
+            continue;
+        for(auto it = jobs.begin(); it != jobs.end(); ++it)
+            candidates.emplace_back(it->seqNr, job, it);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& lhs, const auto& rhs) { return std::get<0>(lhs) < std::get<0>(rhs); });
+    for(const auto& candidate : candidates)
+    {
+        const Job job = std::get<1>(candidate);
+        const auto it = std::get<2>(candidate);
+        if(FindWarehouseForJob(job, it->workplace))
+            jobs_wanted[job].erase(it);
     }
 }
 
 void GamePlayer::FindWarehouseForAllJobs(const Job job)
 {
-    for(auto it = jobs_wanted.begin(); it != jobs_wanted.end();)
+    std::list<JobNeeded>& jobs = jobs_wanted[job];
+    if(jobs.empty() || !IsJobAvailable(job))
+        return;
+    for(auto it = jobs.begin(); it != jobs.end();)
     {
-        if(it->job == job)
-        {
-            if(FindWarehouseForJob(it->job, it->workplace))
-                it = jobs_wanted.erase(it);
-            else
-                ++it;
-        } else
+        if(FindWarehouseForJob(job, it->workplace))
+            it = jobs.erase(it);
+        else
             ++it;
     }
 }
@@ -878,9 +964,16 @@ Ware* GamePlayer::OrderWare(const GoodType ware, noBaseBuilding* goal)
     {
         unsigned bestLength = std::numeric_limits<unsigned>::max();
         Ware* bestWare = nullptr;
-        for(Ware* curWare : ware_list)
+        for(auto it = lostWares.begin(); it != lostWares.end();)
         {
-            if(curWare->IsLostWare() && curWare->type == ware)
+            Ware* curWare = *it;
+            if(!curWare->IsLostWare())
+            {
+                it = lostWares.erase(it);
+                continue;
+            }
+            ++it;
+            if(curWare->type == ware)
             {
                 // got a lost ware with a road to goal -> find best
                 unsigned curLength = curWare->CheckNewGoalForLostWare(*goal);
@@ -1786,9 +1879,28 @@ Team GamePlayer::GetFixedTeam(Team rawteam)
     return rawteam;
 }
 
+void GamePlayer::RegisterWare(Ware* ware)
+{
+    RTTR_Assert(!IsWareRegistred(ware));
+    ware_list.insert(ware);
+}
+
+void GamePlayer::RemoveWare(Ware* ware)
+{
+    RTTR_Assert(IsWareRegistred(ware));
+    ware_list.erase(ware);
+    lostWares.erase(ware);
+}
+
 bool GamePlayer::IsWareRegistred(Ware* ware)
 {
-    return (helpers::contains(ware_list, ware));
+    return ware_list.count(ware) != 0u;
+}
+
+void GamePlayer::RegisterLostWare(Ware* ware)
+{
+    RTTR_Assert(IsWareRegistred(ware));
+    lostWares.insert(ware);
 }
 
 bool GamePlayer::IsWareDependent(Ware* ware)
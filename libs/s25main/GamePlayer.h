@@ -19,9 +19,12 @@
 
 #include "BuildingRegister.h"
 #include "GamePlayerInfo.h"
+#include "RoadComponents.h"
 #include "helpers/MultiArray.h"
+#include "pathfinding/WareRouteTables.h"
 #include "gameTypes/BuildingType.h"
 #include "gameTypes/Inventory.h"
+#include "gameTypes/JobTypes.h"
 #include "gameTypes/MapCoordinates.h"
 #include "gameTypes/PactTypes.h"
 #include "gameTypes/SettingsTypes.h"
@@ -31,6 +34,7 @@
 #include <array>
 #include <list>
 #include <memory>
+#include <set>
 
 struct Direction;
 class GameWorldGame;
@@ -101,14 +105,18 @@ public:
 
     /// Notify that a new road connection exists (not only an existing road splitted)
     void NewRoadConnection(RoadSegment* rs);
-    /// Neue Straße hinzufügen
-    void AddRoad(RoadSegment* rs);
+    /// Notify that the road oldRoad was split and newRoad is its (new) 2nd part
+    void RoadSplit(const RoadSegment& oldRoad, RoadSegment* newRoad);
     /// Gibt dem Spieler bekannt, das eine Straße abgerissen wurde
-    void RoadDestroyed();
+    void RoadDestroyed(unsigned segmentId);
     /// (Unbesetzte) Straße aus der Liste entfernen
     void DeleteRoad(RoadSegment* rs);
     /// Sucht einen Träger für die Straße und ruft ggf den Träger aus dem jeweiligen nächsten Lagerhaus
     bool FindCarrierForRoad(RoadSegment* rs) const;
+    /// Return true if both nodes are connected by roads of this player. Ship connections are not considered!
+    bool AreConnectedByRoads(const noRoadNode& node1, const noRoadNode& node2) const;
+    /// Next-hop tables for the routes of wares to goals of this player
+    WareRouteTables& GetWareRouteTables() { return wareRouteTables; }
     /// Returns true if the given wh does still exist and hence the ptr is valid
     bool IsWarehouseValid(nobBaseWarehouse* wh) const;
     /// Gibt erstes Lagerhaus zurück
@@ -168,13 +176,11 @@ public:
     void ConvertTransportData(const TransportOrders& transport_data);
 
     /// Ware zur globalen Warenliste hinzufügen und entfernen
-    void RegisterWare(Ware* ware) { ware_list.push_back(ware); }
-    void RemoveWare(Ware* ware)
-    {
-        RTTR_Assert(IsWareRegistred(ware));
-        ware_list.remove(ware);
-    }
+    void RegisterWare(Ware* ware);
+    void RemoveWare(Ware* ware);
     bool IsWareRegistred(Ware* ware);
+    /// Called by a registered ware when it (might have) lost its goal
+    void RegisterLostWare(Ware* ware);
     bool IsWareDependent(Ware* ware);
 
     /// Fügt Waren zur Inventur hinzu
@@ -357,18 +363,34 @@ private:
 
     /// Lister aller Straßen von dem Spieler
     std::list<RoadSegment*> roads;
+    /// Connectivity index of the roads (cache only)
+    mutable RoadComponents roadComponents;
+    /// Next-hop tables of the roads (cache only)
+    WareRouteTables wareRouteTables;
 
     struct JobNeeded
     {
-        Job job;
+        /// Position in the order of all requests. Requests are served in this order
+        unsigned seqNr;
         noRoadNode* workplace;
     };
+    /// Orders objects by their id which is the order of creation
+    struct ObjIdLess
+    {
+        template<class T>
+        bool operator()(const T* lhs, const T* rhs) const { return lhs->GetObjId() < rhs->GetObjId(); }
+    };
+    using WareSet = std::set<Ware*, ObjIdLess>;
 
-    /// Liste von Baustellen/Gebäuden, die bestimmten Beruf wollen
-    std::list<JobNeeded> jobs_wanted;
+    /// Liste von Baustellen/Gebäuden, die bestimmten Beruf wollen (per job)
+    std::array<std::list<JobNeeded>, NUM_JOB_TYPES> jobs_wanted;
+    /// Sequence number for the next entry in jobs_wanted
+    unsigned nextJobSeqNr;
 
     /// Liste von sämtlichen Waren, die herumgetragen werden und an Fahnen liegen
-    std::list<Ware*> ware_list;
+    WareSet ware_list;
+    /// Wares which might be lost. Superset of all lost wares, others are removed when found
+    WareSet lostWares;
     /// Liste von Geologen und Spähern, die an eine Flagge gebunden sind
     std::list<nofFlagWorker*> flagworkers;
     /// Liste von Schiffen dieses Spielers
@@ -439,6 +461,8 @@ private:
     void PactChanged(PactType pt);
     // Sucht Weg für Job zu entsprechenden noRoadNode
     bool FindWarehouseForJob(Job job, noRoadNode* goal) const;
+    /// Return true if any warehouse has (or can recruit) the job, so requests for it might be satisfied
+    bool IsJobAvailable(Job job) const;
     /// Prüft, ob der Spieler besiegt wurde
     void TestDefeat();
 
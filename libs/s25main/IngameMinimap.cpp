@@ -24,119 +24,115 @@
 #include "gameData/MinimapConsts.h"
 #include "gameData/TerrainDesc.h"
 #include "libsiedler2/ColorBGRA.h"
+#include <algorithm>
 
 IngameMinimap::IngameMinimap(const GameWorldViewer& gwv)
     : Minimap(gwv.GetWorld().GetSize()), gwv(gwv), nodes_updated(GetMapSize().x * GetMapSize().y, false),
-      dos(GetMapSize().x * GetMapSize().y, DO_INVALID), territory(true), houses(true), roads(true)
+      dos(GetMapSize().x * GetMapSize().y, DO_INVALID), territory(true), houses(true), roads(true), isDetached_(false)
 {
     CreateMapTexture();
 }
 
 unsigned IngameMinimap::CalcPixelColor(const MapPoint pt, const unsigned t)
 {
-    unsigned color = 0;
+    return CalcNodeColors(pt)[t];
+}
 
+std::array<unsigned, 2> IngameMinimap::CalcNodeColors(const MapPoint pt)
+{
     Visibility visibility = gwv.GetVisibility(pt);
 
     if(visibility == VIS_INVISIBLE)
     {
         dos[GetMMIdx(pt)] = DO_INVISIBLE;
         // Man sieht nichts --> schwarz
-        return 0xFF000000;
-    } else
-    {
-        DrawnObject drawn_object = DO_INVALID;
+        return {{0xFF000000, 0xFF000000}};
+    }
 
-        const bool fow = (visibility == VIS_FOW);
+    std::array<unsigned, 2> colors;
+    DrawnObject drawn_object = DO_INVALID;
 
-        unsigned char owner;
-        NodalObjectType noType = NOP_NOTHING;
-        FOW_Type fot = FOW_NOTHING;
-        if(!fow)
-        {
-            const MapNode& node = gwv.GetNode(pt);
-            owner = node.owner;
-            if(node.obj)
-                noType = node.obj->GetType();
-        } else
-        {
-            const FoWNode& node = gwv.GetYoungestFOWNode(pt);
-            owner = node.owner;
-            if(node.object)
-                fot = node.object->GetType();
-        }
+    const bool fow = (visibility == VIS_FOW);
 
-        // Baum an dieser Stelle?
-        if((!fow && noType == NOP_TREE) || (fow && fot == FOW_TREE)) //-V807
-        {
-            color = VaryBrightness(TREE_COLOR, VARY_TREE_COLOR);
-            drawn_object = DO_TERRAIN;
-            // Ggf. mit Spielerfarbe
-            if(owner)
-            {
-                drawn_object = DO_PLAYER;
-                if(territory)
-                    color = CombineWithPlayerColor(color, owner);
-            }
-        }
-        // Granit an dieser Stelle?
-        else if((!fow && noType == NOP_GRANITE) || (fow && fot == FOW_GRANITE))
+    unsigned char owner;
+    NodalObjectType noType = NOP_NOTHING;
+    FOW_Type fot = FOW_NOTHING;
+    if(!fow)
+    {
+        const MapNode& node = gwv.GetNode(pt);
+        owner = node.owner;
+        if(node.obj)
+            noType = node.obj->GetType();
+    } else
+    {
+        const FoWNode& node = gwv.GetYoungestFOWNode(pt);
+        owner = node.owner;
+        if(node.object)
+            fot = node.object->GetType();
+    }
+
+    const bool isTree = (!fow && noType == NOP_TREE) || (fow && fot == FOW_TREE);
+    // Baum oder Granit an dieser Stelle?
+    if(isTree || (!fow && noType == NOP_GRANITE) || (fow && fot == FOW_GRANITE))
+    {
+        drawn_object = owner ? DO_PLAYER : DO_TERRAIN;
+        for(unsigned& color : colors)
         {
-            color = VaryBrightness(GRANITE_COLOR, VARY_GRANITE_COLOR);
-            drawn_object = DO_TERRAIN;
+            color = isTree ? VaryBrightness(TREE_COLOR, VARY_TREE_COLOR) :
+                             VaryBrightness(GRANITE_COLOR, VARY_GRANITE_COLOR);
             // Ggf. mit Spielerfarbe
-            if(owner)
-            {
-                drawn_object = DO_PLAYER;
-                if(territory)
-                    color = CombineWithPlayerColor(color, owner);
-            }
+            if(owner && territory)
+                color = CombineWithPlayerColor(color, owner);
         }
-        // Ansonsten die jeweilige Terrainfarbe nehmen
+    }
+    // Ansonsten die jeweilige Terrainfarbe nehmen
+    // Ggf. Spielerfarbe mit einberechnen, falls das von einem Spieler ein Territorium ist
+    else if(owner)
+    {
+        // Building?
+        if(((!fow && (noType == NOP_BUILDING || noType == NOP_BUILDINGSITE))
+            || (fow && (fot == FOW_BUILDING || fot == FOW_BUILDINGSITE))))
+            drawn_object = DO_BUILDING;
+        /// Roads?
+        else if(IsRoad(pt, visibility))
+            drawn_object = DO_ROAD;
+        // ansonsten normales Territorium?
         else
+            drawn_object = DO_PLAYER;
+
+        for(unsigned t = 0; t < 2; ++t)
         {
-            // Ggf. Spielerfarbe mit einberechnen, falls das von einem Spieler ein Territorium ist
-            if(owner)
-            {
-                // Building?
-                if(((!fow && (noType == NOP_BUILDING || noType == NOP_BUILDINGSITE))
-                    || (fow && (fot == FOW_BUILDING || fot == FOW_BUILDINGSITE))))
-                    drawn_object = DO_BUILDING;
-                /// Roads?
-                else if(IsRoad(pt, visibility))
-                    drawn_object = DO_ROAD;
-                // ansonsten normales Territorium?
-                else
-                    drawn_object = DO_PLAYER;
-
-                if(drawn_object == DO_BUILDING && houses)
-                    color = BUILDING_COLOR;
-                /// Roads?
-                else if(drawn_object == DO_ROAD && roads)
-                    color = ROAD_COLOR;
-                // ansonsten normales Territorium?
-                else if(territory)
-                    // Normales Terrain und Spielerfarbe berechnen
-                    color = CombineWithPlayerColor(CalcTerrainColor(pt, t), owner);
-                else
-                    // Normales Terrain berechnen
-                    color = CalcTerrainColor(pt, t);
-            } else
-            {
+            if(drawn_object == DO_BUILDING && houses)
+                colors[t] = BUILDING_COLOR;
+            /// Roads?
+            else if(drawn_object == DO_ROAD && roads)
+                colors[t] = ROAD_COLOR;
+            // ansonsten normales Territorium?
+            else if(territory)
+                // Normales Terrain und Spielerfarbe berechnen
+                colors[t] = CombineWithPlayerColor(CalcTerrainColor(pt, t), owner);
+            else
                 // Normales Terrain berechnen
-                color = CalcTerrainColor(pt, t);
-                drawn_object = DO_TERRAIN;
-            }
+                colors[t] = CalcTerrainColor(pt, t);
         }
+    } else
+    {
+        // Normales Terrain berechnen
+        colors[0] = CalcTerrainColor(pt, 0);
+        colors[1] = CalcTerrainColor(pt, 1);
+        drawn_object = DO_TERRAIN;
+    }
 
-        // Bei FOW die Farben abdunkeln
-        if(fow)
+    // Bei FOW die Farben abdunkeln
+    if(fow)
+    {
+        for(unsigned& color : colors)
             color = MakeColor(0xFF, GetRed(color) / 2, GetGreen(color) / 2, GetBlue(color) / 2);
-
-        dos[GetMMIdx(pt)] = drawn_object;
     }
 
-    return color;
+    dos[GetMMIdx(pt)] = drawn_object;
+
+    return colors;
 }
 
 /**
@@ -198,7 +194,7 @@ unsigned IngameMinimap::CombineWithPlayerColor(const unsigned color, const unsig
 
 void IngameMinimap::UpdateNode(const MapPoint pt)
 {
-    if(!nodes_updated[GetMMIdx(pt)])
+    if(!isDetached_ && !nodes_updated[GetMMIdx(pt)])
     {
         nodes_updated[GetMMIdx(pt)] = true;
         nodesToUpdate.push_back(pt);
@@ -210,36 +206,34 @@ void IngameMinimap::UpdateNode(const MapPoint pt)
  */
 void IngameMinimap::BeforeDrawing()
 {
-    // Ab welcher Knotenanzahl (Teil der Gesamtknotenanzahl) die Textur komplett neu erstellt werden soll
-    static const unsigned MAX_NODES_UPDATE_DENOMINATOR = 2; // (2 = 1/2, 3 = 1/3 usw.)
+    // Minimum number of nodes updated per frame
+    static const unsigned MIN_NODES_PER_FRAME = 4096;
+    // Number of frames a full map update may be spread over
+    static const unsigned NUM_FRAMES_FOR_FULL_UPDATE = 8;
 
-    if(!nodesToUpdate.empty())
-    {
-        // Komplette Textur neu erzeugen, weil es zu viele Knoten sind?
-        if(nodesToUpdate.size() >= nodes_updated.size() / MAX_NODES_UPDATE_DENOMINATOR)
-        {
-            // Ja, alles neu erzeugen
-            UpdateAll();
-            std::fill(nodes_updated.begin(), nodes_updated.end(), false);
-        } else
-        {
-            map.beginUpdate();
-            // Entsprechende Pixel updaten
-            for(auto& it : nodesToUpdate)
-            {
-                for(unsigned t = 0; t < 2; ++t)
-                {
-                    unsigned color = CalcPixelColor(it, t);
-                    DrawPoint texPos((it.x * 2 + t + (it.y & 1)) % (GetMapSize().x * 2), it.y);
-                    map.updatePixel(texPos, libsiedler2::ColorBGRA(color));
-                }
-                nodes_updated[GetMMIdx(it)] = false;
-            }
-            map.endUpdate();
-        }
+    if(nodesToUpdate.empty())
+        return;
 
-        this->nodesToUpdate.clear();
+    // Limit the work per frame, so mass changes (e.g. territory changes in big battles) are spread over some frames
+    // instead of causing a hitch. Only the changed parts of the texture are uploaded
+    const size_t maxNodes = std::max<size_t>(MIN_NODES_PER_FRAME, nodes_updated.size() / NUM_FRAMES_FOR_FULL_UPDATE);
+    const size_t numNodes = std::min(nodesToUpdate.size(), maxNodes);
+    const auto itFirst = nodesToUpdate.end() - numNodes;
+    map.beginUpdate();
+    for(auto it = itFirst; it != nodesToUpdate.end(); ++it)
+    {
+        UpdatePixels(*it);
+        nodes_updated[GetMMIdx(*it)] = false;
     }
+    map.endUpdate();
+    nodesToUpdate.erase(itFirst, nodesToUpdate.end());
+}
+
+void IngameMinimap::UpdatePixels(const MapPoint pt)
+{
+    const std::array<unsigned, 2> colors = CalcNodeColors(pt);
+    for(unsigned t = 0; t < 2; ++t)
+        map.updatePixel(GetTexPos(pt, t), libsiedler2::ColorBGRA(colors[t]));
 }
 
 /**
@@ -247,10 +241,29 @@ void IngameMinimap::BeforeDrawing()
  */
 void IngameMinimap::UpdateAll()
 {
+    if(isDetached_)
+        return;
     map.DeleteTexture();
     CreateMapTexture();
 }
 
+void IngameMinimap::Detach()
+{
+    isDetached_ = true;
+}
+
+void IngameMinimap::Reattach()
+{
+    if(!isDetached_)
+        return;
+    isDetached_ = false;
+    // Pending updates are included in the full update
+    for(const MapPoint pt : nodesToUpdate)
+        nodes_updated[GetMMIdx(pt)] = false;
+    nodesToUpdate.clear();
+    UpdateAll();
+}
+
 /**
  *  Update all nodes with the given drawn object
  */
@@ -260,17 +273,12 @@ void IngameMinimap::UpdateAll(const DrawnObject drawn_object)
     // Gesamte Karte neu berechnen
     RTTR_FOREACH_PT(MapPoint, GetMapSize())
     {
-        for(unsigned t = 0; t < 2; ++t)
+        if(dos[GetMMIdx(pt)] == drawn_object
+           || (drawn_object == DO_PLAYER && // for DO_PLAYER check for not drawn buildings or roads as there is only
+                                            // the player territory visible
+               ((dos[GetMMIdx(pt)] == DO_BUILDING && !houses) || (dos[GetMMIdx(pt)] == DO_ROAD && !roads))))
         {
-            if(dos[GetMMIdx(pt)] == drawn_object
-               || (drawn_object == DO_PLAYER && // for DO_PLAYER check for not drawn buildings or roads as there is only
-                                                // the player territory visible
-                   ((dos[GetMMIdx(pt)] == DO_BUILDING && !houses) || (dos[GetMMIdx(pt)] == DO_ROAD && !roads))))
-            {
-                unsigned color = CalcPixelColor(pt, t);
-                DrawPoint texPos((pt.x * 2 + t + (pt.y & 1)) % (GetMapSize().x * 2), pt.y);
-                map.updatePixel(texPos, libsiedler2::ColorBGRA(color));
-            }
+            UpdatePixels(pt);
         }
     }
     map.endUpdate();
@@ -50,6 +50,8 @@ class IngameMinimap : public Minimap
     bool territory; /// Länder der Spieler
     bool houses;    /// Häuser
     bool roads;     /// Straßen
+    /// No updates are done while detached (e.g. fast forwarding)
+    bool isDetached_;
 
 public:
     IngameMinimap(const GameWorldViewer& gwv);
@@ -60,6 +62,10 @@ public:
     /// Updatet die gesamte Minimap
     void UpdateAll();
 
+    /// Ignore all updates till Reattach is called which then updates the whole map once
+    void Detach();
+    void Reattach();
+
     /// Die einzelnen Dinge umschalten
     void ToggleTerritory();
     void ToggleHouses();
@@ -68,6 +74,8 @@ public:
 protected:
     /// Berechnet die Farbe für einen bestimmten Pixel der Minimap (t = Terrain1 oder 2)
     unsigned CalcPixelColor(MapPoint pt, unsigned t) override;
+    /// Calculate both pixels of a node at once, so the node (visibility, objects, roads) is only inspected once
+    std::array<unsigned, 2> CalcNodeColors(MapPoint pt) override;
     /// Berechnet für einen bestimmten Punkt und ein Dreieck die normale Terrainfarbe
     unsigned CalcTerrainColor(MapPoint pt, unsigned t);
     /// Prüft ob an einer Stelle eine Straße gezeichnet werden muss
@@ -79,4 +87,6 @@ protected:
     void BeforeDrawing() override;
     /// Alle Punkte Updaten, bei denen das DrawnObject gleich dem übergebenen drawn_object ist
     void UpdateAll(DrawnObject drawn_object);
+    /// Recalculate the node and write its pixels to the texture. Must be called between map.beginUpdate/endUpdate
+    void UpdatePixels(MapPoint pt);
 };
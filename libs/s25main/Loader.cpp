@@ -28,6 +28,7 @@
 #include "files.h"
 #include "helpers/containerUtils.h"
 #include "helpers/format.hpp"
+#include "helpers/parallelFor.h"
 #include "ogl/MusicItem.h"
 #include "ogl/SoundEffectItem.h"
 #include "ogl/glArchivItem_Bitmap_Player.h"
@@ -55,6 +56,7 @@
 #include "s25util/dynamicUniqueCast.h"
 #include "s25util/strAlgos.h"
 #include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
 #include <boost/range/adaptor/map.hpp>
 #include <algorithm>
 #include <chrono>
@@ -63,9 +65,62 @@
 #include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 
 using namespace std::chrono;
 
+namespace {
+/// Version of the sprite cache. Increase when fillCaches creates different sprites from the same files
+constexpr uint32_t SPRITE_CACHE_VERSION = 1;
+
+/// FNV-1a hash to identify files by their name, size and modification time
+class FileStampHasher
+{
+    uint64_t hash_ = 14695981039346656037ull;
+
+public:
+    void add(const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for(size_t i = 0; i < size; i++)
+        {
+            hash_ ^= bytes[i];
+            hash_ *= 1099511628211ull;
+        }
+    }
+    template<typename T>
+    void add(const T value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "Only for plain types");
+        add(&value, sizeof(value));
+    }
+    void add(const std::string& value)
+    {
+        add(value.size());
+        add(value.data(), value.size());
+    }
+    void addFile(const bfs::path& filepath)
+    {
+        boost::system::error_code ec;
+        add(filepath.string());
+        if(bfs::is_directory(filepath, ec))
+        {
+            std::vector<bfs::path> entries;
+            for(const auto& it : bfs::directory_iterator(filepath, ec))
+                entries.push_back(it.path());
+            std::sort(entries.begin(), entries.end());
+            for(const bfs::path& entry : entries)
+                addFile(entry);
+        } else
+        {
+            add(static_cast<uint64_t>(bfs::file_size(filepath, ec)));
+            add(static_cast<int64_t>(bfs::last_write_time(filepath, ec)));
+        }
+    }
+    uint64_t get() const { return hash_; }
+};
+} // namespace
+
 /// Exception thrown when loading failed
 class LoadError : public std::runtime_error
 {
@@ -75,6 +130,28 @@ public:
     {}
 };
 
+/// Decode a file or directory into an archive.
+/// Does not use any shared state (e.g. logging) so it can be called from multiple threads at once
+static libsiedler2::Archiv decodeFileOrDirectory(const bfs::path& filePath,
+                                                 const libsiedler2::ArchivItem_Palette* palette)
+{
+    if(!exists(filePath))
+        throw LoadError(_("File or directory does not exist: %s\n"), filePath);
+    libsiedler2::Archiv archive;
+    if(is_regular_file(filePath))
+    {
+        if(int ec = libsiedler2::Load(filePath, archive, palette))
+            throw LoadError(libsiedler2::getErrorString(ec));
+    } else if(is_directory(filePath))
+    {
+        const std::vector<libsiedler2::FileEntry> files = libsiedler2::ReadFolderInfo(filePath);
+        if(int ec = libsiedler2::LoadFolder(files, archive, palette))
+            throw LoadError(libsiedler2::getErrorString(ec));
+    } else
+        throw LoadError(_("Could not determine type of path %s\n"), filePath);
+    return archive;
+}
+
 Loader::Loader(Log& logger, const RttrConfig& config)
     : logger_(logger), config_(config), isWinterGFX_(false), map_gfx(nullptr), stp(nullptr)
 {
@@ -466,20 +543,68 @@ bool Loader::LoadOverrideFiles()
 bool Loader::LoadFiles(const std::vector<std::string>& files)
 {
     const libsiedler2::ArchivItem_Palette* pal5 = GetPaletteN("pal5");
-    // load the files
+    std::vector<bfs::path> filePaths;
+    filePaths.reserve(files.size());
     for(const std::string& curFile : files)
+        filePaths.push_back(config_.ExpandPath(curFile));
+
+    PreloadFiles(filePaths, pal5, false);
+    // load the files
+    for(const bfs::path& filePath : filePaths)
     {
-        const bfs::path filePath = config_.ExpandPath(curFile);
         if(!Load(filePath, pal5))
         {
             logger_.write(_("Failed to load %s\n")) % filePath;
+            preloadedFiles_.clear();
             return false;
         }
     }
+    preloadedFiles_.clear();
 
     return true;
 }
 
+void Loader::PreloadFiles(const std::vector<bfs::path>& filePaths, const libsiedler2::ArchivItem_Palette* palette,
+                          bool isFromOverrideDir)
+{
+    // Collect all files (including overrides) that will be loaded
+    std::vector<bfs::path> filesToDecode;
+    for(const bfs::path& filePath : filePaths)
+    {
+        if(!IsLoadRequired(filePath, isFromOverrideDir))
+            continue;
+        for(const bfs::path& curFilepath : GetFilesToLoad(filePath))
+        {
+            if(!helpers::contains(filesToDecode, curFilepath) && !helpers::contains(preloadedFiles_, curFilepath))
+                filesToDecode.push_back(curFilepath);
+        }
+    }
+    if(filesToDecode.size() < 2u)
+        return;
+
+    // Decode them in parallel. Merging (in order) is done by Load
+    const Timer timer(true);
+    std::vector<boost::optional<PreloadedFile>> decodedFiles(filesToDecode.size());
+    helpers::parallelFor(filesToDecode.size(), [&](size_t i) {
+        try
+        {
+            const Timer fileTimer(true);
+            libsiedler2::Archiv archiv = decodeFileOrDirectory(filesToDecode[i], palette);
+            decodedFiles[i] = PreloadedFile{std::move(archiv), duration_cast<milliseconds>(fileTimer.getElapsed())};
+        } catch(const LoadError&)
+        {
+            // Ignored. Will be loaded again and reported by Load
+        }
+    });
+    for(unsigned i = 0; i < filesToDecode.size(); i++)
+    {
+        if(decodedFiles[i])
+            preloadedFiles_[filesToDecode[i]] = std::move(*decodedFiles[i]);
+    }
+    logger_.write(_("Decoded %1% files in %2%ms\n")) % filesToDecode.size()
+      % duration_cast<milliseconds>(timer.getElapsed()).count();
+}
+
 void Loader::fillCaches()
 {
     stp = std::make_unique<glTexturePacker>();
@@ -874,12 +999,51 @@ void Loader::fillCaches()
 
     if(SETTINGS.video.shared_textures)
     {
-        // generate mega texture
-        stp->pack();
+        // Packing the sprites is expensive, so we store the packed textures and reuse them as long as the source files
+        // are the same
+        const bfs::path cacheFilepath = config_.ExpandPath(s25::folders::cache) / "sprites.cache";
+        const uint64_t cacheKey = CalcSpriteCacheKey();
+        const Timer timer(true);
+        if(stp->loadCache(cacheFilepath, cacheKey))
+        {
+            logger_.write(_("Loaded sprite textures from cache in %ums\n"))
+              % duration_cast<milliseconds>(timer.getElapsed()).count();
+        } else
+        {
+            // generate mega texture
+            const bool packed = stp->pack(true, GetPaletteN("colors"), GetPaletteN("pal5"));
+            if(packed && bfs::is_directory(cacheFilepath.parent_path()) && !stp->saveCache(cacheFilepath, cacheKey))
+                logger_.write(_("Failed to save sprite texture cache to %1%\n")) % cacheFilepath;
+            stp->releasePixels();
+        }
     } else
         stp.reset();
 }
 
+uint64_t Loader::CalcSpriteCacheKey() const
+{
+    FileStampHasher hasher;
+    hasher.add(SPRITE_CACHE_VERSION);
+    hasher.add(isWinterGFX_);
+    for(const OverrideFolder& folder : overrideFolders_)
+        hasher.add(folder.path.string());
+    // Archives used by fillCaches. Note: files_ is ordered so the result is deterministic
+    const std::vector<ResourceId> usedResources = {"pal5",    "colors",   "jobs",      "carrier",
+                                                   "boat",    "rom_bobs", "mis0bobs", "charburner"};
+    for(const auto& it : files_)
+    {
+        const libsiedler2::Archiv* archiv = &it.second.archiv;
+        if(!helpers::contains(usedResources, it.first) && archiv != map_gfx && !helpers::contains(nation_gfx, archiv))
+            continue;
+        hasher.add(it.first);
+        for(const bfs::path& filepath : it.second.sourceFiles)
+            hasher.addFile(filepath);
+    }
+    for(const libsiedler2::Archiv* archiv : nation_gfx)
+        hasher.add(archiv != nullptr);
+    return hasher.get();
+}
+
 /**
  *  Extrahiert eine Textur aus den Daten.
  */
@@ -1050,7 +1214,26 @@ bool Loader::Load(libsiedler2::Archiv& archiv, const bfs::path& path, const libs
     {
         try
         {
-            libsiedler2::Archiv newEntries = DoLoadFileOrDirectory(curFilepath, palette);
+            libsiedler2::Archiv newEntries;
+            const auto itPreloaded = preloadedFiles_.find(curFilepath);
+            if(itPreloaded != preloadedFiles_.end())
+            {
+                // Same log lines as when loading it here
+                const PreloadedFile& preloadedFile = itPreloaded->second;
+                if(is_directory(curFilepath))
+                {
+                    logger_.write(_("Loading directory %s: ")) % curFilepath;
+                    logger_.write(_("%1% entries done in %2%ms\n")) % preloadedFile.archiv.size()
+                      % preloadedFile.decodeTime.count();
+                } else
+                {
+                    logger_.write(_("Loading \"%s\": ")) % curFilepath;
+                    logger_.write(_("done in %ums\n")) % preloadedFile.decodeTime.count();
+                }
+                newEntries = std::move(itPreloaded->second.archiv);
+                preloadedFiles_.erase(itPreloaded);
+            } else
+                newEntries = DoLoadFileOrDirectory(curFilepath, palette);
 
             std::map<uint16_t, uint16_t> bobMapping;
             if(isBobOverride(curFilepath))
@@ -1082,18 +1265,28 @@ bool Loader::Load(libsiedler2::Archiv& archiv, const bfs::path& path, const libs
  *  @param pfad Path to file or directory
  *  @param palette Palette to use for possible graphic files
  */
-bool Loader::Load(const bfs::path& path, const libsiedler2::ArchivItem_Palette* palette, bool isFromOverrideDir)
+bool Loader::IsLoadRequired(const bfs::path& path, bool isFromOverrideDir)
 {
-    FileEntry& entry = files_[MakeResourceId(path)];
+    const auto itEntry = files_.find(MakeResourceId(path));
+    if(itEntry == files_.end())
+        return true;
+    const FileEntry& entry = itEntry->second;
     // Load if: 1. Not loaded
     //          2. archive content changed BUT we are not loading an override file or the file wasn't loaded since the
     //          last override change
-    if(entry.archiv.empty()
-       || (entry.filesUsed != GetFilesToLoad(path) && (!isFromOverrideDir || !entry.loadedAfterOverrideChange)))
+    return entry.archiv.empty()
+           || (entry.filesUsed != GetFilesToLoad(path) && (!isFromOverrideDir || !entry.loadedAfterOverrideChange));
+}
+
+bool Loader::Load(const bfs::path& path, const libsiedler2::ArchivItem_Palette* palette, bool isFromOverrideDir)
+{
+    if(IsLoadRequired(path, isFromOverrideDir))
     {
+        FileEntry& entry = files_[MakeResourceId(path)];
         if(!Load(entry.archiv, path, palette))
             return false;
         entry.loadedAfterOverrideChange = true;
+        entry.sourceFiles = GetFilesToLoad(path);
     }
     return true;
 }
@@ -1114,22 +1307,19 @@ libsiedler2::Archiv Loader::DoLoadFileOrDirectory(const boost::filesystem::path&
     if(!is_directory(filePath))
         throw LoadError(_("Could not determine type of path %s\n"), filePath);
 
-    logger_.write(_("Loading directory %s\n")) % filePath;
+    logger_.write(_("Loading directory %s: ")) % filePath;
     const Timer timer(true);
-    std::vector<libsiedler2::FileEntry> files = libsiedler2::ReadFolderInfo(filePath);
-    logger_.write(_("  Loading %1% entries: ")) % files.size();
-
-    libsiedler2::Archiv archive;
-
-    if(int ec = libsiedler2::LoadFolder(files, archive, palette))
+    try
+    {
+        libsiedler2::Archiv archive = decodeFileOrDirectory(filePath, palette);
+        logger_.write(_("%1% entries done in %2%ms\n")) % archive.size()
+          % duration_cast<milliseconds>(timer.getElapsed()).count();
+        return archive;
+    } catch(const LoadError& e)
     {
-        logger_.write(_("failed: %1%\n")) % libsiedler2::getErrorString(ec);
-        throw LoadError(libsiedler2::getErrorString(ec));
+        logger_.write(_("failed: %1%\n")) % e.what();
+        throw;
     }
-
-    logger_.write(_("done in %ums\n")) % duration_cast<milliseconds>(timer.getElapsed()).count();
-
-    return archive;
 }
 
 /**
@@ -1147,16 +1337,16 @@ libsiedler2::Archiv Loader::DoLoadFile(const boost::filesystem::path& filePath,
     logger_.write(_("Loading \"%s\": ")) % filePath;
     fflush(stdout);
 
-    libsiedler2::Archiv archive;
-    if(int ec = libsiedler2::Load(filePath, archive, palette))
+    try
     {
-        logger_.write(_("failed: %1%\n")) % libsiedler2::getErrorString(ec);
-        throw LoadError(libsiedler2::getErrorString(ec));
+        libsiedler2::Archiv archive = decodeFileOrDirectory(filePath, palette);
+        logger_.write(_("done in %ums\n")) % duration_cast<milliseconds>(timer.getElapsed()).count();
+        return archive;
+    } catch(const LoadError& e)
+    {
+        logger_.write(_("failed: %1%\n")) % e.what();
+        throw;
     }
-
-    logger_.write(_("done in %ums\n")) % duration_cast<milliseconds>(timer.getElapsed()).count();
-
-    return archive;
 }
 
 bool Loader::LoadOverrideDirectory(const bfs::path& path)
@@ -1179,11 +1369,16 @@ bool Loader::LoadOverrideDirectory(const bfs::path& path)
     }
 
     const libsiedler2::ArchivItem_Palette* pal5 = GetPaletteN("pal5");
+    PreloadFiles(filesAndFolders, pal5, true);
     for(const bfs::path& curPath : filesAndFolders)
     {
         if(!Load(curPath, pal5, true))
+        {
+            preloadedFiles_.clear();
             return false;
+        }
     }
+    preloadedFiles_.clear();
     logger_.write(_("finished in %ums\n")) % duration_cast<milliseconds>(timer.getElapsed()).count();
     return true;
 }
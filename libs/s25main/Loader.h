@@ -31,6 +31,7 @@
 #include "libsiedler2/Archiv.h"
 #include <boost/filesystem/path.hpp>
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -75,6 +76,15 @@ class Loader
         /// List of files used to build this archiv
         std::vector<boost::filesystem::path> filesUsed;
         bool loadedAfterOverrideChange;
+        /// Files (including overrides) the archiv was actually loaded from
+        std::vector<boost::filesystem::path> sourceFiles;
+    };
+    /// File decoded by PreloadFiles
+    struct PreloadedFile
+    {
+        libsiedler2::Archiv archiv;
+        /// Time spent decoding it (in a worker thread)
+        std::chrono::milliseconds decodeTime;
     };
     struct OverrideFolder
     {
@@ -223,9 +233,17 @@ public:
 
 private:
     static ResourceId MakeResourceId(const boost::filesystem::path& filepath);
+    /// Calculate a key identifying all source files (and their versions) used for the sprites created in fillCaches
+    uint64_t CalcSpriteCacheKey() const;
 
     /// Get all files to load for a request of loading filepath
     std::vector<boost::filesystem::path> GetFilesToLoad(const boost::filesystem::path& filepath);
+    /// Return true if Load(path, ..., isFromOverrideDir) would (re)load the file
+    bool IsLoadRequired(const boost::filesystem::path& path, bool isFromOverrideDir);
+    /// Decode all files (including overrides) required to load the given files in parallel.
+    /// The results are stored in preloadedFiles_ and used by the next calls to Load
+    void PreloadFiles(const std::vector<boost::filesystem::path>& filePaths,
+                      const libsiedler2::ArchivItem_Palette* palette, bool isFromOverrideDir);
     bool MergeArchives(libsiedler2::Archiv& targetArchiv, libsiedler2::Archiv& otherArchiv);
 
     /// Load all sounds
@@ -250,6 +268,8 @@ private:
     const RttrConfig& config_;
     std::vector<OverrideFolder> overrideFolders_;
     std::map<ResourceId, FileEntry> files_;
+    /// Files decoded by PreloadFiles but not yet merged into their archives
+    std::map<boost::filesystem::path, PreloadedFile> preloadedFiles_;
     std::vector<glFont> fonts;
 
     bool isWinterGFX_;
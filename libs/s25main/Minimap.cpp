@@ -30,12 +30,12 @@ void Minimap::CreateMapTexture()
 
     RTTR_FOREACH_PT(MapPoint, mapSize)
     {
+        const std::array<unsigned, 2> colors = CalcNodeColors(pt);
         // Die 2. Terraindreiecke durchgehen
         for(unsigned t = 0; t < 2; ++t)
         {
-            libsiedler2::ColorBGRA color(CalcPixelColor(pt, t));
-            unsigned xCoord = (pt.x * 2 + t + (pt.y & 1)) % buffer.getWidth();
-            buffer.set(xCoord, pt.y, color);
+            const DrawPoint texPos = GetTexPos(pt, t);
+            buffer.set(texPos.x, texPos.y, libsiedler2::ColorBGRA(colors[t]));
         }
     }
 
@@ -50,6 +50,11 @@ void Minimap::Draw(const Rect& rect)
         map.DrawFull(rect);
 }
 
+std::array<unsigned, 2> Minimap::CalcNodeColors(const MapPoint pt)
+{
+    return {{CalcPixelColor(pt, 0), CalcPixelColor(pt, 1)}};
+}
+
 void Minimap::BeforeDrawing() {}
 
 /**
@@ -20,6 +20,7 @@
 #include "Rect.h"
 #include "ogl/glArchivItem_Bitmap_Direct.h"
 #include "gameTypes/MapCoordinates.h"
+#include <array>
 
 class Minimap
 {
@@ -51,6 +52,13 @@ protected:
     /// Erstellt die Textur
     void CreateMapTexture();
     virtual unsigned CalcPixelColor(MapPoint pt, unsigned t) = 0;
+    /// Calculate the colors of both triangles (pixels) of a node. Uses CalcPixelColor by default
+    virtual std::array<unsigned, 2> CalcNodeColors(MapPoint pt);
+    /// Return the position of the pixel of triangle t of the node in the texture
+    DrawPoint GetTexPos(const MapPoint pt, const unsigned t) const
+    {
+        return DrawPoint((pt.x * 2 + t + (pt.y & 1)) % (mapSize.x * 2), pt.y);
+    }
     /// Zusätzliche Dinge, die die einzelnen Maps vor dem Zeichenvorgang zu tun haben
     virtual void BeforeDrawing();
 };
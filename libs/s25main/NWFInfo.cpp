@@ -61,7 +61,7 @@ bool NWFInfo::addPlayerCmds(unsigned playerId, const PlayerGameCommands& cmds)
     // others are received. This means no one can execute NWF n + cmdDelay before we executed NWF n. So the last NWF one
     // can have executed is n + cmDelay - 1 with the commands for n + cmdDelay - 1 + cmdDelay. Counting those leads to
     // cmdDelay*2 pending commands.
-    if(it->commands.size() >= 2 * cmdDelay_)
+    if(!allowBacklog_ && it->commands.size() >= 2 * cmdDelay_)
         return false;
     it->commands.push(cmds);
     return true;
@@ -138,8 +138,13 @@ void NWFInfo::execute(FramesInfo& info)
 }
 
 unsigned NWFInfo::getLastNWF() const
+{
+    return getLastServerInfo().nextNWF;
+}
+
+const NWFServerInfo& NWFInfo::getLastServerInfo() const
 {
     if(serverInfos_.empty())
         throw std::runtime_error("Server is not ready yet");
-    return serverInfos_.back().nextNWF;
+    return serverInfos_.back();
 }
@@ -52,9 +52,11 @@ class NWFInfo
     std::queue<NWFServerInfo> serverInfos_;
     std::vector<NWFPlayerInfo> playerInfos_;
     unsigned nextNWF_, cmdDelay_;
+    /// Accept any number of pending commands (used while catching up after a rejoin)
+    bool allowBacklog_;
 
 public:
-    NWFInfo() : nextNWF_(0), cmdDelay_(1) {}
+    NWFInfo() : nextNWF_(0), cmdDelay_(1), allowBacklog_(false) {}
     /// Has to be called on game start with the first server info. Command delay is the number of NWS a command is sent
     /// in advance (>=1)
     void init(unsigned nextNWF, unsigned cmdDelay);
@@ -82,6 +84,15 @@ public:
     unsigned getNextNWF() const { return nextNWF_; }
     /// Return the nextNWF from the last serverInfo entry (must exist)
     unsigned getLastNWF() const;
+    /// Return the last serverInfo entry (must exist)
+    const NWFServerInfo& getLastServerInfo() const;
     /// Number of NWFs a command is sent in advance (>= 1)
     unsigned getCmdDelay() const { return cmdDelay_; }
+    /// Number of NWFs announced by the server but not yet executed
+    unsigned getNumPendingNWFs() const { return serverInfos_.size(); }
+    /// First NWF that was not yet announced. No one can have executed it
+    unsigned getFirstUnannouncedNWF() const { return serverInfos_.empty() ? nextNWF_ : serverInfos_.back().nextNWF; }
+    /// Allow more pending commands than can occur in lockstep. Required when the commands of already executed NWFs
+    /// are received at once (rejoining player)
+    void setBacklogAllowed(bool allowed) { allowBacklog_ = allowed; }
 };
@@ -15,9 +15,12 @@
 // You should have received a copy of the GNU General Public License
 // along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
 
+#include "EventManager.h"
 #include "GamePlayer.h"
 #include "pathfinding/FreePathFinder.h"
 #include "pathfinding/FreePathFinderImpl.h"
+#include "pathfinding/HierarchicalPathFinder.h"
+#include "pathfinding/HumanFlowFields.h"
 #include "pathfinding/PathConditionHuman.h"
 #include "pathfinding/PathConditionShip.h"
 #include "pathfinding/PathConditionTrade.h"
@@ -39,6 +42,12 @@ helpers::OptionalEnum<Direction> GameWorldBase::FindHumanPath(const MapPoint sta
         return boost::none;
 }
 
+helpers::OptionalEnum<Direction> GameWorldBase::FindHumanPathToSharedGoal(const MapPoint start, const MapPoint dest,
+                                                                          const unsigned max_route) const
+{
+    return GetHumanFlowFields().GetDir(start, dest, max_route, GetEvMgr().GetCurrentGF());
+}
+
 /// Wegfindung für Menschen im Straßennetz
 RoadPathDirection GameWorldGame::FindHumanPathOnRoads(const noRoadNode& start, const noRoadNode& goal, unsigned* length,
                                                       MapPoint* firstPt, const RoadSegment* const forbidden)
@@ -53,10 +62,19 @@ RoadPathDirection GameWorldGame::FindHumanPathOnRoads(const noRoadNode& start, c
 
 /// Wegfindung für Waren im Straßennetz
 RoadPathDirection GameWorldGame::FindPathForWareOnRoads(const noRoadNode& start, const noRoadNode& goal,
-                                                        unsigned* length, MapPoint* firstPt, unsigned max)
+                                                        unsigned* length, MapPoint* firstPt, unsigned max,
+                                                        std::vector<unsigned>* segmentIds)
 {
     RoadPathDirection first_dir;
-    if(GetRoadPathFinder().FindPath(start, goal, true, max, nullptr, length, &first_dir, firstPt))
+    GamePlayer& owner = GetPlayer(goal.GetPlayer());
+    bool found;
+    // Ship connections are not part of the next-hop tables
+    if(owner.GetBuildingRegister().GetHarbors().empty())
+        found = GetRoadPathFinder().FindWarePath(start, goal, owner.GetWareRouteTables(), max, length, &first_dir,
+                                                 firstPt, segmentIds);
+    else
+        found = GetRoadPathFinder().FindPath(start, goal, true, max, nullptr, length, &first_dir, firstPt, segmentIds);
+    if(found)
         return first_dir;
     else
         return RoadPathDirection::None;
@@ -79,12 +97,19 @@ bool GameWorldBase::FindShipPathToHarbor(const MapPoint start, unsigned harborId
     }
     // Add a few fields reserve
     maxDistance += 6;
+    const SeaRouteField* routeField = GetSeaRouteField(harborId, seaId);
+    if(routeField)
+        return routeField->GetRoute(*this, start, maxDistance, route, length);
     return FindShipPath(start, GetCoastalPoint(harborId, seaId), maxDistance, route, length);
 }
 
 bool GameWorldBase::FindShipPath(const MapPoint start, const MapPoint dest, unsigned maxDistance,
                                  std::vector<Direction>* route, unsigned* length)
 {
+    // Long routes are searched on the sector graph which is a lot cheaper than searching the whole sea.
+    // Same lengths as the regular path finder
+    if(CalcDistance(start, dest) >= HierarchicalPathFinder<PathConditionShip>::MIN_DISTANCE)
+        return GetShipPathFinder().FindPath(start, dest, maxDistance, route, length);
     return GetFreePathFinder().FindPath(start, dest, true, maxDistance, route, length, nullptr,
                                         PathConditionShip(*this));
 }
@@ -45,6 +45,18 @@ public:
     }
 };
 
+static bool LoadApplication()
+{
+    ApplicationLoader loader(RTTRCONFIG, LOADER, LOG, SETTINGS.sound.playlist);
+    if(!loader.load())
+        return false;
+    if(loader.getPlaylist())
+        MUSICPLAYER.SetPlaylist(std::move(*loader.getPlaylist()));
+    if(SETTINGS.sound.musik)
+        MUSICPLAYER.Play();
+    return true;
+}
+
 bool QuickStartGame(const boost::filesystem::path& mapOrReplayPath, bool singlePlayer)
 {
     if(!exists(mapOrReplayPath))
@@ -53,13 +65,8 @@ bool QuickStartGame(const boost::filesystem::path& mapOrReplayPath, bool singleP
         return false;
     }
 
-    ApplicationLoader loader(RTTRCONFIG, LOADER, LOG, SETTINGS.sound.playlist);
-    if(!loader.load())
+    if(!LoadApplication())
         return false;
-    if(loader.getPlaylist())
-        MUSICPLAYER.SetPlaylist(std::move(*loader.getPlaylist()));
-    if(SETTINGS.sound.musik)
-        MUSICPLAYER.Play();
 
     const CreateServerInfo csi(singlePlayer ? ServerType::LOCAL : ServerType::DIRECT, SETTINGS.server.localPort,
                                _("Unlimited Play"));
@@ -80,3 +87,28 @@ bool QuickStartGame(const boost::filesystem::path& mapOrReplayPath, bool singleP
         return GAMECLIENT.StartReplay(mapOrReplayPath);
     }
 }
+
+bool QuickSpectateGame(const std::string& serverAndPort)
+{
+    const auto portSeparator = serverAndPort.rfind(':');
+    if(portSeparator == std::string::npos)
+    {
+        LOG.write(_("Expected server and port (host:port) but got %1%\n")) % serverAndPort;
+        return false;
+    }
+    const std::string server = serverAndPort.substr(0, portSeparator);
+    const boost::optional<uint16_t> port = checkPort(serverAndPort.substr(portSeparator + 1));
+    if(!port)
+    {
+        LOG.write(_("Invalid port in %1%\n")) % serverAndPort;
+        return false;
+    }
+
+    if(!LoadApplication())
+        return false;
+
+    LOG.write(_("Waiting for the game from %1%...\n")) % serverAndPort;
+    // The game starts when its beginning was received, so this must stay active till then
+    static SwitchOnStart switchOnStart;
+    return GAMECLIENT.StartSpectating(server, *port, false);
+}
@@ -22,3 +22,5 @@
 
 /// Tries to start a game (map, savegame or replay) and returns whether this was successfull
 bool QuickStartGame(const boost::filesystem::path& mapOrReplayPath, bool singlePlayer = false);
+/// Connects to the spectator port of a server (given as host:port) and watches the game as soon as it is received
+bool QuickSpectateGame(const std::string& serverAndPort);
@@ -31,6 +31,12 @@ std::string Replay::GetSignature() const
 uint16_t Replay::GetVersion() const
 {
     /// Version des Replay-Formates
+    return 7;
+}
+
+uint16_t Replay::GetMinVersion() const
+{
+    /// Version 6 only differs in the format of the game commands
     return 6;
 }
 
@@ -267,7 +273,10 @@ void Replay::ReadGameCommand(uint8_t& player, PlayerGameCommands& cmds)
     Serializer ser;
     ser.ReadFromFile(file);
     player = ser.PopUnsignedChar();
-    cmds.Deserialize(ser);
+    if(GetFileVersion() < 7)
+        cmds.DeserializeLegacy(ser);
+    else
+        cmds.Deserialize(ser);
 }
 
 void Replay::UpdateLastGF(unsigned last_gf)
@@ -48,6 +48,7 @@ public:
 
     std::string GetSignature() const override;
     uint16_t GetVersion() const override;
+    uint16_t GetMinVersion() const override;
 
     /// Beginnt die Save-Datei und schreibt den Header
     bool StartRecording(const boost::filesystem::path& filepath, const MapInfo& mapInfo);
@@ -19,6 +19,7 @@
 
 #include "Replay.h"
 #include <boost/filesystem/path.hpp>
+#include <boost/nowide/fstream.hpp>
 #include <string>
 
 struct ReplayInfo
@@ -36,3 +37,21 @@ struct ReplayInfo
     /// Alles sichtbar (FoW deaktiviert)
     bool all_visible;
 };
+
+/// Replay that is streamed live from the spectator relay of a server
+struct SpectatorInfo
+{
+    SpectatorInfo() : headerSize(0), numBytesReceived(0), endGF(0), isNextGFPending(false), isCatchingUp(true) {}
+
+    /// Local copy of the stream that is played like a replay
+    boost::filesystem::path filepath;
+    boost::nowide::ofstream file;
+    unsigned headerSize;
+    unsigned numBytesReceived;
+    /// All commands for GFs before this one were received
+    unsigned endGF;
+    /// The GF of the next command was not received yet
+    bool isNextGFPending;
+    /// Fast forward till we are close to the received GFs (after joining)
+    bool isCatchingUp;
+};
@@ -0,0 +1,87 @@
+// Copyright (c) 2005 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "RoadComponents.h"
+#include "RoadSegment.h"
+#include "nodeObjs/noRoadNode.h"
+
+namespace {
+/// Returns the flag of a road node: The node itself for flags, the flag in front of it for buildings
+const noRoadNode* getFlagOf(const noRoadNode& node)
+{
+    if(node.GetGOT() == GOT_FLAG)
+        return &node;
+    const RoadSegment* entrance = node.GetRoute(Direction::SOUTHEAST);
+    return entrance ? entrance->GetF1() : nullptr;
+}
+} // namespace
+
+void RoadComponents::Connect(const RoadSegment& road)
+{
+    // No need to update anything, the next query rebuilds everything anyway
+    if(isValid_)
+        Unite(road.GetF1()->GetObjId(), road.GetF2()->GetObjId());
+}
+
+void RoadComponents::Invalidate()
+{
+    isValid_ = false;
+    parent_.clear();
+}
+
+bool RoadComponents::AreConnected(const noRoadNode& node1, const noRoadNode& node2,
+                                  const std::list<RoadSegment*>& roads)
+{
+    const noRoadNode* flag1 = getFlagOf(node1);
+    const noRoadNode* flag2 = getFlagOf(node2);
+    if(!flag1 || !flag2)
+        return false;
+    if(flag1 == flag2)
+        return true;
+    if(!isValid_)
+        Rebuild(roads);
+    return FindRoot(flag1->GetObjId()) == FindRoot(flag2->GetObjId());
+}
+
+unsigned RoadComponents::FindRoot(unsigned flagId)
+{
+    // Iterative with path halving to keep the trees flat
+    for(auto it = parent_.find(flagId); it != parent_.end(); it = parent_.find(flagId))
+    {
+        const auto itParent = parent_.find(it->second);
+        if(itParent != parent_.end())
+            it->second = itParent->second;
+        flagId = it->second;
+    }
+    return flagId;
+}
+
+void RoadComponents::Unite(unsigned flagId1, unsigned flagId2)
+{
+    const unsigned root1 = FindRoot(flagId1);
+    const unsigned root2 = FindRoot(flagId2);
+    if(root1 != root2)
+        parent_[root1] = root2;
+}
+
+void RoadComponents::Rebuild(const std::list<RoadSegment*>& roads)
+{
+    parent_.clear();
+    for(const RoadSegment* road : roads)
+        Unite(road->GetF1()->GetObjId(), road->GetF2()->GetObjId());
+    isValid_ = true;
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2005 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+class noRoadNode;
+class RoadSegment;
+
+/// Connected components of the road network of a player (union-find over the flags)
+/// Roads are only ever added or split incrementally. Removing a road invalidates the index which is then rebuilt from
+/// the road list on the next query. This is a cache only and hence not serialized.
+class RoadComponents
+{
+public:
+    /// Adds the connection made by the given road
+    void Connect(const RoadSegment& road);
+    /// Marks the index as outdated, e.g. after a road was removed
+    void Invalidate();
+    /// True if both nodes are connected by roads (ignoring ship connections). Buildings are handled via their flag.
+    /// Rebuilds the index from the given roads if required
+    bool AreConnected(const noRoadNode& node1, const noRoadNode& node2, const std::list<RoadSegment*>& roads);
+    bool IsValid() const { return isValid_; }
+
+private:
+    /// Returns the representative of the component containing the flag with the given id
+    unsigned FindRoot(unsigned flagId);
+    void Unite(unsigned flagId1, unsigned flagId2);
+    void Rebuild(const std::list<RoadSegment*>& roads);
+
+    /// Parent flag id per flag id. Flags without entry are their own component
+    std::unordered_map<unsigned, unsigned> parent_;
+    bool isValid_ = false;
+};
@@ -186,7 +186,7 @@ void RoadSegment::SplitRoad(noFlag* splitflag)
         }
     }
 
-    gwg->GetPlayer(f1->GetPlayer()).AddRoad(second);
+    gwg->GetPlayer(f1->GetPlayer()).RoadSplit(*this, second);
 
     for(unsigned char i = 0; i < 2; ++i)
     {
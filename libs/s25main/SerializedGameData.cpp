@@ -97,8 +97,8 @@
 /// GetGameDataVersion. Then reset this number to 1. Changelog: 2: All player buildings together, variable width size
 /// for containers and ship names 3: Landscape and terrain names stored as strings 4:
 /// STATE_HUNTER_WAITING_FOR_ANIMAL_READY introduced as sub-state of STATE_HUNTER_FINDINGSHOOTINGPOINT 5: Make
-/// RoadPathDirection contiguous and use optional for ware in nofBuildingWorker
-static const unsigned currentGameDataVersion = 5;
+/// RoadPathDirection contiguous and use optional for ware in nofBuildingWorker 6: Route segments of wares
+static const unsigned currentGameDataVersion = 6;
 
 GameObject* SerializedGameData::Create_GameObject(const GO_Type got, const unsigned obj_id)
 {
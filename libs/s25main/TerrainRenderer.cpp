@@ -1137,6 +1137,38 @@ void TerrainRenderer::UpdateAllColors(const GameWorldViewer& gwv)
     }
 }
 
+void TerrainRenderer::UpdateAll(const GameWorldViewer& gwv)
+{
+    // Terrain types never change, so only positions (altitude) and colors (visibility, shadow) need an update
+    RTTR_FOREACH_PT(MapPoint, size_)
+    {
+        UpdateVertexPos(pt, gwv);
+        UpdateVertexColor(pt, gwv);
+    }
+
+    RTTR_FOREACH_PT(MapPoint, size_)
+        UpdateBorderVertex(pt);
+
+    RTTR_FOREACH_PT(MapPoint, size_)
+    {
+        UpdateTrianglePos(pt, false);
+        UpdateTriangleColor(pt, false);
+    }
+
+    RTTR_FOREACH_PT(MapPoint, size_)
+    {
+        UpdateBorderTrianglePos(pt, false);
+        UpdateBorderTriangleColor(pt, false);
+    }
+
+    if(vbo_vertices.isValid())
+    {
+        vbo_vertices.update(gl_vertices);
+        vbo_colors.update(gl_colors);
+        vbo_colors.unbind();
+    }
+}
+
 MapPoint TerrainRenderer::GetNeighbour(const MapPoint& pt, const Direction dir) const
 {
     return MakeMapPoint(::GetNeighbour(Position(pt), dir), size_);
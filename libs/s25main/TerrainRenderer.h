@@ -70,6 +70,8 @@ public:
 
     /// Recalculates all colors on the map
     void UpdateAllColors(const GameWorldViewer& gwv);
+    /// Recalculates all positions and colors on the map (e.g. after the callbacks were not called for some time)
+    void UpdateAll(const GameWorldViewer& gwv);
 
 private:
     struct MapTile
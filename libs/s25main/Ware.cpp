@@ -24,6 +24,7 @@
 #include "buildings/noBuilding.h"
 #include "buildings/nobBaseWarehouse.h"
 #include "buildings/nobHarborBuilding.h"
+#include "helpers/containerUtils.h"
 #include "world/GameWorldGame.h"
 #include "nodeObjs/noFlag.h"
 #include "nodeObjs/noRoadNode.h"
@@ -31,19 +32,22 @@
 #include "gameData/GameConsts.h"
 #include "gameData/ShieldConsts.h"
 #include "s25util/Log.h"
+#include <limits>
 #include <sstream>
 
 Ware::Ware(const GoodType type, noBaseBuilding* goal, noRoadNode* location)
     : next_dir(RoadPathDirection::None), state(STATE_WAITINWAREHOUSE), location(location),
       type(convertShieldToNation(type,
                                  gwg->GetPlayer(location->GetPlayer()).nation)), // Use nation specific shield
-      goal(goal), next_harbor(MapPoint::Invalid())
+      goal(goal), next_harbor(MapPoint::Invalid()), isRouteKnown_(false)
 {
     RTTR_Assert(location);
     // Ware in den Index mit eintragen
     gwg->GetPlayer(location->GetPlayer()).RegisterWare(this);
     if(goal)
         goal->TakeWare(this);
+    else
+        CheckLost();
 }
 
 Ware::~Ware() = default;
@@ -71,6 +75,8 @@ void Ware::Serialize_Ware(SerializedGameData& sgd) const
     sgd.PushEnum<uint8_t>(type);
     sgd.PushObject(goal, false);
     sgd.PushMapPoint(next_harbor);
+    sgd.PushContainer(routeSegments_);
+    sgd.PushBool(isRouteKnown_);
 }
 
 static RoadPathDirection PopRoadPathDirection(SerializedGameData& sgd)
@@ -92,23 +98,34 @@ static RoadPathDirection PopRoadPathDirection(SerializedGameData& sgd)
 Ware::Ware(SerializedGameData& sgd, const unsigned obj_id)
     : GameObject(sgd, obj_id), next_dir(PopRoadPathDirection(sgd)), state(State(sgd.PopUnsignedChar())),
       location(sgd.PopObject<noRoadNode>(GOT_UNKNOWN)), type(sgd.Pop<GoodType>()),
-      goal(sgd.PopObject<noBaseBuilding>(GOT_UNKNOWN)), next_harbor(sgd.PopMapPoint())
-{}
+      goal(sgd.PopObject<noBaseBuilding>(GOT_UNKNOWN)), next_harbor(sgd.PopMapPoint()), isRouteKnown_(false)
+{
+    if(sgd.GetGameDataVersion() >= 6)
+    {
+        sgd.PopContainer(routeSegments_);
+        isRouteKnown_ = sgd.PopBool();
+    }
+}
 
 void Ware::SetGoal(noBaseBuilding* newGoal)
 {
     goal = newGoal;
     if(goal)
         goal->TakeWare(this);
+    else
+        CheckLost();
 }
 
 void Ware::RecalcRoute()
 {
     // Nächste Richtung nehmen
     if(location && goal)
-        next_dir = gwg->FindPathForWareOnRoads(*location, *goal, nullptr, &next_harbor);
+        next_dir = FindPathToGoal();
     else
+    {
         next_dir = RoadPathDirection::None;
+        InvalidateRoute();
+    }
 
     // Evtl gibts keinen Weg mehr? Dann wieder zurück ins Lagerhaus (wenns vorher überhaupt zu nem Ziel ging)
     if(next_dir == RoadPathDirection::None && goal)
@@ -189,6 +206,7 @@ void Ware::GoalDestroyed()
             {
                 goal = nullptr;
                 next_dir = RoadPathDirection::None;
+                InvalidateRoute();
             }
         }
         // Wenn sie an einer Flagge liegt, muss der Weg neu berechnet werden und dem Träger Bescheid gesagt werden
@@ -237,6 +255,7 @@ void Ware::GoalDestroyed()
             }
         }
     }
+    CheckLost();
 }
 
 void Ware::WaitAtFlag(noFlag* flag)
@@ -269,6 +288,8 @@ void Ware::NotifyGoalAboutLostWare()
         goal->WareLost(this);
         goal = nullptr;
         next_dir = RoadPathDirection::None;
+        InvalidateRoute();
+        CheckLost();
     }
 }
 
@@ -327,18 +348,53 @@ bool Ware::FindRouteToWarehouse()
         if(state != STATE_CARRIED)
         {
             if(location == goal)
+            {
                 next_dir = RoadPathDirection::None; // Warehouse will detect this
-            else
+                InvalidateRoute();
+            } else
             {
-                next_dir = gwg->FindPathForWareOnRoads(*location, *goal, nullptr, &next_harbor);
+                next_dir = FindPathToGoal();
                 RTTR_Assert(next_dir != RoadPathDirection::None);
             }
         }
     } else
+    {
         next_dir = RoadPathDirection::None; // Make sure we are not going anywhere
+        InvalidateRoute();
+    }
     return goal != nullptr;
 }
 
+RoadPathDirection Ware::FindPathToGoal()
+{
+    RTTR_Assert(location && goal);
+    const RoadPathDirection dir =
+      gwg->FindPathForWareOnRoads(*location, *goal, nullptr, &next_harbor, std::numeric_limits<unsigned>::max(),
+                                  &routeSegments_);
+    isRouteKnown_ = dir != RoadPathDirection::None;
+    if(!isRouteKnown_)
+        routeSegments_.clear();
+    return dir;
+}
+
+void Ware::InvalidateRoute()
+{
+    isRouteKnown_ = false;
+    routeSegments_.clear();
+}
+
+bool Ware::IsRouteAffectedBy(const unsigned segmentId) const
+{
+    return !isRouteKnown_ || helpers::contains(routeSegments_, segmentId);
+}
+
+void Ware::RoadSplit(const unsigned oldSegmentId, const unsigned newSegmentId)
+{
+    // The old id is kept for the first part, so the route might now use both
+    if(isRouteKnown_ && helpers::contains(routeSegments_, oldSegmentId))
+        routeSegments_.push_back(newSegmentId);
+}
+
 /// a lost ware got ordered
 unsigned Ware::CheckNewGoalForLostWare(const noBaseBuilding& newgoal) const
 {
@@ -384,7 +440,7 @@ void Ware::SetNewGoalForLostWare(noBaseBuilding* newgoal)
     const auto newDir = CalcPathToGoal(*newgoal).dir;
     if(newDir != RoadPathDirection::None) // there is a valid path to the goal? -> ordered!
     {
-        next_dir = newDir;
+        SetNextDir(newDir);
         SetGoal(newgoal);
         CallCarrier();
     }
@@ -397,6 +453,9 @@ bool Ware::IsRouteToGoal()
         return false;
     if(location == goal)
         return true; // We are at our goal. All ok
+    // Cheap check first: Connected by roads implies a path. Otherwise there might still be one using ships
+    if(gwg->GetPlayer(location->GetPlayer()).AreConnectedByRoads(*location, *goal))
+        return true;
     return gwg->FindPathForWareOnRoads(*location, *goal) != RoadPathDirection::None;
 }
 
@@ -413,6 +472,7 @@ void Ware::ShipJorneyEnded(nobHarborBuilding* hb)
     RTTR_Assert(hb);
     state = STATE_WAITINWAREHOUSE;
     location = hb;
+    CheckLost();
 }
 
 /// Beginnt damit auf ein Schiff im Hafen zu warten
@@ -423,6 +483,12 @@ void Ware::WaitForShip(nobHarborBuilding* hb)
     location = hb;
 }
 
+void Ware::CheckLost()
+{
+    if(location && IsLostWare())
+        gwg->GetPlayer(location->GetPlayer()).RegisterLostWare(this);
+}
+
 std::string Ware::ToString() const
 {
     std::stringstream s;
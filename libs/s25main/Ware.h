@@ -22,6 +22,7 @@
 #include "gameTypes/GoodTypes.h"
 #include "gameTypes/MapCoordinates.h"
 #include "gameTypes/RoadPathDirection.h"
+#include <vector>
 
 class noBaseBuilding;
 class nobHarborBuilding;
@@ -57,6 +58,10 @@ private:
     noBaseBuilding* goal;
     /// Nächster Hafenpunkt, der ggf. angesteuert werden soll
     MapPoint next_harbor;
+    /// Ids of the road segments on the last calculated route from location to goal
+    std::vector<unsigned> routeSegments_;
+    /// False if next_dir was not set from a calculated route (e.g. set from outside), so routeSegments_ is unusable
+    bool isRouteKnown_;
 
 public:
     Ware(GoodType type, noBaseBuilding* goal, noRoadNode* location);
@@ -84,8 +89,17 @@ public:
     /// Berechnet den Weg neu zu ihrem Ziel
     void RecalcRoute();
     /// set new next dir
-    void SetNextDir(RoadPathDirection newNextDir) { next_dir = newNextDir; }
-    void SetNextDir(Direction newNextDir) { next_dir = toRoadPathDirection(newNextDir); }
+    void SetNextDir(RoadPathDirection newNextDir)
+    {
+        next_dir = newNextDir;
+        InvalidateRoute();
+    }
+    void SetNextDir(Direction newNextDir) { SetNextDir(toRoadPathDirection(newNextDir)); }
+    /// Return true if the current route might use the given road segment and hence needs to be recalculated when it is
+    /// destroyed
+    bool IsRouteAffectedBy(unsigned segmentId) const;
+    /// Notify the ware that a road segment was split and the 2nd part got the new id
+    void RoadSplit(unsigned oldSegmentId, unsigned newSegmentId);
     /// Wird aufgerufen, wenn es das Ziel der Ware nicht mehr gibt und sie wieder "nach Hause" getragen werden muss
     void GoalDestroyed();
     /// Changes the state of the ware
@@ -178,4 +192,9 @@ private:
         RoadPathDirection dir;
     };
     RouteParams CalcPathToGoal(const noBaseBuilding& newgoal) const;
+    /// Calculate the route from the current location to the goal and remember the used road segments
+    RoadPathDirection FindPathToGoal();
+    void InvalidateRoute();
+    /// Tell the owner if we are lost now, so it can find a new goal for us
+    void CheckLost();
 };
@@ -80,6 +80,7 @@ void HandleBuildingNote(AIEventManager& eventMgr, const BuildingNote& note)
         case BuildingNote::LuaOrder:
             ev = std::make_unique<AIEvent::Building>(AIEvent::LuaConstructionOrder, note.pos, note.bld);
             break;
+        case BuildingNote::TroopsChanged: return;
         default: RTTR_Assert(false); return;
     }
     eventMgr.AddAIEvent(std::move(ev));
@@ -1735,20 +1736,19 @@ void AIPlayerJH::TryToAttack()
         unsigned attackersStrength = 0;
 
         // ask each of nearby own military buildings for soldiers to contribute to the potential attack
-        sortedMilitaryBlds myBuildings = gwb.LookForMilitaryBuildings(dest, 2);
-        for(const nobBaseMilitary* otherMilBld : myBuildings)
-        {
+        gwb.CheckMilitaryBuildings(dest, 2, [&](const nobBaseMilitary* otherMilBld) {
             if(otherMilBld->GetPlayer() == playerId)
             {
                 const auto* myMil = dynamic_cast<const nobMilitary*>(otherMilBld);
                 if(!myMil || myMil->IsUnderAttack())
-                    continue;
+                    return false;
 
                 unsigned newAttackers;
                 attackersStrength += myMil->GetSoldiersStrengthForAttack(dest, newAttackers);
                 attackersCount += newAttackers;
             }
-        }
+            return false;
+        });
 
         if(attackersCount == 0)
             continue;
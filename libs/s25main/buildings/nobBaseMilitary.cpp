@@ -24,6 +24,7 @@
 #include "figures/nofDefender.h"
 #include "helpers/containerUtils.h"
 #include "nobMilitary.h"
+#include "pathfinding/HumanFlowFields.h"
 #include "random/Random.h"
 #include "world/GameWorldGame.h"
 #include "gameData/BuildingProperties.h"
@@ -32,7 +33,8 @@
 
 nobBaseMilitary::nobBaseMilitary(const BuildingType type, const MapPoint pos, const unsigned char player,
                                  const Nation nation)
-    : noBuilding(type, pos, player, nation), leaving_event(nullptr), go_out(false), defender_(nullptr)
+    : noBuilding(type, pos, player, nation), leaving_event(nullptr), go_out(false), defender_(nullptr),
+      militarySquareIdx_(0)
 {}
 
 nobBaseMilitary::~nobBaseMilitary()
@@ -56,6 +58,7 @@ void nobBaseMilitary::DestroyBuilding()
     for(auto& tmpAggressor : tmpAggressors)
         tmpAggressor->AttackedGoalDestroyed();
     aggressors.clear();
+    gwg->GetHumanFlowFields().Remove(GetFlagPos());
 
     // Aggressiv-Verteidigenden Soldaten Bescheid sagen, dass sie nach Hause gehen können
     std::vector<nofAggressiveDefender*> tmpDefenders(aggressive_defenders.begin(), aggressive_defenders.end());
@@ -116,7 +119,8 @@ void nobBaseMilitary::Serialize_nobBaseMilitary(SerializedGameData& sgd) const
     sgd.PushObject(defender_, true);
 }
 
-nobBaseMilitary::nobBaseMilitary(SerializedGameData& sgd, const unsigned obj_id) : noBuilding(sgd, obj_id)
+nobBaseMilitary::nobBaseMilitary(SerializedGameData& sgd, const unsigned obj_id)
+    : noBuilding(sgd, obj_id), militarySquareIdx_(0)
 {
     sgd.PopObjectContainer(leave_house, GOT_UNKNOWN);
     leaving_event = sgd.PopEvent();
@@ -239,6 +243,15 @@ MapPoint nobBaseMilitary::FindAnAttackerPlace(unsigned short& ret_radius, nofAtt
     return minPt;
 }
 
+void nobBaseMilitary::UnlinkAggressor(nofAttacker* soldier)
+{
+    RTTR_Assert(IsAggressor(soldier));
+    aggressors.remove(soldier);
+    // Attack is over
+    if(aggressors.empty())
+        gwg->GetHumanFlowFields().Remove(GetFlagPos());
+}
+
 bool nobBaseMilitary::CallDefender(nofAttacker* attacker)
 {
     // Ist noch ein Verteidiger draußen (der z.B. grad wieder reingeht?
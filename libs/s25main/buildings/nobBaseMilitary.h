@@ -83,11 +83,7 @@ public:
 
     /// Soldaten zur Angreifer-Liste hinzufügen und wieder entfernen
     void LinkAggressor(nofAttacker* soldier) { aggressors.push_back(soldier); }
-    virtual void UnlinkAggressor(nofAttacker* soldier)
-    {
-        RTTR_Assert(IsAggressor(soldier));
-        aggressors.remove(soldier);
-    }
+    virtual void UnlinkAggressor(nofAttacker* soldier);
 
     /// Soldaten zur Aggressiven-Verteidiger-Liste hinzufügen und wieder entfernen
     void LinkAggressiveDefender(nofAggressiveDefender* soldier) { aggressive_defenders.push_back(soldier); }
@@ -156,6 +152,11 @@ protected:
     virtual nofDefender* ProvideDefender(nofAttacker* attacker) = 0;
     /// Add a figure that will leave the house
     void AddLeavingFigure(noFigure* fig);
+
+private:
+    friend class MilitarySquares;
+    /// Index of this building in its military square for removal in O(1). Maintained by MilitarySquares only
+    unsigned militarySquareIdx_;
 };
 
 class sortedMilitaryBlds : public boost::container::flat_set<nobBaseMilitary*, nobBaseMilitary::Comparer>
@@ -37,6 +37,7 @@
 #include "ogl/glArchivItem_Bitmap.h"
 #include "ogl/glArchivItem_Bitmap_Player.h"
 #include "pathfinding/FindPathReachable.h"
+#include "pathfinding/HumanFlowFields.h"
 #include "postSystem/PostMsgWithBuilding.h"
 #include "random/Random.h"
 #include "world/GameWorldGame.h"
@@ -470,6 +471,7 @@ void nobMilitary::RegulateTroops()
                     it = helpers::erase(troops, it);
                 }
             }
+            TroopsChanged();
         }
 
     } else if(diff > 0)
@@ -528,11 +530,12 @@ void nobMilitary::SendSoldiersHome()
                 mrank = (*it)->GetRank();
             else if(mrank > (*it)->GetRank()) // if the current soldier is of lower rank than what we started with ->
                                               // send no more troops out
-                return;
+                break;
             (*it)->LeaveBuilding();
             AddLeavingFigure(*it);
             it = helpers::erase(troops, it);
         }
+        TroopsChanged();
     }
 }
 
@@ -576,6 +579,11 @@ void nobMilitary::OrderNewSoldiers()
         sld->NotNeeded();
 }
 
+void nobMilitary::TroopsChanged()
+{
+    gwg->GetNotifications().publish(BuildingNote(BuildingNote::TroopsChanged, player, pos, bldType_));
+}
+
 bool nobMilitary::IsUseless() const
 {
     if(frontier_distance != DIST_FAR || new_built)
@@ -701,6 +709,7 @@ void nobMilitary::AddPassiveSoldier(nofPassiveSoldier* soldier)
         gwg->GetNotifications().publish(BuildingNote(BuildingNote::Captured, player, pos, bldType_));
     } else
     {
+        TroopsChanged();
         // Evtl. Soldaten befördern
         PrepareUpgrading();
     }
@@ -733,6 +742,7 @@ void nobMilitary::SoldierOnMission(nofPassiveSoldier* passive_soldier, nofActive
     passive_soldier->LeftBuilding();
     troops_on_mission.push_back(active_soldier);
     AddLeavingFigure(active_soldier);
+    TroopsChanged();
 }
 
 nofPassiveSoldier* nobMilitary::ChooseSoldier()
@@ -796,6 +806,17 @@ nofAggressiveDefender* nobMilitary::SendAggressiveDefender(nofAttacker* attacker
 
 /// Gibt die Anzahl der Soldaten zurück, die für einen Angriff auf ein bestimmtes Ziel zur Verfügung stehen
 unsigned nobMilitary::GetNumSoldiersForAttack(const MapPoint dest) const
+{
+    const unsigned soldiers_count = GetMaxNumSoldiersForAttack(dest);
+    // und auch der Weg zu Fuß darf dann nicht so weit sein, wenn das alles bestanden ist, können wir ihn nehmen..
+    if(soldiers_count && gwg->FindHumanPath(pos, dest, MAX_ATTACKING_RUN_DISTANCE))
+        // Soldaten davon nehmen
+        return soldiers_count;
+    else
+        return 0;
+}
+
+unsigned nobMilitary::GetMaxNumSoldiersForAttack(const MapPoint dest) const
 {
     // Soldaten ausrechnen, wie viel man davon nehmen könnte, je nachdem wie viele in den
     // Militäreinstellungen zum Angriff eingestellt wurden
@@ -819,12 +840,7 @@ unsigned nobMilitary::GetNumSoldiersForAttack(const MapPoint dest) const
             return 0;
     }
 
-    // und auch der Weg zu Fuß darf dann nicht so weit sein, wenn das alles bestanden ist, können wir ihn nehmen..
-    if(soldiers_count && gwg->FindHumanPath(pos, dest, MAX_ATTACKING_RUN_DISTANCE))
-        // Soldaten davon nehmen
-        return soldiers_count;
-    else
-        return 0;
+    return soldiers_count;
 }
 
 /// Gibt die Soldaten zurück, die für einen Angriff auf ein bestimmtes Ziel zur Verfügung stehen
@@ -905,6 +921,7 @@ nofDefender* nobMilitary::ProvideDefender(nofAttacker* const attacker)
     // und vernichten
     soldier->Destroy();
     delete soldier;
+    TroopsChanged();
 
     return defender;
 }
@@ -1236,6 +1253,7 @@ void nobMilitary::HitOfCatapultStone()
         soldier->LeftBuilding();
         soldier->Destroy();
         deletePtr(soldier);
+        TroopsChanged();
     }
 
     // If there are troops left, order some more, else this will be destroyed
@@ -1283,7 +1301,11 @@ void nobMilitary::UnlinkAggressor(nofAttacker* soldier)
     far_away_capturers.remove(soldier);
 
     if(aggressors.empty())
+    {
+        // Attack is over
+        gwg->GetHumanFlowFields().Remove(GetFlagPos());
         RegulateTroops();
+    }
 }
 
 void nobMilitary::CapturingSoldierArrived()
@@ -92,6 +92,8 @@ private:
     size_t GetTotalSoldiers() const;
     /// Looks for the next far-away-capturer waiting around and calls it to the flag
     void CallNextFarAwayCapturer(nofAttacker* attacker);
+    /// Notifies about a change of the stationed soldiers (e.g. for the attack overlay)
+    void TroopsChanged();
 
     friend class SerializedGameData;
     friend class BuildingFactory;
@@ -171,6 +173,8 @@ public:
 
     /// Gibt die Anzahl der Soldaten zurück, die für einen Angriff auf ein bestimmtes Ziel zur Verfügung stehen
     unsigned GetNumSoldiersForAttack(MapPoint dest) const;
+    /// Same as GetNumSoldiersForAttack but without checking if the soldiers can walk to the target
+    unsigned GetMaxNumSoldiersForAttack(MapPoint dest) const;
     /// Gibt die Soldaten zurück, die für einen Angriff auf ein bestimmtes Ziel zur Verfügung stehen
     std::vector<nofPassiveSoldier*> GetSoldiersForAttack(MapPoint dest) const;
     /// Gibt die Stärke der Soldaten zurück, die für einen Angriff auf ein bestimmtes Ziel zur Verfügung stehen
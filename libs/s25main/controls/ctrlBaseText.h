@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 class glFont;
+class glTextLayout;
 
 /// Base class for controls containing a text
 class ctrlBaseText
@@ -35,7 +37,12 @@ public:
     unsigned GetTextColor() const { return color_; }
 
 protected:
+    /// Return the (unlimited width) layout of the text. Kept until text or font change
+    const glTextLayout& GetTextLayout() const;
+
     std::string text;
     unsigned color_;
     const glFont* font;
+    /// Cached layout, reset whenever the text or font changes
+    mutable std::shared_ptr<const glTextLayout> layout_;
 };
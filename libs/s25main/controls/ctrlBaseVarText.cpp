@@ -17,6 +17,7 @@
 
 #include "ctrlBaseVarText.h"
 #include "RTTR_Assert.h"
+#include "ogl/glFont.h"
 #include <sstream>
 
 ctrlBaseVarText::ctrlBaseVarText(const std::string& fmtString, const unsigned color, const glFont* font, unsigned count,
@@ -73,3 +74,14 @@ std::string ctrlBaseVarText::GetFormatedText() const
 
     return str.str();
 }
+
+const glTextLayout& ctrlBaseVarText::GetFormatedTextLayout() const
+{
+    std::string curText = GetFormatedText();
+    if(!layout_ || curText != layoutText_)
+    {
+        layout_ = font->GetLayout(curText);
+        layoutText_ = std::move(curText);
+    }
+    return *layout_;
+}
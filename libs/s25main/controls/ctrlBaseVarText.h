@@ -34,7 +34,11 @@ public:
 protected:
     /// Returns the text with placeholders replaced by the actual vars
     std::string GetFormatedText() const;
+    /// Returns the layout of the formatted text. Only recreated if the formatted text changed
+    const glTextLayout& GetFormatedTextLayout() const;
 
 private:
     std::vector<void*> vars;
+    /// Formatted text the current layout was created for
+    mutable std::string layoutText_;
 };
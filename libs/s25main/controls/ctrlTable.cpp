@@ -28,6 +28,7 @@
 #include <cmath>
 #include <numeric>
 #include <sstream>
+#include <unordered_map>
 
 /// Return <0 for a < b; >0 for a>b and 0 for a==b
 static int Compare(const std::string& a, const std::string& b, ctrlTable::SortType sortType)
@@ -235,6 +236,77 @@ void ctrlTable::RemoveRow(unsigned rowIdx)
     SetSelection(selection_);
 }
 
+bool ctrlTable::UpdateRows(std::vector<std::vector<std::string>> rows, const unsigned keyColumn)
+{
+    if(keyColumn >= GetNumColumns())
+        throw std::logic_error("Invalid key column");
+    boost::optional<std::string> selectedKey;
+    if(selection_ && *selection_ < rows_.size())
+        selectedKey = rows_[*selection_].columns[keyColumn];
+
+    // Index of the new row for each key. Later rows with the same key are ignored
+    std::unordered_map<std::string, unsigned> newRowIdx;
+    for(unsigned i = 0; i < rows.size(); i++)
+    {
+        if(rows[i].size() > GetNumColumns())
+            throw std::logic_error("Invalid number of columns for updated row");
+        rows[i].resize(GetNumColumns());
+        newRowIdx.emplace(rows[i][keyColumn], i);
+    }
+
+    bool changed = false;
+    std::vector<bool> isUsed(rows.size(), false);
+    // Update the existing rows in place and remove the ones not present anymore
+    unsigned numKept = 0;
+    for(Row& row : rows_)
+    {
+        const auto itNew = newRowIdx.find(row.columns[keyColumn]);
+        if(itNew == newRowIdx.end() || isUsed[itNew->second])
+        {
+            changed = true;
+            continue;
+        }
+        isUsed[itNew->second] = true;
+        if(row.columns != rows[itNew->second])
+        {
+            row.columns = std::move(rows[itNew->second]);
+            changed = true;
+        }
+        if(&rows_[numKept] != &row)
+            rows_[numKept] = std::move(row);
+        ++numKept;
+    }
+    rows_.resize(numKept);
+    // Add new ones in the given order
+    for(unsigned i = 0; i < rows.size(); i++)
+    {
+        if(isUsed[i] || newRowIdx[rows[i][keyColumn]] != i)
+            continue;
+        if(rows_.size() == std::numeric_limits<unsigned short>::max())
+            throw std::range_error("Maximum amount of rows exceeded");
+        rows_.emplace_back(Row{std::move(rows[i])});
+        changed = true;
+    }
+    if(!changed)
+        return false;
+
+    GetCtrl<ctrlScrollBar>(0)->SetRange(GetNumRows());
+    if(sortColumn_ >= 0)
+        SortRows(sortColumn_, sortDir_);
+
+    boost::optional<unsigned> newSelection;
+    if(selectedKey)
+    {
+        const auto itRow = std::find_if(rows_.begin(), rows_.end(),
+                                        [&](const Row& row) { return row.columns[keyColumn] == *selectedKey; });
+        if(itRow != rows_.end())
+            newSelection = static_cast<unsigned>(std::distance(rows_.begin(), itRow));
+    }
+    if(newSelection != selection_)
+        SetSelection(newSelection);
+    return true;
+}
+
 /**
  *  liefert den Wert eines Feldes.
  *
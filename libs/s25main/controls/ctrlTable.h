@@ -64,6 +64,10 @@ public:
     /// fügt eine Zeile hinzu.
     void AddRow(std::vector<std::string> row);
     void RemoveRow(unsigned rowIdx);
+    /// Replace all rows by the given ones where the value in keyColumn identifies a row.
+    /// Only changed rows are touched, the sorting is kept and the selection stays on the same key.
+    /// Returns true if anything was changed
+    bool UpdateRows(std::vector<std::vector<std::string>> rows, unsigned keyColumn);
     /// liefert den Wert eines Feldes.
     const std::string& GetItemText(unsigned short row, unsigned short column) const;
     /// sortiert die Zeilen.
@@ -26,12 +26,23 @@ ctrlBaseText::ctrlBaseText(std::string text, const unsigned color, const glFont*
 
 void ctrlBaseText::SetText(const std::string& text)
 {
+    if(this->text == text)
+        return;
     this->text = text;
+    layout_.reset();
 }
 
 void ctrlBaseText::SetFont(glFont* font)
 {
     this->font = font;
+    layout_.reset();
+}
+
+const glTextLayout& ctrlBaseText::GetTextLayout() const
+{
+    if(!layout_)
+        layout_ = font->GetLayout(text);
+    return *layout_;
 }
 
 ctrlText::ctrlText(Window* parent, unsigned id, const DrawPoint& pos, const std::string& text, unsigned color,
@@ -53,5 +64,5 @@ Rect ctrlText::GetBoundaryRect() const
 void ctrlText::Draw_()
 {
     if(!text.empty())
-        font->Draw(GetDrawPos(), text, format, color_);
+        font->Draw(GetDrawPos(), GetTextLayout(), format, color_);
 }
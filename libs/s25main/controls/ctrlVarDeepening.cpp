@@ -27,5 +27,5 @@ ctrlVarDeepening::ctrlVarDeepening(Window* parent, unsigned id, const DrawPoint&
 
 void ctrlVarDeepening::DrawContent() const
 {
-    font->Draw(GetDrawPos() + GetSize() / 2, GetFormatedText(), FontStyle::CENTER | FontStyle::VCENTER, color_);
+    font->Draw(GetDrawPos() + GetSize() / 2, GetFormatedTextLayout(), FontStyle::CENTER | FontStyle::VCENTER, color_);
 }
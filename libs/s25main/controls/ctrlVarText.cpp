@@ -46,5 +46,5 @@ Rect ctrlVarText::GetBoundaryRect() const
 
 void ctrlVarText::Draw_()
 {
-    font->Draw(GetDrawPos(), GetFormatedText(), format_, color_);
+    font->Draw(GetDrawPos(), GetFormatedTextLayout(), format_, color_);
 }
@@ -812,7 +812,7 @@ bool dskGameInterface::Msg_KeyDown(const KeyEvent& ke)
             return true;
         case 'j': // GFs überspringen
             if(game_->world_.IsSinglePlayer() || GAMECLIENT.IsReplayModeOn())
-                WINDOWMANAGER.ToggleWindow(std::make_unique<iwSkipGFs>(gwv));
+                WINDOWMANAGER.ToggleWindow(std::make_unique<iwSkipGFs>());
             return true;
         case 'l': // Minimap anzeigen
             WINDOWMANAGER.ToggleWindow(std::make_unique<iwMinimap>(minimap, gwv));
@@ -1115,6 +1115,14 @@ void dskGameInterface::CI_PlayerLeft(const unsigned playerId)
     messenger.AddMessage("", 0, CD_SYSTEM, text, COLOR_GREEN);
 }
 
+void dskGameInterface::CI_NewPlayer(const unsigned playerId)
+{
+    // A player who lost the connection took over from the AI again
+    const std::string text =
+      helpers::format(_("Player '%s' rejoined the game!"), worldViewer.GetWorld().GetPlayer(playerId).name);
+    messenger.AddMessage("", 0, CD_SYSTEM, text, COLOR_GREEN);
+}
+
 void dskGameInterface::CI_GGSChanged(const GlobalGameSettings& /*ggs*/)
 {
     // TODO: print what has changed
@@ -1168,6 +1176,19 @@ void dskGameInterface::CI_GameResumed()
     messenger.AddMessage(_("SYSTEM"), COLOR_GREY, CD_SYSTEM, _("Game was resumed."));
 }
 
+void dskGameInterface::CI_FastForwardStarted()
+{
+    // Nothing is drawn while fast forwarding, so don't update the views for every single change
+    worldViewer.DetachTerrainRenderer();
+    minimap.Detach();
+}
+
+void dskGameInterface::CI_FastForwardFinished()
+{
+    worldViewer.ReattachTerrainRenderer();
+    minimap.Reattach();
+}
+
 void dskGameInterface::CI_Error(const ClientError ce)
 {
     messenger.AddMessage("", 0, CD_SYSTEM, ClientErrorToStr(ce), COLOR_RED);
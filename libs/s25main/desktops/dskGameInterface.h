@@ -66,6 +66,7 @@ public:
     RoadBuildMode GetRoadMode() const { return road.mode; }
 
     void CI_PlayerLeft(unsigned playerId) override;
+    void CI_NewPlayer(unsigned playerId) override;
     void CI_GGSChanged(const GlobalGameSettings& ggs) override;
     void CI_Chat(unsigned playerId, ChatDestination cd, const std::string& msg) override;
     void CI_Async(const std::string& checksums_list) override;
@@ -73,6 +74,8 @@ public:
     void CI_ReplayEndReached(const std::string& msg) override;
     void CI_GamePaused() override;
     void CI_GameResumed() override;
+    void CI_FastForwardStarted() override;
+    void CI_FastForwardFinished() override;
     void CI_Error(ClientError ce) override;
     void CI_PlayersSwapped(unsigned player1, unsigned player2) override;
 
@@ -26,6 +26,7 @@
 #include "dskLobby.h"
 #include "dskSinglePlayer.h"
 #include "files.h"
+#include "helpers/format.hpp"
 #include "ingameWindows/iwMsgbox.h"
 #include "network/GameClient.h"
 #include "ogl/FontStyle.h"
@@ -49,6 +50,8 @@ dskGameLoader::dskGameLoader(std::shared_ptr<Game> game)
 
     for(unsigned i = 0; i < 8; ++i)
         AddText(11 + i, DrawPoint(30, 30 + i * 20), "", COLOR_GREEN, FontStyle{}, LargeFont);
+    // Load times
+    AddText(19, DrawPoint(30, 30 + 8 * 20), "", COLOR_GREY, FontStyle{}, NormalFont);
 
     LOBBYCLIENT.AddListener(this);
     GAMECLIENT.SetInterface(this);
@@ -110,6 +113,11 @@ void dskGameLoader::Msg_Timer(const unsigned /*ctrl_id*/)
             }
 
             text->SetText(_("Game crate was picked and spread out..."));
+            const auto filesTime = loader_.getFilesLoadTime();
+            const auto cachesTime = loader_.getCachesLoadTime();
+            GetCtrl<ctrlText>(19)->SetText(helpers::format(_("Graphics loaded in %1%ms (files: %2%ms, caches: %3%ms)"),
+                                                           (filesTime + cachesTime).count(), filesTime.count(),
+                                                           cachesTime.count()));
             break;
         }
         case 4: // Welt erstellen
@@ -42,7 +42,7 @@ enum
 };
 }
 
-dskLAN::dskLAN() : dskMenuBase(LOADER.GetImageN("setup013", 0)), discovery(LAN_DISCOVERY_CFG)
+dskLAN::dskLAN() : dskMenuBase(LOADER.GetImageN("setup013", 0)), discovery(LAN_DISCOVERY_CFG), nextGameId(0)
 {
     // "Server hinzufügen"
     AddTextButton(ID_btAddServer, DrawPoint(530, 250), Extent(250, 22), TC_GREEN2, _("Add Server"), NormalFont);
@@ -63,7 +63,8 @@ dskLAN::dskLAN() : dskMenuBase(LOADER.GetImageN("setup013", 0)), discovery(LAN_D
     discovery.Start();
 
     AddTimer(ID_tmrRefreshServers, 60000); // Servers broadcast changes, so force a full update only once a minute
-    AddTimer(ID_tmrRefreshList, 2000);
+    // Only changed rows are updated, so refresh often to show new games quickly
+    AddTimer(ID_tmrRefreshList, 500);
 }
 
 void dskLAN::Msg_Timer(const unsigned ctrl_id)
@@ -117,7 +118,10 @@ void dskLAN::ReadOpenGames()
         GameInfo info;
         info.ip = service.second.ip;
         info.info.Deserialize(ser);
-        openGames.push_back(info);
+        const auto itId = gameIds.emplace(info.ip + ":" + helpers::toString(info.info.port), nextGameId).first;
+        if(itId->second == nextGameId)
+            ++nextGameId;
+        openGames[itId->second] = std::move(info);
     }
 }
 
@@ -126,27 +130,21 @@ void dskLAN::UpdateServerList()
     ReadOpenGames();
 
     auto* servertable = GetCtrl<ctrlTable>(ID_tblServer);
+    if(servertable->GetSortColumn() < 0)
+        servertable->SortRows(0, TableSortDir::Ascending);
 
-    const unsigned selection = servertable->GetSelection().value_or(0u);
-    int sortColumn = servertable->GetSortColumn();
-    if(sortColumn == -1)
-        sortColumn = 0;
-    const auto direction = servertable->GetSortDirection();
-    servertable->DeleteAllItems();
-
-    unsigned curId = 0;
-    for(const auto& gameInfo : openGames)
+    std::vector<std::vector<std::string>> rows;
+    rows.reserve(openGames.size());
+    for(const auto& idAndGame : openGames)
     {
-        std::string id = helpers::toString(curId++);
+        const GameInfo& gameInfo = idAndGame.second;
+        std::string id = helpers::toString(idAndGame.first);
         std::string name = (gameInfo.info.hasPwd ? "(pwd) " : "") + gameInfo.info.name; //-V807
         std::string player =
           helpers::toString(gameInfo.info.curNumPlayers) + "/" + helpers::toString(gameInfo.info.maxNumPlayers);
-        servertable->AddRow({id, name, gameInfo.info.map, player, gameInfo.info.version});
+        rows.push_back({id, name, gameInfo.info.map, player, gameInfo.info.version});
     }
-
-    if(sortColumn >= 0)
-        servertable->SortRows(sortColumn, direction);
-    servertable->SetSelection(selection);
+    servertable->UpdateRows(std::move(rows), 0);
 }
 
 bool dskLAN::ConnectToSelectedGame()
@@ -160,10 +158,11 @@ bool dskLAN::ConnectToSelectedGame()
         return false;
     const auto selectedId = boost::lexical_cast<unsigned>(table->GetItemText(*selectedRow, 0));
 
-    if(selectedId >= openGames.size())
+    const auto itGame = openGames.find(selectedId);
+    if(itGame == openGames.end())
         return false;
 
-    const GameInfo& game = openGames[selectedId];
+    const GameInfo& game = itGame->second;
     if(game.info.revision == RTTR_Version::GetRevision())
     {
         auto connect = std::make_unique<iwDirectIPConnect>(ServerType::LAN);
@@ -20,7 +20,8 @@
 #include "desktops/dskMenuBase.h"
 #include "gameTypes/LanGameInfo.h"
 #include "s25util/LANDiscoveryClient.h"
-#include <vector>
+#include <map>
+#include <string>
 
 class dskLAN : public dskMenuBase
 {
@@ -45,7 +46,11 @@ protected:
 
 private:
     LANDiscoveryClient discovery;
-    std::vector<GameInfo> openGames;
+    /// Currently open games by their ID
+    std::map<unsigned, GameInfo> openGames;
+    /// ID for each game ever seen (by address), so rows keep their identity (and selection) over updates
+    std::map<std::string, unsigned> gameIds;
+    unsigned nextGameId;
 
     void UpdateServerList();
     void ReadOpenGames();
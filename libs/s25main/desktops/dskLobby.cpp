@@ -74,6 +74,8 @@ dskLobby::dskLobby()
     AddEdit(21, DrawPoint(20, 530), Extent(500, 22), TC_GREY, NormalFont);
 
     AddTimer(30, 5000);
+    // Lists are taken from the lobby client. Only changed rows are updated so this is cheap even for big lobbies
+    AddTimer(31, 500);
 
     // If we came from an active game, tell the server we quit
     if(LOBBYCLIENT.IsIngame())
@@ -95,17 +97,22 @@ dskLobby::~dskLobby()
     GAMECLIENT.RemoveInterface(this);
 }
 
-void dskLobby::Msg_Timer(const unsigned /*ctrl_id*/)
+void dskLobby::Msg_Timer(const unsigned ctrl_id)
 {
-    if(LOBBYCLIENT.IsLoggedIn())
-        LOBBYCLIENT.SendServerListRequest();
+    if(ctrl_id == 30)
+    {
+        if(LOBBYCLIENT.IsLoggedIn())
+            LOBBYCLIENT.SendServerListRequest();
+    } else
+    {
+        UpdateServerList();
+        UpdatePlayerList();
+    }
 }
 
 void dskLobby::Msg_PaintBefore()
 {
     dskMenuBase::Msg_PaintBefore();
-    UpdateServerList();
-    UpdatePlayerList();
     GetCtrl<ctrlEdit>(21)->SetFocus();
 }
 
@@ -323,15 +330,10 @@ void dskLobby::LC_Chat(const std::string& player, const std::string& text)
 void dskLobby::LC_ServerList(const LobbyServerList& servers)
 {
     auto* servertable = GetCtrl<ctrlTable>(10);
-    bool first = servertable->GetNumRows() == 0;
-
-    const unsigned selection = servertable->GetSelection().value_or(0u);
-    int sortColumn = servertable->GetSortColumn();
-    if(sortColumn == -1)
-        sortColumn = 0;
-    const auto direction = servertable->GetSortDirection();
-    servertable->DeleteAllItems();
+    if(servertable->GetSortColumn() < 0)
+        servertable->SortRows(0, TableSortDir::Ascending);
 
+    std::vector<std::vector<std::string>> rows;
     std::set<unsigned> ids;
     for(const LobbyServerInfo& server : servers)
     {
@@ -349,32 +351,20 @@ void dskLobby::LC_ServerList(const LobbyServerList& servers)
         std::string ping = helpers::toString(server.getPing());
         std::string player =
           helpers::toString(server.getCurPlayers()) + "/" + helpers::toString(server.getMaxPlayers());
-        servertable->AddRow({id, name, server.getMap(), player, server.getVersion(), ping});
+        rows.push_back({id, name, server.getMap(), player, server.getVersion(), ping});
     }
-    if(first)
-        servertable->SortRows(0, TableSortDir::Ascending);
-    else
-        servertable->SortRows(sortColumn, direction);
-    servertable->SetSelection(selection);
+    // Only changed rows are updated, so sorting and selection are kept
+    servertable->UpdateRows(std::move(rows), 0);
 }
 
 void dskLobby::LC_PlayerList(const LobbyPlayerList& players)
 {
     auto* playertable = GetCtrl<ctrlTable>(11);
-    bool first = playertable->GetNumRows() == 0;
-
-    if((playertable->GetNumRows() > 0) && (playertable->GetNumRows() < players.size()))
-    {
-        LOADER.GetSoundN("sound", 114)->Play(255, false);
-    }
-
-    const unsigned selection = playertable->GetSelection().value_or(0u);
-    int sortColumn = playertable->GetSortColumn();
-    if(sortColumn == -1)
-        sortColumn = 0;
-    const auto direction = playertable->GetSortDirection();
-    playertable->DeleteAllItems();
+    const unsigned short oldNumRows = playertable->GetNumRows();
+    if(playertable->GetSortColumn() < 0)
+        playertable->SortRows(0, TableSortDir::Ascending);
 
+    std::vector<std::vector<std::string>> rows;
     for(const LobbyPlayerInfo& player : players)
     {
         if(player.getId() != 0xFFFFFFFF)
@@ -383,14 +373,13 @@ void dskLobby::LC_PlayerList(const LobbyPlayerList& players)
             std::string name = player.getName();
             if(player.isIngame)
                 name += _(" (playing)");
-            playertable->AddRow({name, punkte, player.getVersion()});
+            rows.push_back({name, punkte, player.getVersion()});
         }
     }
-    if(first)
-        playertable->SortRows(0, TableSortDir::Ascending);
-    else
-        playertable->SortRows(sortColumn, direction);
-    playertable->SetSelection(selection);
+    playertable->UpdateRows(std::move(rows), 0);
+
+    if(oldNumRows > 0 && oldNumRows < playertable->GetNumRows())
+        LOADER.GetSoundN("sound", 114)->Play(255, false);
 }
 
 void dskLobby::LC_ServerInfo(const LobbyServerInfo&)
@@ -195,7 +195,7 @@ void nofAttacker::Walked()
                     ContinueAtFlag();
             } else
             {
-                const auto dir = gwg->FindHumanPath(pos, goalFlagPos, 5, true);
+                const auto dir = gwg->FindHumanPathToSharedGoal(pos, goalFlagPos, 5);
                 if(dir)
                     StartWalking(*dir);
                 else
@@ -562,8 +562,10 @@ void nofAttacker::MissAttackingWalk()
     // Könnte mir noch ein neuer Verteidiger entgegenlaufen?
     TryToOrderAggressiveDefender();
 
-    // Ansonsten Weg zum Ziel suchen
-    const auto dir = gwg->FindHumanPath(pos, goal, MAX_ATTACKING_RUN_DISTANCE, true);
+    // Ansonsten Weg zum Ziel suchen. All attackers going to the flag share the paths to it
+    const auto dir = (goal == attacked_goal->GetFlagPos()) ?
+                       gwg->FindHumanPathToSharedGoal(pos, goal, MAX_ATTACKING_RUN_DISTANCE) :
+                       gwg->FindHumanPath(pos, goal, MAX_ATTACKING_RUN_DISTANCE, true);
     // Keiner gefunden? Nach Hause gehen
     if(!dir)
     {
@@ -763,7 +765,7 @@ void nofAttacker::AttackedGoalDestroyed()
 bool nofAttacker::AttackFlag(nofDefender* /*defender*/)
 {
     // Zur Flagge laufen, findet er einen Weg?
-    const auto dir = gwg->FindHumanPath(pos, attacked_goal->GetFlag()->GetPos(), 3, true);
+    const auto dir = gwg->FindHumanPathToSharedGoal(pos, attacked_goal->GetFlagPos(), 3);
 
     if(dir)
     {
@@ -888,7 +890,7 @@ void nofAttacker::CapturingWalking()
         }
 
         // weiter zur Flagge laufen
-        const auto dir = gwg->FindHumanPath(pos, attFlagPos, 10, true);
+        const auto dir = gwg->FindHumanPathToSharedGoal(pos, attFlagPos, 10);
         if(dir)
             StartWalking(*dir);
         else
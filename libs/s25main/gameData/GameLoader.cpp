@@ -20,13 +20,18 @@
 #include "GamePlayer.h"
 #include "Loader.h"
 #include "RttrForeachPt.h"
+#include "Timer.h"
 #include "addons/const_addons.h"
 #include "files.h"
 #include "helpers/containerUtils.h"
+#include "s25util/Log.h"
+#include <chrono>
 #include <set>
 #include <utility>
 
-GameLoader::GameLoader(Loader& loader, std::shared_ptr<Game> game) : loader(loader), game(std::move(game)) {}
+GameLoader::GameLoader(Loader& loader, std::shared_ptr<Game> game)
+    : loader(loader), game(std::move(game)), filesLoadTime(0), cachesLoadTime(0)
+{}
 
 GameLoader::~GameLoader() = default;
 
@@ -88,13 +93,18 @@ bool GameLoader::loadTextures()
         loader.AddAddonFolder(AddonId::CATAPULT_GRAPHICS);
 
     const LandscapeDesc& lt = game->world_.GetDescription().get(game->world_.GetLandscapeType());
+    const Timer timer(true);
     if(!loader.LoadFilesAtGame(lt.mapGfxPath, lt.isWinter, usedNations) || !loader.LoadFiles(textures)
        || !loader.LoadOverrideFiles())
     {
         return false;
     }
+    filesLoadTime = std::chrono::duration_cast<std::chrono::milliseconds>(timer.getElapsed());
 
     loader.fillCaches();
+    cachesLoadTime = std::chrono::duration_cast<std::chrono::milliseconds>(timer.getElapsed()) - filesLoadTime;
+    LOG.write("Game graphics loaded in %1%ms (files: %2%ms, caches: %3%ms)\n")
+      % (filesLoadTime + cachesLoadTime).count() % filesLoadTime.count() % cachesLoadTime.count();
     return true;
 }
 
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "gameTypes/Nation.h"
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -39,10 +40,14 @@ public:
     /// Execute all steps
     bool load();
     const std::shared_ptr<Game>& getGame() const { return game; }
+    /// Time spent in loadTextures for loading the files and for filling the caches
+    std::chrono::milliseconds getFilesLoadTime() const { return filesLoadTime; }
+    std::chrono::milliseconds getCachesLoadTime() const { return cachesLoadTime; }
 
 private:
     Loader& loader;
     std::shared_ptr<Game> game;
     std::vector<Nation> usedNations;
     std::vector<std::string> textures;
+    std::chrono::milliseconds filesLoadTime, cachesLoadTime;
 };
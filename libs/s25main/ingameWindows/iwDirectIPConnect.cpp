@@ -24,6 +24,7 @@
 #include "controls/ctrlEdit.h"
 #include "controls/ctrlOptionGroup.h"
 #include "controls/ctrlText.h"
+#include "desktops/dskGameLoader.h"
 #include "desktops/dskHostGame.h"
 #include "drivers/VideoDriverWrapper.h"
 #include "network/GameClient.h"
@@ -32,6 +33,7 @@
 #include "liblobby/LobbyClient.h"
 #include "s25util/StringConversion.h"
 #include "s25util/colors.h"
+#include <boost/format.hpp>
 
 iwDirectIPConnect::iwDirectIPConnect(ServerType server_type)
     : IngameWindow(CGI_DIRECTIPCONNECT, IngameWindow::posLastOrCenter, Extent(300, 285), _("Join Game"),
@@ -218,6 +220,18 @@ void iwDirectIPConnect::CI_Error(const ClientError ce)
     GetCtrl<ctrlButton>(7)->SetEnabled();
 }
 
+void iwDirectIPConnect::CI_MapTransferProgress(unsigned receivedBytes, unsigned totalBytes)
+{
+    const unsigned percent = totalBytes ? static_cast<unsigned>(receivedBytes * 100ull / totalBytes) : 100u;
+    SetStatus((boost::format(_("Receiving map... %1%%%")) % percent).str(), COLOR_YELLOW);
+}
+
+/// Rejoining a running game skips the lobby
+void iwDirectIPConnect::CI_GameLoading(const std::shared_ptr<Game>& game)
+{
+    WINDOWMANAGER.Switch(std::make_unique<dskGameLoader>(game));
+}
+
 void iwDirectIPConnect::CI_NextConnectState(const ConnectState cs)
 {
     switch(cs)
@@ -43,4 +43,6 @@ private:
 
     void CI_Error(ClientError ce) override;
     void CI_NextConnectState(ConnectState cs) override;
+    void CI_MapTransferProgress(unsigned receivedBytes, unsigned totalBytes) override;
+    void CI_GameLoading(const std::shared_ptr<Game>& game) override;
 };
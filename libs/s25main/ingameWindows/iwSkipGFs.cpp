@@ -23,10 +23,9 @@
 #include "s25util/StringConversion.h"
 #include "s25util/colors.h"
 
-iwSkipGFs::iwSkipGFs(GameWorldView& gwv)
+iwSkipGFs::iwSkipGFs()
     : IngameWindow(CGI_SKIPGFS, IngameWindow::posLastOrCenter, Extent(300, 110), _("Skip GameFrames"),
-                   LOADER.GetImageN("resource", 41)),
-      gwv(gwv)
+                   LOADER.GetImageN("resource", 41))
 {
     // Text vor Editfeld
     AddText(0, DrawPoint(50, 36), _("to GameFrame:"), COLOR_YELLOW, FontStyle{}, NormalFont);
@@ -42,7 +41,7 @@ iwSkipGFs::iwSkipGFs(GameWorldView& gwv)
 void iwSkipGFs::SkipGFs()
 {
     int gf = s25util::fromStringClassicDef(GetCtrl<ctrlEdit>(1)->GetText(), 0);
-    GAMECLIENT.SkipGF(gf, gwv);
+    GAMECLIENT.SkipGF(gf);
 }
 
 void iwSkipGFs::Msg_ButtonClick(const unsigned /*ctrl_id*/)
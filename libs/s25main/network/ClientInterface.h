@@ -46,6 +46,8 @@ public:
 
     virtual void CI_NextConnectState(ConnectState) {}
     virtual void CI_Error(ClientError) {}
+    /// Progress of the map (and lua) download
+    virtual void CI_MapTransferProgress(unsigned /*receivedBytes*/, unsigned /*totalBytes*/) {}
 
     virtual void CI_NewPlayer(unsigned /*playerId*/) {}
     virtual void CI_PlayerLeft(unsigned /*playerId*/) {}
@@ -69,4 +71,7 @@ public:
     virtual void CI_ReplayEndReached(const std::string& /*msg*/) {}
     virtual void CI_GamePaused() {}
     virtual void CI_GameResumed() {}
+    /// Started skipping GFs as fast as possible. Nothing is drawn till it is finished
+    virtual void CI_FastForwardStarted() {}
+    virtual void CI_FastForwardFinished() {}
 };
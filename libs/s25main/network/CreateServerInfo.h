@@ -30,9 +30,13 @@ struct CreateServerInfo
     const std::string password;
     const bool ipv6; // IPv6 or IPv4
     const bool use_upnp;
+    /// Port for spectators (0 = no spectators)
+    const uint16_t spectatorPort;
+    /// Delay of the spectator stream in seconds
+    const unsigned spectatorDelay;
     CreateServerInfo(ServerType type, uint16_t port, std::string gameName, std::string password = "", bool ipv6 = false,
-                     bool useUpnp = false)
+                     bool useUpnp = false, uint16_t spectatorPort = 0, unsigned spectatorDelay = 0)
         : type(type), port(port), gameName(std::move(gameName)), password(std::move(password)), ipv6(ipv6),
-          use_upnp(useUpnp)
+          use_upnp(useUpnp), spectatorPort(spectatorPort), spectatorDelay(spectatorDelay)
     {}
 };
@@ -50,11 +50,10 @@
 #include "ogl/glFont.h"
 #include "random/Random.h"
 #include "world/GameWorld.h"
-#include "world/GameWorldView.h"
-#include "gameTypes/RoadBuildState.h"
 #include "gameData/GameConsts.h"
 #include "libsiedler2/ArchivItem_Map_Header.h"
 #include "libsiedler2/prototypen.h"
+#include "s25util/Serializer.h"
 #include "s25util/SocketSet.h"
 #include "s25util/StringConversion.h"
 #include "s25util/System.h"
@@ -74,7 +73,10 @@ void GameClient::ClientConfig::Clear()
     isHost = false;
 }
 
-GameClient::GameClient() : skiptogf(0), mainPlayer(0), state(CS_STOPPED), ci(nullptr), replayMode(false) {}
+GameClient::GameClient()
+    : skiptogf(0), mainPlayer(0), state(CS_STOPPED), ci(nullptr), replayMode(false), isFastForwarding_(false),
+      isRejoining_(false), isCatchingUp_(false)
+{}
 
 GameClient::~GameClient()
 {
@@ -124,6 +126,26 @@ bool GameClient::Connect(const std::string& server, const std::string& password,
     return true;
 }
 
+bool GameClient::StartSpectating(const std::string& server, unsigned short port, bool use_ipv6)
+{
+    Stop();
+
+    if(!mainPlayer.socket.Connect(server, port, use_ipv6, SETTINGS.proxy))
+    {
+        LOG.write("GameClient::StartSpectating: ERROR: Connect failed!\n");
+        return false;
+    }
+    // Wait for the start of the stream
+    spectatorInfo = std::make_unique<SpectatorInfo>();
+    state = CS_CONNECT;
+    replayMode = false;
+
+    if(ci)
+        ci->CI_NextConnectState(CS_WAITFORANSWER);
+
+    return true;
+}
+
 bool GameClient::HostGame(const CreateServerInfo& csi, const boost::filesystem::path& map_path, MapType map_type)
 {
     std::string hostPw = createRandString(20);
@@ -139,37 +161,41 @@ void GameClient::Run()
     if(state == CS_STOPPED)
         return;
 
-    SocketSet set;
+    // A live replay continues without connection after the stream ended
+    if(mainPlayer.socket.isValid())
+    {
+        SocketSet set;
 
-    // erstmal auf Daten überprüfen
-    set.Clear();
+        // erstmal auf Daten überprüfen
+        set.Clear();
 
-    // zum set hinzufügen
-    set.Add(mainPlayer.socket);
-    if(set.Select(0, 0) > 0)
-    {
-        // nachricht empfangen
-        if(!mainPlayer.receiveMsgs())
+        // zum set hinzufügen
+        set.Add(mainPlayer.socket);
+        if(set.Select(0, 0) > 0)
         {
-            LOG.write("Receiving Message from server failed\n");
-            ServerLost();
+            // nachricht empfangen
+            if(!mainPlayer.receiveMsgs())
+            {
+                LOG.write("Receiving Message from server failed\n");
+                ServerLost();
+            }
         }
-    }
 
-    // nun auf Fehler prüfen
-    set.Clear();
+        // nun auf Fehler prüfen
+        set.Clear();
 
-    // zum set hinzufügen
-    set.Add(mainPlayer.socket);
+        // zum set hinzufügen
+        set.Add(mainPlayer.socket);
 
-    // auf fehler prüfen
-    if(set.Select(0, 2) > 0)
-    {
-        if(set.InSet(mainPlayer.socket))
+        // auf fehler prüfen
+        if(set.Select(0, 2) > 0)
         {
-            // Server ist weg
-            LOG.write("Error on socket to server\n");
-            ServerLost();
+            if(set.InSet(mainPlayer.socket))
+            {
+                // Server ist weg
+                LOG.write("Error on socket to server\n");
+                ServerLost();
+            }
         }
     }
 
@@ -206,17 +232,24 @@ void GameClient::Stop()
     framesinfo.Clear();
     clientconfig.Clear();
     mapinfo.Clear();
+    sentChecksums_.clear();
 
     if(replayinfo)
     {
         replayinfo->replay.Close();
         replayinfo.reset();
     }
+    spectatorInfo.reset();
+    requestedSnapshotGF_.reset();
+    isRejoining_ = isCatchingUp_ = false;
+    rejoinRandomState_.clear();
+    pendingRejoins_.clear();
 
     mainPlayer.closeConnection();
 
     // clear jump target
     skiptogf = 0;
+    isFastForwarding_ = false;
 
     // Consistency check: No game, no lobby remaining
     RTTR_Assert(!game);
@@ -331,7 +364,8 @@ void GameClient::StartGame(const unsigned random_init)
     // Update visual settings
     ResetVisualSettings();
 
-    if(!replayMode)
+    // A replay can only restore the random state from its seed, which does not work for a rejoin
+    if(!replayMode && !isRejoining_)
     {
         RTTR_Assert(!replayinfo);
         StartReplayRecording(random_init);
@@ -363,7 +397,9 @@ void GameClient::GameLoaded()
                 }
             }
         }
-        SendNothingNC();
+        // When rejoining, the first commands for our slot are still sent by the AI
+        if(!isRejoining_)
+            SendNothingNC();
     }
 }
 
@@ -608,6 +644,8 @@ bool GameClient::OnGameMessage(const GameMessage_Player_Kicked& msg)
     {
         // Im Spiel anzeigen, dass der Spieler das Spiel verlassen hat
         GamePlayer& player = GetPlayer(msg.player);
+        // Left again before taking over: The AI keeps playing
+        helpers::remove_if(pendingRejoins_, [&msg](const auto& rejoin) { return rejoin.first == msg.player; });
         if(player.ps != PS_AI)
         {
             player.ps = PS_AI;
@@ -627,6 +665,17 @@ bool GameClient::OnGameMessage(const GameMessage_Player_Kicked& msg)
     return true;
 }
 
+bool GameClient::OnGameMessage(const GameMessage_Player_Rejoined& msg)
+{
+    if(state != CS_LOADING && state != CS_LOADED && state != CS_GAME)
+        return true;
+    if(msg.player >= GetNumPlayers())
+        return true;
+    // The slot is handed over when executing the given NWF, which was not announced yet
+    pendingRejoins_.emplace_back(msg.player, msg.gf);
+    return true;
+}
+
 bool GameClient::OnGameMessage(const GameMessage_Player_Swap& msg)
 {
     LOG.writeToFile("<<< NMS_PLAYER_SWAP(%u, %u)\n") % unsigned(msg.player) % unsigned(msg.player2);
@@ -709,6 +758,10 @@ bool GameClient::OnGameMessage(const GameMessage_Server_Password& msg)
         return true;
     }
 
+    // Lets the server give us our slot back if we were dropped from a running game
+    if(!rejoinToken_.token.empty() && rejoinToken_.server == clientconfig.server
+       && rejoinToken_.port == clientconfig.port)
+        mainPlayer.sendMsgAsync(new GameMessage_Rejoin_Token(rejoinToken_.token));
     mainPlayer.sendMsgAsync(new GameMessage_Player_Name(0xFF, SETTINGS.lobby.name));
     mainPlayer.sendMsgAsync(new GameMessage_MapRequest(true));
 
@@ -926,19 +979,34 @@ bool GameClient::OnGameMessage(const GameMessage_Map_Data& msg)
         return true;
 
     LOG.writeToFile("<<< NMS_MAP_DATA(%u)\n") % msg.data.size();
-    if(msg.isMapData)
-        std::copy(msg.data.begin(), msg.data.end(), mapinfo.mapData.data.begin() + msg.offset);
-    else
-        std::copy(msg.data.begin(), msg.data.end(), mapinfo.luaData.data.begin() + msg.offset);
-
+    std::vector<char>& targetData = msg.isMapData ? mapinfo.mapData.data : mapinfo.luaData.data;
     const unsigned curSize = msg.offset + msg.data.size();
+    if(curSize > targetData.size())
+    {
+        OnError(CE_MAP_TRANSMISSION);
+        return true;
+    }
+    std::copy(msg.data.begin(), msg.data.end(), targetData.begin() + msg.offset);
+
     bool isCompleted;
     if(msg.isMapData)
         isCompleted = mapinfo.luaFilepath.empty() && curSize == mapinfo.mapData.data.size();
     else
         isCompleted = curSize == mapinfo.luaData.data.size();
 
-    if(isCompleted)
+    // Lua data follows the map data
+    const unsigned numBytesReceived = msg.isMapData ? curSize : mapinfo.mapData.data.size() + curSize;
+    if(ci)
+        ci->CI_MapTransferProgress(numBytesReceived, mapinfo.mapData.data.size() + mapinfo.luaData.data.size());
+
+    if(!isCompleted)
+        mainPlayer.sendMsgAsync(new GameMessage_Map_DataAck(numBytesReceived));
+    else if(isRejoining_)
+    {
+        // Server continues with the commands since the snapshot after the last ack
+        mainPlayer.sendMsgAsync(new GameMessage_Map_DataAck(numBytesReceived));
+        StartRejoinedGame();
+    } else
     {
         if(!mapinfo.mapData.DecompressToFile(mapinfo.filepath, &mapinfo.mapChecksum))
         {
@@ -963,6 +1031,166 @@ bool GameClient::OnGameMessage(const GameMessage_Map_Data& msg)
     return true;
 }
 
+bool GameClient::OnGameMessage(const GameMessage_Rejoin_RequestSnapshot& msg)
+{
+    if((state != CS_LOADED && state != CS_GAME) || replayMode || !nwfInfo)
+        return true;
+    // The NWF was not announced yet, so we did not execute it
+    if(msg.gf < GetGFNumber())
+    {
+        LOG.write("Snapshot for rejoin requested for past GF %1%\n") % msg.gf;
+        return true;
+    }
+    requestedSnapshotGF_ = msg.gf;
+    return true;
+}
+
+bool GameClient::OnGameMessage(const GameMessage_Rejoin_Start& msg)
+{
+    if(state != CS_CONNECT || replayMode)
+        return true;
+    if(msg.compressedLength > REJOIN_MAX_SNAPSHOT_SIZE || msg.length > REJOIN_MAX_SNAPSHOT_SIZE)
+    {
+        OnError(CE_MAP_TRANSMISSION);
+        return true;
+    }
+    mainPlayer.playerId = msg.player;
+
+    // The snapshot is transferred like the map of a savegame
+    mapinfo.Clear();
+    mapinfo.type = MAPTYPE_SAVEGAME;
+    mapinfo.filepath = RTTRCONFIG.ExpandPath(s25::folders::mapsPlayed) / "rejoin.sav";
+    mapinfo.mapData.length = msg.length;
+    mapinfo.mapData.data.resize(msg.compressedLength);
+
+    nwfInfo = std::make_shared<NWFInfo>();
+    nwfInfo->init(msg.snapshotGF, msg.cmdDelay);
+    // We receive the commands of all NWFs executed since the snapshot at once
+    nwfInfo->setBacklogAllowed(true);
+    rejoinRandomState_ = msg.randomState;
+    isRejoining_ = isCatchingUp_ = true;
+    LOG.write("Rejoining the game as player %1% at GF %2%\n") % unsigned(msg.player) % msg.snapshotGF;
+    return true;
+}
+
+bool GameClient::OnGameMessage(const GameMessage_Rejoin_Token& msg)
+{
+    if(replayMode)
+        return true;
+    rejoinToken_.server = clientconfig.server;
+    rejoinToken_.port = clientconfig.port;
+    rejoinToken_.token = msg.token;
+    return true;
+}
+
+void GameClient::SendRejoinSnapshot()
+{
+    const unsigned gf = *requestedSnapshotGF_;
+    requestedSnapshotGF_.reset();
+
+    CompressedData snapshot;
+    std::vector<char> randomState;
+    try
+    {
+        const bfs::path tmpPath = RTTRCONFIG.ExpandPath(s25::folders::mapsPlayed) / "rejoin_snapshot.sav";
+        Savegame save;
+        MakeSavegame(save);
+        if(!save.Save(tmpPath, mapinfo.title))
+            throw std::runtime_error("Could not save the snapshot");
+        const bool compressed = snapshot.CompressFromFile(tmpPath);
+        bfs::remove(tmpPath);
+        if(!compressed)
+            throw std::runtime_error("Could not compress the snapshot");
+
+        // Not part of the savegame but required to continue the game
+        Serializer ser;
+        RANDOM.GetCurrentState().serialize(ser);
+        const auto* rngData = reinterpret_cast<const char*>(ser.GetData());
+        randomState.assign(rngData, rngData + ser.GetLength());
+    } catch(std::exception& e)
+    {
+        // The server aborts the rejoin when the snapshot never arrives (e.g. the player disconnects)
+        LOG.write("Error during snapshot for rejoin: %1%\n") % e.what();
+        return;
+    }
+
+    const unsigned compressedLength = snapshot.data.size();
+    for(unsigned offset = 0; offset < compressedLength; offset += REJOIN_SNAPSHOT_PART_SIZE)
+    {
+        const unsigned partSize = std::min(REJOIN_SNAPSHOT_PART_SIZE, compressedLength - offset);
+        std::vector<char> part(snapshot.data.begin() + offset, snapshot.data.begin() + offset + partSize);
+        mainPlayer.sendMsgAsync(new GameMessage_Rejoin_Snapshot(gf, snapshot.length, compressedLength, offset,
+                                                                std::move(part),
+                                                                offset == 0 ? randomState : std::vector<char>()));
+    }
+}
+
+void GameClient::StartRejoinedGame()
+{
+    if(!mapinfo.mapData.DecompressToFile(mapinfo.filepath))
+    {
+        OnError(CE_MAP_TRANSMISSION);
+        return;
+    }
+    mapinfo.savegame = std::make_unique<Savegame>();
+    if(!mapinfo.savegame->Load(mapinfo.filepath, SaveGameDataToLoad::HeaderAndSettings)
+       || GetPlayerId() >= mapinfo.savegame->GetNumPlayers())
+    {
+        OnError(CE_INVALID_MAP);
+        return;
+    }
+    mapinfo.title = mapinfo.savegame->GetMapName();
+
+    gameLobby = std::make_shared<GameLobby>(true, false, mapinfo.savegame->GetNumPlayers());
+    for(unsigned i = 0; i < gameLobby->getNumPlayers(); ++i)
+        gameLobby->getPlayer(i) = JoinPlayerInfo(mapinfo.savegame->GetPlayer(i));
+    gameLobby->getSettings() = mapinfo.savegame->ggs;
+
+    state = CS_CONFIG;
+    try
+    {
+        // The seed is irrelevant as the state is restored below
+        StartGame(0);
+    } catch(SerializedGameData::Error& error)
+    {
+        LOG.write("Error when loading game: %s\n") % error.what();
+        Stop();
+        GAMEMANAGER.ShowMenu();
+        return;
+    }
+    if(!game)
+        return;
+
+    UsedRandom::PRNG rng;
+    Serializer ser(rejoinRandomState_.data(), rejoinRandomState_.size());
+    rng.deserialize(ser);
+    RANDOM.ResetState(rng);
+    rejoinRandomState_.clear();
+}
+
+void GameClient::HandlePendingRejoins()
+{
+    const unsigned curGF = GetGFNumber();
+    for(auto it = pendingRejoins_.begin(); it != pendingRejoins_.end();)
+    {
+        if(it->second > curGF)
+        {
+            ++it;
+            continue;
+        }
+        const unsigned playerId = it->first;
+        it = pendingRejoins_.erase(it);
+
+        GetPlayer(playerId).ps = PS_OCCUPIED;
+        if(IsHost())
+            game->aiPlayers_.erase_if([playerId](const AIPlayer& ai) { return ai.GetPlayerId() == playerId; });
+        if(playerId == GetPlayerId())
+            isRejoining_ = false;
+        if(ci)
+            ci->CI_NewPlayer(playerId);
+    }
+}
+
 bool GameClient::OnGameMessage(const GameMessage_SkipToGF& msg)
 {
     skiptogf = msg.targetGF;
@@ -1176,6 +1404,13 @@ bool GameClient::OnGameMessage(const GameMessage_GetAsyncLog& /*msg*/)
     if(state != CS_GAME)
         return true;
     std::string systemInfo = System::getCompilerName() + " @ " + System::getOSName();
+    for(const auto& gfAndChecksum : sentChecksums_)
+    {
+        const AsyncChecksum& checksum = gfAndChecksum.second;
+        systemInfo += helpers::format("\nGF %1%: RandCS = %2%, objects/ID = %3%/%4%, events/ID = %5%/%6% (Hash = %7%)",
+                                      gfAndChecksum.first, checksum.randChecksum, checksum.objCt, checksum.objIdCt,
+                                      checksum.eventCt, checksum.evInstanceCt, checksum.getHash());
+    }
     mainPlayer.sendMsgAsync(new GameMessage_AsyncLog(systemInfo));
 
     // AsyncLog an den Server senden
@@ -1199,6 +1434,72 @@ bool GameClient::OnGameMessage(const GameMessage_GetAsyncLog& /*msg*/)
     return true;
 }
 
+bool GameClient::OnGameMessage(const GameMessage_Spectator_Start& msg)
+{
+    if(state != CS_CONNECT || !spectatorInfo || spectatorInfo->file.is_open())
+        return true;
+
+    spectatorInfo->headerSize = msg.headerSize;
+    spectatorInfo->endGF = msg.startGF;
+    spectatorInfo->filepath =
+      RTTRCONFIG.ExpandPath(s25::folders::replays) / (s25util::Time::FormatTime("%Y-%m-%d_%H-%i-%s") + "_live.rpl");
+    spectatorInfo->file.open(spectatorInfo->filepath, std::ios::binary);
+    if(!spectatorInfo->file)
+    {
+        LOG.write(_("Could not open %1% for the spectator stream\n")) % spectatorInfo->filepath;
+        OnError(CE_CONNECTION_LOST);
+    }
+    return true;
+}
+
+bool GameClient::OnGameMessage(const GameMessage_Spectator_Data& msg)
+{
+    if(!spectatorInfo || !spectatorInfo->file.is_open())
+        return true;
+
+    if(!msg.data.empty())
+    {
+        spectatorInfo->file.write(msg.data.data(), msg.data.size());
+        // The replay reads from the file, so it must be written immediately
+        spectatorInfo->file.flush();
+        if(!spectatorInfo->file)
+        {
+            LOG.write(_("Could not write the spectator stream to %1%\n")) % spectatorInfo->filepath;
+            if(replayMode)
+                mainPlayer.closeConnection();
+            else
+                OnError(CE_CONNECTION_LOST);
+            return true;
+        }
+        spectatorInfo->numBytesReceived += msg.data.size();
+    }
+    spectatorInfo->endGF = std::max<unsigned>(spectatorInfo->endGF, msg.endGF);
+
+    if(state == CS_CONNECT)
+    {
+        if(spectatorInfo->numBytesReceived < spectatorInfo->headerSize)
+            return true;
+        // Header is complete: Start the game like a replay but keep the connection for the remaining stream
+        state = CS_STOPPED;
+        if(!StartReplay(spectatorInfo->filepath))
+        {
+            mainPlayer.closeConnection();
+            spectatorInfo.reset();
+        }
+    } else if(state == CS_GAME && spectatorInfo->isCatchingUp)
+    {
+        // Fast forward till we are close to the stream
+        if(GetGFNumber() + SPECTATOR_CATCHUP_GFS < spectatorInfo->endGF)
+            framesinfo.gf_length = FramesInfo::milliseconds32_t(1);
+        else
+        {
+            spectatorInfo->isCatchingUp = false;
+            framesinfo.gf_length = framesinfo.gfLengthReq;
+        }
+    }
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// testet ob ein Netwerkframe abgelaufen ist und führt dann ggf die Befehle aus
 void GameClient::ExecuteGameFrame()
@@ -1211,86 +1512,114 @@ void GameClient::ExecuteGameFrame()
     if(framesinfo.forcePauseLen.count())
     {
         if(currentTime - framesinfo.forcePauseStart > framesinfo.forcePauseLen)
+        {
             framesinfo.forcePauseLen = FramesInfo::milliseconds32_t::zero();
-        else
+            // The pause must not be caught up afterwards
+            framesinfo.lastTime = currentTime - framesinfo.frameTime;
+        } else
             return; // Pause
     }
 
+    // After a rejoin we fast forward through everything announced so far
+    if(isCatchingUp_ && !skiptogf && nwfInfo->getNumPendingNWFs() > 0u)
+        skiptogf = nwfInfo->getLastNWF();
+    UpdateFastForward();
+
+    // If we are skipping, it is always time for the next GF but only execute 1 GF so the caller can report progress
+    if(skiptogf > GetGFNumber())
+    {
+        if(ExecuteNextGF(currentTime))
+        {
+            framesinfo.lastTime = currentTime;
+            framesinfo.frameTime = FramesInfo::milliseconds32_t::zero();
+        }
+        if(game && skiptogf == GetGFNumber())
+            skiptogf = 0;
+        UpdateFastForward();
+        return;
+    }
+
+    framesinfo.runDueGFs(currentTime, MAX_GFS_PER_FRAME, [this, currentTime]() { return ExecuteNextGF(currentTime); });
+    RTTR_Assert(framesinfo.frameTime < framesinfo.gf_length);
+}
+
+bool GameClient::ExecuteNextGF(const FramesInfo::UsedClock::time_point currentTime)
+{
     const unsigned curGF = GetGFNumber();
-    // Is it time for the next GF? If we are skipping, it is always time for the next GF
-    if(skiptogf > curGF || (currentTime - framesinfo.lastTime) >= framesinfo.gf_length)
+    try
     {
-        try
+        if(replayMode)
         {
-            if(replayMode)
-            {
-                // In replay mode we have all commands in the file -> Execute them
-                ExecuteGameFrame_Replay();
-            } else
+            // A live replay can only be played till the GF whose commands were not received yet
+            if(spectatorInfo && curGF >= spectatorInfo->endGF)
+                return false;
+            // In replay mode we have all commands in the file -> Execute them
+            ExecuteGameFrame_Replay();
+        } else
+        {
+            RTTR_Assert(curGF <= nwfInfo->getNextNWF());
+            bool isNWF = (curGF == nwfInfo->getNextNWF());
+            // Is it time for a NWF, handle that first
+            if(isNWF)
             {
-                RTTR_Assert(curGF <= nwfInfo->getNextNWF());
-                bool isNWF = (curGF == nwfInfo->getNextNWF());
-                // Is it time for a NWF, handle that first
-                if(isNWF)
+                // The snapshot must not contain the commands of this NWF
+                if(requestedSnapshotGF_ == curGF)
+                    SendRejoinSnapshot();
+                // If a player is lagging (we did not got his commands) "pause" the game by skipping the rest of
+                // this function
+                // -> Don't execute GF, don't autosave etc.
+                if(!nwfInfo->isReady())
                 {
-                    // If a player is lagging (we did not got his commands) "pause" the game by skipping the rest of
-                    // this function
-                    // -> Don't execute GF, don't autosave etc.
-                    if(!nwfInfo->isReady())
+                    // Reached the first NWF not yet announced after a rejoin -> Ready to take over
+                    if(isCatchingUp_ && nwfInfo->getNumPendingNWFs() == 0u)
                     {
-                        // If a player is a few GFs behind, he will never catch up and always lag
-                        // Hence, pause up to 4 GFs randomly before trying again to execute this NWF
-                        // Do not reset frameTime or lastTime as this will mess up interpolation for drawing
-                        framesinfo.forcePauseStart = currentTime;
-                        framesinfo.forcePauseLen = (rand() * 4 * framesinfo.gf_length) / RAND_MAX;
-                        return;
+                        isCatchingUp_ = false;
+                        skiptogf = 0;
+                        nwfInfo->setBacklogAllowed(false);
+                        mainPlayer.sendMsgAsync(new GameMessage_Rejoin_Ready());
+                        LOG.write("Caught up with the game at GF %1%\n") % curGF;
                     }
+                    // If a player is a few GFs behind, he will never catch up and always lag
+                    // Hence, pause up to 4 GFs randomly before trying again to execute this NWF
+                    // Do not reset frameTime as this will mess up interpolation for drawing
+                    framesinfo.forcePauseStart = currentTime;
+                    framesinfo.forcePauseLen = (rand() * 4 * framesinfo.gf_length) / RAND_MAX;
+                    return false;
+                }
 
-                    RTTR_Assert(nwfInfo->getServerInfo().gf == curGF);
+                RTTR_Assert(nwfInfo->getServerInfo().gf == curGF);
 
-                    ExecuteNWF();
+                ExecuteNWF();
 
-                    FramesInfo::milliseconds32_t oldGFLen = framesinfo.gf_length;
-                    nwfInfo->execute(framesinfo);
-                    if(oldGFLen != framesinfo.gf_length)
-                    {
-                        LOG.write("Client: Speed changed at %1% from %2% to %3% (NWF: %4%)\n") % curGF % oldGFLen
-                          % framesinfo.gf_length % framesinfo.nwf_length;
-                    }
+                FramesInfo::milliseconds32_t oldGFLen = framesinfo.gf_length;
+                nwfInfo->execute(framesinfo);
+                if(oldGFLen != framesinfo.gf_length)
+                {
+                    LOG.write("Client: Speed changed at %1% from %2% to %3% (NWF: %4%)\n") % curGF % oldGFLen
+                      % framesinfo.gf_length % framesinfo.nwf_length;
                 }
-
-                NextGF(isNWF);
-                RTTR_Assert(curGF <= nwfInfo->getNextNWF());
-                HandleAutosave();
-
-                // GF-Ende im Replay aktualisieren
-                if(replayinfo && replayinfo->replay.IsRecording())
-                    replayinfo->replay.UpdateLastGF(curGF);
             }
 
-            // Store this timestamp
-            framesinfo.lastTime = currentTime;
-            // Reset frameTime
-            framesinfo.frameTime = FramesInfo::milliseconds32_t::zero();
-        } catch(LuaExecutionError& e)
-        {
-            if(ci)
-            {
-                SystemChat(
-                  (boost::format(_("Error during execution of lua script: %1\nGame stopped!")) % e.what()).str());
-                ci->CI_Error(CE_INVALID_MAP);
-            }
-            Stop();
+            NextGF(isNWF);
+            RTTR_Assert(curGF <= nwfInfo->getNextNWF());
+            HandleAutosave();
+            HandleSpectatorSnapshot();
+
+            // GF-Ende im Replay aktualisieren
+            if(replayinfo && replayinfo->replay.IsRecording())
+                replayinfo->replay.UpdateLastGF(curGF);
         }
-        if(skiptogf == GetGFNumber())
-            skiptogf = 0;
-    } else
+    } catch(LuaExecutionError& e)
     {
-        // Next GF not yet reached, just update the time in the current one for drawing
-        framesinfo.frameTime =
-          std::chrono::duration_cast<FramesInfo::milliseconds32_t>(currentTime - framesinfo.lastTime);
-        RTTR_Assert(framesinfo.frameTime < framesinfo.gf_length);
+        if(ci)
+        {
+            SystemChat((boost::format(_("Error during execution of lua script: %1\nGame stopped!")) % e.what()).str());
+            ci->CI_Error(CE_INVALID_MAP);
+        }
+        Stop();
+        return false;
     }
+    return true;
 }
 
 void GameClient::HandleAutosave()
@@ -1312,6 +1641,23 @@ void GameClient::HandleAutosave()
     }
 }
 
+void GameClient::HandleSpectatorSnapshot()
+{
+    if(!IsHost() || !GAMESERVER.IsSpectatorSnapshotDue(GetGFNumber()))
+        return;
+
+    auto save = std::make_unique<Savegame>();
+    try
+    {
+        MakeSavegame(*save);
+    } catch(std::exception& e)
+    {
+        LOG.write("Error during snapshot for spectators: %1%\n") % e.what();
+        save.reset();
+    }
+    GAMESERVER.AddSpectatorSnapshot(std::move(save));
+}
+
 /// Führt notwendige Dinge für nächsten GF aus
 void GameClient::NextGF(bool wasNWF)
 {
@@ -1351,7 +1697,8 @@ void GameClient::OnGameStart()
             ci->CI_GameStarted(game);
     } else if(state == CS_GAME && !game->IsStarted())
     {
-        framesinfo.isPaused = replayMode;
+        // Live replays are watched without pause
+        framesinfo.isPaused = replayMode && !spectatorInfo;
         game->Start(!!mapinfo.savegame);
     }
 }
@@ -1465,7 +1812,7 @@ bool GameClient::StartReplay(const boost::filesystem::path& path)
         return false;
     }
 
-    replayinfo->replay.ReadGF(&replayinfo->next_gf);
+    ReadNextReplayGF();
 
     return true;
 }
@@ -1518,6 +1865,14 @@ int GameClient::Interpolate(int x1, int x2, const GameEvent* ev)
 
 void GameClient::ServerLost()
 {
+    // The received part of a live replay can still be watched
+    if(spectatorInfo && replayMode)
+    {
+        // Keep the queue as it might contain the last part of the stream
+        mainPlayer.socket.Close();
+        SystemChat(_("The connection to the server was lost. The game can be watched till the last received GF."));
+        return;
+    }
     OnError(CE_CONNECTION_LOST);
     // Stop game
     framesinfo.isPaused = true;
@@ -1528,7 +1883,7 @@ void GameClient::ServerLost()
  *
  *  @param[in] dest_gf Zielgameframe
  */
-void GameClient::SkipGF(unsigned gf, GameWorldView& gwv)
+void GameClient::SkipGF(unsigned gf)
 {
     if(gf <= GetGFNumber())
         return;
@@ -1543,26 +1898,28 @@ void GameClient::SkipGF(unsigned gf, GameWorldView& gwv)
         return;
     }
 
+    // A live replay can only be played till the last received GF
+    if(spectatorInfo)
+        gf = std::min(gf, spectatorInfo->endGF);
     SetPause(false);
     skiptogf = gf;
 
+    // Time in ms between progress updates. The map itself is not drawn as the views are detached while fast forwarding
+    constexpr unsigned progressInterval = 500;
+    const unsigned startGF = GetGFNumber();
+    unsigned lastProgressTicks = start_ticks;
     // GFs überspringen
-    for(unsigned i = GetGFNumber(); i < skiptogf; ++i)
+    for(unsigned i = startGF; i < skiptogf; ++i)
     {
-        if(i % 1000 == 0)
+        const unsigned curTicks = VIDEODRIVER.GetTickCount();
+        if(curTicks - lastProgressTicks >= progressInterval)
         {
-            RoadBuildState road;
-            road.mode = RM_DISABLED;
-
-            // spiel aktualisieren
-            gwv.Draw(road, MapPoint::Invalid(), false);
-
-            // text oben noch hinschreiben
+            lastProgressTicks = curTicks;
+            VIDEODRIVER.ClearScreen();
             boost::format nwfString(_("current GF: %u - still fast forwarding: %d GFs left (%d %%)"));
-            nwfString % GetGFNumber() % (gf - i) % (i * 100 / gf);
+            nwfString % GetGFNumber() % (gf - i) % ((i - startGF) * 100 / (gf - startGF));
             LargeFont->Draw(DrawPoint(VIDEODRIVER.GetRenderSize() / 2u), nwfString.str(), FontStyle::CENTER,
                             COLOR_YELLOW);
-
             VIDEODRIVER.SwapBuffers();
         }
         ExecuteGameFrame();
@@ -1576,6 +1933,20 @@ void GameClient::SkipGF(unsigned gf, GameWorldView& gwv)
     SetPause(true);
 }
 
+void GameClient::UpdateFastForward()
+{
+    const bool isSkipping = game && skiptogf > GetGFNumber();
+    if(isSkipping == isFastForwarding_)
+        return;
+    isFastForwarding_ = isSkipping;
+    if(!ci)
+        return;
+    if(isFastForwarding_)
+        ci->CI_FastForwardStarted();
+    else
+        ci->CI_FastForwardFinished();
+}
+
 void GameClient::SystemChat(const std::string& text)
 {
     SystemChat(text, GetPlayerId());
@@ -1599,6 +1970,20 @@ bool GameClient::SaveToFile(const boost::filesystem::path& filepath)
 
     Savegame save;
 
+    try
+    {
+        MakeSavegame(save);
+        // Und alles speichern
+        return save.Save(filepath, mapinfo.title);
+    } catch(std::exception& e)
+    {
+        SystemChat(std::string("Error during saving: ") + e.what());
+        return false;
+    }
+}
+
+void GameClient::MakeSavegame(Savegame& save)
+{
     WritePlayerInfo(save);
 
     // GGS-Daten
@@ -1609,17 +1994,8 @@ bool GameClient::SaveToFile(const boost::filesystem::path& filepath)
     // Enable/Disable debugging of savegames
     save.sgd.debugMode = SETTINGS.global.debugMode;
 
-    try
-    {
-        // Spiel serialisieren
-        save.sgd.MakeSnapshot(game);
-        // Und alles speichern
-        return save.Save(filepath, mapinfo.title);
-    } catch(std::exception& e)
-    {
-        SystemChat(std::string("Error during saving: ") + e.what());
-        return false;
-    }
+    // Spiel serialisieren
+    save.sgd.MakeSnapshot(game);
 }
 
 void GameClient::ResetVisualSettings()
@@ -1663,13 +2039,15 @@ bool GameClient::IsReplayFOWDisabled() const
 
 unsigned GameClient::GetLastReplayGF() const
 {
+    if(spectatorInfo)
+        return spectatorInfo->endGF;
     return replayinfo ? replayinfo->replay.GetLastGF() : 0u;
 }
 
 bool GameClient::AddGC(gc::GameCommandPtr gc)
 {
-    // Nicht in der Pause oder wenn er besiegt wurde
-    if(framesinfo.isPaused || GetPlayer(GetPlayerId()).IsDefeated() || IsReplayModeOn())
+    // Nicht in der Pause oder wenn er besiegt wurde (oder noch nicht wieder im Spiel ist)
+    if(framesinfo.isPaused || GetPlayer(GetPlayerId()).IsDefeated() || IsReplayModeOn() || isRejoining_)
         return false;
 
     gameCommands_.push_back(gc);
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "AsyncChecksum.h"
 #include "ClientError.h"
 #include "FramesInfo.h"
 #include "GameCommand.h"
@@ -31,7 +32,10 @@
 #include "gameTypes/TeamTypes.h"
 #include "gameTypes/VisualSettings.h"
 #include "s25util/Singleton.h"
+#include <boost/optional.hpp>
+#include <deque>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace AI {
@@ -44,13 +48,14 @@ class SavedFile;
 class GamePlayer;
 class GameEvent;
 class GameLobby;
-class GameWorldView;
 class Game;
 class Replay;
 struct PlayerGameCommands;
 class NWFInfo;
 struct CreateServerInfo;
 struct ReplayInfo;
+struct SpectatorInfo;
+class Savegame;
 
 class GameClient final :
     public Singleton<GameClient, SingletonPolicies::WithLongevity>,
@@ -60,6 +65,8 @@ class GameClient final :
 {
 public:
     static constexpr unsigned Longevity = 5;
+    /// Maximum number of GFs to execute in one call to Run when we are behind
+    static constexpr unsigned MAX_GFS_PER_FRAME = 4;
 
     enum ClientState
     {
@@ -141,6 +148,10 @@ public:
 
     /// Lädt ein Replay und startet dementsprechend das Spiel
     bool StartReplay(const boost::filesystem::path& path);
+    /// Connect to the spectator relay of a server. The game is watched like a replay as soon as its start was received
+    bool StartSpectating(const std::string& server, unsigned short port, bool use_ipv6);
+    /// Is this a replay streamed live from a server?
+    bool IsSpectating() const { return spectatorInfo != nullptr; }
     void SetPause(bool pause);
     void TogglePause() { SetPause(!framesinfo.isPaused); }
     /// Schaltet FoW im Replaymodus ein/aus
@@ -160,7 +171,7 @@ public:
     /// Is tournament mode activated (0 if not)? Returns the durations of the tournament mode in gf otherwise
     unsigned GetTournamentModeDuration() const;
 
-    void SkipGF(unsigned gf, GameWorldView& gwv);
+    void SkipGF(unsigned gf);
 
     /// Changes the player ingame (for replay or debugging)
     void ChangePlayerIngame(unsigned char playerId1, unsigned char playerId2);
@@ -192,8 +203,15 @@ private:
     GamePlayer& GetPlayer(unsigned id);
 
     /// Versucht einen neuen GameFrame auszuführen, falls die Zeit dafür gekommen ist
+    /// Executes all GFs that are due (up to MAX_GFS_PER_FRAME) so the GF rate does not depend on the framerate
     void ExecuteGameFrame();
+    /// Execute the next GF (including NWF handling). Return false if it could not be executed (lagging player, error)
+    bool ExecuteNextGF(FramesInfo::UsedClock::time_point currentTime);
     void ExecuteGameFrame_Replay();
+    /// Notify the interface when fast forwarding (skiptogf) started or finished
+    void UpdateFastForward();
+    /// Read the GF of the next command of the replay. For live replays it might not have been received yet
+    void ReadNextReplayGF();
     void ExecuteNWF();
     /// Filtert aus einem Network-Command-Paket alle Commands aus und führt sie aus, falls ein Spielerwechsel-Command
     /// dabei ist, füllt er die übergebenen IDs entsprechend aus
@@ -205,6 +223,16 @@ private:
     void NextGF(bool wasNWF);
     /// Checks if its time for autosaving (if enabled) and does it
     void HandleAutosave();
+    /// Provides a snapshot of the game for late joining spectators if we are the host and it is due
+    void HandleSpectatorSnapshot();
+    /// Fill the savegame with the current state of the game
+    void MakeSavegame(Savegame& save);
+    /// Make the snapshot requested by the server for a rejoining player and send it
+    void SendRejoinSnapshot();
+    /// Start the game from the snapshot received for our rejoin
+    void StartRejoinedGame();
+    /// Hand over the slots of players who rejoined at the current NWF
+    void HandlePendingRejoins();
 
     //  Netzwerknachrichten
     RTTR_IGNORE_OVERLOADED_VIRTUAL
@@ -231,6 +259,7 @@ private:
     bool OnGameMessage(const GameMessage_Player_New& msg) override;
     bool OnGameMessage(const GameMessage_Player_Ready& msg) override;
     bool OnGameMessage(const GameMessage_Player_Swap& msg) override;
+    bool OnGameMessage(const GameMessage_Player_Rejoined& msg) override;
 
     bool OnGameMessage(const GameMessage_Map_Info& msg) override;
     bool OnGameMessage(const GameMessage_Map_Data& msg) override;
@@ -245,6 +274,13 @@ private:
     bool OnGameMessage(const GameMessage_RemoveLua& msg) override;
 
     bool OnGameMessage(const GameMessage_GetAsyncLog& msg) override;
+
+    bool OnGameMessage(const GameMessage_Spectator_Start& msg) override;
+    bool OnGameMessage(const GameMessage_Spectator_Data& msg) override;
+
+    bool OnGameMessage(const GameMessage_Rejoin_RequestSnapshot& msg) override;
+    bool OnGameMessage(const GameMessage_Rejoin_Start& msg) override;
+    bool OnGameMessage(const GameMessage_Rejoin_Token& msg) override;
     RTTR_POP_DIAGNOSTIC
 
     /// Report the error and stop
@@ -302,9 +338,34 @@ private:
 
     /// GameCommands, die vom Client noch an den Server gesendet werden müssen
     std::vector<gc::GameCommandPtr> gameCommands_;
+    /// Checksums (with GF) sent with the last GameCommands. Only their hashes are sent, so they are added to the async
+    /// log for investigation
+    std::deque<std::pair<unsigned, AsyncChecksum>> sentChecksums_;
 
     std::unique_ptr<ReplayInfo> replayinfo;
     bool replayMode;
+    /// Currently skipping GFs (views are detached)
+    bool isFastForwarding_;
+    /// Only set when watching a game live
+    std::unique_ptr<SpectatorInfo> spectatorInfo;
+
+    /// GF at which we have to make a snapshot for a rejoining player
+    boost::optional<unsigned> requestedSnapshotGF_;
+    /// We rejoined a running game: Our slot is played by the AI until the server hands it over
+    bool isRejoining_;
+    /// Fast forward till the last announced NWF after loading the snapshot of a rejoin
+    bool isCatchingUp_;
+    /// State of the random number generator at the start of the snapshot (not stored in savegames)
+    std::vector<char> rejoinRandomState_;
+    /// Players that take over their slot again at the given GF
+    std::vector<std::pair<unsigned, unsigned>> pendingRejoins_;
+    /// Token for rejoining the last game we played and its server. Kept when the client is stopped
+    struct
+    {
+        std::string server;
+        unsigned short port = 0;
+        std::string token;
+    } rejoinToken_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
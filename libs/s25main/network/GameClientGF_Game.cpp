@@ -29,6 +29,8 @@ void GameClient::ExecuteNWF()
     AsyncChecksum checksum = AsyncChecksum::create(*game);
     const unsigned curGF = GetGFNumber();
 
+    HandlePendingRejoins();
+
     for(const NWFPlayerInfo& player : nwfInfo->getPlayerInfos())
     {
         const PlayerGameCommands& currentGCs = player.commands.front();
@@ -57,6 +59,12 @@ void GameClient::ExecuteNWF()
         else
             mainPlayer.sendMsgAsync(new GameMessage_GameCommand(ai.GetPlayerId(), checksum, aiGCs));
     }
-    mainPlayer.sendMsgAsync(new GameMessage_GameCommand(0xFF, checksum, gameCommands_));
+    // Till the hand over our slot is played by the AI of the host
+    if(!isRejoining_)
+        mainPlayer.sendMsgAsync(new GameMessage_GameCommand(0xFF, checksum, gameCommands_));
     gameCommands_.clear();
+    sentChecksums_.emplace_back(curGF, checksum);
+    // Async is detected within the command delay, so keep only a few
+    if(sentChecksums_.size() > 8u)
+        sentChecksums_.pop_front();
 }
@@ -22,9 +22,13 @@
 #include "network/ClientInterface.h"
 #include "network/GameClient.h"
 #include "s25util/Log.h"
+#include <cstdio>
 
 void GameClient::ExecuteGameFrame_Replay()
 {
+    if(spectatorInfo && spectatorInfo->isNextGFPending)
+        ReadNextReplayGF();
+
     AsyncChecksum checksum = AsyncChecksum::create(*game);
 
     const unsigned curGF = GetGFNumber();
@@ -58,7 +62,7 @@ void GameClient::ExecuteGameFrame_Replay()
             AsyncChecksum& msgChecksum = msg.checksum;
 
             // Check for async if checksum data is valid
-            if(msgChecksum.randChecksum != 0 && msgChecksum != checksum)
+            if(msgChecksum.isValid() && msgChecksum != checksum)
             {
                 // Show message if this is the first async GF
                 if(replayinfo->async == 0)
@@ -69,9 +73,17 @@ void GameClient::ExecuteGameFrame_Replay()
                           _("Warning: The played replay is not in sync with the original match. (GF: %u)"), curGF));
                     }
 
-                    LOG.write("Async at GF %u: Checksum %i:%i ObjCt %u:%u ObjIdCt %u:%u\n") % curGF
-                      % msgChecksum.randChecksum % checksum.randChecksum % msgChecksum.objCt % checksum.objCt
-                      % msgChecksum.objIdCt % checksum.objIdCt;
+                    if(msgChecksum.isHashOnly())
+                    {
+                        LOG.write("Async at GF %u: Checksum hash %u:%u (Checksum %i ObjCt %u ObjIdCt %u)\n")
+                          % curGF % msgChecksum.getHash() % checksum.getHash() % checksum.randChecksum
+                          % checksum.objCt % checksum.objIdCt;
+                    } else
+                    {
+                        LOG.write("Async at GF %u: Checksum %i:%i ObjCt %u:%u ObjIdCt %u:%u\n") % curGF
+                          % msgChecksum.randChecksum % checksum.randChecksum % msgChecksum.objCt % checksum.objCt
+                          % msgChecksum.objIdCt % checksum.objIdCt;
+                    }
 
                     // and pause the game for further investigation
                     framesinfo.isPaused = true;
@@ -83,14 +95,14 @@ void GameClient::ExecuteGameFrame_Replay()
             }
         }
         // Read GF of next command
-        replayinfo->replay.ReadGF(&replayinfo->next_gf);
+        ReadNextReplayGF();
     }
 
     // Run game simulation
     NextGF(cmdsExecuted);
 
-    // Check for game end
-    if(curGF == replayinfo->replay.GetLastGF())
+    // Check for game end. A live replay has no known end
+    if(!spectatorInfo && curGF == replayinfo->replay.GetLastGF())
     {
         if(ci)
         {
@@ -124,3 +136,21 @@ void GameClient::ExecuteGameFrame_Replay()
             skiptogf = GetGFNumber();
     }
 }
+
+void GameClient::ReadNextReplayGF()
+{
+    if(spectatorInfo)
+    {
+        BinaryFile& file = replayinfo->replay.GetFile();
+        // Only whole commands are received, so if there is data, the next command is complete
+        spectatorInfo->isNextGFPending = static_cast<unsigned>(file.Tell()) >= spectatorInfo->numBytesReceived;
+        if(spectatorInfo->isNextGFPending)
+        {
+            replayinfo->next_gf = 0xFFFFFFFF;
+            return;
+        }
+        // The file was appended after the last read, so reset the read state
+        file.Seek(file.Tell(), SEEK_SET);
+    }
+    replayinfo->replay.ReadGF(&replayinfo->next_gf);
+}
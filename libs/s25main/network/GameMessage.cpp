@@ -18,6 +18,7 @@
 #include "GameMessage.h"
 #include "GameMessage_GameCommand.h"
 #include "GameMessages.h"
+#include "SerializedGameMessage.h"
 #include "commonDefines.h"
 
 bool GameMessage::run(MessageInterface* callback, unsigned senderPlayerID)
@@ -36,6 +37,7 @@ Message* GameMessage::create_game(unsigned short id)
 
         case NMS_PING: msg = new GameMessage_Ping(); break;
         case NMS_PONG: msg = new GameMessage_Pong(); break;
+        case NMS_BATCH: msg = new GameMessage_Batch(); break;
         case NMS_SERVER_TYPE: msg = new GameMessage_Server_Type(); break;
         case NMS_SERVER_TYPEOK: msg = new GameMessage_Server_TypeOK(); break;
         case NMS_SERVER_PASSWORD: msg = new GameMessage_Server_Password(); break;
@@ -58,11 +60,13 @@ Message* GameMessage::create_game(unsigned short id)
         case NMS_PLAYER_READY: msg = new GameMessage_Player_Ready(); break;
         case NMS_PLAYER_SWAP: msg = new GameMessage_Player_Swap(); break;
         case NMS_PLAYER_SWAP_CONFIRM: msg = new GameMessage_Player_SwapConfirm(); break;
+        case NMS_PLAYER_REJOINED: msg = new GameMessage_Player_Rejoined(); break;
         case NMS_MAP_INFO: msg = new GameMessage_Map_Info(); break;
         case NMS_MAP_REQUEST: msg = new GameMessage_MapRequest(); break;
         case NMS_MAP_DATA: msg = new GameMessage_Map_Data(); break;
         case NMS_MAP_CHECKSUM: msg = new GameMessage_Map_Checksum(); break;
         case NMS_MAP_CHECKSUMOK: msg = new GameMessage_Map_ChecksumOK(); break;
+        case NMS_MAP_DATA_ACK: msg = new GameMessage_Map_DataAck(); break;
         case NMS_SERVER_NWF_DONE: msg = new GameMessage_Server_NWFDone(); break;
         case NMS_GAMECOMMANDS: msg = new GameMessage_GameCommand(); break;
         case NMS_PAUSE: msg = new GameMessage_Pause(); break;
@@ -72,6 +76,13 @@ Message* GameMessage::create_game(unsigned short id)
         case NMS_REMOVE_LUA: msg = new GameMessage_RemoveLua(); break;
         case NMS_GET_ASYNC_LOG: msg = new GameMessage_GetAsyncLog(); break;
         case NMS_ASYNC_LOG: msg = new GameMessage_AsyncLog(); break;
+        case NMS_SPECTATOR_START: msg = new GameMessage_Spectator_Start(); break;
+        case NMS_SPECTATOR_DATA: msg = new GameMessage_Spectator_Data(); break;
+        case NMS_REJOIN_REQUEST_SNAPSHOT: msg = new GameMessage_Rejoin_RequestSnapshot(); break;
+        case NMS_REJOIN_SNAPSHOT: msg = new GameMessage_Rejoin_Snapshot(); break;
+        case NMS_REJOIN_START: msg = new GameMessage_Rejoin_Start(); break;
+        case NMS_REJOIN_READY: msg = new GameMessage_Rejoin_Ready(); break;
+        case NMS_REJOIN_TOKEN: msg = new GameMessage_Rejoin_Token(); break;
     }
 
     return msg;
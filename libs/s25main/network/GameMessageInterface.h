@@ -62,12 +62,18 @@ GENERATE_GAME_MESSAGE_INTERFACE(GameMessage_Ping, GameMessage_Pong,
                                 GameMessage_Player_State, GameMessage_Player_Nation, GameMessage_Player_Team,
                                 GameMessage_Player_Color, GameMessage_Player_Kicked, GameMessage_Player_Ping,
                                 GameMessage_Player_New, GameMessage_Player_Ready, GameMessage_Player_Swap,
-                                GameMessage_Player_SwapConfirm,
+                                GameMessage_Player_SwapConfirm, GameMessage_Player_Rejoined,
 
                                 GameMessage_Map_Info, GameMessage_MapRequest, GameMessage_Map_Data,
-                                GameMessage_Map_Checksum, GameMessage_Map_ChecksumOK, GameMessage_GGSChange,
+                                GameMessage_Map_DataAck, GameMessage_Map_Checksum, GameMessage_Map_ChecksumOK,
+                                GameMessage_GGSChange,
                                 GameMessage_RemoveLua, GameMessage_Pause, GameMessage_SkipToGF,
                                 GameMessage_Server_NWFDone, GameMessage_GameCommand, GameMessage_Speed,
 
-                                GameMessage_GetAsyncLog, GameMessage_AsyncLog)
+                                GameMessage_GetAsyncLog, GameMessage_AsyncLog,
+
+                                GameMessage_Spectator_Start, GameMessage_Spectator_Data,
+
+                                GameMessage_Rejoin_RequestSnapshot, GameMessage_Rejoin_Snapshot,
+                                GameMessage_Rejoin_Start, GameMessage_Rejoin_Ready, GameMessage_Rejoin_Token)
 RTTR_POP_DIAGNOSTIC
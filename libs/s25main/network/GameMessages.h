@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <memory>
 #include <utility>
 
 #include "GameMessage.h"
@@ -718,6 +719,37 @@ public:
     bool Run(GameMessageInterface* callback) const override { return callback->OnGameMessage(*this); }
 };
 
+/// A dropped player took over his slot again starting at the given GF
+class GameMessage_Player_Rejoined : public GameMessageWithPlayer
+{
+public:
+    /// First GF (always a NWF) at which the player sends his own commands again
+    uint32_t gf;
+
+    GameMessage_Player_Rejoined() : GameMessageWithPlayer(NMS_PLAYER_REJOINED) {} //-V730
+    GameMessage_Player_Rejoined(uint8_t player, uint32_t gf)
+        : GameMessageWithPlayer(NMS_PLAYER_REJOINED, player), gf(gf)
+    {}
+
+    void Serialize(Serializer& ser) const override
+    {
+        GameMessageWithPlayer::Serialize(ser);
+        ser.PushUnsignedInt(gf);
+    }
+
+    void Deserialize(Serializer& ser) override
+    {
+        GameMessageWithPlayer::Deserialize(ser);
+        gf = ser.PopUnsignedInt();
+    }
+
+    bool Run(GameMessageInterface* callback) const override
+    {
+        LOG.writeToFile("<<< NMS_PLAYER_REJOINED(%d, %d)\n") % unsigned(player) % gf;
+        return callback->OnGameMessage(*this);
+    }
+};
+
 class GameMessage_Map_Info : public GameMessage
 {
 public:
@@ -792,17 +824,22 @@ public:
 class GameMessage_Map_Data : public GameMessage
 {
 public:
+    /// True for map data, false for luaData
     bool isMapData;
     /// Offset into map buffer
     uint32_t offset;
-    /// Kartendaten
+    /// Kartendaten (received data only)
     std::vector<char> data;
-    /// True for map data, false for luaData
 
     GameMessage_Map_Data() : GameMessage(NMS_MAP_DATA) {} //-V730
-    GameMessage_Map_Data(bool isMapData, const uint32_t offset, const char* const data, unsigned length)
-        : GameMessage(NMS_MAP_DATA), isMapData(isMapData), offset(offset), data(data, data + length)
-    {
+    /// Send length bytes starting at offset from the buffer. The buffer is shared (not copied) so it can be used for
+    /// all chunks and players
+    GameMessage_Map_Data(bool isMapData, const uint32_t offset, std::shared_ptr<const std::vector<char>> buffer,
+                         unsigned length)
+        : GameMessage(NMS_MAP_DATA), isMapData(isMapData), offset(offset), srcBuffer_(std::move(buffer)),
+          srcLength_(length)
+    {
+        RTTR_Assert(offset + length <= srcBuffer_->size());
         LOG.writeToFile(">>> NMS_MAP_DATA\n");
     }
 
@@ -811,8 +848,15 @@ public:
         GameMessage::Serialize(ser);
         ser.PushBool(isMapData);
         ser.PushUnsignedInt(offset);
-        ser.PushUnsignedInt(data.size());
-        ser.PushRawData(&data.front(), data.size());
+        if(srcBuffer_)
+        {
+            ser.PushUnsignedInt(srcLength_);
+            ser.PushRawData(srcBuffer_->data() + offset, srcLength_);
+        } else
+        {
+            ser.PushUnsignedInt(data.size());
+            ser.PushRawData(data.data(), data.size());
+        }
     }
 
     void Deserialize(Serializer& ser) override
@@ -821,7 +865,7 @@ public:
         isMapData = ser.PopBool();
         offset = ser.PopUnsignedInt();
         data.resize(ser.PopUnsignedInt());
-        ser.PopRawData(&data.front(), data.size());
+        ser.PopRawData(data.data(), data.size());
     }
 
     bool Run(GameMessageInterface* callback) const override
@@ -829,6 +873,37 @@ public:
         LOG.writeToFile("<<< NMS_MAP_DATA\n");
         return callback->OnGameMessage(*this);
     }
+
+private:
+    std::shared_ptr<const std::vector<char>> srcBuffer_;
+    unsigned srcLength_ = 0;
+};
+
+/// Acknowledges received map data so the server can send more
+class GameMessage_Map_DataAck : public GameMessage
+{
+public:
+    /// Total number of bytes received (map and lua data)
+    uint32_t numBytesReceived;
+
+    GameMessage_Map_DataAck() : GameMessage(NMS_MAP_DATA_ACK) {} //-V730
+    GameMessage_Map_DataAck(uint32_t numBytesReceived)
+        : GameMessage(NMS_MAP_DATA_ACK), numBytesReceived(numBytesReceived)
+    {}
+
+    void Serialize(Serializer& ser) const override
+    {
+        GameMessage::Serialize(ser);
+        ser.PushUnsignedInt(numBytesReceived);
+    }
+
+    void Deserialize(Serializer& ser) override
+    {
+        GameMessage::Deserialize(ser);
+        numBytesReceived = ser.PopUnsignedInt();
+    }
+
+    bool Run(GameMessageInterface* callback) const override { return callback->OnGameMessage(*this); }
 };
 
 class GameMessage_Map_Checksum : public GameMessage
@@ -1113,3 +1188,232 @@ public:
         return callback->OnGameMessage(*this);
     }
 };
+
+/// Start of a spectator stream: The first headerSize bytes of the data are the replay header
+class GameMessage_Spectator_Start : public GameMessage
+{
+public:
+    uint32_t headerSize;
+    /// First GF of the stream (game start or GF of the snapshot)
+    uint32_t startGF;
+
+    GameMessage_Spectator_Start() : GameMessage(NMS_SPECTATOR_START) {} //-V730
+    GameMessage_Spectator_Start(uint32_t headerSize, uint32_t startGF)
+        : GameMessage(NMS_SPECTATOR_START), headerSize(headerSize), startGF(startGF)
+    {}
+
+    void Serialize(Serializer& ser) const override
+    {
+        GameMessage::Serialize(ser);
+        ser.PushUnsignedInt(headerSize);
+        ser.PushUnsignedInt(startGF);
+    }
+
+    void Deserialize(Serializer& ser) override
+    {
+        GameMessage::Deserialize(ser);
+        headerSize = ser.PopUnsignedInt();
+        startGF = ser.PopUnsignedInt();
+    }
+
+    bool Run(GameMessageInterface* callback) const override
+    {
+        LOG.writeToFile("<<< NMS_SPECTATOR_START(%d, %d)\n") % headerSize % startGF;
+        return callback->OnGameMessage(*this);
+    }
+};
+
+/// Part of a spectator stream in the replay file format. Always ends at the end of a replay command
+class GameMessage_Spectator_Data : public GameMessage
+{
+public:
+    /// All commands for GFs before this one are contained in the data received so far
+    uint32_t endGF;
+    std::vector<char> data;
+
+    GameMessage_Spectator_Data() : GameMessage(NMS_SPECTATOR_DATA) {} //-V730
+    GameMessage_Spectator_Data(uint32_t endGF, std::vector<char> data)
+        : GameMessage(NMS_SPECTATOR_DATA), endGF(endGF), data(std::move(data))
+    {}
+
+    void Serialize(Serializer& ser) const override
+    {
+        GameMessage::Serialize(ser);
+        ser.PushUnsignedInt(endGF);
+        ser.PushUnsignedInt(data.size());
+        ser.PushRawData(data.data(), data.size());
+    }
+
+    void Deserialize(Serializer& ser) override
+    {
+        GameMessage::Deserialize(ser);
+        endGF = ser.PopUnsignedInt();
+        data.resize(ser.PopUnsignedInt());
+        ser.PopRawData(data.data(), data.size());
+    }
+
+    bool Run(GameMessageInterface* callback) const override { return callback->OnGameMessage(*this); }
+};
+
+/// Request a snapshot (savegame) of the game state right before executing the given NWF from a client
+class GameMessage_Rejoin_RequestSnapshot : public GameMessage
+{
+public:
+    uint32_t gf;
+
+    GameMessage_Rejoin_RequestSnapshot() : GameMessage(NMS_REJOIN_REQUEST_SNAPSHOT) {} //-V730
+    GameMessage_Rejoin_RequestSnapshot(uint32_t gf) : GameMessage(NMS_REJOIN_REQUEST_SNAPSHOT), gf(gf) {}
+
+    void Serialize(Serializer& ser) const override
+    {
+        GameMessage::Serialize(ser);
+        ser.PushUnsignedInt(gf);
+    }
+
+    void Deserialize(Serializer& ser) override
+    {
+        GameMessage::Deserialize(ser);
+        gf = ser.PopUnsignedInt();
+    }
+
+    bool Run(GameMessageInterface* callback) const override
+    {
+        LOG.writeToFile("<<< NMS_REJOIN_REQUEST_SNAPSHOT(%d)\n") % gf;
+        return callback->OnGameMessage(*this);
+    }
+};
+
+/// Part of the compressed snapshot sent from the providing client to the server
+class GameMessage_Rejoin_Snapshot : public GameMessage
+{
+public:
+    /// GF the snapshot was made at
+    uint32_t gf;
+    /// Uncompressed and compressed length of the whole snapshot
+    uint32_t length, compressedLength;
+    /// Offset of this part in the compressed data
+    uint32_t offset;
+    std::vector<char> data;
+    /// State of the random number generator which is not part of savegames (first part only)
+    std::vector<char> randomState;
+
+    GameMessage_Rejoin_Snapshot() : GameMessage(NMS_REJOIN_SNAPSHOT) {} //-V730
+    GameMessage_Rejoin_Snapshot(uint32_t gf, uint32_t length, uint32_t compressedLength, uint32_t offset,
+                                std::vector<char> data, std::vector<char> randomState = {})
+        : GameMessage(NMS_REJOIN_SNAPSHOT), gf(gf), length(length), compressedLength(compressedLength), offset(offset),
+          data(std::move(data)), randomState(std::move(randomState))
+    {}
+
+    void Serialize(Serializer& ser) const override
+    {
+        GameMessage::Serialize(ser);
+        ser.PushUnsignedInt(gf);
+        ser.PushUnsignedInt(length);
+        ser.PushUnsignedInt(compressedLength);
+        ser.PushUnsignedInt(offset);
+        ser.PushUnsignedInt(data.size());
+        ser.PushRawData(data.data(), data.size());
+        ser.PushUnsignedInt(randomState.size());
+        ser.PushRawData(randomState.data(), randomState.size());
+    }
+
+    void Deserialize(Serializer& ser) override
+    {
+        GameMessage::Deserialize(ser);
+        gf = ser.PopUnsignedInt();
+        length = ser.PopUnsignedInt();
+        compressedLength = ser.PopUnsignedInt();
+        offset = ser.PopUnsignedInt();
+        data.resize(ser.PopUnsignedInt());
+        ser.PopRawData(data.data(), data.size());
+        randomState.resize(ser.PopUnsignedInt());
+        ser.PopRawData(randomState.data(), randomState.size());
+    }
+
+    bool Run(GameMessageInterface* callback) const override { return callback->OnGameMessage(*this); }
+};
+
+/// Sent to a rejoining client: The snapshot follows as map data, then all commands since the snapshot
+class GameMessage_Rejoin_Start : public GameMessageWithPlayer
+{
+public:
+    /// GF the snapshot was made at. Always a NWF
+    uint32_t snapshotGF;
+    uint32_t cmdDelay;
+    /// Uncompressed and compressed length of the snapshot
+    uint32_t length, compressedLength;
+    /// State of the random number generator at the snapshot GF
+    std::vector<char> randomState;
+
+    GameMessage_Rejoin_Start() : GameMessageWithPlayer(NMS_REJOIN_START) {} //-V730
+    GameMessage_Rejoin_Start(uint8_t player, uint32_t snapshotGF, uint32_t cmdDelay, uint32_t length,
+                             uint32_t compressedLength, std::vector<char> randomState)
+        : GameMessageWithPlayer(NMS_REJOIN_START, player), snapshotGF(snapshotGF), cmdDelay(cmdDelay), length(length),
+          compressedLength(compressedLength), randomState(std::move(randomState))
+    {}
+
+    void Serialize(Serializer& ser) const override
+    {
+        GameMessageWithPlayer::Serialize(ser);
+        ser.PushUnsignedInt(snapshotGF);
+        ser.PushUnsignedInt(cmdDelay);
+        ser.PushUnsignedInt(length);
+        ser.PushUnsignedInt(compressedLength);
+        ser.PushUnsignedInt(randomState.size());
+        ser.PushRawData(randomState.data(), randomState.size());
+    }
+
+    void Deserialize(Serializer& ser) override
+    {
+        GameMessageWithPlayer::Deserialize(ser);
+        snapshotGF = ser.PopUnsignedInt();
+        cmdDelay = ser.PopUnsignedInt();
+        length = ser.PopUnsignedInt();
+        compressedLength = ser.PopUnsignedInt();
+        randomState.resize(ser.PopUnsignedInt());
+        ser.PopRawData(randomState.data(), randomState.size());
+    }
+
+    bool Run(GameMessageInterface* callback) const override
+    {
+        LOG.writeToFile("<<< NMS_REJOIN_START(%d, %d)\n") % unsigned(player) % snapshotGF;
+        return callback->OnGameMessage(*this);
+    }
+};
+
+/// The rejoining client caught up with the game and is ready to take over its slot
+class GameMessage_Rejoin_Ready : public GameMessage
+{
+public:
+    GameMessage_Rejoin_Ready() : GameMessage(NMS_REJOIN_READY) {}
+    bool Run(GameMessageInterface* callback) const override { return callback->OnGameMessage(*this); }
+};
+
+/// Secret token of a player for rejoining the game after a disconnect.
+/// Sent by the server to each player at game start and by a rejoining client to get its slot back
+class GameMessage_Rejoin_Token : public GameMessage
+{
+public:
+    std::string token;
+
+    GameMessage_Rejoin_Token() : GameMessage(NMS_REJOIN_TOKEN) {}
+    GameMessage_Rejoin_Token(std::string token) : GameMessage(NMS_REJOIN_TOKEN), token(std::move(token)) {}
+
+    void Serialize(Serializer& ser) const override
+    {
+        GameMessage::Serialize(ser);
+        ser.PushString(token);
+    }
+
+    void Deserialize(Serializer& ser) override
+    {
+        GameMessage::Deserialize(ser);
+        token = ser.PopString();
+    }
+
+    bool Run(GameMessageInterface* callback) const override
+    {
+        LOG.writeToFile("<<< NMS_REJOIN_TOKEN(%s)\n") % "********";
+        return callback->OnGameMessage(*this);
+    }
+};
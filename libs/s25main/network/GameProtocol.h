@@ -23,8 +23,9 @@
 // Netzwerk Messages                       // client> | <server
 enum
 {
-    NMS_PING = 0x0001, // 0
-    NMS_PONG = 0x0002, // 0
+    NMS_PING = 0x0001,  // 0
+    NMS_PONG = 0x0002,  // 0
+    NMS_BATCH = 0x0003, // 4 count, count * (2 id, x message)
 
     NMS_SERVER_TYPE = 0x0101, // 1 servertyp, x server-version
     NMS_SERVER_TYPEOK,        // 1 servertyp, x server-version
@@ -49,6 +50,7 @@ enum
     NMS_PLAYER_READY,       // 1 status | 1 playerId, 1 status
     NMS_PLAYER_SWAP,        // 1 playerId1, 1 playerId2
     NMS_PLAYER_SWAP_CONFIRM,
+    NMS_PLAYER_REJOINED,    // 1 playerId, 4 GF of the take over
 
     NMS_MAP_NAME = 0x0301, // x mapname
     NMS_MAP_INFO,          // 0 | 4 parts, 4 ziplength, 4 length
@@ -56,6 +58,7 @@ enum
     NMS_MAP_DATA,       // 0 | x mappartdata
     NMS_MAP_CHECKSUM,   // 4 checksum
     NMS_MAP_CHECKSUMOK, // 1 checksumok
+    NMS_MAP_DATA_ACK,   // 4 number of bytes received
 
     NMS_SERVER_NWF_DONE = 0x0401, // 0
     NMS_GAMECOMMANDS,
@@ -67,7 +70,16 @@ enum
     NMS_REMOVE_LUA,
 
     NMS_GET_ASYNC_LOG = 0x0600,
-    NMS_ASYNC_LOG
+    NMS_ASYNC_LOG,
+
+    NMS_SPECTATOR_START = 0x0701, // 4 header size, 4 start GF
+    NMS_SPECTATOR_DATA,           // 4 end GF, x replay data
+
+    NMS_REJOIN_REQUEST_SNAPSHOT = 0x0801, // 4 GF
+    NMS_REJOIN_SNAPSHOT,                  // 4 GF, 4 length, 4 compressed length, 4 offset, x data, x rng state
+    NMS_REJOIN_START,                     // 1 playerId, 4 GF, 4 cmd delay, 4 length, 4 compressed length, x rng state
+    NMS_REJOIN_READY,                     // 0
+    NMS_REJOIN_TOKEN                      // x token
 };
 
 /* Hinweise:
@@ -166,5 +178,20 @@ const unsigned PING_TIMEOUT = 5 * 60;
 const unsigned LOAD_TIMEOUT = 10 * 60;
 
 /// Größe eines Map-Paketes
-/// ACHTUNG: IPV4 garantiert nur maximal 576!!
-const unsigned MAP_PART_SIZE = 512;
+const unsigned MAP_PART_SIZE = 8 * 1024;
+/// Maximum number of map bytes sent but not yet acknowledged by the client
+const unsigned MAP_TRANSFER_WINDOW = 8 * MAP_PART_SIZE;
+
+/// Maximum size of the replay data sent to a spectator in one message
+const unsigned SPECTATOR_PART_SIZE = 8 * 1024;
+/// Maximum number of messages queued for a spectator. A slow spectator falls behind instead of using up memory
+const unsigned SPECTATOR_MAX_QUEUED_MSGS = 8;
+/// Minimum age (in GFs) of the last snapshot before a joining spectator requests a new one from the host
+const unsigned SPECTATOR_SNAPSHOT_INTERVAL = 5000;
+/// A spectator lagging more GFs behind the stream fast forwards to catch up
+const unsigned SPECTATOR_CATCHUP_GFS = 100;
+
+/// Maximum size of the snapshot data sent in one message from the client providing it for a rejoining player
+const unsigned REJOIN_SNAPSHOT_PART_SIZE = MAP_PART_SIZE;
+/// Maximum (uncompressed and compressed) size of a snapshot for a rejoining player. Larger ones are rejected
+const unsigned REJOIN_MAX_SNAPSHOT_SIZE = 128 * 1024 * 1024;
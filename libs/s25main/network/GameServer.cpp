@@ -25,6 +25,7 @@
 #include "RTTR_Version.h"
 #include "RttrConfig.h"
 #include "Savegame.h"
+#include "SerializedGameMessage.h"
 #include "Settings.h"
 #include "commonDefines.h"
 #include "files.h"
@@ -32,6 +33,7 @@
 #include "helpers/containerUtils.h"
 #include "network/CreateServerInfo.h"
 #include "network/GameMessages.h"
+#include "network/PlayerRejoin.h"
 #include "ogl/glArchivItem_Map.h"
 #include "gameTypes/LanGameInfo.h"
 #include "gameTypes/TeamTypes.h"
@@ -51,9 +53,15 @@
 #include <iomanip>
 #include <iterator>
 #include <mygettext/mygettext.h>
+#include <random>
+#include <sstream>
+#include <thread>
 
 inline std::ostream& operator<<(std::ostream& os, const AsyncChecksum& checksum)
 {
+    // Details are sent by the clients with their async logs
+    if(checksum.isHashOnly())
+        return os << "Hash = " << checksum.getHash();
     return os << "RandCS = " << checksum.randChecksum << ",\tobjects/ID = " << checksum.objCt << "/" << checksum.objIdCt
               << ",\tevents/ID = " << checksum.eventCt << "/" << checksum.evInstanceCt;
 }
@@ -80,6 +88,8 @@ void GameServer::ServerConfig::Clear()
     password.clear();
     port = 0;
     ipv6 = false;
+    spectatorPort = 0;
+    spectatorDelay = 0;
 }
 
 GameServer::CountDown::CountDown() : isActive(false), remainingSecs(0) {}
@@ -140,6 +150,8 @@ bool GameServer::Start(const CreateServerInfo& csi, const boost::filesystem::pat
     config.servertype = csi.type;
     config.port = csi.port;
     config.ipv6 = csi.ipv6;
+    config.spectatorPort = csi.spectatorPort;
+    config.spectatorDelay = csi.spectatorDelay;
     mapinfo.type = map_type;
     mapinfo.filepath = map_path;
 
@@ -208,8 +220,10 @@ bool GameServer::Start(const CreateServerInfo& csi, const boost::filesystem::pat
         if(!mapinfo.luaData.CompressFromFile(luaFilePath, &mapinfo.luaChecksum))
             return false;
         mapinfo.luaFilepath = luaFilePath;
+        sharedLuaData = std::make_shared<const std::vector<char>>(mapinfo.luaData.data);
     } else
         RTTR_Assert(mapinfo.luaFilepath.empty() && mapinfo.luaChecksum == 0);
+    sharedMapData = std::make_shared<const std::vector<char>>(mapinfo.mapData.data);
 
     // ab in die Konfiguration
     state = SS_CONFIG;
@@ -321,9 +335,61 @@ void GameServer::Run()
     }
     helpers::remove_if(networkPlayers, [](const auto& player) { return !player.socket.isValid(); });
 
+    spectatorRelay.Run(currentGF);
     lanAnnouncer.Run();
 }
 
+GameServer::SteadyClock::duration GameServer::GetTimeToNextEvent() const
+{
+    // Upper bound for regular tasks not tracked here (pings, countdown, lag checks, LAN discovery)
+    constexpr SteadyClock::duration maxWaitTime = std::chrono::milliseconds(100);
+    if(state == SS_STOPPED)
+        return maxWaitTime;
+    // Messages only get sent in Run
+    for(const GameServerPlayer& player : networkPlayers)
+    {
+        if(!player.sendQueue.empty())
+            return SteadyClock::duration::zero();
+    }
+    if(state != SS_GAME || framesinfo.isPaused)
+        return maxWaitTime;
+    if(skiptogf > currentGF)
+        return SteadyClock::duration::zero();
+    const FramesInfo::UsedClock::time_point nextGFTime = framesinfo.lastTime + framesinfo.gf_length;
+    const FramesInfo::UsedClock::time_point now = FramesInfo::UsedClock::now();
+    if(nextGFTime <= now)
+        return SteadyClock::duration::zero();
+    return std::min<SteadyClock::duration>(nextGFTime - now, maxWaitTime);
+}
+
+void GameServer::WaitForEvents(SteadyClock::duration timeout)
+{
+    // Round up so we don't wake up just before the timeout and wait again with a timeout of zero
+    auto timeoutMs = std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
+    if(timeoutMs < timeout)
+        ++timeoutMs;
+    if(timeoutMs.count() <= 0)
+        return;
+
+    SocketSet set;
+    bool hasSockets = false;
+    if(state == SS_CONFIG || (state == SS_GAME && !droppedPlayers.empty()))
+    {
+        set.Add(serversocket);
+        hasSockets = true;
+    }
+    for(const GameServerPlayer& player : networkPlayers)
+    {
+        set.Add(player.socket);
+        hasSockets = true;
+    }
+    // Select without sockets is an error on some systems
+    if(hasSockets)
+        set.Select(static_cast<int>(timeoutMs.count()), 0);
+    else
+        std::this_thread::sleep_for(timeoutMs);
+}
+
 void GameServer::RunStateConfig()
 {
     WaitForClients();
@@ -394,6 +460,9 @@ void GameServer::RunStateLoading()
 
 void GameServer::RunStateGame()
 {
+    // Dropped players may reconnect
+    if(!droppedPlayers.empty())
+        WaitForClients();
     if(!framesinfo.isPaused)
         ExecuteGameFrame();
 }
@@ -408,11 +477,17 @@ void GameServer::Stop()
     // player verabschieden
     playerInfos.clear();
     networkPlayers.clear();
+    spectatorRelay.Stop();
+    rejoin.reset();
+    droppedPlayers.clear();
+    rejoinTokens.clear();
 
     // aufräumen
     framesinfo.Clear();
     config.Clear();
     mapinfo.Clear();
+    sharedMapData.reset();
+    sharedLuaData.reset();
     countdown.Stop();
 
     // laden dicht machen
@@ -434,6 +509,17 @@ void GameServer::Stop()
     LOG.write("server state changed to stop\n");
 }
 
+/// Create a secret token that cannot be guessed by other players
+static std::string createRejoinToken()
+{
+    std::random_device rd;
+    std::ostringstream token;
+    token << std::hex << std::setfill('0');
+    for(unsigned i = 0; i < 4; i++)
+        token << std::setw(8) << static_cast<uint32_t>(rd());
+    return token.str();
+}
+
 // Check if there are players that have not been assigned a team but only a
 // range. Those players are assigned a team now while we try to balanace the
 // number of players per team. Returns true iff players have been assigned.
@@ -547,31 +633,32 @@ bool GameServer::StartGame()
     else
         random_init = static_cast<unsigned>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
 
-    nwfInfo.init(currentGF, 3);
+    const unsigned highestPing = GetHighestPing();
+    framesinfo.gfLengthReq = framesinfo.gf_length = FramesInfo::milliseconds32_t(SPEED_GF_LENGTHS[ggs_.speed]);
+
+    const unsigned cmdDelay = CalcCmdDelay(highestPing, framesinfo.gf_length);
+    nwfInfo.init(currentGF, cmdDelay);
 
     // Send start first, then load the rest
     SendToAll(GameMessage_Server_Start(random_init, nwfInfo.getNextNWF(), nwfInfo.getCmdDelay()));
     LOG.writeToFile("SERVER >>> BROADCAST: NMS_SERVER_START(%d)\n") % random_init;
 
-    // Höchsten Ping ermitteln
-    unsigned highest_ping = 0;
-    for(const JoinPlayerInfo& player : playerInfos)
+    // Only the owner of a slot can rejoin it after a disconnect
+    rejoinTokens.assign(playerInfos.size(), std::string());
+    for(GameServerPlayer& player : networkPlayers)
     {
-        if(player.ps == PS_OCCUPIED)
-        {
-            if(player.ping > highest_ping)
-                highest_ping = player.ping;
-        }
+        if(playerInfos[player.playerId].ps != PS_OCCUPIED)
+            continue;
+        rejoinTokens[player.playerId] = createRejoinToken();
+        player.sendMsgAsync(new GameMessage_Rejoin_Token(rejoinTokens[player.playerId]));
     }
 
-    framesinfo.gfLengthReq = framesinfo.gf_length = FramesInfo::milliseconds32_t(SPEED_GF_LENGTHS[ggs_.speed]);
-
     // NetworkFrame-Länge bestimmen, je schlechter (also höher) die Pings, desto länger auch die Framelänge
-    framesinfo.nwf_length = CalcNWFLenght(FramesInfo::milliseconds32_t(highest_ping));
+    framesinfo.nwf_length = CalcNWFLenght(FramesInfo::milliseconds32_t(highestPing), framesinfo.gf_length);
 
     LOG.write("SERVER: Using gameframe length of %d\n") % framesinfo.gf_length;
-    LOG.write("SERVER: Using networkframe length of %u GFs (%u)\n") % framesinfo.nwf_length
-      % (framesinfo.nwf_length * framesinfo.gf_length);
+    LOG.write("SERVER: Using networkframe length of %u GFs (%u) and command delay of %u\n") % framesinfo.nwf_length
+      % (framesinfo.nwf_length * framesinfo.gf_length) % cmdDelay;
 
     for(unsigned id = 0; id < playerInfos.size(); id++)
     {
@@ -584,26 +671,114 @@ bool GameServer::StartGame()
     nwfInfo.addServerInfo(NWFServerInfo(currentGF, framesinfo.gf_length / FramesInfo::milliseconds32_t(1),
                                         currentGF + framesinfo.nwf_length));
 
+    if(config.spectatorPort)
+        StartSpectatorRelay(random_init);
+
     state = SS_LOADING;
     loadStartTime = SteadyClock::now();
 
     return true;
 }
 
-unsigned GameServer::CalcNWFLenght(FramesInfo::milliseconds32_t minDuration) const
+void GameServer::StartSpectatorRelay(unsigned random_init)
+{
+    // Spectators should be delayed by the same time independent of the speed
+    const unsigned delayGFs =
+      std::chrono::duration_cast<FramesInfo::milliseconds32_t>(std::chrono::seconds(config.spectatorDelay))
+      / framesinfo.gf_length;
+    if(!spectatorRelay.Start(config.spectatorPort, config.ipv6, delayGFs))
+        return;
+
+    Replay& replay = spectatorRelay.GetReplay();
+    replay.random_init = random_init;
+    for(const JoinPlayerInfo& player : playerInfos)
+        replay.AddPlayer(player);
+    replay.ggs = ggs_;
+
+    // The replay contains the full savegame
+    if(mapinfo.type == MAPTYPE_SAVEGAME)
+    {
+        mapinfo.savegame = std::make_unique<Savegame>();
+        if(!mapinfo.savegame->Load(mapinfo.filepath, SaveGameDataToLoad::All))
+        {
+            LOG.write(_("SERVER: Could not load savegame for spectators: %1%\n"))
+              % mapinfo.savegame->GetLastErrorMsg();
+            mapinfo.savegame.reset();
+            spectatorRelay.Stop();
+            return;
+        }
+    }
+    const bfs::path replaysDir = RTTRCONFIG.ExpandPath(s25::folders::replays);
+    boost::system::error_code ec;
+    bfs::create_directories(replaysDir, ec);
+    const bfs::path filepath = replaysDir / (s25util::Time::FormatTime("%Y-%m-%d_%H-%i-%s") + "_relay.rpl");
+    if(!spectatorRelay.StartStream(filepath, mapinfo, currentGF))
+        spectatorRelay.Stop();
+    else
+    {
+        LOG.write(_("SERVER: Spectators can connect on port %1% with a delay of %2% GFs\n")) % config.spectatorPort
+          % delayGFs;
+    }
+    mapinfo.savegame.reset();
+}
+
+bool GameServer::IsSpectatorSnapshotDue(unsigned gf) const
+{
+    return spectatorRelay.IsSnapshotDue(gf);
+}
+
+void GameServer::AddSpectatorSnapshot(std::unique_ptr<Savegame> savegame)
+{
+    spectatorRelay.AddSnapshot(std::move(savegame));
+}
+
+unsigned GameServer::CalcNWFLenght(FramesInfo::milliseconds32_t minDuration, FramesInfo::milliseconds32_t gfLength)
 {
     constexpr unsigned maxNumGF = 20;
     for(unsigned i = 1; i < maxNumGF; ++i)
     {
-        if(i * framesinfo.gf_length >= minDuration)
+        if(i * gfLength >= minDuration)
             return i;
     }
     return maxNumGF;
 }
 
+unsigned GameServer::CalcAdaptiveNWFLength(const NWFServerInfo& lastInfo, FramesInfo::milliseconds32_t newGFLength,
+                                           unsigned highestPing)
+{
+    const FramesInfo::milliseconds32_t lastDuration =
+      (lastInfo.nextNWF - lastInfo.gf) * FramesInfo::milliseconds32_t(lastInfo.newGFLen);
+    FramesInfo::milliseconds32_t minDuration(highestPing);
+    // Increase immediately to avoid stalls but decrease only by 1 GF per NWF so a single good ping doesn't cause
+    // oscillation
+    if(minDuration < lastDuration)
+        minDuration = std::max(minDuration, lastDuration - newGFLength);
+    return CalcNWFLenght(minDuration, newGFLength);
+}
+
+unsigned GameServer::CalcCmdDelay(unsigned highestPing, FramesInfo::milliseconds32_t gfLength)
+{
+    // Commands are sent cmdDelay NWFs in advance. If all players have a ping below 1 GF (e.g. LAN) the default
+    // latency reserve is not required so reduce it to lower the input lag
+    return (FramesInfo::milliseconds32_t(highestPing) < gfLength) ? 2 : 3;
+}
+
+unsigned GameServer::GetHighestPing() const
+{
+    unsigned highestPing = 0;
+    for(const JoinPlayerInfo& player : playerInfos)
+    {
+        if(player.ps == PS_OCCUPIED)
+            highestPing = std::max(highestPing, player.ping);
+    }
+    return highestPing;
+}
+
 void GameServer::SendNWFDone(const NWFServerInfo& info)
 {
     nwfInfo.addServerInfo(info);
+    if(rejoin)
+        rejoin->addServerInfo(info);
     SendToAll(GameMessage_Server_NWFDone(info.gf, info.newGFLen, info.nextNWF));
 }
 
@@ -612,11 +787,17 @@ void GameServer::SendNWFDone(const NWFServerInfo& info)
  */
 void GameServer::SendToAll(const GameMessage& msg)
 {
+    // Serialize only once and share the data with all players
+    std::unique_ptr<SerializedGameMessage> serMsg;
     for(GameServerPlayer& player : networkPlayers)
     {
         // ist der Slot Belegt, dann Nachricht senden
         if(player.isActive())
-            player.sendMsgAsync(msg.clone());
+        {
+            if(!serMsg)
+                serMsg = std::make_unique<SerializedGameMessage>(msg);
+            player.sendMsgAsync(new SerializedGameMessage(msg.getId(), serMsg->getData()));
+        }
     }
 }
 
@@ -627,19 +808,40 @@ void GameServer::KickPlayer(uint8_t playerId, KickReason cause, uint32_t param)
     JoinPlayerInfo& playerInfo = playerInfos[playerId];
     GameServerPlayer* player = GetNetworkPlayer(playerId);
     if(player)
+    {
         player->closeConnection();
+        // A rejoining player does not own the slot yet. It stays with the AI
+        if(state == SS_GAME && (!player->isActive() || (rejoin && rejoin->getPlayerId() == playerId)))
+        {
+            if(rejoin && rejoin->getPlayerId() == playerId)
+            {
+                LOG.write(_("SERVER: Rejoin of player %1% failed\n")) % unsigned(playerId);
+                rejoin.reset();
+            }
+            return;
+        }
+    }
     // Non-existing or connecting player
     if(!playerInfo.isUsed())
         return;
     playerInfo.ps = PS_FREE;
 
     SendToAll(GameMessage_Player_Kicked(playerId, cause, param));
+    if(rejoin)
+        rejoin->addMsg(std::make_unique<GameMessage_Player_Kicked>(playerId, cause, param));
 
     // If we are ingame, replace by KI
     if(state == SS_GAME || state == SS_LOADING)
     {
         playerInfo.ps = PS_AI;
         playerInfo.aiInfo = AI::Info(AI::DUMMY);
+        // Players who lost the connection can rejoin
+        if(state == SS_GAME && player && (cause == NP_CONNECTIONLOST || cause == NP_PINGTIMEOUT)
+           && !helpers::contains(droppedPlayers, playerId))
+            droppedPlayers.push_back(playerId);
+        // Snapshot for a rejoin will never arrive
+        if(rejoin && rejoin->getProviderId() == playerId && !rejoin->hasSnapshot())
+            AbortRejoin();
     } else
         CancelCountdown();
 
@@ -648,6 +850,45 @@ void GameServer::KickPlayer(uint8_t playerId, KickReason cause, uint32_t param)
       % unsigned(param);
 }
 
+bool GameServer::IsRejoiningPlayer(unsigned playerId)
+{
+    if(state != SS_GAME)
+        return false;
+    const GameServerPlayer* player = GetNetworkPlayer(playerId);
+    return player && !player->isActive();
+}
+
+bool GameServer::StartRejoin(unsigned playerId)
+{
+    if(rejoin || !helpers::contains(droppedPlayers, playerId))
+        return false;
+    // Any client can provide the snapshot. Prefer the host as its connection is the fastest
+    GameServerPlayer* provider = nullptr;
+    for(GameServerPlayer& player : networkPlayers)
+    {
+        if(player.isActive() && (!provider || IsHost(player.playerId)))
+            provider = &player;
+    }
+    if(!provider)
+        return false;
+    rejoin = std::make_unique<PlayerRejoin>(playerId, provider->playerId, nwfInfo);
+    provider->sendMsgAsync(new GameMessage_Rejoin_RequestSnapshot(rejoin->getSnapshotGF()));
+    LOG.write(_("SERVER: Player %1% is rejoining. Requested snapshot at GF %2% from player %3%\n")) % playerId
+      % rejoin->getSnapshotGF() % provider->playerId;
+    return true;
+}
+
+void GameServer::AbortRejoin()
+{
+    if(!rejoin)
+        return;
+    LOG.write(_("SERVER: Rejoin of player %1% aborted\n")) % rejoin->getPlayerId();
+    GameServerPlayer* player = GetNetworkPlayer(rejoin->getPlayerId());
+    if(player)
+        player->closeConnection();
+    rejoin.reset();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // testet, ob in der Verbindungswarteschlange Clients auf Verbindung warten
 void GameServer::ClientWatchDog()
@@ -737,12 +978,17 @@ void GameServer::ExecuteNWF()
         // Notify players
         std::vector<unsigned> checksumHashes;
         for(const GameServerPlayer& player : networkPlayers)
-            checksumHashes.push_back(nwfInfo.getPlayerCmds(player.playerId).checksum.getHash());
+        {
+            if(player.isActive())
+                checksumHashes.push_back(nwfInfo.getPlayerCmds(player.playerId).checksum.getHash());
+        }
         SendToAll(GameMessage_Server_Async(checksumHashes));
 
         // Request async logs
         for(GameServerPlayer& player : networkPlayers)
         {
+            if(!player.isActive())
+                continue;
             asyncLogs.push_back(AsyncLog(player.playerId, nwfInfo.getPlayerCmds(player.playerId).checksum));
             player.sendMsgAsync(new GameMessage_GetAsyncLog());
         }
@@ -750,8 +996,19 @@ void GameServer::ExecuteNWF()
     const NWFServerInfo serverInfo = nwfInfo.getServerInfo();
     RTTR_Assert(serverInfo.gf == currentGF);
     RTTR_Assert(serverInfo.nextNWF > currentGF);
+    // Forward the commands executed at this NWF in the same order as the clients execute them.
+    // The checksums are from different GFs than the commands are recorded at, so they are omitted
+    if(spectatorRelay.IsRunning())
+    {
+        for(const NWFPlayerInfo& player : nwfInfo.getPlayerInfos())
+        {
+            const PlayerGameCommands& cmds = nwfInfo.getPlayerCmds(player.id);
+            if(!cmds.gcs.empty())
+                spectatorRelay.AddGameCommand(currentGF, player.id, PlayerGameCommands(AsyncChecksum(), cmds.gcs));
+        }
+    }
     // First save old values
-    unsigned lastNWF = nwfInfo.getLastNWF();
+    const NWFServerInfo lastInfo = nwfInfo.getLastServerInfo();
     FramesInfo::milliseconds32_t oldGFLen = framesinfo.gf_length;
     nwfInfo.execute(framesinfo);
     if(oldGFLen != framesinfo.gf_length)
@@ -759,17 +1016,11 @@ void GameServer::ExecuteNWF()
         LOG.write(_("SERVER: At GF %1%: Speed changed from %2% to %3%. NWF %4%\n")) % currentGF % oldGFLen
           % framesinfo.gf_length % framesinfo.nwf_length;
     }
-    NWFServerInfo newInfo(lastNWF, framesinfo.gfLengthReq / FramesInfo::milliseconds32_t(1),
-                          lastNWF + framesinfo.nwf_length);
-    if(framesinfo.gfLengthReq != framesinfo.gf_length)
-    {
-        // Speed will change, adjust nwf length so the time will stay constant
-        using namespace std::chrono;
-        using MsDouble = duration<double, std::milli>;
-        double newNWFLen =
-          framesinfo.nwf_length * framesinfo.gf_length / duration_cast<MsDouble>(framesinfo.gfLengthReq);
-        newInfo.nextNWF = lastNWF + std::max(1l, std::lround(newNWFLen));
-    }
+    // The NWF length is adapted to the current pings (and speed). As this is sent with the NWFDone for the NWF
+    // cmdDelay NWFs in advance, all clients switch at the same NWF which keeps the game deterministic
+    const unsigned newNWFLen = CalcAdaptiveNWFLength(lastInfo, framesinfo.gfLengthReq, GetHighestPing());
+    NWFServerInfo newInfo(lastInfo.nextNWF, framesinfo.gfLengthReq / FramesInfo::milliseconds32_t(1),
+                          lastInfo.nextNWF + newNWFLen);
     SendNWFDone(newInfo);
 }
 
@@ -798,6 +1049,9 @@ void GameServer::CheckAndKickLaggingPlayers()
 {
     for(const GameServerPlayer& player : networkPlayers)
     {
+        // Players still joining do not send commands
+        if(!player.isActive())
+            continue;
         const unsigned timeOut = player.getLagTimeOut();
         if(timeOut == 0)
             KickPlayer(player.playerId, NP_PINGTIMEOUT, __LINE__);
@@ -814,7 +1068,7 @@ bool GameServer::CheckForLaggingPlayers()
         return false;
     for(GameServerPlayer& player : networkPlayers)
     {
-        if(nwfInfo.getPlayerInfo(player.playerId).isLagging)
+        if(player.isActive() && nwfInfo.getPlayerInfo(player.playerId).isLagging)
             player.setLagging();
     }
     return true;
@@ -840,7 +1094,10 @@ void GameServer::WaitForClients()
         // Geeigneten Platz suchen
         for(unsigned playerId = 0; playerId < playerInfos.size(); ++playerId)
         {
-            if(playerInfos[playerId].ps == PS_FREE && !GetNetworkPlayer(playerId))
+            // Ingame only dropped players can connect (one at a time). The final slot is assigned by the rejoin token
+            const bool isFree = (state == SS_GAME) ? (!rejoin && helpers::contains(droppedPlayers, playerId)) :
+                                                     playerInfos[playerId].ps == PS_FREE;
+            if(isFree && !GetNetworkPlayer(playerId))
             {
                 networkPlayers.push_back(GameServerPlayer(playerId, socket));
                 newPlayerId = playerId;
@@ -913,7 +1170,7 @@ bool GameServer::OnGameMessage(const GameMessage_Pong& msg)
 // servertype
 bool GameServer::OnGameMessage(const GameMessage_Server_Type& msg)
 {
-    if(state != SS_CONFIG)
+    if(state != SS_CONFIG && !IsRejoiningPlayer(msg.senderPlayerID))
     {
         KickPlayer(msg.senderPlayerID, NP_INVALIDMSG, __LINE__);
         return true;
@@ -941,7 +1198,7 @@ bool GameServer::OnGameMessage(const GameMessage_Server_Type& msg)
  */
 bool GameServer::OnGameMessage(const GameMessage_Server_Password& msg)
 {
-    if(state != SS_CONFIG)
+    if(state != SS_CONFIG && !IsRejoiningPlayer(msg.senderPlayerID))
     {
         KickPlayer(msg.senderPlayerID, NP_INVALIDMSG, __LINE__);
         return true;
@@ -951,13 +1208,11 @@ bool GameServer::OnGameMessage(const GameMessage_Server_Password& msg)
     if(!player)
         return true;
 
-    std::string passwordok = (config.password == msg.password ? "true" : "false");
-    if(msg.password == config.hostPassword)
-    {
-        passwordok = "true";
-        playerInfos[msg.senderPlayerID].isHost = true;
-    } else
-        playerInfos[msg.senderPlayerID].isHost = false;
+    const bool isHostPassword = msg.password == config.hostPassword;
+    std::string passwordok = (config.password == msg.password || isHostPassword ? "true" : "false");
+    // A player rejoining a running game keeps the host status of the slot
+    if(state == SS_CONFIG)
+        playerInfos[msg.senderPlayerID].isHost = isHostPassword;
 
     player->sendMsgAsync(new GameMessage_Server_Password(passwordok));
 
@@ -973,7 +1228,12 @@ bool GameServer::OnGameMessage(const GameMessage_Chat& msg)
 {
     int playerID = GetTargetPlayer(msg);
     if(playerID >= 0)
+    {
         SendToAll(GameMessage_Chat(playerID, msg.destination, msg.text));
+        // Spectators see only public messages
+        if(state == SS_GAME && msg.destination == CD_ALL)
+            spectatorRelay.AddChatCommand(currentGF, playerID, msg.destination, msg.text);
+    }
     return true;
 }
 
@@ -1044,6 +1304,9 @@ bool GameServer::OnGameMessage(const GameMessage_Player_State& msg)
 // Spielername
 bool GameServer::OnGameMessage(const GameMessage_Player_Name& msg)
 {
+    // The name of a rejoining player is that of its slot. The slot itself is assigned by the rejoin token
+    if(IsRejoiningPlayer(msg.senderPlayerID))
+        return true;
     if(state != SS_CONFIG)
     {
         KickPlayer(msg.senderPlayerID, NP_INVALIDMSG, __LINE__);
@@ -1148,6 +1411,14 @@ bool GameServer::OnGameMessage(const GameMessage_Player_Ready& msg)
 
 bool GameServer::OnGameMessage(const GameMessage_MapRequest& msg)
 {
+    if(IsRejoiningPlayer(msg.senderPlayerID))
+    {
+        // Instead of the map the player gets a snapshot of the game as soon as it is available
+        const GameServerPlayer* player = GetNetworkPlayer(msg.senderPlayerID);
+        if(!msg.requestInfo || !player->isRejoinVerified() || !StartRejoin(msg.senderPlayerID)) //-V522
+            KickPlayer(msg.senderPlayerID, NP_INVALIDMSG, __LINE__);
+        return true;
+    }
     if(state != SS_CONFIG)
     {
         KickPlayer(msg.senderPlayerID, NP_INVALIDMSG, __LINE__);
@@ -1168,38 +1439,67 @@ bool GameServer::OnGameMessage(const GameMessage_MapRequest& msg)
         KickPlayer(msg.senderPlayerID, NP_INVALIDMSG, __LINE__);
     } else
     {
-        // Send map data
-        unsigned curPos = 0;
-        unsigned remainingSize = mapinfo.mapData.data.size();
-        while(remainingSize)
-        {
-            unsigned chunkSize = std::min(MAP_PART_SIZE, remainingSize);
-
-            player->sendMsgAsync(new GameMessage_Map_Data(true, curPos, &mapinfo.mapData.data[curPos], chunkSize));
-            curPos += chunkSize;
-            remainingSize -= chunkSize;
-        }
-
-        // And lua data (if there is any)
         RTTR_Assert(mapinfo.luaFilepath.empty() == mapinfo.luaData.data.empty());
         RTTR_Assert(mapinfo.luaData.data.empty() == (mapinfo.luaData.length == 0));
-        curPos = 0;
-        remainingSize = mapinfo.luaData.data.size();
-        while(remainingSize)
-        {
-            unsigned chunkSize = std::min(MAP_PART_SIZE, remainingSize);
+        // Estimate time assuming a slow connection (~25kb/s). Data is sent as fast as the client acknowledges it
+        const auto numBytes = mapinfo.mapData.data.size() + mapinfo.luaData.data.size();
+        player->setMapSending(std::chrono::seconds(numBytes / (25 * 1024) + 1), sharedMapData, sharedLuaData);
+        SendMapData(*player);
+    }
+    return true;
+}
 
-            player->sendMsgAsync(new GameMessage_Map_Data(false, curPos, &mapinfo.luaData.data[curPos], chunkSize));
-            curPos += chunkSize;
-            remainingSize -= chunkSize;
-        }
-        // estimate time. max 60 chunks/s (currently limited by framerate), assume 50 (~25kb/s)
-        auto numChunks = (mapinfo.mapData.data.size() + mapinfo.luaData.data.size()) / MAP_PART_SIZE;
-        player->setMapSending(std::chrono::seconds(numChunks / 50 + 1));
+bool GameServer::OnGameMessage(const GameMessage_Map_DataAck& msg)
+{
+    GameServerPlayer* player = GetNetworkPlayer(msg.senderPlayerID);
+    // Acks may arrive after the transfer was finished or aborted
+    if((state != SS_CONFIG && state != SS_GAME) || !player || !player->isMapSending())
+        return true;
+    if(msg.numBytesReceived > player->getMapBytesSent())
+    {
+        KickPlayer(msg.senderPlayerID, NP_INVALIDMSG, __LINE__);
+        return true;
+    }
+    player->setMapBytesAcked(std::max(player->getMapBytesAcked(), msg.numBytesReceived));
+    SendMapData(*player);
+    // Snapshot received by the rejoining player: Continue with everything that happened since then
+    if(state == SS_GAME && rejoin && rejoin->getPlayerId() == player->playerId
+       && player->getMapBytesAcked() == rejoin->getSnapshot()->size())
+    {
+        LOG.write(_("SERVER: Snapshot sent to player %1%. Sending %2% messages to catch up\n")) % player->playerId
+          % rejoin->getNumBufferedMsgs();
+        rejoin->sendBufferedMsgs(*player);
+        player->setActive();
     }
     return true;
 }
 
+void GameServer::SendMapData(GameServerPlayer& player)
+{
+    const std::shared_ptr<const std::vector<char>>& mapData = player.getMapData();
+    const std::shared_ptr<const std::vector<char>>& luaData = player.getLuaData();
+    // Map data is sent first followed by the lua data. Positions are counted over both
+    const unsigned mapSize = mapData ? mapData->size() : 0u;
+    const unsigned luaSize = luaData ? luaData->size() : 0u;
+    unsigned curPos = player.getMapBytesSent();
+    while(curPos < mapSize + luaSize && curPos - player.getMapBytesAcked() < MAP_TRANSFER_WINDOW)
+    {
+        unsigned chunkSize;
+        if(curPos < mapSize)
+        {
+            chunkSize = std::min(MAP_PART_SIZE, mapSize - curPos);
+            player.sendMsgAsync(new GameMessage_Map_Data(true, curPos, mapData, chunkSize));
+        } else
+        {
+            const unsigned luaPos = curPos - mapSize;
+            chunkSize = std::min(MAP_PART_SIZE, luaSize - luaPos);
+            player.sendMsgAsync(new GameMessage_Map_Data(false, luaPos, luaData, chunkSize));
+        }
+        curPos += chunkSize;
+    }
+    player.setMapBytesSent(curPos);
+}
+
 bool GameServer::OnGameMessage(const GameMessage_Map_Checksum& msg)
 {
     if(state != SS_CONFIG)
@@ -1211,7 +1511,10 @@ bool GameServer::OnGameMessage(const GameMessage_Map_Checksum& msg)
     if(!player)
         return true;
 
-    bool checksumok = (msg.mapChecksum == mapinfo.mapChecksum && msg.luaChecksum == mapinfo.luaChecksum);
+    // The lua script may have been removed while it was sent to this player. Don't check it as it is removed later
+    const bool luaRemoved = player->isMapSending() && player->getLuaData() && !sharedLuaData;
+    bool checksumok =
+      (msg.mapChecksum == mapinfo.mapChecksum && (luaRemoved || msg.luaChecksum == mapinfo.luaChecksum));
 
     LOG.writeToFile("CLIENT%d >>> SERVER: NMS_MAP_CHECKSUM(%u) expected: %u, ok: %s\n") % unsigned(msg.senderPlayerID)
       % msg.mapChecksum % mapinfo.mapChecksum % (checksumok ? "yes" : "no");
@@ -1243,6 +1546,10 @@ bool GameServer::OnGameMessage(const GameMessage_Map_Checksum& msg)
             playerInfo.ps = PS_OCCUPIED;
             player->setActive();
 
+            // The other players got this already
+            if(luaRemoved)
+                player->sendMsgAsync(new GameMessage_RemoveLua());
+
             // Servername senden
             player->sendMsgAsync(new GameMessage_Server_Name(config.gamename));
 
@@ -1276,16 +1583,20 @@ bool GameServer::OnGameMessage(const GameMessage_GameCommand& msg)
 {
     int targetPlayerId = GetTargetPlayer(msg);
     if((state != SS_GAME && state != SS_LOADING) || targetPlayerId < 0
-       || (state == SS_LOADING && !msg.cmds.gcs.empty()))
+       || (state == SS_LOADING && !msg.cmds.gcs.empty()) || IsRejoiningPlayer(msg.senderPlayerID)
+       || (rejoin && msg.senderPlayerID == rejoin->getPlayerId()))
     {
+        // Note: A rejoining player takes over the slot only after being told so
         KickPlayer(msg.senderPlayerID, NP_INVALIDMSG, __LINE__);
         return true;
     }
 
     if(!nwfInfo.addPlayerCmds(targetPlayerId, msg.cmds))
         return true; // Ignore
+    if(rejoin)
+        rejoin->addPlayerCmds(targetPlayerId, msg.cmds);
     GameServerPlayer* player = GetNetworkPlayer(targetPlayerId);
-    if(player)
+    if(player && player->isActive())
         player->setNotLagging();
     SendToAll(GameMessage_GameCommand(targetPlayerId, msg.cmds.checksum, msg.cmds.gcs));
 
@@ -1364,6 +1675,7 @@ bool GameServer::OnGameMessage(const GameMessage_RemoveLua& msg)
     mapinfo.luaFilepath.clear();
     mapinfo.luaData.Clear();
     mapinfo.luaChecksum = 0;
+    sharedLuaData.reset();
     SendToAll(msg);
     CancelCountdown();
     return true;
@@ -1695,9 +2007,16 @@ void GameServer::SwapPlayer(const uint8_t player1, const uint8_t player2)
         // Ingame we can only switch to a KI
         if(playerInfos[player1].ps != PS_OCCUPIED || playerInfos[player2].ps != PS_AI)
             return;
+        // The slot is taken, so its player cannot rejoin anymore
+        if(rejoin && rejoin->getPlayerId() == player2)
+            AbortRejoin();
+        helpers::remove(droppedPlayers, player2);
 
         LOG.write("GameServer::ChangePlayer %i - %i \n") % unsigned(player1) % unsigned(player2);
         using std::swap;
+        // The token belongs to the player, not the slot
+        if(!rejoinTokens.empty())
+            swap(rejoinTokens[player1], rejoinTokens[player2]);
         swap(playerInfos[player2].ps, playerInfos[player1].ps);
         swap(playerInfos[player2].aiInfo, playerInfos[player1].aiInfo);
         swap(playerInfos[player2].isHost, playerInfos[player1].isHost);
@@ -1710,6 +2029,9 @@ void GameServer::SwapPlayer(const uint8_t player1, const uint8_t player2)
     if(oldPlayer)
         oldPlayer->playerId = player2;
     SendToAll(GameMessage_Player_Swap(player1, player2));
+    // A rejoining player must get it after the snapshot like all other messages
+    if(rejoin)
+        rejoin->addMsg(std::make_unique<GameMessage_Player_Swap>(player1, player2));
     const auto pSwap = std::make_pair(player1, player2);
     for(GameServerPlayer& player : networkPlayers)
     {
@@ -1736,7 +2058,10 @@ void GameServer::SetPaused(bool paused)
     framesinfo.isPaused = paused;
     SendToAll(GameMessage_Pause(framesinfo.isPaused));
     for(GameServerPlayer& player : networkPlayers)
-        player.setNotLagging();
+    {
+        if(player.isActive())
+            player.setNotLagging();
+    }
 }
 
 JoinPlayerInfo& GameServer::GetJoinPlayer(unsigned playerIdx)
@@ -1773,3 +2098,78 @@ int GameServer::GetTargetPlayer(const GameMessageWithPlayer& msg)
         return msg.senderPlayerID;
     return -1;
 }
+
+bool GameServer::OnGameMessage(const GameMessage_Rejoin_Snapshot& msg)
+{
+    // Parts may arrive after the rejoin was aborted
+    if(state != SS_GAME || !rejoin || msg.senderPlayerID != rejoin->getProviderId())
+        return true;
+    if(!rejoin->addSnapshotPart(msg))
+    {
+        LOG.write(_("SERVER: Invalid snapshot received from player %1%\n")) % unsigned(msg.senderPlayerID);
+        AbortRejoin();
+        return true;
+    }
+    if(!rejoin->hasSnapshot())
+        return true;
+
+    GameServerPlayer* player = GetNetworkPlayer(rejoin->getPlayerId());
+    // The rejoin is reset when the player leaves
+    RTTR_Assert(player && !player->isActive());
+    const unsigned compressedLength = rejoin->getSnapshot()->size();
+    player->sendMsgAsync(new GameMessage_Rejoin_Start(rejoin->getPlayerId(), rejoin->getSnapshotGF(), //-V522
+                                                      nwfInfo.getCmdDelay(), rejoin->getSnapshotLength(),
+                                                      compressedLength, rejoin->getRandomState()));
+    // A rejoining player gets the snapshot of the running game instead of the map
+    player->setMapSending(std::chrono::seconds(compressedLength / (25 * 1024) + 1), rejoin->getSnapshot(), nullptr);
+    SendMapData(*player);
+    return true;
+}
+
+bool GameServer::OnGameMessage(const GameMessage_Rejoin_Token& msg)
+{
+    // Clients send their token whenever they reconnect to the same server, so ignore it if there is no running game
+    if(!IsRejoiningPlayer(msg.senderPlayerID))
+        return true;
+    GameServerPlayer* player = GetNetworkPlayer(msg.senderPlayerID);
+    if(player->isRejoinVerified()) //-V522
+    {
+        KickPlayer(msg.senderPlayerID, NP_INVALIDMSG, __LINE__);
+        return true;
+    }
+    // Assign the connection to the dropped slot owning the token
+    const auto itSlot = helpers::find_if(droppedPlayers, [this, &msg](unsigned id) {
+        return !msg.token.empty() && id < rejoinTokens.size() && rejoinTokens[id] == msg.token
+               && (id == msg.senderPlayerID || !GetNetworkPlayer(id));
+    });
+    if(itSlot == droppedPlayers.end())
+    {
+        LOG.write(_("SERVER: Player %1% tried to rejoin with an invalid token\n")) % unsigned(msg.senderPlayerID);
+        KickPlayer(msg.senderPlayerID, NP_NOCAUSE, __LINE__);
+        return true;
+    }
+    player->playerId = *itSlot;
+    player->setRejoinVerified();
+    return true;
+}
+
+bool GameServer::OnGameMessage(const GameMessage_Rejoin_Ready& msg)
+{
+    GameServerPlayer* player = GetNetworkPlayer(msg.senderPlayerID);
+    if(state != SS_GAME || !rejoin || rejoin->getPlayerId() != msg.senderPlayerID || !player || !player->isActive())
+    {
+        KickPlayer(msg.senderPlayerID, NP_INVALIDMSG, __LINE__);
+        return true;
+    }
+    // Everyone hands over at the same NWF. It is not announced yet, so no one can have executed it
+    const unsigned takeOverGF = nwfInfo.getFirstUnannouncedNWF();
+    JoinPlayerInfo& playerInfo = playerInfos[msg.senderPlayerID];
+    playerInfo.ps = PS_OCCUPIED;
+    helpers::remove(droppedPlayers, msg.senderPlayerID);
+    rejoin.reset();
+
+    SendToAll(GameMessage_Player_Rejoined(msg.senderPlayerID, takeOverGF));
+    LOG.write(_("SERVER: Player %1% rejoined at GF %2%\n")) % unsigned(msg.senderPlayerID) % takeOverGF;
+    AnnounceStatusChange();
+    return true;
+}
@@ -23,19 +23,24 @@
 #include "GlobalGameSettings.h"
 #include "JoinPlayerInfo.h"
 #include "NWFInfo.h"
+#include "SpectatorRelay.h"
 #include "gameTypes/MapInfo.h"
 #include "gameTypes/ServerType.h"
 #include "liblobby/LobbyInterface.h"
 #include "s25util/LANDiscoveryService.h"
 #include "s25util/Singleton.h"
 #include <chrono>
+#include <memory>
+#include <string>
 #include <vector>
 
 struct CreateServerInfo;
+class Savegame;
 class GameMessage;
 class GameMessageWithPlayer;
 class GameMessage_GameCommand;
 class GameServerPlayer;
+class PlayerRejoin;
 struct AIServerPlayer;
 
 class GameServer :
@@ -55,6 +60,12 @@ public:
                const std::string& hostPw);
 
     void Run();
+    /// Return true if the server is started
+    bool IsRunning() const { return state != SS_STOPPED; }
+    /// Return the time until the server has to do work (execute a GF, send messages, ping, ...) if nothing is received
+    SteadyClock::duration GetTimeToNextEvent() const;
+    /// Wait till a message or connection is received but at most timeout. Used when the server is run standalone
+    void WaitForEvents(SteadyClock::duration timeout);
 
     void RunStateGame();
 
@@ -62,10 +73,26 @@ public:
 
     void Stop();
 
+    /// Return true if the host should provide a snapshot of the game at this GF for a joining spectator
+    bool IsSpectatorSnapshotDue(unsigned gf) const;
+    /// Add a snapshot of the game at the start of its start GF for late joining spectators (nullptr on failure)
+    void AddSpectatorSnapshot(std::unique_ptr<Savegame> savegame);
+
+    /// Get the number of GFs (of the given length) per NWF so that the NWF takes at least minDuration
+    static unsigned CalcNWFLenght(FramesInfo::milliseconds32_t minDuration, FramesInfo::milliseconds32_t gfLength);
+    /// Get the NWF length for the NWF following lastInfo (last one announced) for the given highest ping in ms
+    static unsigned CalcAdaptiveNWFLength(const NWFServerInfo& lastInfo, FramesInfo::milliseconds32_t newGFLength,
+                                          unsigned highestPing);
+    /// Get the number of NWFs commands are sent in advance for the given highest ping in ms
+    static unsigned CalcCmdDelay(unsigned highestPing, FramesInfo::milliseconds32_t gfLength);
+
 private:
     bool StartGame();
+    /// Start forwarding the game to spectators
+    void StartSpectatorRelay(unsigned random_init);
 
-    unsigned CalcNWFLenght(FramesInfo::milliseconds32_t minDuration) const;
+    /// Get the highest (smoothed) ping of all connected players in ms
+    unsigned GetHighestPing() const;
 
     GameServerPlayer* GetNetworkPlayer(unsigned playerId);
     /// Swap players ingame or during config
@@ -77,6 +104,13 @@ private:
     /// Kick a player (free slot and set socket to invalid. Does NOT remove it from NetworkPlayers)
     void KickPlayer(uint8_t playerId, KickReason cause, uint32_t param);
 
+    /// True if the player connected to a running game to take over his dropped slot and is not yet active
+    bool IsRejoiningPlayer(unsigned playerId);
+    /// Request a snapshot for the rejoining player. Return false if not possible
+    bool StartRejoin(unsigned playerId);
+    /// Cancel the current rejoin and disconnect the rejoining player
+    void AbortRejoin();
+
     void ClientWatchDog();
 
     void WaitForClients();
@@ -105,6 +139,7 @@ private:
     bool OnGameMessage(const GameMessage_Player_Swap& msg) override;
     bool OnGameMessage(const GameMessage_Player_SwapConfirm& msg) override;
     bool OnGameMessage(const GameMessage_MapRequest& msg) override;
+    bool OnGameMessage(const GameMessage_Map_DataAck& msg) override;
     bool OnGameMessage(const GameMessage_Map_Checksum& msg) override;
     bool OnGameMessage(const GameMessage_GameCommand& msg) override;
     bool OnGameMessage(const GameMessage_Speed& msg) override;
@@ -114,8 +149,14 @@ private:
     bool OnGameMessage(const GameMessage_CancelCountdown& msg) override;
     bool OnGameMessage(const GameMessage_Pause& msg) override;
     bool OnGameMessage(const GameMessage_SkipToGF& msg) override;
+    bool OnGameMessage(const GameMessage_Rejoin_Snapshot& msg) override;
+    bool OnGameMessage(const GameMessage_Rejoin_Ready& msg) override;
+    bool OnGameMessage(const GameMessage_Rejoin_Token& msg) override;
     RTTR_POP_DIAGNOSTIC
 
+    /// Send as many map and lua data chunks to the player as the transfer window allows
+    void SendMapData(GameServerPlayer& player);
+
     void CancelCountdown();
     bool ArePlayersReady() const;
     /// Some player data has changed. Set non-ready and cancel countdown
@@ -165,15 +206,27 @@ private:
         std::string hostPassword, password;
         unsigned short port;
         bool ipv6;
+        unsigned short spectatorPort;
+        /// Delay of the spectator stream in seconds
+        unsigned spectatorDelay;
     } config;
 
     MapInfo mapinfo;
+    /// Compressed map and lua data shared by all messages sending them
+    std::shared_ptr<const std::vector<char>> sharedMapData, sharedLuaData;
 
     Socket serversocket;
     std::vector<JoinPlayerInfo> playerInfos;
     std::vector<GameServerPlayer> networkPlayers;
     NWFInfo nwfInfo;
     GlobalGameSettings ggs_;
+    SpectatorRelay spectatorRelay;
+    /// Slots of players who lost the connection during the game. They can rejoin while the slot is played by an AI
+    std::vector<unsigned> droppedPlayers;
+    /// Rejoin in progress (max. 1 at a time)
+    std::unique_ptr<PlayerRejoin> rejoin;
+    /// Secret token per slot sent to its player at game start. Required to rejoin that slot
+    std::vector<std::string> rejoinTokens;
 
     /// der Spielstartcountdown
     class CountDown
@@ -40,11 +40,15 @@ GameServerPlayer::GameServerPlayer(unsigned id, const Socket& socket) //-V818
 
 GameServerPlayer::~GameServerPlayer() = default;
 
-void GameServerPlayer::setMapSending(std::chrono::seconds estimatedSendTime)
+void GameServerPlayer::setMapSending(std::chrono::seconds estimatedSendTime,
+                                     std::shared_ptr<const std::vector<char>> mapData,
+                                     std::shared_ptr<const std::vector<char>> luaData)
 {
     MapSendingState state;
     state.timer.start();
     state.estimatedSendTime = estimatedSendTime;
+    state.mapData = std::move(mapData);
+    state.luaData = std::move(luaData);
     state_ = std::move(state);
 }
 
@@ -100,7 +104,10 @@ unsigned GameServerPlayer::getLagTimeOut() const
 
 void GameServerPlayer::setLagging()
 {
-    boost::get<ActiveState>(state_).lagTimer.restart();
+    // Keep the time of the first lag, otherwise the timeout is never reached
+    Timer& lagTimer = boost::get<ActiveState>(state_).lagTimer;
+    if(!lagTimer.isRunning())
+        lagTimer.start();
 }
 
 void GameServerPlayer::setNotLagging()
@@ -20,7 +20,9 @@
 #include "NetworkPlayer.h"
 #include "Timer.h"
 #include "helpers/SmoothedValue.hpp"
+#include <memory>
 #include <variant.h>
+#include <vector>
 
 /// Player connected to the server
 class GameServerPlayer : public NetworkPlayer
@@ -28,11 +30,17 @@ class GameServerPlayer : public NetworkPlayer
     struct JustConnectedState
     {
         Timer timer;
+        /// Player rejoining a running game sent the token of its slot
+        bool isRejoinVerified = false;
     };
     struct MapSendingState
     {
         Timer timer;
         std::chrono::seconds estimatedSendTime;
+        /// Map and lua data to send. Fixed at the start of the transfer so later changes on the server don't affect it
+        std::shared_ptr<const std::vector<char>> mapData, luaData;
+        /// Bytes of map and lua data sent and acknowledged by the client
+        unsigned numBytesSent = 0, numBytesAcked = 0;
     };
     struct ActiveState
     {
@@ -52,10 +60,17 @@ public:
     GameServerPlayer(unsigned id, const Socket& socket);
     ~GameServerPlayer();
 
-    void setMapSending(std::chrono::seconds estimatedSendTime);
+    void setMapSending(std::chrono::seconds estimatedSendTime, std::shared_ptr<const std::vector<char>> mapData,
+                       std::shared_ptr<const std::vector<char>> luaData);
     void setActive();
     bool isMapSending() const { return holds_alternative<MapSendingState>(state_); }
     bool isActive() const { return holds_alternative<ActiveState>(state_); }
+    void setRejoinVerified() { boost::get<JustConnectedState>(state_).isRejoinVerified = true; }
+    bool isRejoinVerified() const
+    {
+        const auto* state = boost::get<JustConnectedState>(&state_);
+        return state && state->isRejoinVerified;
+    }
 
     /// Get seconds till the player gets kicked due to lag
     unsigned getLagTimeOut() const;
@@ -71,6 +86,13 @@ public:
     /// Set player not lagging (anymore)
     void setNotLagging();
 
+    const auto& getMapData() const { return boost::get<MapSendingState>(state_).mapData; }
+    const auto& getLuaData() const { return boost::get<MapSendingState>(state_).luaData; }
+    unsigned getMapBytesSent() const { return boost::get<MapSendingState>(state_).numBytesSent; }
+    unsigned getMapBytesAcked() const { return boost::get<MapSendingState>(state_).numBytesAcked; }
+    void setMapBytesSent(unsigned numBytes) { boost::get<MapSendingState>(state_).numBytesSent = numBytes; }
+    void setMapBytesAcked(unsigned numBytes) { boost::get<MapSendingState>(state_).numBytesAcked = numBytes; }
+
     auto& getPendingSwaps() { return boost::get<ActiveState>(state_).pendingSwaps; }
 
 private:
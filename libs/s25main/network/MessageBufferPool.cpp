@@ -0,0 +1,66 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "MessageBufferPool.h"
+#include "s25util/Serializer.h"
+#include <mutex>
+
+/// Buffers are only kept up to this size...
+static constexpr unsigned MAX_POOLED_BUFFER_SIZE = 64 * 1024;
+/// ... and this number
+static constexpr unsigned MAX_POOLED_BUFFERS = 256;
+
+struct MessageBufferPool::Storage
+{
+    /// Messages are created and released from the game thread and the threads sending them asynchronously
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Serializer>> freeBuffers;
+};
+
+std::shared_ptr<MessageBufferPool::Storage> MessageBufferPool::getStorage()
+{
+    static const auto storage = std::make_shared<Storage>();
+    return storage;
+}
+
+std::shared_ptr<Serializer> MessageBufferPool::acquire()
+{
+    const std::shared_ptr<Storage> storage = getStorage();
+    std::unique_ptr<Serializer> buffer;
+    {
+        std::lock_guard<std::mutex> lock(storage->mutex);
+        if(!storage->freeBuffers.empty())
+        {
+            buffer = std::move(storage->freeBuffers.back());
+            storage->freeBuffers.pop_back();
+        }
+    }
+    if(!buffer)
+        buffer = std::make_unique<Serializer>();
+    // Buffers may outlive the pool (e.g. in static objects), so only keep a weak reference
+    std::weak_ptr<Storage> weakStorage = storage;
+    return std::shared_ptr<Serializer>(buffer.release(), [weakStorage](Serializer* releasedBuffer) {
+        std::unique_ptr<Serializer> ownedBuffer(releasedBuffer);
+        const std::shared_ptr<Storage> storage = weakStorage.lock();
+        if(!storage || ownedBuffer->GetLength() > MAX_POOLED_BUFFER_SIZE)
+            return;
+        ownedBuffer->Clear();
+        std::lock_guard<std::mutex> lock(storage->mutex);
+        if(storage->freeBuffers.size() < MAX_POOLED_BUFFERS)
+            storage->freeBuffers.push_back(std::move(ownedBuffer));
+    });
+}
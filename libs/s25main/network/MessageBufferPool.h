@@ -0,0 +1,35 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+class Serializer;
+
+/// Keeps serialization buffers of outgoing messages for reuse to avoid reallocating them for each message
+class MessageBufferPool
+{
+public:
+    /// Get an empty buffer. It is returned to the pool when the last reference to it is released
+    static std::shared_ptr<Serializer> acquire();
+
+private:
+    struct Storage;
+    static std::shared_ptr<Storage> getStorage();
+};
@@ -17,6 +17,11 @@
 
 #include "NetworkPlayer.h"
 #include "GameMessage.h"
+#include "SerializedGameMessage.h"
+#include <memory>
+
+/// Messages are combined into one batch until it reaches this size
+static constexpr unsigned MAX_BATCH_SIZE = 16 * 1024;
 
 NetworkPlayer::NetworkPlayer(unsigned playerId)
     : playerId(playerId), recvQueue(GameMessage::create_game), sendQueue(GameMessage::create_game)
@@ -37,7 +42,39 @@ bool NetworkPlayer::receiveMsgs()
 
 bool NetworkPlayer::sendMsgs(int maxNumMsgs)
 {
-    return sendQueue.send(socket, maxNumMsgs);
+    // Combine consecutive messages so they are written to the socket at once.
+    // A single message is sent as-is so only start a batch when there is a second one
+    GameMessage_Batch batch;
+    std::unique_ptr<Message> singleMsg;
+    const auto flushBatch = [&]() {
+        bool result = true;
+        if(batch.size() > 0)
+            result = MessageQueue::sendMessage(socket, batch);
+        else if(singleMsg)
+            result = MessageQueue::sendMessage(socket, *singleMsg);
+        batch.clear();
+        singleMsg.reset();
+        return result;
+    };
+
+    for(int numMsgs = 0; (maxNumMsgs < 0 || numMsgs < maxNumMsgs) && !sendQueue.empty(); numMsgs++)
+    {
+        std::unique_ptr<Message> msg(sendQueue.popFront());
+        if(batch.size() == 0 && !singleMsg)
+        {
+            singleMsg = std::move(msg);
+            continue;
+        }
+        if(singleMsg)
+        {
+            batch.add(*singleMsg);
+            singleMsg.reset();
+        }
+        batch.add(*msg);
+        if(batch.getDataSize() >= MAX_BATCH_SIZE && !flushBatch())
+            return false;
+    }
+    return flushBatch();
 }
 
 void NetworkPlayer::sendMsgAsync(Message* msg)
@@ -52,10 +89,23 @@ void NetworkPlayer::sendMsg(const Message& msg)
 
 void NetworkPlayer::executeMsgs(MessageInterface& msgHandler)
 {
+    // The handler may close the connection (e.g. kicking the player) which clears the queue.
+    // So take each message out before running it and stop once the connection is closed
     while(!recvQueue.empty())
     {
-        recvQueue.front()->run(&msgHandler, playerId);
-        recvQueue.pop();
+        std::unique_ptr<Message> msg(recvQueue.popFront());
+        auto* batch = dynamic_cast<GameMessage_Batch*>(msg.get());
+        if(!batch)
+        {
+            msg->run(&msgHandler, playerId);
+            continue;
+        }
+        for(const auto& subMsg : batch->releaseMsgs())
+        {
+            if(!socket.isValid())
+                return;
+            subMsg->run(&msgHandler, playerId);
+        }
     }
 }
 
@@ -33,7 +33,8 @@ public:
     virtual void closeConnection();
     /// Receive all waiting messages from the socket. Return false on error
     bool receiveMsgs();
-    /// Send at most maxNumMsgs (if non-negative). Return false on error
+    /// Send at most maxNumMsgs (if non-negative). Consecutive messages are combined into one write.
+    /// Return false on error
     bool sendMsgs(int maxNumMsgs);
     /// Enqueue a message to be send later
     void sendMsgAsync(Message* msg);
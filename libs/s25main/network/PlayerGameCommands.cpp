@@ -16,18 +16,109 @@
 // along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
 
 #include "PlayerGameCommands.h"
+#include "GameCommands.h"
 #include "s25util/Serializer.h"
+#include <stdexcept>
+#include <vector>
+
+/* Compact format:
+    AsyncChecksum hash (4 bytes)
+    Number of GCs (varint)
+    Per GC:
+        varint: type * 2 + hasPosition
+        Position (if present): x, y as zigzag varint delta to the previous position (starting at 0,0)
+        varint: size of the remaining data
+        Remaining data as serialized by the GC
+*/
+
+namespace {
+void pushVarInt(Serializer& ser, int value)
+{
+    ser.PushVarSize((static_cast<unsigned>(value) << 1) ^ static_cast<unsigned>(value >> 31));
+}
+
+int popVarInt(Serializer& ser)
+{
+    const unsigned value = ser.PopVarSize();
+    return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+}
+
+MapCoord addDelta(MapCoord value, int delta)
+{
+    const int result = value + delta;
+    if(result < 0 || result > 0xFFFF)
+        throw std::runtime_error("Invalid position delta");
+    return static_cast<MapCoord>(result);
+}
+} // namespace
 
 void PlayerGameCommands::Serialize(Serializer& ser) const
 {
-    checksum.Serialize(ser);
+    checksum.SerializeHash(ser);
 
-    ser.PushUnsignedInt(gcs.size());
+    ser.PushVarSize(gcs.size());
+    MapPoint lastPt(0, 0);
+    Serializer gcSer;
+    std::vector<unsigned char> remainingData;
     for(const gc::GameCommandPtr& gc : gcs)
-        gc->Serialize(ser);
+    {
+        gcSer.Clear();
+        gc->Serialize(gcSer);
+        const unsigned char type = gcSer.PopUnsignedChar();
+        const auto* coordsGC = dynamic_cast<const gc::Coords*>(gc.get());
+        ser.PushVarSize(type * 2u + (coordsGC ? 1u : 0u));
+        if(coordsGC)
+        {
+            // Skip the position, it is written as the delta
+            gcSer.PopUnsignedShort();
+            gcSer.PopUnsignedShort();
+            const MapPoint pt = coordsGC->GetPos();
+            pushVarInt(ser, pt.x - lastPt.x);
+            pushVarInt(ser, pt.y - lastPt.y);
+            lastPt = pt;
+        }
+        remainingData.resize(gcSer.GetBytesLeft());
+        gcSer.PopRawData(remainingData.data(), remainingData.size());
+        ser.PushVarSize(remainingData.size());
+        ser.PushRawData(remainingData.data(), remainingData.size());
+    }
 }
 
 void PlayerGameCommands::Deserialize(Serializer& ser)
+{
+    checksum.DeserializeHash(ser);
+
+    const unsigned numGCs = ser.PopVarSize();
+    if(numGCs > ser.GetBytesLeft())
+        throw std::runtime_error("Invalid number of game commands");
+    gcs.resize(numGCs);
+    MapPoint lastPt(0, 0);
+    Serializer gcSer;
+    std::vector<unsigned char> remainingData;
+    for(gc::GameCommandPtr& gc : gcs)
+    {
+        // Restore the format expected by the GCs
+        gcSer.Clear();
+        const unsigned header = ser.PopVarSize();
+        gcSer.PushUnsignedChar(static_cast<unsigned char>(header / 2u));
+        if(header & 1u)
+        {
+            lastPt.x = addDelta(lastPt.x, popVarInt(ser));
+            lastPt.y = addDelta(lastPt.y, popVarInt(ser));
+            gcSer.PushUnsignedShort(lastPt.x);
+            gcSer.PushUnsignedShort(lastPt.y);
+        }
+        const unsigned remainingSize = ser.PopVarSize();
+        if(remainingSize > ser.GetBytesLeft())
+            throw std::runtime_error("Invalid game command size");
+        remainingData.resize(remainingSize);
+        ser.PopRawData(remainingData.data(), remainingSize);
+        gcSer.PushRawData(remainingData.data(), remainingSize);
+        gc = gc::GameCommand::Deserialize(gcSer);
+    }
+}
+
+void PlayerGameCommands::DeserializeLegacy(Serializer& ser)
 {
     checksum.Deserialize(ser);
 
@@ -34,6 +34,9 @@ struct PlayerGameCommands
     PlayerGameCommands(const AsyncChecksum& checksum, std::vector<gc::GameCommandPtr> gcs)
         : checksum(checksum), gcs(std::move(gcs))
     {}
+    /// Serialize in the compact format: Checksum hash, varints and positions as delta to the previous command
     void Serialize(Serializer& ser) const;
     void Deserialize(Serializer& ser);
+    /// Deserialize the old format with fixed size fields and full checksum (Replays up to version 6)
+    void DeserializeLegacy(Serializer& ser);
 };
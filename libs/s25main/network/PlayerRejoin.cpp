@@ -0,0 +1,110 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "PlayerRejoin.h"
+#include "GameMessage_GameCommand.h"
+#include "GameMessages.h"
+#include "GameProtocol.h"
+#include "NWFInfo.h"
+#include "NetworkPlayer.h"
+#include <queue>
+
+PlayerRejoin::PlayerRejoin(unsigned playerId, unsigned providerId, const NWFInfo& nwfInfo)
+    : playerId_(playerId), providerId_(providerId), isBuffering_(true), snapshotLength_(0), compressedLength_(0)
+{
+    // The server may not yet have executed some of the announced NWFs, whose commands are still queued
+    snapshotGF_ = nwfInfo.getFirstUnannouncedNWF();
+    const unsigned numPendingNWFs = nwfInfo.getNumPendingNWFs();
+    for(const NWFPlayerInfo& player : nwfInfo.getPlayerInfos())
+    {
+        // The first numPendingNWFs commands are for NWFs before the snapshot, the others are required
+        std::queue<PlayerGameCommands> commands = player.commands;
+        if(commands.size() < numPendingNWFs)
+            numCmdsToSkip_[player.id] = numPendingNWFs - commands.size();
+        else
+        {
+            for(unsigned i = 0; i < numPendingNWFs; i++)
+                commands.pop();
+            for(; !commands.empty(); commands.pop())
+                addPlayerCmds(player.id, commands.front());
+        }
+    }
+}
+
+PlayerRejoin::~PlayerRejoin() = default;
+
+void PlayerRejoin::addServerInfo(const NWFServerInfo& info)
+{
+    if(isBuffering_)
+        bufferedMsgs_.push_back(std::make_unique<GameMessage_Server_NWFDone>(info.gf, info.newGFLen, info.nextNWF));
+}
+
+void PlayerRejoin::addPlayerCmds(unsigned playerId, const PlayerGameCommands& cmds)
+{
+    if(!isBuffering_)
+        return;
+    auto itSkip = numCmdsToSkip_.find(playerId);
+    if(itSkip != numCmdsToSkip_.end() && itSkip->second > 0u)
+    {
+        --itSkip->second;
+        return;
+    }
+    bufferedMsgs_.push_back(std::make_unique<GameMessage_GameCommand>(playerId, cmds.checksum, cmds.gcs));
+}
+
+void PlayerRejoin::addMsg(std::unique_ptr<GameMessage> msg)
+{
+    if(isBuffering_)
+        bufferedMsgs_.push_back(std::move(msg));
+}
+
+bool PlayerRejoin::addSnapshotPart(const GameMessage_Rejoin_Snapshot& part)
+{
+    if(hasSnapshot() || part.gf != snapshotGF_ || part.data.empty())
+        return false;
+    if(receivedData_.empty())
+    {
+        if(part.compressedLength == 0u || part.randomState.empty())
+            return false;
+        // Lengths come from the provider and must not make us allocate arbitrary amounts of memory
+        if(part.compressedLength > REJOIN_MAX_SNAPSHOT_SIZE || part.length > REJOIN_MAX_SNAPSHOT_SIZE)
+            return false;
+        snapshotLength_ = part.length;
+        compressedLength_ = part.compressedLength;
+        randomState_ = part.randomState;
+        receivedData_.reserve(compressedLength_);
+    } else if(part.length != snapshotLength_ || part.compressedLength != compressedLength_)
+        return false;
+    // Parts are sent in order
+    if(part.offset != receivedData_.size() || part.offset + part.data.size() > compressedLength_)
+        return false;
+    receivedData_.insert(receivedData_.end(), part.data.begin(), part.data.end());
+    if(receivedData_.size() == compressedLength_)
+    {
+        snapshot_ = std::make_shared<const std::vector<char>>(std::move(receivedData_));
+        receivedData_.clear();
+    }
+    return true;
+}
+
+void PlayerRejoin::sendBufferedMsgs(NetworkPlayer& player)
+{
+    for(std::unique_ptr<GameMessage>& msg : bufferedMsgs_)
+        player.sendMsgAsync(msg.release());
+    bufferedMsgs_.clear();
+    isBuffering_ = false;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+class GameMessage;
+class GameMessage_Rejoin_Snapshot;
+class NetworkPlayer;
+class NWFInfo;
+struct NWFServerInfo;
+struct PlayerGameCommands;
+
+/// Server side state of a dropped player rejoining a running game.
+/// Another client (the provider) makes a snapshot of the game right before executing the first NWF not yet announced
+/// (snapshot GF). All NWF infos and commands from that NWF on are buffered while the snapshot is transferred and sent
+/// to the rejoining player afterwards. The player then catches up by fast forwarding while the game continues for the
+/// others.
+class PlayerRejoin
+{
+public:
+    /// Start the rejoin of the player using the current NWF state of the server
+    PlayerRejoin(unsigned playerId, unsigned providerId, const NWFInfo& nwfInfo);
+    ~PlayerRejoin();
+
+    unsigned getPlayerId() const { return playerId_; }
+    unsigned getProviderId() const { return providerId_; }
+    unsigned getSnapshotGF() const { return snapshotGF_; }
+
+    /// Called for each announced NWF
+    void addServerInfo(const NWFServerInfo& info);
+    /// Called for each accepted set of commands of a player
+    void addPlayerCmds(unsigned playerId, const PlayerGameCommands& cmds);
+    /// Buffer any other message that changes the game state (e.g. kicked players)
+    void addMsg(std::unique_ptr<GameMessage> msg);
+    unsigned getNumBufferedMsgs() const { return bufferedMsgs_.size(); }
+
+    /// Add the next part of the compressed snapshot. Return false if it does not match the previous parts
+    bool addSnapshotPart(const GameMessage_Rejoin_Snapshot& part);
+    /// True if the snapshot was received completely
+    bool hasSnapshot() const { return snapshot_ != nullptr; }
+    /// Compressed snapshot (only valid if hasSnapshot())
+    const std::shared_ptr<const std::vector<char>>& getSnapshot() const { return snapshot_; }
+    /// Uncompressed length of the snapshot
+    unsigned getSnapshotLength() const { return snapshotLength_; }
+    /// State of the random number generator at the snapshot GF
+    const std::vector<char>& getRandomState() const { return randomState_; }
+
+    /// Queue all buffered messages to the player after the snapshot. Further messages are sent directly
+    void sendBufferedMsgs(NetworkPlayer& player);
+    bool isBuffering() const { return isBuffering_; }
+
+private:
+    unsigned playerId_, providerId_, snapshotGF_;
+    /// Number of commands per player that are still to come but are for NWFs before the snapshot
+    std::map<unsigned, unsigned> numCmdsToSkip_;
+    std::vector<std::unique_ptr<GameMessage>> bufferedMsgs_;
+    bool isBuffering_;
+    /// Snapshot while it is received and the lengths announced by the provider
+    std::vector<char> receivedData_;
+    unsigned snapshotLength_, compressedLength_;
+    std::vector<char> randomState_;
+    std::shared_ptr<const std::vector<char>> snapshot_;
+};
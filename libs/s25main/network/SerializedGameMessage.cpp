@@ -0,0 +1,120 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SerializedGameMessage.h"
+#include "GameMessageInterface.h"
+#include "GameProtocol.h"
+#include "MessageBufferPool.h"
+#include "s25util/Serializer.h"
+#include <stdexcept>
+
+SerializedGameMessage::SerializedGameMessage(const Message& msg) : GameMessage(msg.getId())
+{
+    std::shared_ptr<Serializer> data = MessageBufferPool::acquire();
+    msg.Serialize(*data);
+    data_ = std::move(data);
+}
+
+void SerializedGameMessage::Serialize(Serializer& ser) const
+{
+    ser.PushRawData(data_->GetData(), data_->GetLength());
+}
+
+bool SerializedGameMessage::Run(GameMessageInterface*) const
+{
+    RTTR_Assert(false);
+    return false;
+}
+
+unsigned SerializedGameMessage::getSize() const
+{
+    return data_->GetLength();
+}
+
+GameMessage_Batch::GameMessage_Batch() : GameMessage(NMS_BATCH) {}
+
+GameMessage_Batch::~GameMessage_Batch() = default;
+
+void GameMessage_Batch::add(const Message& msg)
+{
+    RTTR_Assert(msg.getId() != NMS_BATCH);
+    if(!outData_)
+        outData_ = MessageBufferPool::acquire();
+    outData_->PushUnsignedShort(msg.getId());
+    msg.Serialize(*outData_);
+    ++numOutMsgs_;
+}
+
+void GameMessage_Batch::clear()
+{
+    outData_.reset();
+    numOutMsgs_ = 0;
+    inMsgs_.clear();
+}
+
+unsigned GameMessage_Batch::size() const
+{
+    return numOutMsgs_ + inMsgs_.size();
+}
+
+unsigned GameMessage_Batch::getDataSize() const
+{
+    return outData_ ? outData_->GetLength() : 0u;
+}
+
+void GameMessage_Batch::Serialize(Serializer& ser) const
+{
+    GameMessage::Serialize(ser);
+    ser.PushUnsignedInt(numOutMsgs_);
+    if(outData_)
+        ser.PushRawData(outData_->GetData(), outData_->GetLength());
+}
+
+void GameMessage_Batch::Deserialize(Serializer& ser)
+{
+    GameMessage::Deserialize(ser);
+    clear();
+    const unsigned numMsgs = ser.PopUnsignedInt();
+    // Each message consists of at least its id
+    if(numMsgs > ser.GetBytesLeft() / sizeof(uint16_t))
+        throw std::runtime_error("Invalid number of messages in batch");
+    inMsgs_.reserve(numMsgs);
+    for(unsigned i = 0; i < numMsgs; i++)
+    {
+        const uint16_t id = ser.PopUnsignedShort();
+        std::unique_ptr<Message> msg(id == NMS_BATCH ? nullptr : create_game(id));
+        if(!msg)
+            throw std::runtime_error("Invalid message id in batch");
+        msg->Deserialize(ser);
+        inMsgs_.push_back(std::move(msg));
+    }
+}
+
+std::vector<std::unique_ptr<Message>> GameMessage_Batch::releaseMsgs()
+{
+    std::vector<std::unique_ptr<Message>> msgs;
+    std::swap(msgs, inMsgs_);
+    return msgs;
+}
+
+bool GameMessage_Batch::Run(GameMessageInterface* callback) const
+{
+    bool result = true;
+    for(const auto& msg : inMsgs_)
+        result &= msg->run(callback, senderPlayerID);
+    return result;
+}
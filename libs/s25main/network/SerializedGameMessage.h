@@ -0,0 +1,77 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "GameMessage.h"
+#include <memory>
+#include <utility>
+#include <vector>
+
+class Serializer;
+
+/// Message which was already serialized. Used to send the same message to multiple players
+class SerializedGameMessage : public GameMessage
+{
+public:
+    /// Serialize the message into a pooled buffer
+    explicit SerializedGameMessage(const Message& msg);
+    SerializedGameMessage(uint16_t id, std::shared_ptr<const Serializer> data)
+        : GameMessage(id), data_(std::move(data))
+    {}
+
+    void Serialize(Serializer& ser) const override;
+    /// Only for sending, never received
+    bool Run(GameMessageInterface* callback) const override;
+
+    const std::shared_ptr<const Serializer>& getData() const { return data_; }
+    unsigned getSize() const;
+
+private:
+    std::shared_ptr<const Serializer> data_;
+};
+
+/// Multiple (small) messages sent as one to reduce the number of socket writes
+class GameMessage_Batch : public GameMessage
+{
+public:
+    GameMessage_Batch();
+    ~GameMessage_Batch() override;
+
+    /// Add a message to be sent. It is serialized directly into the batch
+    void add(const Message& msg);
+    /// Remove all messages
+    void clear();
+    /// Number of messages contained
+    unsigned size() const;
+    /// Size of the serialized sub messages in bytes
+    unsigned getDataSize() const;
+
+    void Serialize(Serializer& ser) const override;
+    void Deserialize(Serializer& ser) override;
+    /// Take the received messages out of the batch so they can be run even when the batch gets destroyed
+    std::vector<std::unique_ptr<Message>> releaseMsgs();
+    /// Run all contained messages in order. The callback must not destroy the batch, use releaseMsgs for that case
+    bool Run(GameMessageInterface* callback) const override;
+
+private:
+    /// Serialized messages to send
+    std::shared_ptr<Serializer> outData_;
+    unsigned numOutMsgs_ = 0;
+    /// Received messages
+    std::vector<std::unique_ptr<Message>> inMsgs_;
+};
@@ -0,0 +1,386 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SpectatorRelay.h"
+#include "GameMessages.h"
+#include "GameProtocol.h"
+#include "PlayerGameCommands.h"
+#include "Savegame.h"
+#include "helpers/containerUtils.h"
+#include "gameTypes/MapInfo.h"
+#include "s25util/Log.h"
+#include "s25util/SocketSet.h"
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <iterator>
+#include <mygettext/mygettext.h>
+
+namespace bfs = boost::filesystem;
+
+SpectatorRelay::Spectator::Spectator(unsigned id) : connection(id), numHeaderBytesSent(0), recordsOffset(0), endGF(0)
+{}
+
+SpectatorRelay::SpectatorRelay()
+    : isRunning_(false), delayGFs_(1), nextSpectatorId_(0), recordedSize_(0), curStart_{0, nullptr, 0},
+      lastSnapshotGF_(0), isSnapshotRequested_(false), lastUpdatedGF_(0)
+{}
+
+SpectatorRelay::~SpectatorRelay()
+{
+    Stop();
+}
+
+bool SpectatorRelay::Start(uint16_t port, bool ipv6, unsigned delayGFs)
+{
+    Stop();
+    if(!serverSocket_.Listen(port, ipv6, false))
+    {
+        LOG.write("SERVER: Listening for spectators on port %1% failed!\n") % port;
+        return false;
+    }
+    delayGFs_ = std::max(delayGFs, 1u);
+    isRunning_ = true;
+    return true;
+}
+
+void SpectatorRelay::Stop()
+{
+    for(Spectator& spectator : spectators_)
+        spectator.connection.closeConnection();
+    spectators_.clear();
+    serverSocket_.Close();
+    replay_.StopRecording();
+    replay_.ClearPlayers();
+    recordedFile_.close();
+    records_.clear();
+    recordedSize_ = 0;
+    curStart_ = StreamStart{0, nullptr, 0};
+    pendingSnapshots_.clear();
+    isSnapshotRequested_ = false;
+    isRunning_ = false;
+}
+
+bool SpectatorRelay::StartStream(const bfs::path& filepath, const MapInfo& mapInfo, unsigned startGF)
+{
+    RTTR_Assert(isRunning_ && !replay_.IsRecording());
+    if(!replay_.StartRecording(filepath, mapInfo))
+    {
+        LOG.write("SERVER: Could not record the spectator stream to %1%\n") % filepath;
+        return false;
+    }
+    filepath_ = filepath;
+    mapTitle_ = mapInfo.title;
+    recordedSize_ = replay_.GetFile().Tell();
+    recordedFile_.open(filepath_, std::ios::binary);
+    auto header = std::make_shared<std::vector<char>>(ReadRecordedData(0, recordedSize_));
+    if(header->size() != recordedSize_)
+    {
+        LOG.write("SERVER: Could not read the spectator stream from %1%\n") % filepath;
+        replay_.StopRecording();
+        return false;
+    }
+    curStart_ = StreamStart{startGF, std::move(header), recordedSize_};
+    lastSnapshotGF_ = lastUpdatedGF_ = startGF;
+    return true;
+}
+
+void SpectatorRelay::AddChatCommand(unsigned gf, uint8_t player, uint8_t dest, const std::string& str)
+{
+    if(!replay_.IsRecording())
+        return;
+    AddRecord(gf, recordedSize_);
+    replay_.AddChatCommand(gf, player, dest, str);
+    recordedSize_ = replay_.GetFile().Tell();
+}
+
+void SpectatorRelay::AddGameCommand(unsigned gf, uint8_t player, const PlayerGameCommands& cmds)
+{
+    if(!replay_.IsRecording())
+        return;
+    AddRecord(gf, recordedSize_);
+    replay_.AddGameCommand(gf, player, cmds);
+    recordedSize_ = replay_.GetFile().Tell();
+}
+
+void SpectatorRelay::AddRecord(unsigned gf, unsigned offset)
+{
+    // Commands must be recorded in order, the offsets are searched by GF
+    RTTR_Assert(records_.empty() || records_.back().first <= gf);
+    records_.emplace_back(gf, offset);
+}
+
+bool SpectatorRelay::IsSnapshotDue(unsigned gf) const
+{
+    return replay_.IsRecording() && isSnapshotRequested_ && gf > lastSnapshotGF_;
+}
+
+void SpectatorRelay::AddSnapshot(std::unique_ptr<Savegame> savegame)
+{
+    isSnapshotRequested_ = false;
+    if(!savegame)
+        return;
+    const unsigned startGF = savegame->start_gf;
+    if(!replay_.IsRecording() || startGF <= lastSnapshotGF_)
+        return;
+    lastSnapshotGF_ = startGF;
+
+    // The header of a replay starting with the snapshot. The commands are taken from the recorded stream
+    Replay snapshotReplay;
+    for(unsigned i = 0; i < savegame->GetNumPlayers(); ++i)
+        snapshotReplay.AddPlayer(savegame->GetPlayer(i));
+    snapshotReplay.ggs = savegame->ggs;
+    MapInfo mapInfo;
+    mapInfo.type = MAPTYPE_SAVEGAME;
+    mapInfo.title = mapTitle_;
+    mapInfo.filepath = filepath_;
+    mapInfo.savegame = std::move(savegame);
+
+    bfs::path tmpFilepath = filepath_;
+    tmpFilepath += ".snapshot";
+    if(!snapshotReplay.StartRecording(tmpFilepath, mapInfo))
+    {
+        LOG.write("SERVER: Could not write spectator snapshot to %1%\n") % tmpFilepath;
+        return;
+    }
+    auto header = std::make_shared<std::vector<char>>(snapshotReplay.GetFile().Tell());
+    snapshotReplay.StopRecording();
+    {
+        boost::nowide::ifstream file(tmpFilepath, std::ios::binary);
+        file.read(header->data(), header->size());
+        if(static_cast<size_t>(file.gcount()) != header->size())
+            header.reset();
+    }
+    boost::system::error_code ec;
+    bfs::remove(tmpFilepath, ec);
+    if(!header)
+    {
+        LOG.write("SERVER: Could not read spectator snapshot from %1%\n") % tmpFilepath;
+        return;
+    }
+    // Offset gets determined when the snapshot is older than the delay and all commands for earlier GFs are recorded
+    pendingSnapshots_.push_back(StreamStart{startGF, std::move(header), 0});
+}
+
+void SpectatorRelay::Run(unsigned currentGF)
+{
+    if(!isRunning_)
+        return;
+    AcceptSpectators(currentGF);
+    CheckConnections();
+    if(!replay_.IsRecording())
+        return;
+
+    if(currentGF != lastUpdatedGF_)
+    {
+        replay_.UpdateLastGF(currentGF);
+        lastUpdatedGF_ = currentGF;
+    }
+
+    // Commands are added at the current GF, so all commands for GFs before endGF are complete
+    const unsigned endGF = (currentGF > delayGFs_) ? currentGF - delayGFs_ : 0;
+    // New spectators start at the newest snapshot that is older than the delay
+    while(!pendingSnapshots_.empty() && pendingSnapshots_.front().startGF <= endGF)
+    {
+        curStart_ = pendingSnapshots_.front();
+        curStart_.recordsOffset = GetRecordsOffset(curStart_.startGF);
+        pendingSnapshots_.erase(pendingSnapshots_.begin());
+    }
+    // Start spectators waiting for a snapshot once there is none in progress anymore
+    if(!isSnapshotRequested_ && pendingSnapshots_.empty())
+    {
+        for(Spectator& spectator : spectators_)
+        {
+            if(!spectator.header && spectator.connection.socket.isValid())
+                StartSpectator(spectator);
+        }
+    }
+    const unsigned endOffset = GetRecordsOffset(endGF);
+
+    SocketSet set;
+    bool hasSockets = false;
+    for(Spectator& spectator : spectators_)
+    {
+        while(spectator.connection.sendQueue.size() < SPECTATOR_MAX_QUEUED_MSGS
+              && QueueNextData(spectator, endGF, endOffset))
+        {}
+        if(!spectator.connection.sendQueue.empty())
+        {
+            set.Add(spectator.connection.socket);
+            hasSockets = true;
+        }
+    }
+    // Only send to spectators that can take the data, so a slow one never blocks the game
+    if(hasSockets && set.Select(0, 1) > 0)
+    {
+        for(Spectator& spectator : spectators_)
+        {
+            if(set.InSet(spectator.connection.socket) && !spectator.connection.sendMsgs(1))
+            {
+                LOG.write("SERVER: Sending to spectator %1% failed\n") % spectator.connection.playerId;
+                spectator.connection.closeConnection();
+            }
+        }
+    }
+    helpers::remove_if(spectators_, [](const Spectator& spectator) { return !spectator.connection.socket.isValid(); });
+}
+
+void SpectatorRelay::AcceptSpectators(unsigned currentGF)
+{
+    SocketSet set;
+    set.Add(serverSocket_);
+    if(set.Select(0, 0) <= 0)
+        return;
+    Socket socket = serverSocket_.Accept();
+    if(!socket.isValid())
+        return;
+    // Nothing to watch yet
+    if(!curStart_.header)
+    {
+        socket.Close();
+        return;
+    }
+    spectators_.emplace_back(nextSpectatorId_++);
+    Spectator& spectator = spectators_.back();
+    spectator.connection.socket = socket;
+    // Let the spectator wait for a new snapshot instead of fast forwarding over a long time
+    if(replay_.IsRecording() && currentGF >= lastSnapshotGF_ + SPECTATOR_SNAPSHOT_INTERVAL)
+        isSnapshotRequested_ = true;
+    if(isSnapshotRequested_ || !pendingSnapshots_.empty())
+        LOG.write(_("SERVER: Spectator %1% connected. Waiting for a snapshot\n")) % spectator.connection.playerId;
+    else
+        StartSpectator(spectator);
+}
+
+void SpectatorRelay::StartSpectator(Spectator& spectator)
+{
+    spectator.header = curStart_.header;
+    spectator.numHeaderBytesSent = 0;
+    spectator.recordsOffset = curStart_.recordsOffset;
+    spectator.endGF = curStart_.startGF;
+    spectator.connection.sendMsgAsync(new GameMessage_Spectator_Start(curStart_.header->size(), curStart_.startGF));
+    LOG.write(_("SERVER: Sending the stream to spectator %1% starting at GF %2%\n")) % spectator.connection.playerId
+      % curStart_.startGF;
+}
+
+void SpectatorRelay::CheckConnections()
+{
+    if(spectators_.empty())
+        return;
+    SocketSet set;
+    for(const Spectator& spectator : spectators_)
+        set.Add(spectator.connection.socket);
+    // Spectators do not send anything, so a readable socket means the connection was closed
+    if(set.Select(0, 0) > 0)
+    {
+        for(Spectator& spectator : spectators_)
+        {
+            if(!set.InSet(spectator.connection.socket))
+                continue;
+            if(spectator.connection.receiveMsgs())
+                spectator.connection.recvQueue.clear();
+            else
+            {
+                LOG.write(_("SERVER: Spectator %1% disconnected\n")) % spectator.connection.playerId;
+                spectator.connection.closeConnection();
+            }
+        }
+    }
+    set.Clear();
+    for(const Spectator& spectator : spectators_)
+        set.Add(spectator.connection.socket);
+    if(set.Select(0, 2) > 0)
+    {
+        for(Spectator& spectator : spectators_)
+        {
+            if(set.InSet(spectator.connection.socket))
+                spectator.connection.closeConnection();
+        }
+    }
+}
+
+bool SpectatorRelay::QueueNextData(Spectator& spectator, unsigned endGF, unsigned endOffset)
+{
+    NetworkPlayer& connection = spectator.connection;
+    if(!connection.socket.isValid() || !spectator.header)
+        return false;
+    if(spectator.numHeaderBytesSent < spectator.header->size())
+    {
+        const unsigned length =
+          std::min<unsigned>(spectator.header->size() - spectator.numHeaderBytesSent, SPECTATOR_PART_SIZE);
+        const auto itStart = spectator.header->begin() + spectator.numHeaderBytesSent;
+        connection.sendMsgAsync(
+          new GameMessage_Spectator_Data(spectator.endGF, std::vector<char>(itStart, itStart + length)));
+        spectator.numHeaderBytesSent += length;
+        return true;
+    }
+    if(spectator.recordsOffset >= endOffset)
+    {
+        // No new commands but the spectator can advance
+        if(spectator.endGF >= endGF)
+            return false;
+        spectator.endGF = endGF;
+        connection.sendMsgAsync(new GameMessage_Spectator_Data(endGF, std::vector<char>()));
+        return true;
+    }
+
+    // Only whole commands are sent. A single big command is sent even if it exceeds the part size
+    unsigned partEnd = endOffset;
+    unsigned partEndGF = endGF;
+    if(endOffset - spectator.recordsOffset > SPECTATOR_PART_SIZE)
+    {
+        auto itEnd = std::upper_bound(records_.begin(), records_.end(), spectator.recordsOffset + SPECTATOR_PART_SIZE,
+                                      [](unsigned offset, const auto& record) { return offset < record.second; });
+        RTTR_Assert(itEnd != records_.begin());
+        if(std::prev(itEnd)->second > spectator.recordsOffset)
+            --itEnd;
+        if(itEnd != records_.end() && itEnd->second < endOffset)
+        {
+            partEnd = itEnd->second;
+            // Commands for this GF might follow in the next part
+            partEndGF = itEnd->first;
+        }
+    }
+    std::vector<char> data = ReadRecordedData(spectator.recordsOffset, partEnd - spectator.recordsOffset);
+    if(data.size() != partEnd - spectator.recordsOffset)
+    {
+        LOG.write("SERVER: Could not read the spectator stream from %1%\n") % filepath_;
+        connection.closeConnection();
+        return false;
+    }
+    spectator.recordsOffset = partEnd;
+    spectator.endGF = partEndGF;
+    connection.sendMsgAsync(new GameMessage_Spectator_Data(partEndGF, std::move(data)));
+    return true;
+}
+
+unsigned SpectatorRelay::GetRecordsOffset(unsigned gf) const
+{
+    const auto it = std::lower_bound(records_.begin(), records_.end(), gf,
+                                     [](const auto& record, unsigned gf) { return record.first < gf; });
+    return (it == records_.end()) ? recordedSize_ : it->second;
+}
+
+std::vector<char> SpectatorRelay::ReadRecordedData(unsigned offset, unsigned length)
+{
+    std::vector<char> data(length);
+    // The file grows while reading, so reset the state of earlier reads
+    recordedFile_.clear();
+    recordedFile_.seekg(offset);
+    recordedFile_.read(data.data(), length);
+    data.resize(static_cast<size_t>(recordedFile_.gcount()));
+    return data;
+}
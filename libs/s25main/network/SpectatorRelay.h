@@ -0,0 +1,125 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "NetworkPlayer.h"
+#include "Replay.h"
+#include <boost/filesystem/path.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class MapInfo;
+class Savegame;
+struct PlayerGameCommands;
+
+/// Forwards the command stream of a running game to read-only observers (spectators) in the replay format.
+/// The stream is recorded as a regular replay on the server and spectators get the bytes of that file.
+/// Spectators are not part of the lockstep: They only get commands that are older than the configured delay and a slow
+/// spectator falls behind but never holds up the game.
+/// Late joining spectators start from the most recent snapshot of the game (if provided by the host) and catch up by
+/// fast forwarding. Snapshots are only requested when a spectator joins and the last one is too old, so a game without
+/// spectators never pays for them.
+class SpectatorRelay
+{
+public:
+    SpectatorRelay();
+    ~SpectatorRelay();
+
+    /// Listen for spectators on the given port. The stream lags delayGFs (at least 1) behind the game
+    bool Start(uint16_t port, bool ipv6, unsigned delayGFs);
+    void Stop();
+    bool IsRunning() const { return isRunning_; }
+
+    /// Replay used for recording the stream. Set players, settings and random_init before calling StartStream
+    Replay& GetReplay() { return replay_; }
+    /// Record the replay header at the given path. Must be called before adding commands
+    bool StartStream(const boost::filesystem::path& filepath, const MapInfo& mapInfo, unsigned startGF);
+
+    void AddChatCommand(unsigned gf, uint8_t player, uint8_t dest, const std::string& str);
+    void AddGameCommand(unsigned gf, uint8_t player, const PlayerGameCommands& cmds);
+
+    /// Return true if a new snapshot for a joining spectator should be made at the given GF
+    bool IsSnapshotDue(unsigned gf) const;
+    /// Add a snapshot of the game made at the start of its start GF (before the commands of that GF were executed).
+    /// Pass nullptr if the snapshot could not be made, so waiting spectators start from the last one
+    void AddSnapshot(std::unique_ptr<Savegame> savegame);
+
+    /// Accept new spectators and send them the stream up to the current GF minus the delay
+    void Run(unsigned currentGF);
+    unsigned GetNumSpectators() const { return spectators_.size(); }
+
+private:
+    /// Start of a stream: The header followed by the recorded commands starting at recordsOffset
+    struct StreamStart
+    {
+        unsigned startGF;
+        std::shared_ptr<const std::vector<char>> header;
+        unsigned recordsOffset;
+    };
+    struct Spectator
+    {
+        NetworkPlayer connection;
+        /// Header of the stream. Not set while waiting for a snapshot
+        std::shared_ptr<const std::vector<char>> header;
+        unsigned numHeaderBytesSent;
+        /// Position in the recorded file up to which the stream was sent
+        unsigned recordsOffset;
+        /// Last GF sent as the end of the received commands
+        unsigned endGF;
+        explicit Spectator(unsigned id);
+    };
+
+    void AcceptSpectators(unsigned currentGF);
+    /// Start sending the stream beginning at the current start to the spectator
+    void StartSpectator(Spectator& spectator);
+    /// Close the connections of spectators that disconnected
+    void CheckConnections();
+    /// Queue the next part of the stream. Return false if there is nothing to send
+    bool QueueNextData(Spectator& spectator, unsigned endGF, unsigned endOffset);
+    /// Get the offset of the first command for the GF or a later one. Commands added later will also be after this
+    unsigned GetRecordsOffset(unsigned gf) const;
+    std::vector<char> ReadRecordedData(unsigned offset, unsigned length);
+    void AddRecord(unsigned gf, unsigned offset);
+
+    bool isRunning_;
+    unsigned delayGFs_;
+    Socket serverSocket_;
+    std::vector<Spectator> spectators_;
+    unsigned nextSpectatorId_;
+
+    Replay replay_;
+    boost::filesystem::path filepath_;
+    std::string mapTitle_;
+    /// Recorded file opened for reading the data sent to the spectators
+    boost::nowide::ifstream recordedFile_;
+    /// GF and file offset of each recorded command
+    std::vector<std::pair<unsigned, unsigned>> records_;
+    /// Number of bytes recorded (and flushed) so far
+    unsigned recordedSize_;
+    /// Start of the stream for newly connecting spectators
+    StreamStart curStart_;
+    /// Snapshots that are not older than the delay yet
+    std::vector<StreamStart> pendingSnapshots_;
+    unsigned lastSnapshotGF_;
+    /// A spectator is waiting for a new snapshot
+    bool isSnapshotRequested_;
+    unsigned lastUpdatedGF_;
+};
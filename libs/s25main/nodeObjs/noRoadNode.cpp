@@ -113,11 +113,12 @@ void noRoadNode::DestroyRoad(const Direction dir)
 
     SetRoute(dir, nullptr);
 
+    const unsigned routeId = route->GetObjId();
     route->Destroy();
     delete route;
 
     // Spieler Bescheid sagen
-    gwg->GetPlayer(player).RoadDestroyed();
+    gwg->GetPlayer(player).RoadDestroyed(routeId);
 }
 
 /// Vernichtet Alle Straße um diesen Knoten
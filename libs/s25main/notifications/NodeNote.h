@@ -29,6 +29,7 @@ struct NodeNote
         Altitude, // Nodes altitude was changed
         BQ,       // Building quality
         Owner,
+        Passability, // Object or road changed which may block or free paths
     };
 
     NodeNote(Type type, const MapPoint& pt) : type(type), pos(pt) {}
@@ -19,20 +19,59 @@
 #include "openglCfg.hpp"
 #include <s25util/warningSuppression.h>
 #include <glad/glad.h>
+#include <algorithm>
+#include <map>
 
 namespace rttrOglMock {
 RTTR_IGNORE_DIAGNOSTIC("-Wmissing-declarations")
 
+// Keep the uploaded texture data so tests can check it
+std::map<GLuint, DummyRenderer::TextureData> textureData;
+GLuint boundTexture = 0;
+
 void APIENTRY glGenTextures(GLsizei n, GLuint* textures)
 {
     static GLuint cur = 0;
     for(; n > 0; --n)
         *(textures++) = ++cur;
 }
-void APIENTRY glDeleteTextures(GLsizei, const GLuint*) {}
-void APIENTRY glBindTexture(GLenum, GLuint) {}
+void APIENTRY glDeleteTextures(GLsizei n, const GLuint* textures)
+{
+    for(; n > 0; --n)
+        textureData.erase(*(textures++));
+}
+void APIENTRY glBindTexture(GLenum, GLuint texture)
+{
+    boundTexture = texture;
+}
 void APIENTRY glTexParameteri(GLenum, GLenum, GLint) {}
-void APIENTRY glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid*) {}
+void APIENTRY glTexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum, GLenum,
+                           const GLvoid* pixels)
+{
+    DummyRenderer::TextureData& data = textureData[boundTexture];
+    data.size = Extent(width, height);
+    data.pixels.assign(static_cast<size_t>(width) * height * 4u, 0);
+    if(pixels)
+    {
+        const auto* src = static_cast<const uint8_t*>(pixels);
+        std::copy(src, src + data.pixels.size(), data.pixels.begin());
+    }
+}
+void APIENTRY glTexSubImage2D(GLenum, GLint, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum,
+                              GLenum, const GLvoid* pixels)
+{
+    DummyRenderer::TextureData& data = textureData[boundTexture];
+    RTTR_Assert(xoffset >= 0 && yoffset >= 0);
+    RTTR_Assert(static_cast<unsigned>(xoffset + width) <= data.size.x);
+    RTTR_Assert(static_cast<unsigned>(yoffset + height) <= data.size.y);
+    const auto* src = static_cast<const uint8_t*>(pixels);
+    for(GLsizei y = 0; y < height; y++)
+    {
+        const uint8_t* srcRow = src + static_cast<size_t>(y) * width * 4u;
+        const size_t dstOffset = (static_cast<size_t>(yoffset + y) * data.size.x + xoffset) * 4u;
+        std::copy(srcRow, srcRow + width * 4u, data.pixels.begin() + dstOffset);
+    }
+}
 void APIENTRY glClear(GLbitfield) {}
 void APIENTRY glVertexPointer(GLint, GLenum, GLsizei, const GLvoid*) {}
 void APIENTRY glTexCoordPointer(GLint, GLenum, GLsizei, const GLvoid*) {}
@@ -55,6 +94,7 @@ bool DummyRenderer::initOpenGL(OpenGL_Loader_Proc)
     MOCK(glBindTexture);
     MOCK(glTexParameteri);
     MOCK(glTexImage2D);
+    MOCK(glTexSubImage2D);
     MOCK(glClear);
     MOCK(glVertexPointer);
     MOCK(glTexCoordPointer);
@@ -63,3 +103,9 @@ bool DummyRenderer::initOpenGL(OpenGL_Loader_Proc)
     MOCK(glGetTexLevelParameteriv);
     return true;
 }
+
+const DummyRenderer::TextureData* DummyRenderer::getTextureData(unsigned texture)
+{
+    const auto it = rttrOglMock::textureData.find(texture);
+    return it == rttrOglMock::textureData.end() ? nullptr : &it->second;
+}
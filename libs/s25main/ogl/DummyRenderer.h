@@ -18,6 +18,8 @@
 #pragma once
 
 #include "IRenderer.h"
+#include <cstdint>
+#include <vector>
 
 class glArchivItem_Bitmap;
 
@@ -31,4 +33,13 @@ public:
     {}
     void DrawRect(const Rect&, unsigned) override {}
     void DrawLine(DrawPoint, DrawPoint, unsigned, unsigned) override {}
+
+    /// Content of a texture as uploaded to the mocked OpenGL functions (4 bytes per pixel)
+    struct TextureData
+    {
+        Extent size;
+        std::vector<uint8_t> pixels;
+    };
+    /// Return the content of the texture or nullptr if it has no content
+    static const TextureData* getTextureData(unsigned texture);
 };
@@ -19,6 +19,7 @@
 
 #include "Rect.h"
 #include "glArchivItem_Bitmap.h"
+#include <vector>
 
 namespace libsiedler2 {
 struct ColorBGRA;
@@ -34,7 +35,7 @@ public:
 
     /// Call before updating texture
     void beginUpdate();
-    /// Call after updating texture
+    /// Call after updating texture. Uploads only the changed parts of each tile
     void endUpdate();
     /// Updates a pixels color
     void updatePixel(const DrawPoint& pos, const libsiedler2::ColorBGRA& clr);
@@ -45,6 +46,14 @@ public:
     int write(std::ostream& /*file*/, const libsiedler2::ArchivItem_Palette* /*palette*/) const override { return 254; }
 
 private:
+    /// Size of the tiles for which the changed area is tracked separately
+    static constexpr unsigned TILE_SIZE = 64;
+
+    /// Extend the changed area of the tile containing pos
+    void markDirty(const DrawPoint& pos);
+
     bool isUpdating_;
-    Rect areaToUpdate_;
+    /// Changed area per tile (empty if unchanged), row-major
+    std::vector<Rect> dirtyAreas_;
+    unsigned numTilesX_;
 };
@@ -28,7 +28,9 @@
 #include "libsiedler2/libsiedler2.h"
 #include "s25util/utf8.h"
 #include <boost/algorithm/string.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/nowide/detail/utf.hpp>
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -143,52 +145,69 @@ void glFont::AddCharInfo(char32_t c, const CharInfo& info)
 /**
  *  @brief fügt ein einzelnes Zeichen zur Zeichenliste hinzu
  */
-inline void glFont::DrawChar(char32_t curChar, VertexArrays& vertices, DrawPoint& curPos) const
+inline void glFont::DrawChar(char32_t curChar, glTextLayout& layout, DrawPoint& curPos) const
 {
     CharInfo ci = GetCharInfo(curChar);
 
     GlPoint texCoord1(ci.pos);
     GlPoint texCoord2(ci.pos + DrawPoint(ci.width, maxCharSize.y));
 
-    vertices.texCoords.push_back(texCoord1);
-    vertices.texCoords.push_back(GlPoint(texCoord1.x, texCoord2.y));
-    vertices.texCoords.push_back(texCoord2);
-    vertices.texCoords.push_back(GlPoint(texCoord2.x, texCoord1.y));
+    layout.texCoords.push_back(texCoord1);
+    layout.texCoords.push_back(GlPoint(texCoord1.x, texCoord2.y));
+    layout.texCoords.push_back(texCoord2);
+    layout.texCoords.push_back(GlPoint(texCoord2.x, texCoord1.y));
 
     GlPoint curPos1(curPos);
     GlPoint curPos2(curPos + DrawPoint(ci.width, maxCharSize.y));
 
-    vertices.vertices.push_back(curPos1);
-    vertices.vertices.push_back(GlPoint(curPos1.x, curPos2.y));
-    vertices.vertices.push_back(curPos2);
-    vertices.vertices.push_back(GlPoint(curPos2.x, curPos1.y));
+    layout.vertices.push_back(curPos1);
+    layout.vertices.push_back(GlPoint(curPos1.x, curPos2.y));
+    layout.vertices.push_back(curPos2);
+    layout.vertices.push_back(GlPoint(curPos2.x, curPos1.y));
 
     curPos.x += ci.width;
 }
 
-/**
- *  Zeichnet einen Text.
- *
- *  @param[in] x      X-Koordinate
- *  @param[in] y      Y-Koordinate
- *  @param[in] text   Der Text
- *  @param[in] format Format des Textes (verodern)
- *                      @p FontStyle::LEFT    - Text links ( standard )
- *                      @p FontStyle::CENTER  - Text mittig
- *                      @p FontStyle::RIGHT   - Text rechts
- *                      @p FontStyle::TOP     - Text oben ( standard )
- *                      @p FontStyle::VCENTER - Text vertikal zentriert
- *                      @p FontStyle::BOTTOM  - Text unten
- *  @param[in] color  Farbe des Textes
- *  @param[in] length Länge des Textes
- *  @param[in] max    maximale Länge
- *  @param     end    Suffix for displaying a truncation of the text (...)
- */
-void glFont::Draw(DrawPoint pos, const std::string& text, FontStyle format, unsigned color, unsigned short maxWidth,
-                  const std::string& end) const
+size_t glFont::LayoutKeyHasher::operator()(const LayoutKey& key) const
+{
+    size_t seed = std::hash<std::string>()(key.text);
+    boost::hash_combine(seed, key.end);
+    boost::hash_combine(seed, key.maxWidth);
+    return seed;
+}
+
+std::shared_ptr<const glTextLayout> glFont::GetLayout(const std::string& text, unsigned short maxWidth,
+                                                      const std::string& end) const
+{
+    // end is unused without a width limit
+    LayoutKey key{text, maxWidth == 0xFFFF ? std::string() : end, maxWidth};
+    auto it = layoutCache.find(key);
+    if(it != layoutCache.end())
+    {
+        // Move to front
+        layoutLRU.splice(layoutLRU.begin(), layoutLRU, it->second.itLRU);
+        return it->second.layout;
+    }
+    if(layoutCache.size() >= MAX_CACHED_LAYOUTS)
+    {
+        // Pointer refers to the key inside the element, so use the iterator for erasing
+        layoutCache.erase(layoutCache.find(*layoutLRU.back()));
+        layoutLRU.pop_back();
+    }
+    std::shared_ptr<const glTextLayout> layout = CreateLayout(key.text, key.maxWidth, key.end);
+    it = layoutCache.emplace(std::move(key), CachedLayout{layout, layoutLRU.end()}).first;
+    // Keys of unordered_map elements are stable, so we can refer to them
+    layoutLRU.push_front(&it->first);
+    it->second.itLRU = layoutLRU.begin();
+    return layout;
+}
+
+std::shared_ptr<glTextLayout> glFont::CreateLayout(const std::string& text, unsigned short maxWidth,
+                                                   const std::string& end) const
 {
     RTTR_Assert(s25util::isValidUTF8(text));
 
+    auto layout = std::make_shared<glTextLayout>();
     unsigned maxNumChars;
     unsigned short textWidth;
     bool drawEnd;
@@ -207,7 +226,7 @@ void glFont::Draw(DrawPoint pos, const std::string& text, FontStyle format, unsi
 
             // If "end" does not fit, draw nothing
             if(textWidth < endWidth)
-                return;
+                return layout;
 
             // Wieviele Buchstaben gehen in den "Rest" (ohne "end")
             textWidth = getWidth(text, textWidth - endWidth, &maxNumChars) + endWidth;
@@ -217,27 +236,15 @@ void glFont::Draw(DrawPoint pos, const std::string& text, FontStyle format, unsi
     }
 
     if(maxNumChars == 0)
-        return;
+        return layout;
     const auto itEnd = text.cbegin() + maxNumChars;
 
-    // Vertical alignment (assumes 1 line only!)
-    if(format.is(FontStyle::BOTTOM))
-        pos.y -= maxCharSize.y;
-    else if(format.is(FontStyle::VCENTER))
-        pos.y -= maxCharSize.y / 2;
-    // Horizontal alignment
-    if(format.is(FontStyle::RIGHT))
-        pos.x -= textWidth;
-    else if(format.is(FontStyle::CENTER))
-        pos.x -= textWidth / 2;
-
-    texList.texCoords.clear();
-    texList.vertices.clear();
-
+    layout->width = textWidth;
+    DrawPoint pos(0, 0);
     for(auto it = text.begin(); it != itEnd;)
     {
         const utf::code_point curChar = utf8::decode(it, itEnd);
-        DrawChar(curChar, texList, pos);
+        DrawChar(curChar, *layout, pos);
     }
 
     if(drawEnd)
@@ -245,29 +252,80 @@ void glFont::Draw(DrawPoint pos, const std::string& text, FontStyle format, unsi
         for(auto it = end.begin(); it != end.end();)
         {
             const utf::code_point curChar = utf8::decode(it, end.end());
-            DrawChar(curChar, texList, pos);
+            DrawChar(curChar, *layout, pos);
         }
     }
+    RTTR_Assert(layout->texCoords.size() == layout->vertices.size());
+    RTTR_Assert(layout->texCoords.size() % 4u == 0);
+    return layout;
+}
+
+/**
+ *  Zeichnet einen Text.
+ *
+ *  @param[in] x      X-Koordinate
+ *  @param[in] y      Y-Koordinate
+ *  @param[in] text   Der Text
+ *  @param[in] format Format des Textes (verodern)
+ *                      @p FontStyle::LEFT    - Text links ( standard )
+ *                      @p FontStyle::CENTER  - Text mittig
+ *                      @p FontStyle::RIGHT   - Text rechts
+ *                      @p FontStyle::TOP     - Text oben ( standard )
+ *                      @p FontStyle::VCENTER - Text vertikal zentriert
+ *                      @p FontStyle::BOTTOM  - Text unten
+ *  @param[in] color  Farbe des Textes
+ *  @param[in] length Länge des Textes
+ *  @param[in] max    maximale Länge
+ *  @param     end    Suffix for displaying a truncation of the text (...)
+ */
+void glFont::Draw(DrawPoint pos, const std::string& text, FontStyle format, unsigned color, unsigned short maxWidth,
+                  const std::string& end) const
+{
+    if(text.empty())
+        return;
+    Draw(pos, *GetLayout(text, maxWidth, end), format, color);
+}
 
-    if(texList.vertices.empty())
+void glFont::Draw(DrawPoint pos, const glTextLayout& layout, FontStyle format, unsigned color) const
+{
+    if(layout.empty())
         return;
 
+    // Vertical alignment (assumes 1 line only!)
+    if(format.is(FontStyle::BOTTOM))
+        pos.y -= maxCharSize.y;
+    else if(format.is(FontStyle::VCENTER))
+        pos.y -= maxCharSize.y / 2;
+    // Horizontal alignment
+    if(format.is(FontStyle::RIGHT))
+        pos.x -= layout.width;
+    else if(format.is(FontStyle::CENTER))
+        pos.x -= layout.width / 2;
+
     // Get texture first as it might need to be created
     glArchivItem_Bitmap& usedFont = format.is(FontStyle::NO_OUTLINE) ? *fontNoOutline : *fontWithOutline;
     unsigned texture = usedFont.GetTexture();
     if(!texture)
         return;
-    const GlPoint texSize(usedFont.GetTexSize());
-    RTTR_Assert(texList.texCoords.size() == texList.vertices.size());
-    RTTR_Assert(texList.texCoords.size() % 4u == 0);
-    for(GlPoint& pt : texList.texCoords)
-        pt /= texSize;
-
-    glVertexPointer(2, GL_FLOAT, 0, &texList.vertices[0]);
-    glTexCoordPointer(2, GL_FLOAT, 0, &texList.texCoords[0]);
+    // Both font textures have the same size, so this is only done once per layout
+    const Extent texSize = usedFont.GetTexSize();
+    if(layout.normTexSize != texSize)
+    {
+        const GlPoint glTexSize(texSize);
+        layout.normTexCoords.resize(layout.texCoords.size());
+        std::transform(layout.texCoords.begin(), layout.texCoords.end(), layout.normTexCoords.begin(),
+                       [glTexSize](const GlPoint& pt) { return pt / glTexSize; });
+        layout.normTexSize = texSize;
+    }
+
+    glPushMatrix();
+    glTranslatef(static_cast<GLfloat>(pos.x), static_cast<GLfloat>(pos.y), 0.f);
+    glVertexPointer(2, GL_FLOAT, 0, &layout.vertices[0]);
+    glTexCoordPointer(2, GL_FLOAT, 0, &layout.normTexCoords[0]);
     VIDEODRIVER.BindTexture(texture);
     glColor4ub(GetRed(color), GetGreen(color), GetBlue(color), GetAlpha(color));
-    glDrawArrays(GL_QUADS, 0, texList.vertices.size());
+    glDrawArrays(GL_QUADS, 0, layout.vertices.size());
+    glPopMatrix();
 }
 
 template<bool T_limitWidth>
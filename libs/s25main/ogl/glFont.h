@@ -24,15 +24,38 @@
 #include "s25util/colors.h"
 #include <glad/glad.h>
 #include <array>
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace libsiedler2 {
 class ArchivItem_Font;
 }
 
+/// Glyph quads of a single line of text relative to its top left corner as created by glFont::GetLayout
+class glTextLayout
+{
+public:
+    /// Width of the text in pixels
+    unsigned getWidth() const { return width; }
+    bool empty() const { return vertices.empty(); }
+
+private:
+    friend class glFont;
+    using GlPoint = Point<GLfloat>;
+
+    unsigned width = 0;
+    std::vector<GlPoint> vertices;
+    /// Texture coordinates in pixels
+    std::vector<GlPoint> texCoords;
+    /// Texture coordinates normalized for the texture size below. Calculated on first draw
+    mutable std::vector<GlPoint> normTexCoords;
+    mutable Extent normTexSize = Extent(0, 0);
+};
+
 class glFont
 {
 public:
@@ -44,6 +67,13 @@ public:
     /// appended (included in maxWidth)
     void Draw(DrawPoint pos, const std::string& text, FontStyle format, unsigned color = COLOR_WHITE,
               unsigned short maxWidth = 0xFFFF, const std::string& end = "...") const;
+    /// Draw a layout previously created by GetLayout at the given position with format (alignment) and color.
+    void Draw(DrawPoint pos, const glTextLayout& layout, FontStyle format, unsigned color = COLOR_WHITE) const;
+
+    /// Return the layout for drawing the text. Parameters are the same as for Draw.
+    /// The result is cached, so repeated calls with the same text are cheap
+    std::shared_ptr<const glTextLayout> GetLayout(const std::string& text, unsigned short maxWidth = 0xFFFF,
+                                                  const std::string& end = "...") const;
 
     /// Return the width of the drawn text. If maxWidth is given then the width will be <= maxWidth and maxNumChars will
     /// be set to the maximum number of chars (not glyphs!) that fit into the width
@@ -89,17 +119,35 @@ private:
         Position pos;
         unsigned width;
     };
-    using GlPoint = Point<GLfloat>;
-    struct VertexArrays
+    using GlPoint = glTextLayout::GlPoint;
+    struct LayoutKey
+    {
+        std::string text, end;
+        unsigned short maxWidth;
+        bool operator==(const LayoutKey& rhs) const
+        {
+            return maxWidth == rhs.maxWidth && text == rhs.text && end == rhs.end;
+        }
+    };
+    struct LayoutKeyHasher
+    {
+        size_t operator()(const LayoutKey& key) const;
+    };
+    struct CachedLayout
     {
-        std::vector<GlPoint> texCoords;
-        std::vector<GlPoint> vertices;
+        std::shared_ptr<const glTextLayout> layout;
+        /// Position in the LRU list
+        std::list<const LayoutKey*>::iterator itLRU;
     };
+    /// Maximum number of layouts kept per font
+    static constexpr unsigned MAX_CACHED_LAYOUTS = 1024;
 
     void AddCharInfo(char32_t c, const CharInfo& info);
     /// liefert das Char-Info eines Zeichens
     const CharInfo& GetCharInfo(char32_t c) const;
-    void DrawChar(char32_t curChar, VertexArrays& vertices, DrawPoint& curPos) const;
+    void DrawChar(char32_t curChar, glTextLayout& layout, DrawPoint& curPos) const;
+    std::shared_ptr<glTextLayout> CreateLayout(const std::string& text, unsigned short maxWidth,
+                                               const std::string& end) const;
 
     Extent maxCharSize; // How big each char is at most (aka dx,dy)
     std::unique_ptr<glArchivItem_Bitmap> fontNoOutline;
@@ -108,8 +156,10 @@ private:
     /// Holds ascii chars only. As most chars are ascii this is faster then accessing the map
     std::array<std::pair<bool, CharInfo>, 256> asciiMapping;
     std::map<char32_t, CharInfo> utf8_mapping;
-    CharInfo placeHolder;         /// Placeholder if glyph is missing
-    mutable VertexArrays texList; /// Buffer to hold last textures. Used so memory reallocations are avoided
+    CharInfo placeHolder; /// Placeholder if glyph is missing
+    /// Cache of created layouts. Least recently used ones are at the end of the LRU list and removed first
+    mutable std::unordered_map<LayoutKey, CachedLayout, LayoutKeyHasher> layoutCache;
+    mutable std::list<const LayoutKey*> layoutLRU;
 
     /// Get width of the sequence defined by the begin/end pair of iterators
     template<bool T_unlimitedWidth>
@@ -114,9 +114,13 @@ void glSmartBitmap::calcDimensions()
 
 void glSmartBitmap::drawTo(libsiedler2::PixelBufferBGRA& buffer, const Extent& bufOffset) const
 {
-    libsiedler2::ArchivItem_Palette* p_colors = LOADER.GetPaletteN("colors");
-    libsiedler2::ArchivItem_Palette* p_5 = LOADER.GetPaletteN("pal5");
+    drawTo(buffer, bufOffset, LOADER.GetPaletteN("colors"), LOADER.GetPaletteN("pal5"));
+}
 
+void glSmartBitmap::drawTo(libsiedler2::PixelBufferBGRA& buffer, const Extent& bufOffset,
+                           const libsiedler2::ArchivItem_Palette* p_colors,
+                           const libsiedler2::ArchivItem_Palette* p_5) const
+{
     for(const glBitmapItem& bmpItem : items)
     {
         if((bmpItem.size.x == 0) || (bmpItem.size.y == 0))
@@ -25,6 +25,7 @@
 namespace libsiedler2 {
 class baseArchivItem_Bitmap;
 class ArchivItem_Bitmap_Player;
+class ArchivItem_Palette;
 class PixelBufferBGRA;
 } // namespace libsiedler2
 
@@ -76,6 +77,10 @@ public:
     void drawPercent(DrawPoint drawPt, unsigned percent, unsigned color = 0xFFFFFFFF, unsigned player_color = 0);
     /// Draw the bitmap(s) to the specified buffer at the position starting at bufOffset (must be positive)
     void drawTo(libsiedler2::PixelBufferBGRA& buffer, const Extent& bufOffset = Extent(0, 0)) const;
+    /// Same as above but with the given palettes for player bitmaps and the other bitmaps instead of the loaded ones.
+    /// Does not access the loader, so this can be used to draw different bitmaps in parallel
+    void drawTo(libsiedler2::PixelBufferBGRA& buffer, const Extent& bufOffset,
+                const libsiedler2::ArchivItem_Palette* playerPal, const libsiedler2::ArchivItem_Palette* pal) const;
 
     void add(libsiedler2::baseArchivItem_Bitmap* bmp, bool transferOwnership = false);
     void add(libsiedler2::ArchivItem_Bitmap_Player* bmp, bool transferOwnership = false);
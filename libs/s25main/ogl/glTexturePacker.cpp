@@ -17,15 +17,40 @@
 
 #include "glTexturePacker.h"
 #include "drivers/VideoDriverWrapper.h"
+#include "helpers/parallelFor.h"
 #include "ogl/glSmartBitmap.h"
 #include "ogl/glTexturePackerNode.h"
 #include "ogl/saveBitmap.h"
 #include "libsiedler2/PixelBufferBGRA.h"
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/nowide/fstream.hpp>
 #include <glad/glad.h>
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <memory>
 #include <utility>
 
+namespace {
+/// Identifier and version of the cache file format. Increase version on every change to the format or the packing
+constexpr uint32_t CACHE_MAGIC = 0x43545452; // "RTTC"
+constexpr uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader
+{
+    uint32_t magic, version;
+    uint64_t key;
+    uint32_t numItems, numTextures;
+};
+struct CacheItem
+{
+    uint32_t texIdx;
+    uint32_t width, height;
+    std::array<Point<float>, 8> texCoords;
+};
+} // namespace
+
 static bool isSizeGreater(glSmartBitmap* a, glSmartBitmap* b)
 {
     const Extent sizeA = a->getRequiredTexSize();
@@ -33,7 +58,9 @@ static bool isSizeGreater(glSmartBitmap* a, glSmartBitmap* b)
     return (sizeA.x * sizeA.y) > (sizeB.x * sizeB.y);
 }
 
-bool glTexturePacker::packHelper(std::vector<glSmartBitmap*>& list)
+bool glTexturePacker::packHelper(std::vector<glSmartBitmap*>& list, bool keepPixels,
+                                 const libsiedler2::ArchivItem_Palette* playerPal,
+                                 const libsiedler2::ArchivItem_Palette* pal)
 {
     glTexture texture;
 
@@ -73,48 +100,62 @@ bool glTexturePacker::packHelper(std::vector<glSmartBitmap*>& list)
 
             // list to store bitmaps we could not fit in our current texture
             std::vector<glSmartBitmap*> left;
-
-            libsiedler2::PixelBufferBGRA buffer(curSize.x, curSize.y);
+            // bitmaps with their position in the texture
+            std::vector<std::pair<glSmartBitmap*, Extent>> placed;
+            placed.reserve(list.size());
 
             // try storing bitmaps in the big texture
             for(glSmartBitmap* bmp : list)
             {
-                if(!root->insert(bmp, buffer, tmpVec))
+                Extent pos;
+                if(!root->insert(bmp, curSize, tmpVec, pos))
                 {
                     // inserting this bitmap failed? just remember it for next texture
                     left.push_back(bmp);
                 } else
-                {
-                    // tell or glSmartBitmap, that it uses a shared texture (so it won't try to delete/free it)
-                    bmp->setSharedTexture(texture.get());
-                }
-            }
-            if((false))
-            {
-                bfs::path outFilepath = std::to_string(texture.get()) + "-" + std::to_string(curSize.x) + "x"
-                                        + std::to_string(curSize.y) + ".bmp";
-                saveBitmap(buffer, outFilepath);
+                    placed.emplace_back(bmp, pos);
             }
             // free texture packer, as it is not needed any more
             root->destroy(list.size());
             root.reset();
 
-            if(!texture.uploadData(buffer))
-                return false;
-
-            if(left.empty()) // nothing left, just generate texture and return success
-            {
-                textures.emplace_back(std::move(texture));
-                return true;
-            } else if(maxTex) // maximum texture size reached and something still left
+            if(left.empty() || maxTex)
             {
+                libsiedler2::PixelBufferBGRA buffer(curSize.x, curSize.y);
+                // Composing the bitmaps is the expensive part and each one is drawn to a distinct area of the buffer
+                // so do this in parallel
+                helpers::parallelFor(placed.size(), [&placed, &buffer, playerPal, pal](size_t i) {
+                    placed[i].first->drawTo(buffer, placed[i].second, playerPal, pal);
+                });
+                for(const auto& bmpAndPos : placed)
+                {
+                    // tell or glSmartBitmap, that it uses a shared texture (so it won't try to delete/free it)
+                    bmpAndPos.first->setSharedTexture(texture.get());
+                }
+                if((false))
+                {
+                    bfs::path outFilepath = std::to_string(texture.get()) + "-" + std::to_string(curSize.x) + "x"
+                                            + std::to_string(curSize.y) + ".bmp";
+                    saveBitmap(buffer, outFilepath);
+                }
+
+                // Upload happens on this (the GL context) thread
+                if(!texture.uploadData(buffer))
+                    return false;
+
                 textures.emplace_back(std::move(texture));
-                // recursively generate textures for what is left
-                return packHelper(left);
+                if(keepPixels)
+                    texturePixels.emplace_back(std::move(buffer));
+
+                if(left.empty()) // nothing left, just generate texture and return success
+                    return true;
+                // maximum texture size reached and something still left
+                // -> recursively generate textures for what is left
+                return packHelper(left, keepPixels, playerPal, pal);
             }
 
             // our pre-estimated size if the big texture was not enough for the algorithm to fit all textures in
-            // delete buffer and try again with an increased big texture
+            // try again with an increased big texture
             left.clear();
         }
 
@@ -128,11 +169,16 @@ bool glTexturePacker::packHelper(std::vector<glSmartBitmap*>& list)
     } while(true);
 }
 
-bool glTexturePacker::pack()
+bool glTexturePacker::pack(bool keepPixels, const libsiedler2::ArchivItem_Palette* playerPal,
+                           const libsiedler2::ArchivItem_Palette* pal)
 {
-    std::sort(items.begin(), items.end(), isSizeGreater);
+    textures.clear();
+    texturePixels.clear();
+    // Stable sort so the result only depends on the order the items were added (required for the cache)
+    std::vector<glSmartBitmap*> sortedItems = items;
+    std::stable_sort(sortedItems.begin(), sortedItems.end(), isSizeGreater);
 
-    if(packHelper(items))
+    if(packHelper(sortedItems, keepPixels, playerPal, pal))
         return true;
 
     // reset glSmartBitmap textures
@@ -140,10 +186,136 @@ bool glTexturePacker::pack()
         bmp->setSharedTexture(0);
 
     textures.clear();
+    texturePixels.clear();
 
     return false;
 }
 
+bool glTexturePacker::saveCache(const boost::filesystem::path& filepath, uint64_t key) const
+{
+    if(textures.empty() || texturePixels.size() != textures.size())
+        return false;
+
+    CacheHeader header{CACHE_MAGIC, CACHE_VERSION, key, static_cast<uint32_t>(items.size()),
+                       static_cast<uint32_t>(textures.size())};
+    std::vector<CacheItem> cacheItems;
+    cacheItems.reserve(items.size());
+    for(const glSmartBitmap* bmp : items)
+    {
+        const auto itTex = std::find_if(textures.begin(), textures.end(),
+                                        [bmp](const glTexture& tex) { return tex.get() == bmp->getTexture(); });
+        if(itTex == textures.end())
+            return false;
+        const Extent size = bmp->getRequiredTexSize();
+        cacheItems.push_back(
+          CacheItem{static_cast<uint32_t>(itTex - textures.begin()), size.x, size.y, bmp->texCoords});
+    }
+
+    // Write to a temporary file first so an interrupted write never leaves a corrupt but valid looking cache
+    const boost::filesystem::path tmpFilepath = boost::filesystem::path(filepath).concat(".tmp");
+    {
+        boost::nowide::ofstream file(tmpFilepath, std::ios::binary);
+        if(!file)
+            return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for(const libsiedler2::PixelBufferBGRA& pixels : texturePixels)
+        {
+            const std::array<uint32_t, 2> size{{pixels.getWidth(), pixels.getHeight()}};
+            file.write(reinterpret_cast<const char*>(size.data()), sizeof(size));
+        }
+        file.write(reinterpret_cast<const char*>(cacheItems.data()),
+                   static_cast<std::streamsize>(cacheItems.size() * sizeof(CacheItem)));
+        for(const libsiedler2::PixelBufferBGRA& pixels : texturePixels)
+            file.write(reinterpret_cast<const char*>(pixels.getPixelPtr()),
+                       static_cast<std::streamsize>(pixels.getWidth()) * pixels.getHeight() * 4u);
+        if(!file)
+            return false;
+    }
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmpFilepath, filepath, ec);
+    return !ec;
+}
+
+bool glTexturePacker::loadCache(const boost::filesystem::path& filepath, uint64_t key)
+{
+    if(!boost::filesystem::exists(filepath))
+        return false;
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(filepath.string());
+    } catch(const std::exception&)
+    {
+        return false;
+    }
+    if(!file.is_open())
+        return false;
+
+    const char* curPos = file.data();
+    const char* const endPos = curPos + file.size();
+    const auto read = [&curPos, endPos](void* dst, size_t numBytes) {
+        if(static_cast<size_t>(endPos - curPos) < numBytes)
+            return false;
+        std::memcpy(dst, curPos, numBytes);
+        curPos += numBytes;
+        return true;
+    };
+
+    CacheHeader header;
+    if(!read(&header, sizeof(header)) || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION
+       || header.key != key || header.numItems != items.size() || header.numTextures == 0)
+        return false;
+    // Check the counts against the file size before allocating anything so a corrupt cache is just repacked
+    using TexSizeEntry = std::array<uint32_t, 2>;
+    const size_t remainingBytes = static_cast<size_t>(endPos - curPos);
+    if(header.numTextures > remainingBytes / sizeof(TexSizeEntry)
+       || header.numItems > (remainingBytes - header.numTextures * sizeof(TexSizeEntry)) / sizeof(CacheItem))
+        return false;
+    std::vector<Extent> texSizes(header.numTextures);
+    size_t totalPixelBytes = 0;
+    for(Extent& texSize : texSizes)
+    {
+        TexSizeEntry size;
+        if(!read(size.data(), sizeof(size)))
+            return false;
+        texSize = Extent(size[0], size[1]);
+        // Checked by division so neither the product nor the sum can overflow
+        if(texSize.x == 0 || texSize.y > (remainingBytes - totalPixelBytes) / 4u / texSize.x)
+            return false;
+        totalPixelBytes += static_cast<size_t>(texSize.x) * texSize.y * 4u;
+    }
+    std::vector<CacheItem> cacheItems(header.numItems);
+    if(!read(cacheItems.data(), cacheItems.size() * sizeof(CacheItem))
+       || static_cast<size_t>(endPos - curPos) != totalPixelBytes)
+        return false;
+    // Make sure the bitmaps are the same as when the cache was created
+    for(unsigned i = 0; i < items.size(); i++)
+    {
+        if(cacheItems[i].texIdx >= header.numTextures
+           || items[i]->getRequiredTexSize() != Extent(cacheItems[i].width, cacheItems[i].height))
+            return false;
+    }
+
+    // Upload the textures directly from the mapped file
+    std::vector<glTexture> newTextures;
+    for(const Extent& texSize : texSizes)
+    {
+        glTexture texture;
+        if(!texture.checkSize(texSize) || !texture.uploadData(texSize, curPos))
+            return false;
+        curPos += static_cast<size_t>(texSize.x) * texSize.y * 4u;
+        newTextures.emplace_back(std::move(texture));
+    }
+
+    textures = std::move(newTextures);
+    for(unsigned i = 0; i < items.size(); i++)
+    {
+        items[i]->setSharedTexture(textures[cacheItems[i].texIdx].get());
+        items[i]->texCoords = cacheItems[i].texCoords;
+    }
+    return true;
+}
+
 glTexture::glTexture() : handle(VIDEODRIVER.GenerateTexture()), size(0, 0)
 {
     if(!handle)
@@ -188,13 +360,17 @@ bool glTexture::checkSize(const Extent& size) const
 }
 
 bool glTexture::uploadData(const libsiedler2::PixelBufferBGRA& buffer)
+{
+    return uploadData(Extent(buffer.getWidth(), buffer.getHeight()), buffer.getPixelPtr());
+}
+
+bool glTexture::uploadData(const Extent& texSize, const void* pixels)
 {
     if(!handle)
         return false;
     VIDEODRIVER.BindTexture(handle);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, buffer.getWidth(), buffer.getHeight(), 0, GL_BGRA, GL_UNSIGNED_BYTE,
-                 buffer.getPixelPtr());
-    size = Extent(buffer.getWidth(), buffer.getHeight());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texSize.x, texSize.y, 0, GL_BGRA, GL_UNSIGNED_BYTE, pixels);
+    size = texSize;
     int resultWidth;
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &resultWidth);
     return resultWidth > 0;
@@ -18,12 +18,14 @@
 #pragma once
 
 #include "Point.h"
+#include "libsiedler2/PixelBufferBGRA.h"
+#include <boost/filesystem/path.hpp>
+#include <cstdint>
 #include <vector>
 
 class glSmartBitmap;
-
 namespace libsiedler2 {
-class PixelBufferBGRA;
+class ArchivItem_Palette;
 }
 
 class glTexture
@@ -46,6 +48,8 @@ public:
     void bind() const;
     bool checkSize(const Extent&) const;
     bool uploadData(const libsiedler2::PixelBufferBGRA&);
+    /// Upload BGRA data of the given size
+    bool uploadData(const Extent& texSize, const void* pixels);
 };
 
 class glTexturePacker
@@ -53,11 +57,28 @@ class glTexturePacker
 private:
     std::vector<glTexture> textures;
     std::vector<glSmartBitmap*> items;
+    /// Pixel data of the textures (only if requested in pack)
+    std::vector<libsiedler2::PixelBufferBGRA> texturePixels;
 
-    bool packHelper(std::vector<glSmartBitmap*>& list);
+    bool packHelper(std::vector<glSmartBitmap*>& list, bool keepPixels,
+                    const libsiedler2::ArchivItem_Palette* playerPal, const libsiedler2::ArchivItem_Palette* pal);
 
 public:
-    bool pack();
+    /// Pack all bitmaps into as few textures as possible.
+    /// If keepPixels is true the texture data is kept in memory so it can be saved with saveCache.
+    /// The palettes are used for paletted bitmaps (see glSmartBitmap::drawTo) and only required if there are any
+    bool pack(bool keepPixels = false, const libsiedler2::ArchivItem_Palette* playerPal = nullptr,
+              const libsiedler2::ArchivItem_Palette* pal = nullptr);
     void add(glSmartBitmap& bmp) { items.push_back(&bmp); }
     const auto& getTextures() const { return textures; }
+
+    /// Save the packed textures and the positions of all bitmaps to the file.
+    /// Requires a successful call to pack(true) before. The key identifies the source data of the bitmaps
+    bool saveCache(const boost::filesystem::path& filepath, uint64_t key) const;
+    /// Restore textures and positions of the bitmaps from a file created with saveCache instead of packing them.
+    /// The same bitmaps must have been added in the same order and the key must match.
+    /// Return false if the cache is missing or outdated in which case pack needs to be called
+    bool loadCache(const boost::filesystem::path& filepath, uint64_t key);
+    /// Free the pixel data kept by pack(true)
+    void releasePixels() { texturePixels.clear(); }
 };
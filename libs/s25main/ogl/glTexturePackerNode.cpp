@@ -17,10 +17,9 @@
 
 #include "glTexturePackerNode.h"
 #include "ogl/glSmartBitmap.h"
-#include "libsiedler2/PixelBufferBGRA.h"
 
-bool glTexturePackerNode::insert(glSmartBitmap* b, libsiedler2::PixelBufferBGRA& buffer,
-                                 std::vector<glTexturePackerNode*>& todo)
+bool glTexturePackerNode::insert(glSmartBitmap* b, const Extent& textureSize, std::vector<glTexturePackerNode*>& todo,
+                                 Extent& pos)
 {
     todo.clear();
 
@@ -50,10 +49,10 @@ bool glTexturePackerNode::insert(glSmartBitmap* b, libsiedler2::PixelBufferBGRA&
 
         if(texSize == current->size)
         {
-            b->drawTo(buffer, current->pos);
+            pos = current->pos;
             current->bmp = b;
 
-            const Point<float> bufferSize(buffer.getWidth(), buffer.getHeight());
+            const Point<float> bufferSize(textureSize);
             Extent currentSize(current->size);
             if(b->isPlayer())
                 currentSize.x /= 2;
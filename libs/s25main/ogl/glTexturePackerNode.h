@@ -21,9 +21,6 @@
 #include <vector>
 
 class glSmartBitmap;
-namespace libsiedler2 {
-class PixelBufferBGRA;
-} // namespace libsiedler2
 
 class glTexturePackerNode
 {
@@ -38,8 +35,9 @@ class glTexturePackerNode
 public:
     glTexturePackerNode() : pos(0, 0), size(0, 0), bmp(nullptr) { child[0] = child[1] = nullptr; }
     glTexturePackerNode(const Extent& size) : pos(0, 0), size(size), bmp(nullptr) { child[0] = child[1] = nullptr; }
-    /// Find a position in the buffer to draw the bitmap starting at this node
+    /// Find a position in a texture of the given size to put the bitmap to starting at this node
+    /// and set the texture coordinates of the bitmap accordingly. The bitmap must then be drawn at the returned position.
     /// todo list is cleared and used to avoid frequent allocations
-    bool insert(glSmartBitmap* b, libsiedler2::PixelBufferBGRA& buffer, std::vector<glTexturePackerNode*>& todo);
+    bool insert(glSmartBitmap* b, const Extent& textureSize, std::vector<glTexturePackerNode*>& todo, Extent& pos);
     void destroy(unsigned reserve = 0);
 };
@@ -45,6 +45,12 @@ public:
     template<class TNodeChecker>
     bool FindPath(MapPoint start, MapPoint dest, bool randomRoute, unsigned maxLength, std::vector<Direction>* route,
                   unsigned* length, Direction* firstDir, const TNodeChecker& nodeChecker);
+    /// Same as FindPath but with the given open list implementation, e.g. QueueImpl or BucketQueueImpl.
+    /// Only used for comparing them: They break ties differently, so switching would change the chosen paths
+    template<class T_OpenList, class TNodeChecker>
+    bool FindPathWithOpenList(MapPoint start, MapPoint dest, bool randomRoute, unsigned maxLength,
+                              std::vector<Direction>* route, unsigned* length, Direction* firstDir,
+                              const TNodeChecker& nodeChecker);
 
     bool FindPathAlternatingConditions(MapPoint start, MapPoint dest, bool randomRoute, unsigned maxLength,
                                        std::vector<Direction>* route, unsigned* length, Direction* firstDir,
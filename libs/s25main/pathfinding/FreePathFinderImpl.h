@@ -21,6 +21,7 @@
 #include "pathfinding/FreePathFinder.h"
 #include "pathfinding/NewNode.h"
 #include "pathfinding/OpenListBinaryHeap.h"
+#include "pathfinding/OpenListBucketQueue.h"
 #include "pathfinding/OpenListPrioQueue.h"
 #include "pathfinding/PathfindingPoint.h"
 #include "world/GameWorldBase.h"
@@ -47,20 +48,39 @@ struct GetEstimatedDistance
     unsigned operator()(const FreePathNode& lhs) const { return lhs.estimatedDistance; }
 };
 
+struct GetNodeIdx
+{
+    unsigned operator()(const FreePathNode& lhs) const { return lhs.idx; }
+};
+
 // using QueueImpl = OpenListPrioQueue<NewNode2*, NodePtrCmpGreater>;
+/// Open list used by the game. Stays the binary heap although the bucket queue is faster on long routes:
+/// The heap breaks ties between equal estimates by its layout, so the bucket queue picks other paths of the same
+/// length. This changes the game and makes replays of older versions run async.
+/// So switch only together with another change breaking them.
 using QueueImpl = OpenListBinaryHeap<FreePathNode, GetEstimatedDistance>;
+/// All edges cost 1 and the heuristic is consistent so the estimates are monotone. Same order as NodePtrCmpGreater
+using BucketQueueImpl = OpenListBucketQueue<FreePathNode, GetEstimatedDistance, GetNodeIdx>;
 
 template<class TNodeChecker>
 bool FreePathFinder::FindPath(const MapPoint start, const MapPoint dest, bool randomRoute, unsigned maxLength,
                               std::vector<Direction>* route, unsigned* length, Direction* firstDir,
                               const TNodeChecker& nodeChecker)
+{
+    return FindPathWithOpenList<QueueImpl>(start, dest, randomRoute, maxLength, route, length, firstDir, nodeChecker);
+}
+
+template<class T_OpenList, class TNodeChecker>
+bool FreePathFinder::FindPathWithOpenList(const MapPoint start, const MapPoint dest, bool randomRoute,
+                                          unsigned maxLength, std::vector<Direction>* route, unsigned* length,
+                                          Direction* firstDir, const TNodeChecker& nodeChecker)
 {
     RTTR_Assert(start != dest);
 
     // increase currentVisit, so we don't have to clear the visited-states at every run
     IncreaseCurrentVisit();
 
-    QueueImpl todo;
+    T_OpenList todo;
     const unsigned startId = gwb_.GetIdx(start);
     const unsigned destId = gwb_.GetIdx(dest);
     FreePathNode& startNode = fpNodes[startId];
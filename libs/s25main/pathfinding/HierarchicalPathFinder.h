@@ -0,0 +1,379 @@
+// Copyright (c) 2005 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "world/World.h"
+#include "gameTypes/Direction.h"
+#include "gameTypes/MapCoordinates.h"
+#include <boost/range/adaptor/reversed.hpp>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Hierarchical path finding (HPA*) for long free paths with the node and edge checks of T_Condition
+/// The map is divided into square sectors. Each sector stores transitions to its neighbours: Every usable edge crossing
+/// the sector border. Long queries search the graph of transitions first using the distances inside the sectors and
+/// then refine the result by searches restricted to single sectors.
+/// Every path can be split into parts inside single sectors joined by transitions and the distances inside the sectors
+/// are exact. So the paths found are shortest paths and if none is found there is none within the maximum length.
+/// All data is calculated from the current world on demand. Hence it must be told about every change T_Condition
+/// depends on (\ref MarkChanged) to stay a pure function of the world state.
+template<class T_Condition>
+class HierarchicalPathFinder
+{
+public:
+    static constexpr unsigned SECTOR_SIZE = 16;
+    /// Queries with at least this distance should use this path finder
+    static constexpr unsigned MIN_DISTANCE = 2 * SECTOR_SIZE;
+
+    explicit HierarchicalPathFinder(const World& world) : world_(world) {}
+
+    void Init(const MapExtent& mapSize);
+    /// Notify about a change at the given point which might affect T_Condition
+    void MarkChanged(MapPoint pt);
+    /// Find a shortest path from start to dest with at most maxLength steps
+    bool FindPath(MapPoint start, MapPoint dest, unsigned maxLength, std::vector<Direction>* route, unsigned* length);
+    /// Return the number of sectors with calculated transitions
+    unsigned GetNumValidSectors() const;
+
+private:
+    static constexpr unsigned NO_DIST = std::numeric_limits<unsigned>::max();
+    static constexpr unsigned MAX_SECTOR_NODES = SECTOR_SIZE * SECTOR_SIZE;
+
+    struct Transition
+    {
+        MapPoint from;
+        Direction dir;
+        MapPoint to;
+    };
+    struct Sector
+    {
+        bool isValid = false;
+        std::vector<Transition> transitions;
+        /// Distances from an entry point (by map index) to the start of each transition. NO_DIST if not reachable
+        std::map<unsigned, std::vector<unsigned>> distances;
+    };
+    /// Result of a search restricted to one sector. Indexed by \ref GetLocalIdx
+    struct LocalSearchResult
+    {
+        std::array<unsigned, MAX_SECTOR_NODES> dist;
+        /// Forward search: Direction used to reach the node. Backward search: Direction to go from the node
+        std::array<Direction, MAX_SECTOR_NODES> dirs;
+    };
+    /// Node of the abstract graph
+    struct AbstractNode
+    {
+        MapPoint pt;
+        unsigned cost;
+        unsigned prevIdx;
+        /// Transition used to reach this node or NO_DIST for the final step inside the goal sector
+        unsigned transitionIdx;
+        bool isClosed;
+    };
+
+    const World& world_;
+    MapExtent numSectors_;
+    std::vector<Sector> sectors_;
+
+    unsigned GetSectorIdx(MapPoint pt) const
+    {
+        return pt.x / SECTOR_SIZE + pt.y / SECTOR_SIZE * static_cast<unsigned>(numSectors_.x);
+    }
+    static unsigned GetLocalIdx(MapPoint pt) { return pt.x % SECTOR_SIZE + pt.y % SECTOR_SIZE * SECTOR_SIZE; }
+    /// Return the sector with valid transitions
+    Sector& GetSector(unsigned sectorIdx);
+    /// Return the distances from the entry point to the transitions of its sector
+    const std::vector<unsigned>& GetDistances(MapPoint entryPt);
+    void CalcTransitions(unsigned sectorIdx, Sector& sector) const;
+    /// Breadth-first search inside the sector of start. Backward searches find paths to start instead of from start
+    template<bool T_Backward>
+    void SearchSector(MapPoint start, LocalSearchResult& result) const;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Implementation
+//////////////////////////////////////////////////////////////////////////
+
+template<class T_Condition>
+constexpr unsigned HierarchicalPathFinder<T_Condition>::SECTOR_SIZE;
+template<class T_Condition>
+constexpr unsigned HierarchicalPathFinder<T_Condition>::MIN_DISTANCE;
+template<class T_Condition>
+constexpr unsigned HierarchicalPathFinder<T_Condition>::NO_DIST;
+
+template<class T_Condition>
+void HierarchicalPathFinder<T_Condition>::Init(const MapExtent& mapSize)
+{
+    numSectors_ = MapExtent((mapSize.x + SECTOR_SIZE - 1) / SECTOR_SIZE, (mapSize.y + SECTOR_SIZE - 1) / SECTOR_SIZE);
+    sectors_.clear();
+    sectors_.resize(static_cast<unsigned>(numSectors_.x) * numSectors_.y);
+}
+
+template<class T_Condition>
+void HierarchicalPathFinder<T_Condition>::MarkChanged(const MapPoint pt)
+{
+    // Node and edge checks look at the terrain around a node. So the checks for all nodes within a radius of 1 may
+    // change and so may the transitions of their neighbours
+    for(const MapPoint curPt : world_.GetPointsInRadiusWithCenter(pt, 2))
+    {
+        Sector& sector = sectors_[GetSectorIdx(curPt)];
+        sector.isValid = false;
+        sector.transitions.clear();
+        sector.distances.clear();
+    }
+}
+
+template<class T_Condition>
+unsigned HierarchicalPathFinder<T_Condition>::GetNumValidSectors() const
+{
+    return static_cast<unsigned>(
+      std::count_if(sectors_.begin(), sectors_.end(), [](const Sector& sector) { return sector.isValid; }));
+}
+
+template<class T_Condition>
+typename HierarchicalPathFinder<T_Condition>::Sector& HierarchicalPathFinder<T_Condition>::GetSector(unsigned sectorIdx)
+{
+    Sector& sector = sectors_[sectorIdx];
+    if(!sector.isValid)
+    {
+        CalcTransitions(sectorIdx, sector);
+        sector.isValid = true;
+    }
+    return sector;
+}
+
+template<class T_Condition>
+void HierarchicalPathFinder<T_Condition>::CalcTransitions(unsigned sectorIdx, Sector& sector) const
+{
+    const MapExtent size = world_.GetSize();
+    const MapCoord x0 = static_cast<MapCoord>(sectorIdx % numSectors_.x * SECTOR_SIZE);
+    const MapCoord y0 = static_cast<MapCoord>(sectorIdx / numSectors_.x * SECTOR_SIZE);
+    const MapCoord x1 = static_cast<MapCoord>(std::min<unsigned>(x0 + SECTOR_SIZE, size.x) - 1);
+    const MapCoord y1 = static_cast<MapCoord>(std::min<unsigned>(y0 + SECTOR_SIZE, size.y) - 1);
+
+    // Only border nodes have neighbours in other sectors
+    std::vector<MapPoint> border;
+    for(MapCoord x = x0; x <= x1; x++)
+        border.emplace_back(x, y0);
+    for(MapCoord y = y0 + 1; y <= y1; y++)
+        border.emplace_back(x1, y);
+    if(y1 > y0)
+    {
+        for(MapCoord x = x1; x > x0; x--)
+            border.emplace_back(x - 1, y1);
+    }
+    if(x1 > x0)
+    {
+        for(MapCoord y = y1 - 1; y > y0; y--)
+            border.emplace_back(x0, y);
+    }
+
+    // Leaving out any edge could make the paths longer
+    const T_Condition condition(world_);
+    for(const MapPoint pt : border)
+    {
+        if(!condition.IsNodeOk(pt))
+            continue;
+        for(const auto dir : helpers::EnumRange<Direction>{})
+        {
+            const MapPoint nb = world_.GetNeighbour(pt, dir);
+            if(GetSectorIdx(nb) != sectorIdx && condition.IsNodeOk(nb) && condition.IsEdgeOk(pt, dir))
+                sector.transitions.push_back(Transition{pt, dir, nb});
+        }
+    }
+}
+
+template<class T_Condition>
+template<bool T_Backward>
+void HierarchicalPathFinder<T_Condition>::SearchSector(const MapPoint start, LocalSearchResult& result) const
+{
+    const T_Condition condition(world_);
+    const unsigned sectorIdx = GetSectorIdx(start);
+    result.dist.fill(NO_DIST);
+    result.dist[GetLocalIdx(start)] = 0;
+    std::vector<MapPoint> todo;
+    todo.reserve(MAX_SECTOR_NODES);
+    todo.push_back(start);
+    // The start node is never checked. It is the start or goal of the path or was checked before
+    for(unsigned i = 0; i < todo.size(); i++)
+    {
+        const MapPoint curPt = todo[i];
+        const unsigned nextDist = result.dist[GetLocalIdx(curPt)] + 1;
+        for(const auto dir : helpers::EnumRange<Direction>{})
+        {
+            const MapPoint nb = world_.GetNeighbour(curPt, dir);
+            if(GetSectorIdx(nb) != sectorIdx)
+                continue;
+            const unsigned localIdx = GetLocalIdx(nb);
+            if(result.dist[localIdx] != NO_DIST)
+                continue;
+            if(T_Backward)
+            {
+                // Going from nb to curPt
+                if(!condition.IsEdgeOk(nb, dir + 3u))
+                    continue;
+                result.dist[localIdx] = nextDist;
+                result.dirs[localIdx] = dir + 3u;
+                // Might be the start of the path, but must not be passed otherwise
+                if(condition.IsNodeOk(nb))
+                    todo.push_back(nb);
+            } else
+            {
+                if(!condition.IsNodeOk(nb) || !condition.IsEdgeOk(curPt, dir))
+                    continue;
+                result.dist[localIdx] = nextDist;
+                result.dirs[localIdx] = dir;
+                todo.push_back(nb);
+            }
+        }
+    }
+}
+
+template<class T_Condition>
+const std::vector<unsigned>& HierarchicalPathFinder<T_Condition>::GetDistances(const MapPoint entryPt)
+{
+    Sector& sector = GetSector(GetSectorIdx(entryPt));
+    const unsigned entryIdx = world_.GetIdx(entryPt);
+    const auto it = sector.distances.find(entryIdx);
+    if(it != sector.distances.end())
+        return it->second;
+    LocalSearchResult searchResult;
+    SearchSector<false>(entryPt, searchResult);
+    std::vector<unsigned>& distances = sector.distances[entryIdx];
+    distances.reserve(sector.transitions.size());
+    for(const Transition& transition : sector.transitions)
+        distances.push_back(searchResult.dist[GetLocalIdx(transition.from)]);
+    return distances;
+}
+
+template<class T_Condition>
+bool HierarchicalPathFinder<T_Condition>::FindPath(const MapPoint start, const MapPoint dest, const unsigned maxLength,
+                                                   std::vector<Direction>* route, unsigned* length)
+{
+    RTTR_Assert(start != dest);
+    // Distances to the goal inside its sector
+    const unsigned destSectorIdx = GetSectorIdx(dest);
+    LocalSearchResult destSearch;
+    SearchSector<true>(dest, destSearch);
+
+    // A* on the abstract graph. Nodes are identified by their map index which also breaks ties
+    const unsigned startIdx = world_.GetIdx(start);
+    const unsigned destIdx = world_.GetIdx(dest);
+    std::unordered_map<unsigned, AbstractNode> nodes;
+    // Entries are (estimated cost, node index)
+    using QueueEntry = std::pair<unsigned, unsigned>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> todo;
+    nodes[startIdx] = AbstractNode{start, 0, startIdx, NO_DIST, false};
+    todo.emplace(world_.CalcDistance(start, dest), startIdx);
+    const auto addNode = [&](const MapPoint pt, const unsigned cost, const unsigned prevIdx,
+                             const unsigned transitionIdx) {
+        const unsigned estimate = cost + world_.CalcDistance(pt, dest);
+        if(estimate > maxLength)
+            return;
+        const unsigned idx = world_.GetIdx(pt);
+        const auto it = nodes.find(idx);
+        if(it != nodes.end() && (it->second.isClosed || it->second.cost <= cost))
+            return;
+        nodes[idx] = AbstractNode{pt, cost, prevIdx, transitionIdx, false};
+        todo.emplace(estimate, idx);
+    };
+    bool found = false;
+    while(!todo.empty())
+    {
+        const unsigned curIdx = todo.top().second;
+        todo.pop();
+        AbstractNode& curNode = nodes[curIdx];
+        const MapPoint curPt = curNode.pt;
+        if(curNode.isClosed)
+            continue;
+        curNode.isClosed = true;
+        if(curIdx == destIdx)
+        {
+            found = true;
+            break;
+        }
+        const unsigned curCost = curNode.cost;
+        const unsigned sectorIdx = GetSectorIdx(curPt);
+        if(sectorIdx == destSectorIdx)
+        {
+            const unsigned destDist = destSearch.dist[GetLocalIdx(curPt)];
+            if(destDist != NO_DIST)
+                addNode(dest, curCost + destDist, curIdx, NO_DIST);
+        }
+        const std::vector<unsigned>& distances = GetDistances(curPt);
+        const std::vector<Transition>& transitions = GetSector(sectorIdx).transitions;
+        for(unsigned i = 0; i < transitions.size(); i++)
+        {
+            if(distances[i] != NO_DIST)
+                addNode(transitions[i].to, curCost + distances[i] + 1, curIdx, i);
+        }
+    }
+    if(!found)
+        return false;
+    if(length)
+        *length = nodes[destIdx].cost;
+    if(!route)
+        return true;
+
+    // Collect the abstract path and refine it
+    std::vector<unsigned> abstractPath;
+    for(unsigned idx = destIdx; idx != startIdx; idx = nodes[idx].prevIdx)
+        abstractPath.push_back(idx);
+    route->clear();
+    route->reserve(nodes[destIdx].cost);
+    MapPoint curPt = start;
+    LocalSearchResult search;
+    std::vector<Direction> sectorRoute;
+    for(const unsigned idx : boost::adaptors::reverse(abstractPath))
+    {
+        const AbstractNode& node = nodes[idx];
+        if(node.transitionIdx == NO_DIST)
+        {
+            // Last part inside the goal sector
+            while(curPt != dest)
+            {
+                const Direction dir = destSearch.dirs[GetLocalIdx(curPt)];
+                route->push_back(dir);
+                curPt = world_.GetNeighbour(curPt, dir);
+            }
+        } else
+        {
+            const Transition& transition = GetSector(GetSectorIdx(curPt)).transitions[node.transitionIdx];
+            SearchSector<false>(curPt, search);
+            sectorRoute.clear();
+            for(MapPoint pt = transition.from; pt != curPt;)
+            {
+                const Direction dir = search.dirs[GetLocalIdx(pt)];
+                sectorRoute.push_back(dir);
+                pt = world_.GetNeighbour(pt, dir + 3u);
+            }
+            route->insert(route->end(), sectorRoute.rbegin(), sectorRoute.rend());
+            route->push_back(transition.dir);
+            curPt = transition.to;
+        }
+    }
+    RTTR_Assert(curPt == dest);
+    RTTR_Assert(route->size() == nodes[destIdx].cost);
+    return true;
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2005 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "pathfinding/HumanFlowFields.h"
+#include "pathfinding/PathConditionHuman.h"
+#include "world/World.h"
+#include "gameData/MilitaryConsts.h"
+#include <array>
+#include <vector>
+
+static_assert(HumanFlowFields::MAX_DISTANCE >= MAX_ATTACKING_RUN_DISTANCE, "Attack paths must fit into the fields");
+
+helpers::OptionalEnum<Direction> HumanFlowFields::GetDir(const MapPoint start, const MapPoint goal,
+                                                         const unsigned maxLength, const unsigned curGF)
+{
+    RTTR_Assert(start != goal);
+    RTTR_Assert(maxLength <= MAX_DISTANCE);
+    // Drop fields which were not used for a while
+    for(auto it = fields_.begin(); it != fields_.end();)
+    {
+        if(it->second.lastUsedGF + MAX_UNUSED_GFS < curGF)
+            it = fields_.erase(it);
+        else
+            ++it;
+    }
+
+    const auto itField = fields_.find(world_.GetIdx(goal));
+    Field* field;
+    if(itField != fields_.end())
+        field = &itField->second;
+    else
+    {
+        field = &fields_[world_.GetIdx(goal)];
+        field->goal = goal;
+        Calc(*field);
+    }
+    field->lastUsedGF = curGF;
+
+    const auto itEntry = field->entries.find(world_.GetIdx(start));
+    if(itEntry == field->entries.end() || itEntry->second.distance > maxLength)
+        return boost::none;
+    const Entry& entry = itEntry->second;
+    if(entry.distance == 1u)
+        return entry.dir;
+    // Choose between all directions to a node one step closer so figures do not all take the same path.
+    // Depends only on the position and GF so it is the same for all players
+    const PathConditionHuman condition(world_);
+    std::array<Direction, helpers::NumEnumValues_v<Direction>> dirs;
+    unsigned numDirs = 0;
+    for(const auto dir : helpers::EnumRange<Direction>{})
+    {
+        const MapPoint nb = world_.GetNeighbour(start, dir);
+        const auto itNb = field->entries.find(world_.GetIdx(nb));
+        if(itNb != field->entries.end() && itNb->second.distance + 1u == entry.distance && condition.IsNodeOk(nb)
+           && condition.IsEdgeOk(start, dir))
+            dirs[numDirs++] = dir;
+    }
+    // The stored direction is always one of them
+    RTTR_Assert(numDirs > 0u);
+    return dirs[(world_.GetIdx(start) * 31u + curGF) % numDirs];
+}
+
+void HumanFlowFields::MarkChanged(const MapPoint pt)
+{
+    // A change influences the node itself and the edges to its neighbours
+    for(auto it = fields_.begin(); it != fields_.end();)
+    {
+        if(world_.CalcDistance(it->second.goal, pt) <= MAX_DISTANCE + 1)
+            it = fields_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void HumanFlowFields::Remove(const MapPoint goal)
+{
+    fields_.erase(world_.GetIdx(goal));
+}
+
+void HumanFlowFields::Calc(Field& field) const
+{
+    const PathConditionHuman condition(world_);
+    field.entries.clear();
+    // The goal itself has no direction but must not be reached again
+    field.entries[world_.GetIdx(field.goal)] = Entry{0, Direction::WEST};
+    std::vector<MapPoint> todo;
+    todo.push_back(field.goal);
+    for(unsigned i = 0; i < todo.size(); i++)
+    {
+        const MapPoint curPt = todo[i];
+        const unsigned nextDistance = field.entries[world_.GetIdx(curPt)].distance + 1u;
+        if(nextDistance > MAX_DISTANCE)
+            continue;
+        for(const auto dir : helpers::EnumRange<Direction>{})
+        {
+            const MapPoint nb = world_.GetNeighbour(curPt, dir);
+            const unsigned nbIdx = world_.GetIdx(nb);
+            if(field.entries.count(nbIdx))
+                continue;
+            // Going from nb to curPt
+            const Direction revDir = dir + 3u;
+            if(!condition.IsEdgeOk(nb, revDir))
+                continue;
+            field.entries[nbIdx] = Entry{static_cast<uint8_t>(nextDistance), revDir};
+            // Paths may start at blocked nodes, but must not pass them
+            if(condition.IsNodeOk(nb))
+                todo.push_back(nb);
+        }
+    }
+    field.entries.erase(world_.GetIdx(field.goal));
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2005 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "helpers/OptionalEnum.h"
+#include "gameTypes/Direction.h"
+#include "gameTypes/MapCoordinates.h"
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+
+class World;
+
+/// Flow fields for humans running to a goal shared by many figures, e.g. the flag of an attacked building.
+/// A reverse breadth-first search from the goal with the checks of PathConditionHuman stores the distance and the first
+/// direction of a shortest path for every node within MAX_DISTANCE steps.
+/// Fields are calculated on demand and removed when a node object, road or terrain within their range changes, when
+/// they were unused for MAX_UNUSED_GFS or when the goal is no longer needed. As they are a cache only they always match
+/// a new calculation and are not serialized.
+class HumanFlowFields
+{
+public:
+    /// Max distance stored in the fields. Covers MAX_ATTACKING_RUN_DISTANCE
+    static constexpr unsigned MAX_DISTANCE = 40;
+    /// Fields not used for this many GFs are removed
+    static constexpr unsigned MAX_UNUSED_GFS = 500;
+
+    explicit HumanFlowFields(const World& world) : world_(world) {}
+
+    /// Return the first direction of a shortest path from start to goal with at most maxLength <= MAX_DISTANCE steps.
+    /// If there are multiple shortest paths the direction is chosen by start and curGF
+    helpers::OptionalEnum<Direction> GetDir(MapPoint start, MapPoint goal, unsigned maxLength, unsigned curGF);
+    /// Notify about a changed object, road or terrain at the point
+    void MarkChanged(MapPoint pt);
+    /// Remove the field for the goal if there is any
+    void Remove(MapPoint goal);
+    void Clear() { fields_.clear(); }
+    unsigned GetNumFields() const { return static_cast<unsigned>(fields_.size()); }
+
+private:
+    struct Entry
+    {
+        uint8_t distance;
+        Direction dir;
+    };
+    struct Field
+    {
+        MapPoint goal;
+        unsigned lastUsedGF;
+        /// Entries by map index of the nodes which can reach the goal
+        std::unordered_map<unsigned, Entry> entries;
+    };
+
+    const World& world_;
+    /// Fields by map index of their goal
+    std::map<unsigned, Field> fields_;
+
+    void Calc(Field& field) const;
+};
@@ -0,0 +1,137 @@
+// Copyright (c) 2005 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+/// Monotone bucket queue for integer keys (e.g. A* with a consistent heuristic)
+/// Elements are stored in one bucket per key, so push is O(1) and pop is amortized O(1) plus the tie breaking.
+/// Elements with the same key are returned in ascending order of T_GetTieBreaker which must be unique (e.g. an index)
+/// Requirements:
+///  - Keys pushed are never smaller than the key of the last popped element
+///  - rearrange is only called for elements in the queue whose key decreased
+/// Decreased elements are inserted again and the old entry is skipped on pop, so no position marker is required
+/// Not yet used by the game, see QueueImpl in FreePathFinderImpl.h
+template<typename T, class T_GetKey, class T_GetTieBreaker>
+class OpenListBucketQueue
+{
+public:
+    using size_type = unsigned;
+    using value_type = T;
+    using key_type = unsigned;
+
+    OpenListBucketQueue() : numElements(0), minKey(0), curBucket(0), numUsedBuckets(0) {}
+
+    size_type size() const { return numElements; }
+    bool empty() const { return numElements == 0u; }
+    void clear();
+
+    void push(T* newEl);
+    T* pop();
+    void decreasedKey(T* el) { insert(el); }
+    void rearrange(T* el) { decreasedKey(el); }
+
+private:
+    struct Element
+    {
+        key_type key;
+        unsigned tieBreaker;
+        T* el;
+        Element(key_type key, unsigned tieBreaker, T* el) : key(key), tieBreaker(tieBreaker), el(el) {}
+        /// Used for a min-heap on the tie breaker
+        bool operator<(const Element& rhs) const { return tieBreaker > rhs.tieBreaker; }
+    };
+    using Bucket = std::vector<Element>;
+
+    /// Buckets for keys minKey, minKey + 1, ... Allocated buckets are kept for reuse
+    std::vector<Bucket> buckets;
+    /// Number of elements in the queue (without outdated entries)
+    size_type numElements;
+    /// Key of bucket 0
+    key_type minKey;
+    /// First bucket that may not be empty
+    size_type curBucket;
+    /// Number of buckets used since the last clear
+    size_type numUsedBuckets;
+
+    void insert(T* el);
+    static key_type GetKey(T* el) { return T_GetKey()(*el); }
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Implementation
+//////////////////////////////////////////////////////////////////////////
+
+template<typename T, class T_GetKey, class T_GetTieBreaker>
+void OpenListBucketQueue<T, T_GetKey, T_GetTieBreaker>::clear()
+{
+    for(size_type i = curBucket; i < numUsedBuckets; i++)
+        buckets[i].clear();
+    numElements = 0;
+    curBucket = 0;
+    numUsedBuckets = 0;
+}
+
+template<typename T, class T_GetKey, class T_GetTieBreaker>
+inline void OpenListBucketQueue<T, T_GetKey, T_GetTieBreaker>::push(T* newEl)
+{
+    // The first element defines the smallest key
+    if(numUsedBuckets == 0u)
+        minKey = GetKey(newEl);
+    insert(newEl);
+    ++numElements;
+}
+
+template<typename T, class T_GetKey, class T_GetTieBreaker>
+inline void OpenListBucketQueue<T, T_GetKey, T_GetTieBreaker>::insert(T* el)
+{
+    const key_type key = GetKey(el);
+    RTTR_Assert(key >= minKey + curBucket); // Keys must be monotone
+    const size_type idx = std::max(key, minKey + curBucket) - minKey;
+    if(idx >= buckets.size())
+        buckets.resize(idx + 1);
+    numUsedBuckets = std::max(numUsedBuckets, idx + 1);
+    Bucket& bucket = buckets[idx];
+    bucket.emplace_back(key, T_GetTieBreaker()(*el), el);
+    std::push_heap(bucket.begin(), bucket.end());
+}
+
+template<typename T, class T_GetKey, class T_GetTieBreaker>
+inline T* OpenListBucketQueue<T, T_GetKey, T_GetTieBreaker>::pop()
+{
+    RTTR_Assert(!empty());
+    while(true)
+    {
+        RTTR_Assert(curBucket < numUsedBuckets);
+        Bucket& bucket = buckets[curBucket];
+        if(bucket.empty())
+        {
+            ++curBucket;
+            continue;
+        }
+        std::pop_heap(bucket.begin(), bucket.end());
+        const Element result = bucket.back();
+        bucket.pop_back();
+        // Skip entries of elements which were moved to a smaller key
+        if(GetKey(result.el) != result.key)
+            continue;
+        --numElements;
+        return result.el;
+    }
+}
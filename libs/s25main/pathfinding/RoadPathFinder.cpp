@@ -43,6 +43,7 @@ struct RoadNodeComperatorGreater
 };
 
 using QueueImpl = OpenListPrioQueue<const noRoadNode*, RoadNodeComperatorGreater>;
+/// Not OpenListBucketQueue for the same reason as the free path finder (see QueueImpl in FreePathFinderImpl.h)
 using VecImpl = OpenListVector<const noRoadNode*>;
 VecImpl todo;
 
@@ -63,6 +64,35 @@ struct Carrier
 };
 } // namespace AdditonalCosts
 
+// Namespace with all functors usable as heuristic functors
+namespace Heuristics {
+/// Returned for nodes that cannot reach the goal at all
+constexpr unsigned UNREACHABLE = std::numeric_limits<unsigned>::max();
+
+/// Distance on the map. Never overestimates the road distance
+struct MapDistance
+{
+    const GameWorldBase& gwb_;
+    const MapPoint goalPos_;
+    MapDistance(const GameWorldBase& gwb, const noRoadNode& goal) : gwb_(gwb), goalPos_(goal.GetPos()) {}
+
+    unsigned operator()(const noRoadNode& node) const { return gwb_.CalcDistance(node.GetPos(), goalPos_); }
+};
+
+/// Road distance from a next-hop table. Exact if there is no congestion
+struct RouteTable
+{
+    const WareRouteTables::Table& table_;
+    RouteTable(const WareRouteTables::Table& table) : table_(table) {}
+
+    unsigned operator()(const noRoadNode& node) const
+    {
+        const WareRouteTables::Entry* entry = WareRouteTables::GetEntry(table_, node);
+        return entry ? entry->distance : UNREACHABLE;
+    }
+};
+} // namespace Heuristics
+
 // Namespace with all functors usable as segment constraint functors
 namespace SegmentConstraints {
 struct None
@@ -114,11 +144,12 @@ struct And : private T_Func1, private T_Func2
 } // namespace SegmentConstraints
 
 /// Wegfinden ( A* ), O(v lg v) --> Wegfindung auf Stra�en
-template<class T_AdditionalCosts, class T_SegmentConstraints>
+template<class T_Heuristic, class T_AdditionalCosts, class T_SegmentConstraints>
 bool RoadPathFinder::FindPathImpl(const noRoadNode& start, const noRoadNode& goal, const unsigned max,
-                                  const T_AdditionalCosts addCosts, const T_SegmentConstraints isSegmentAllowed,
+                                  const T_Heuristic heuristic, const T_AdditionalCosts addCosts,
+                                  const T_SegmentConstraints isSegmentAllowed,
                                   unsigned* const length, RoadPathDirection* const firstDir,
-                                  MapPoint* const firstNodePos)
+                                  MapPoint* const firstNodePos, std::vector<unsigned>* const segmentIds)
 {
     if(&start == &goal)
     {
@@ -134,9 +165,15 @@ bool RoadPathFinder::FindPathImpl(const noRoadNode& start, const noRoadNode& goa
             *firstDir = RoadPathDirection::None;
         if(firstNodePos)
             *firstNodePos = start.GetPos();
+        if(segmentIds)
+            segmentIds->clear();
         return true;
     }
 
+    const unsigned startDistance = heuristic(start);
+    if(startDistance == Heuristics::UNREACHABLE)
+        return false;
+
     // increase current_visit_on_roads, so we don't have to clear the visited-states at every run
     currentVisit++;
 
@@ -155,7 +192,7 @@ bool RoadPathFinder::FindPathImpl(const noRoadNode& start, const noRoadNode& goa
     // Anfangsknoten einf�gen
     todo.clear();
 
-    start.targetDistance = gwb_.CalcDistance(start.GetPos(), goal.GetPos());
+    start.targetDistance = startDistance;
     start.estimate = start.targetDistance;
     start.last_visit = currentVisit;
     start.prev = nullptr;
@@ -190,6 +227,16 @@ bool RoadPathFinder::FindPathImpl(const noRoadNode& start, const noRoadNode& goa
             if(firstNodePos)
                 *firstNodePos = firstNode->GetPos();
 
+            if(segmentIds)
+            {
+                segmentIds->clear();
+                for(const noRoadNode* node = &best; node->prev; node = node->prev)
+                {
+                    if(node->dir_ != RoadPathDirection::Ship)
+                        segmentIds->push_back(node->prev->GetRoute(toDirection(node->dir_))->GetObjId());
+                }
+            }
+
             // Done, path found
             return true;
         }
@@ -243,13 +290,16 @@ bool RoadPathFinder::FindPathImpl(const noRoadNode& start, const noRoadNode& goa
                 }
             } else
             {
+                const unsigned targetDistance = heuristic(*neighbour);
+                if(targetDistance == Heuristics::UNREACHABLE)
+                    continue;
                 // Not visited yet -> Add to list
                 neighbour->last_visit = currentVisit;
                 neighbour->cost = cost;
                 neighbour->dir_ = toRoadPathDirection(dir);
                 neighbour->prev = &best;
 
-                neighbour->targetDistance = gwb_.CalcDistance(neighbour->GetPos(), goal.GetPos());
+                neighbour->targetDistance = targetDistance;
                 neighbour->estimate = neighbour->targetDistance + cost;
 
                 todo.push(neighbour);
@@ -285,6 +335,9 @@ bool RoadPathFinder::FindPathImpl(const noRoadNode& start, const noRoadNode& goa
                     }
                 } else
                 {
+                    const unsigned targetDistance = heuristic(dest);
+                    if(targetDistance == Heuristics::UNREACHABLE)
+                        continue;
                     // Not visited yet -> Add to list
                     dest.last_visit = currentVisit;
 
@@ -292,7 +345,7 @@ bool RoadPathFinder::FindPathImpl(const noRoadNode& start, const noRoadNode& goa
                     dest.prev = &best;
                     dest.cost = cost;
 
-                    dest.targetDistance = gwb_.CalcDistance(dest.GetPos(), goal.GetPos());
+                    dest.targetDistance = targetDistance;
                     dest.estimate = dest.targetDistance + cost;
 
                     todo.push(&dest);
@@ -307,28 +360,31 @@ bool RoadPathFinder::FindPathImpl(const noRoadNode& start, const noRoadNode& goa
 
 bool RoadPathFinder::FindPath(const noRoadNode& start, const noRoadNode& goal, const bool wareMode, const unsigned max,
                               const RoadSegment* const forbidden, unsigned* const length,
-                              RoadPathDirection* const firstDir, MapPoint* const firstNodePos)
+                              RoadPathDirection* const firstDir, MapPoint* const firstNodePos,
+                              std::vector<unsigned>* const segmentIds)
 {
     RTTR_Assert(length || firstDir || firstNodePos); // If none of them is set use the \ref PathExist function!
 
     if(wareMode)
     {
         if(forbidden)
-            return FindPathImpl(start, goal, max, AdditonalCosts::Carrier(),
-                                SegmentConstraints::AvoidSegment(forbidden), length, firstDir, firstNodePos);
+            return FindPathImpl(start, goal, max, Heuristics::MapDistance(gwb_, goal), AdditonalCosts::Carrier(),
+                                SegmentConstraints::AvoidSegment(forbidden), length, firstDir, firstNodePos,
+                                segmentIds);
         else
-            return FindPathImpl(start, goal, max, AdditonalCosts::Carrier(), SegmentConstraints::None(), length,
-                                firstDir, firstNodePos);
+            return FindPathImpl(start, goal, max, Heuristics::MapDistance(gwb_, goal), AdditonalCosts::Carrier(),
+                                SegmentConstraints::None(), length, firstDir, firstNodePos, segmentIds);
     } else
     {
         if(forbidden)
-            return FindPathImpl(start, goal, max, AdditonalCosts::None(),
+            return FindPathImpl(start, goal, max, Heuristics::MapDistance(gwb_, goal), AdditonalCosts::None(),
                                 SegmentConstraints::And<SegmentConstraints::AvoidSegment,
                                                         SegmentConstraints::AvoidRoadType<RoadType::Water>>(forbidden),
-                                length, firstDir, firstNodePos);
+                                length, firstDir, firstNodePos, segmentIds);
         else
-            return FindPathImpl(start, goal, max, AdditonalCosts::None(),
-                                SegmentConstraints::AvoidRoadType<RoadType::Water>(), length, firstDir, firstNodePos);
+            return FindPathImpl(start, goal, max, Heuristics::MapDistance(gwb_, goal), AdditonalCosts::None(),
+                                SegmentConstraints::AvoidRoadType<RoadType::Water>(), length, firstDir, firstNodePos,
+                                segmentIds);
     }
 }
 
@@ -338,17 +394,128 @@ bool RoadPathFinder::PathExists(const noRoadNode& start, const noRoadNode& goal,
     if(allowWaterRoads)
     {
         if(forbidden)
-            return FindPathImpl(start, goal, max, AdditonalCosts::None(), SegmentConstraints::AvoidSegment(forbidden));
+            return FindPathImpl(start, goal, max, Heuristics::MapDistance(gwb_, goal), AdditonalCosts::None(),
+                                SegmentConstraints::AvoidSegment(forbidden));
         else
-            return FindPathImpl(start, goal, max, AdditonalCosts::None(), SegmentConstraints::None());
+            return FindPathImpl(start, goal, max, Heuristics::MapDistance(gwb_, goal), AdditonalCosts::None(),
+                                SegmentConstraints::None());
     } else
     {
         if(forbidden)
-            return FindPathImpl(start, goal, max, AdditonalCosts::None(),
+            return FindPathImpl(start, goal, max, Heuristics::MapDistance(gwb_, goal), AdditonalCosts::None(),
                                 SegmentConstraints::And<SegmentConstraints::AvoidSegment,
                                                         SegmentConstraints::AvoidRoadType<RoadType::Water>>(forbidden));
         else
-            return FindPathImpl(start, goal, max, AdditonalCosts::None(),
+            return FindPathImpl(start, goal, max, Heuristics::MapDistance(gwb_, goal), AdditonalCosts::None(),
                                 SegmentConstraints::AvoidRoadType<RoadType::Water>());
     }
 }
+
+bool RoadPathFinder::FindWarePath(const noRoadNode& start, const noRoadNode& goal, WareRouteTables& tables,
+                                  const unsigned max, unsigned* const length, RoadPathDirection* const firstDir,
+                                  MapPoint* const firstNodePos, std::vector<unsigned>* const segmentIds)
+{
+    if(!verifyWarePaths_)
+        return FindWarePathImpl(start, goal, tables.Get(goal), max, length, firstDir, firstNodePos, segmentIds);
+
+    unsigned foundLength = 0;
+    RoadPathDirection foundDir = RoadPathDirection::None;
+    MapPoint foundNodePos = MapPoint::Invalid();
+    std::vector<unsigned> foundSegmentIds;
+    const bool found =
+      FindWarePathImpl(start, goal, tables.Get(goal), max, &foundLength, &foundDir, &foundNodePos, &foundSegmentIds);
+    // Must be optimal...
+    unsigned expectedLength = 0;
+    const bool expectedFound = FindPath(start, goal, true, max, nullptr, &expectedLength);
+    // ...and exactly the same as with a new table (e.g. after loading a savegame)
+    WareRouteTables::Table newTable;
+    WareRouteTables::Build(goal, newTable);
+    unsigned newLength = 0;
+    RoadPathDirection newDir = RoadPathDirection::None;
+    MapPoint newNodePos = MapPoint::Invalid();
+    std::vector<unsigned> newSegmentIds;
+    const bool newFound =
+      FindWarePathImpl(start, goal, newTable, max, &newLength, &newDir, &newNodePos, &newSegmentIds);
+    if(found != expectedFound || found != newFound
+       || (found
+           && (foundLength != expectedLength || foundLength != newLength || foundDir != newDir
+               || foundNodePos != newNodePos || foundSegmentIds != newSegmentIds)))
+    {
+        ++numWarePathMismatches_;
+        LOG.write("WARNING: Ware path from %u,%u to %u,%u differs (found: %d/%d/%d, length: %u/%u/%u, first direction: "
+                  "%u/%u, segments: %u/%u)\n")
+          % unsigned(start.GetX()) % unsigned(start.GetY()) % unsigned(goal.GetX()) % unsigned(goal.GetY()) % found
+          % expectedFound % newFound % foundLength % expectedLength % newLength % unsigned(foundDir) % unsigned(newDir)
+          % foundSegmentIds.size() % newSegmentIds.size();
+    }
+
+    if(!found)
+        return false;
+    if(length)
+        *length = foundLength;
+    if(firstDir)
+        *firstDir = foundDir;
+    if(firstNodePos)
+        *firstNodePos = foundNodePos;
+    if(segmentIds)
+        *segmentIds = std::move(foundSegmentIds);
+    return true;
+}
+
+bool RoadPathFinder::FindWarePathImpl(const noRoadNode& start, const noRoadNode& goal, WareRouteTables::Table& table,
+                                      const unsigned max, unsigned* const length, RoadPathDirection* const firstDir,
+                                      MapPoint* const firstNodePos, std::vector<unsigned>* const segmentIds)
+{
+    // Adds the start if it is a building built after the table, so the table is the same as a new one
+    const WareRouteTables::Entry* startEntry = WareRouteTables::GetStartEntry(table, start);
+    // Nodes not in the table are not connected to the goal
+    if(&start == &goal || !startEntry)
+        return FindPath(start, goal, true, max, nullptr, length, firstDir, firstNodePos, segmentIds);
+    if(startEntry->distance > max)
+        return false; // Distance is a lower bound
+    if(FollowRouteTable(start, goal, table, firstDir, firstNodePos, segmentIds))
+    {
+        if(length)
+            *length = startEntry->distance;
+        return true;
+    }
+    return FindPathImpl(start, goal, max, Heuristics::RouteTable(table), AdditonalCosts::Carrier(),
+                        SegmentConstraints::None(), length, firstDir, firstNodePos, segmentIds);
+}
+
+bool RoadPathFinder::FollowRouteTable(const noRoadNode& start, const noRoadNode& goal,
+                                      const WareRouteTables::Table& table, RoadPathDirection* const firstDir,
+                                      MapPoint* const firstNodePos, std::vector<unsigned>* const segmentIds)
+{
+    if(segmentIds)
+        segmentIds->clear();
+    const noRoadNode* firstNode = nullptr;
+    RoadPathDirection startDir = RoadPathDirection::None;
+    for(const noRoadNode* node = &start; node != &goal;)
+    {
+        const WareRouteTables::Entry* entry = WareRouteTables::GetEntry(table, *node);
+        const RoadSegment* route =
+          (entry && entry->nextDir != RoadPathDirection::None) ? node->GetRoute(toDirection(entry->nextDir)) : nullptr;
+        // Any congestion might make another route better. Missing roads mean an outdated table, which should not happen
+        RTTR_Assert(route);
+        if(!route || node->GetPunishmentPoints(toDirection(entry->nextDir)) > 0)
+        {
+            if(segmentIds)
+                segmentIds->clear();
+            return false;
+        }
+        if(segmentIds)
+            segmentIds->push_back(route->GetObjId());
+        node = node->GetNeighbour(toDirection(entry->nextDir));
+        if(!firstNode)
+        {
+            firstNode = node;
+            startDir = entry->nextDir;
+        }
+    }
+    if(firstDir)
+        *firstDir = startDir;
+    if(firstNodePos)
+        *firstNodePos = firstNode->GetPos();
+    return true;
+}
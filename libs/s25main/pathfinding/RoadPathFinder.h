@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include "pathfinding/WareRouteTables.h"
 #include "gameTypes/MapCoordinates.h"
 #include "gameTypes/RoadPathDirection.h"
 #include <limits>
+#include <vector>
 
 class GameWorldBase;
 class noRoadNode;
@@ -29,9 +31,14 @@ class RoadPathFinder
 {
     GameWorldBase& gwb_;
     unsigned currentVisit;
+    /// Check all results of FindWarePath against the plain A* search
+    bool verifyWarePaths_;
+    unsigned numWarePathMismatches_;
 
 public:
-    RoadPathFinder(GameWorldBase& gwb) : gwb_(gwb), currentVisit(0) {}
+    RoadPathFinder(GameWorldBase& gwb)
+        : gwb_(gwb), currentVisit(0), verifyWarePaths_(false), numWarePathMismatches_(0)
+    {}
 
     /// Calculates the best path from start to goal
     /// Outputs are only valid if true is returned!
@@ -44,9 +51,25 @@ public:
     /// @param length If != nullptr will receive the final costs
     /// @param firstDir If != nullptr will receive the first direction to travel
     /// @param firstNodePos If != nullptr will receive the position of the first node
+    /// @param segmentIds If != nullptr will receive the object ids of all road segments on the path (ship transfers are
+    /// not included)
     bool FindPath(const noRoadNode& start, const noRoadNode& goal, bool wareMode,
                   unsigned max = std::numeric_limits<unsigned>::max(), const RoadSegment* forbidden = nullptr,
-                  unsigned* length = nullptr, RoadPathDirection* firstDir = nullptr, MapPoint* firstNodePos = nullptr);
+                  unsigned* length = nullptr, RoadPathDirection* firstDir = nullptr, MapPoint* firstNodePos = nullptr,
+                  std::vector<unsigned>* segmentIds = nullptr);
+
+    /// Calculates the best path for a ware from start to goal using the next-hop tables of the goals owner.
+    /// Same results (costs) as FindPath in ware mode but usually needs only a table lookup. The path only depends on the
+    /// game state, not on when the table was built. Must not be used if the owner has ship connections as those are not
+    /// part of the tables.
+    bool FindWarePath(const noRoadNode& start, const noRoadNode& goal, WareRouteTables& tables,
+                      unsigned max = std::numeric_limits<unsigned>::max(), unsigned* length = nullptr,
+                      RoadPathDirection* firstDir = nullptr, MapPoint* firstNodePos = nullptr,
+                      std::vector<unsigned>* segmentIds = nullptr);
+    /// Enable to check every FindWarePath result against the plain A* search (costs) and against the result using a new
+    /// table (costs, first direction and path) and count differing results
+    void SetVerifyWarePaths(bool verify) { verifyWarePaths_ = verify; }
+    unsigned GetNumWarePathMismatches() const { return numWarePathMismatches_; }
 
     /// Checks if there is ANY path from start to goal
     ///
@@ -57,8 +80,15 @@ public:
                     unsigned max = std::numeric_limits<unsigned>::max(), const RoadSegment* forbidden = nullptr);
 
 private:
-    template<class T_AdditionalCosts, class T_SegmentConstraints>
-    bool FindPathImpl(const noRoadNode& start, const noRoadNode& goal, unsigned max, T_AdditionalCosts addCosts,
-                      T_SegmentConstraints isSegmentAllowed, unsigned* length = nullptr,
-                      RoadPathDirection* firstDir = nullptr, MapPoint* firstNodePos = nullptr);
+    template<class T_Heuristic, class T_AdditionalCosts, class T_SegmentConstraints>
+    bool FindPathImpl(const noRoadNode& start, const noRoadNode& goal, unsigned max, T_Heuristic heuristic,
+                      T_AdditionalCosts addCosts, T_SegmentConstraints isSegmentAllowed, unsigned* length = nullptr,
+                      RoadPathDirection* firstDir = nullptr, MapPoint* firstNodePos = nullptr,
+                      std::vector<unsigned>* segmentIds = nullptr);
+    bool FindWarePathImpl(const noRoadNode& start, const noRoadNode& goal, WareRouteTables::Table& table, unsigned max,
+                          unsigned* length, RoadPathDirection* firstDir, MapPoint* firstNodePos,
+                          std::vector<unsigned>* segmentIds);
+    /// Follow the table from start to goal. Fails if there is congestion on the way as another path might be better
+    bool FollowRouteTable(const noRoadNode& start, const noRoadNode& goal, const WareRouteTables::Table& table,
+                          RoadPathDirection* firstDir, MapPoint* firstNodePos, std::vector<unsigned>* segmentIds);
 };
@@ -0,0 +1,110 @@
+// Copyright (c) 2005 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "pathfinding/SeaRouteField.h"
+#include "pathfinding/PathConditionShip.h"
+#include "world/World.h"
+#include <algorithm>
+
+constexpr uint8_t SeaRouteField::NO_DIR;
+
+void SeaRouteField::Calc(const World& world, const MapPoint goal)
+{
+    const PathConditionShip condition(world);
+    // Direction to go from each node or NO_DIR if not (yet) reached
+    std::vector<uint8_t> nodeDirs(prodOfComponents(world.GetSize()), NO_DIR);
+    const unsigned goalIdx = world.GetIdx(goal);
+    unsigned minIdx = goalIdx, maxIdx = goalIdx;
+    // Mark the goal as reached, it is never used as a direction
+    nodeDirs[goalIdx] = 0;
+
+    std::vector<MapPoint> todo;
+    todo.push_back(goal);
+    for(unsigned i = 0; i < todo.size(); i++)
+    {
+        const MapPoint curPt = todo[i];
+        for(const auto dir : helpers::EnumRange<Direction>{})
+        {
+            const MapPoint nb = world.GetNeighbour(curPt, dir);
+            const unsigned nbIdx = world.GetIdx(nb);
+            if(nodeDirs[nbIdx] != NO_DIR)
+                continue;
+            // Going from nb to curPt
+            const Direction revDir = dir + 3u;
+            if(!condition.IsEdgeOk(nb, revDir))
+                continue;
+            nodeDirs[nbIdx] = static_cast<uint8_t>(revDir);
+            minIdx = std::min(minIdx, nbIdx);
+            maxIdx = std::max(maxIdx, nbIdx);
+            // Routes may start at nodes like coastal points, but must not pass them
+            if(condition.IsNodeOk(nb))
+                todo.push_back(nb);
+        }
+    }
+    nodeDirs[goalIdx] = NO_DIR;
+
+    goal_ = goal;
+    firstIdx_ = minIdx;
+    numNodes_ = maxIdx - minIdx + 1;
+    dirs_.assign((numNodes_ + 1) / 2, 0);
+    for(unsigned i = 0; i < numNodes_; i++)
+        dirs_[i / 2] |= nodeDirs[firstIdx_ + i] << (i % 2u * 4u);
+}
+
+void SeaRouteField::Clear()
+{
+    goal_ = MapPoint::Invalid();
+    firstIdx_ = numNodes_ = 0;
+    dirs_.clear();
+    dirs_.shrink_to_fit();
+}
+
+uint8_t SeaRouteField::GetDir(const unsigned idx) const
+{
+    if(idx < firstIdx_ || idx - firstIdx_ >= numNodes_)
+        return NO_DIR;
+    const unsigned localIdx = idx - firstIdx_;
+    return (dirs_[localIdx / 2] >> (localIdx % 2u * 4u)) & 0xF;
+}
+
+bool SeaRouteField::GetRoute(const World& world, const MapPoint start, const unsigned maxLength,
+                             std::vector<Direction>* route, unsigned* length) const
+{
+    RTTR_Assert(IsCalculated());
+    // Check first, so the route is not changed if there is none
+    unsigned curLength = 0;
+    for(MapPoint curPt = start; curPt != goal_; curLength++)
+    {
+        const uint8_t dir = GetDir(world.GetIdx(curPt));
+        if(dir == NO_DIR || curLength == maxLength)
+            return false;
+        curPt = world.GetNeighbour(curPt, Direction::fromInt(dir));
+    }
+    if(length)
+        *length = curLength;
+    if(route)
+    {
+        route->resize(curLength);
+        MapPoint curPt = start;
+        for(Direction& dir : *route)
+        {
+            dir = Direction::fromInt(GetDir(world.GetIdx(curPt)));
+            curPt = world.GetNeighbour(curPt, dir);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2005 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "gameTypes/Direction.h"
+#include "gameTypes/MapCoordinates.h"
+#include <cstdint>
+#include <vector>
+
+class World;
+
+/// Directions for ships to a goal (the coastal point of a harbor) from every point of the sea which can reach it.
+/// It is calculated by a breadth-first search from the goal with the checks of PathConditionShip, so following the
+/// directions results in a shortest route. Directions are stored as 4 bit values for the range of nodes which can reach
+/// the goal.
+/// The field depends on the terrain only and must be cleared when it changes. It is a cache only and hence not
+/// serialized.
+class SeaRouteField
+{
+public:
+    /// Calculate the field for the given goal
+    void Calc(const World& world, MapPoint goal);
+    void Clear();
+    bool IsCalculated() const { return goal_.isValid(); }
+    /// Get the route from start to the goal if it is at most maxLength steps long. Return false if there is none
+    bool GetRoute(const World& world, MapPoint start, unsigned maxLength, std::vector<Direction>* route,
+                  unsigned* length) const;
+    /// Return the number of bytes used for the directions
+    unsigned GetMemorySize() const { return static_cast<unsigned>(dirs_.size()); }
+
+private:
+    static constexpr uint8_t NO_DIR = 0xF;
+
+    MapPoint goal_ = MapPoint::Invalid();
+    /// Map index of the first node in dirs_
+    unsigned firstIdx_ = 0;
+    unsigned numNodes_ = 0;
+    /// Direction to go from each node, 2 nodes per byte
+    std::vector<uint8_t> dirs_;
+
+    uint8_t GetDir(unsigned idx) const;
+};
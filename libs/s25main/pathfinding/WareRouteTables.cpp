@@ -0,0 +1,110 @@
+// Copyright (c) 2005 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "WareRouteTables.h"
+#include "RoadSegment.h"
+#include "nodeObjs/noRoadNode.h"
+#include <queue>
+#include <tuple>
+#include <vector>
+
+namespace {
+/// Node in the open list: Distance, object id (for a deterministic order) and the node
+using OpenNode = std::tuple<unsigned, unsigned, const noRoadNode*>;
+struct OpenNodeGreater
+{
+    bool operator()(const OpenNode& lhs, const OpenNode& rhs) const
+    {
+        return std::tie(std::get<0>(lhs), std::get<1>(lhs)) > std::tie(std::get<0>(rhs), std::get<1>(rhs));
+    }
+};
+} // namespace
+
+WareRouteTables::Table& WareRouteTables::Get(const noRoadNode& goal)
+{
+    auto it = tables_.find(goal.GetObjId());
+    if(it != tables_.end())
+        return it->second;
+    Table& table = tables_[goal.GetObjId()];
+    Build(goal, table);
+    return table;
+}
+
+void WareRouteTables::Clear()
+{
+    tables_.clear();
+}
+
+const WareRouteTables::Entry* WareRouteTables::GetEntry(const Table& table, const noRoadNode& node)
+{
+    const auto it = table.find(node.GetObjId());
+    return (it == table.end()) ? nullptr : &it->second;
+}
+
+const WareRouteTables::Entry* WareRouteTables::GetStartEntry(Table& table, const noRoadNode& start)
+{
+    const Entry* entry = GetEntry(table, start);
+    if(entry || start.GetGOT() == GOT_FLAG)
+        return entry;
+    // A building is only connected to its flag. Same entry as set by Build
+    const noRoadNode* flag = start.GetNeighbour(Direction::SOUTHEAST);
+    const Entry* flagEntry = flag ? GetEntry(table, *flag) : nullptr;
+    if(!flagEntry)
+        return nullptr;
+    const unsigned distance = flagEntry->distance + start.GetRoute(Direction::SOUTHEAST)->GetLength();
+    Entry& newEntry = table[start.GetObjId()];
+    newEntry = {distance, RoadPathDirection::SouthEast};
+    return &newEntry;
+}
+
+/// Dijkstra from the goal backwards over the roads using the same rules as the road path finder for wares
+void WareRouteTables::Build(const noRoadNode& goal, Table& table)
+{
+    table.clear();
+    std::priority_queue<OpenNode, std::vector<OpenNode>, OpenNodeGreater> todo;
+    table[goal.GetObjId()] = {0, RoadPathDirection::None};
+    todo.emplace(0, goal.GetObjId(), &goal);
+
+    while(!todo.empty())
+    {
+        unsigned distance;
+        const noRoadNode* node;
+        std::tie(distance, std::ignore, node) = todo.top();
+        todo.pop();
+        // Outdated entry (node was reached with a shorter distance later)
+        if(table[node->GetObjId()].distance != distance)
+            continue;
+
+        for(const auto dir : helpers::EnumRange<Direction>{})
+        {
+            const noRoadNode* neighbour = node->GetNeighbour(dir);
+            if(!neighbour)
+                continue;
+            // The road is used from neighbour to node. No paths over buildings, only flags and harbors can be passed
+            const Direction dirFromNeighbour = dir + 3u;
+            if(dirFromNeighbour == Direction::NORTHWEST && node != &goal && node->GetGOT() != GOT_FLAG
+               && node->GetGOT() != GOT_NOB_HARBORBUILDING)
+                continue;
+            const unsigned newDistance = distance + node->GetRoute(dir)->GetLength();
+            const auto itNeighbour = table.find(neighbour->GetObjId());
+            if(itNeighbour != table.end() && itNeighbour->second.distance <= newDistance)
+                continue;
+            table[neighbour->GetObjId()] = {newDistance, toRoadPathDirection(dirFromNeighbour)};
+            todo.emplace(newDistance, neighbour->GetObjId(), neighbour);
+        }
+    }
+}
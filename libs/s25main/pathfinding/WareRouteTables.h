@@ -0,0 +1,63 @@
+// Copyright (c) 2005 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "gameTypes/RoadPathDirection.h"
+#include <unordered_map>
+
+class noRoadNode;
+
+/// Next-hop tables for ware routes of a player: For each goal the road distance of every node that can reach it and the
+/// direction of the first road on that path.
+/// Distances only consider road lengths and no congestion (punishment points). As congestion only adds costs they are
+/// exact lower bounds of the route costs used for wares. So the path of the table is optimal if there is no congestion
+/// on it and the distances are a perfect heuristic for the A* search otherwise.
+/// The tables depend on the road network only and must be cleared on every change of it. They are a cache only and
+/// hence not serialized, so the results must not depend on when a table was built: Only buildings can be added without
+/// changing the road network. They are dead ends, so they don't change any other entry and are added when used as a
+/// start (see GetStartEntry). Then every table is equal to a newly built one.
+class WareRouteTables
+{
+public:
+    struct Entry
+    {
+        /// Road distance to the goal
+        unsigned distance;
+        /// Direction of the next road to take (None for the goal itself)
+        RoadPathDirection nextDir;
+    };
+    /// Entries by object id of the road nodes
+    using Table = std::unordered_map<unsigned, Entry>;
+
+    /// Get the table for the goal, building it if it does not exist yet
+    Table& Get(const noRoadNode& goal);
+    /// Remove all tables, e.g. after the road network changed
+    void Clear();
+    unsigned GetNumTables() const { return static_cast<unsigned>(tables_.size()); }
+
+    /// Return the entry for the node or nullptr if it cannot reach the goal of the table
+    static const Entry* GetEntry(const Table& table, const noRoadNode& node);
+    /// Same as GetEntry but adds the entry for a building built after the table
+    static const Entry* GetStartEntry(Table& table, const noRoadNode& start);
+    /// Build the table for the goal
+    static void Build(const noRoadNode& goal, Table& table);
+
+private:
+    /// Tables by object id of the goal. At most one per road node and all are removed on every road change
+    std::unordered_map<unsigned, Table> tables_;
+};
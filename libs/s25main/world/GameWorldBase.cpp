@@ -30,6 +30,9 @@
 #include "notifications/NodeNote.h"
 #include "notifications/PlayerNodeNote.h"
 #include "pathfinding/FreePathFinder.h"
+#include "pathfinding/HierarchicalPathFinder.h"
+#include "pathfinding/HumanFlowFields.h"
+#include "pathfinding/PathConditionShip.h"
 #include "pathfinding/RoadPathFinder.h"
 #include "nodeObjs/noFlag.h"
 #include "gameData/BuildingProperties.h"
@@ -38,8 +41,10 @@
 #include <utility>
 
 GameWorldBase::GameWorldBase(std::vector<GamePlayer> players, const GlobalGameSettings& gameSettings, EventManager& em)
-    : roadPathFinder(new RoadPathFinder(*this)), freePathFinder(new FreePathFinder(*this)), players(std::move(players)),
-      gameSettings(gameSettings), em(em), gi(nullptr)
+    : roadPathFinder(new RoadPathFinder(*this)), freePathFinder(new FreePathFinder(*this)),
+      shipPathFinder(new HierarchicalPathFinder<PathConditionShip>(*this)),
+      humanFlowFields(new HumanFlowFields(*this)), players(std::move(players)), gameSettings(gameSettings), em(em),
+      gi(nullptr)
 {}
 
 GameWorldBase::~GameWorldBase() = default;
@@ -50,6 +55,8 @@ void GameWorldBase::Init(const MapExtent& mapSize, DescIdx<LandscapeDesc> lt)
     BuildingProperties::Init();
     World::Init(mapSize, lt);
     freePathFinder->Init(mapSize);
+    shipPathFinder->Init(mapSize);
+    humanFlowFields->Clear();
 }
 
 void GameWorldBase::InitAfterLoad()
@@ -278,6 +285,12 @@ void GameWorldBase::AltitudeChanged(const MapPoint pt)
     GetNotifications().publish(NodeNote(NodeNote::Altitude, pt));
 }
 
+void GameWorldBase::PassabilityChanged(const MapPoint pt)
+{
+    humanFlowFields->MarkChanged(pt);
+    GetNotifications().publish(NodeNote(NodeNote::Passability, pt));
+}
+
 void GameWorldBase::RecalcBQAroundPoint(const MapPoint pt)
 {
     RecalcBQ(pt);
@@ -32,10 +32,14 @@ class FreePathFinder;
 class GamePlayer;
 class GameInterface;
 class GlobalGameSettings;
+class HumanFlowFields;
+template<class T_Condition>
+class HierarchicalPathFinder;
 class noBuildingSite;
 class noFlag;
 class nobHarborBuilding;
 class nofPassiveSoldier;
+struct PathConditionShip;
 class RoadPathFinder;
 
 inline Direction getOppositeDir(const RoadDir roadDir) noexcept
@@ -61,6 +65,8 @@ class GameWorldBase : public World
 {
     std::unique_ptr<RoadPathFinder> roadPathFinder;
     std::unique_ptr<FreePathFinder> freePathFinder;
+    std::unique_ptr<HierarchicalPathFinder<PathConditionShip>> shipPathFinder;
+    std::unique_ptr<HumanFlowFields> humanFlowFields;
     PostManager postManager;
     mutable NotificationManager notifications;
 
@@ -107,11 +113,21 @@ public:
     /// Erstellt eine Liste mit allen Milit�rgeb�uden in der Umgebung, radius bestimmt wie viele K�stchen nach einer
     /// Richtung im Umkreis
     sortedMilitaryBlds LookForMilitaryBuildings(MapPoint pt, unsigned short radius) const;
+    /// Call func for the same buildings as LookForMilitaryBuildings but unsorted and without building a list.
+    /// Stops and returns true as soon as func returns true
+    template<class T_Func>
+    bool CheckMilitaryBuildings(MapPoint pt, unsigned short radius, T_Func&& func) const
+    {
+        return militarySquares.CheckBuildingsInRange(pt, radius, std::forward<T_Func>(func));
+    }
 
     /// Finds a path for figures. Returns first direction to walk in if found
     helpers::OptionalEnum<Direction> FindHumanPath(MapPoint start, MapPoint dest, unsigned max_route = 0xFFFFFFFF,
                                                    bool random_route = false, unsigned* length = nullptr,
                                                    std::vector<Direction>* route = nullptr) const;
+    /// Find a path for figures to a goal many figures go to (e.g. the flag of an attacked building).
+    /// Returns the first direction of a shortest path with at most max_route steps, if found
+    helpers::OptionalEnum<Direction> FindHumanPathToSharedGoal(MapPoint start, MapPoint dest, unsigned max_route) const;
     /// Find path for ships to a specific harbor and see. Return true on success
     bool FindShipPathToHarbor(MapPoint start, unsigned harborId, unsigned seaId, std::vector<Direction>* route,
                               unsigned* length);
@@ -120,6 +136,8 @@ public:
                       unsigned* length);
     RoadPathFinder& GetRoadPathFinder() const { return *roadPathFinder; }
     FreePathFinder& GetFreePathFinder() const { return *freePathFinder; }
+    HierarchicalPathFinder<PathConditionShip>& GetShipPathFinder() const { return *shipPathFinder; }
+    HumanFlowFields& GetHumanFlowFields() const { return *humanFlowFields; }
 
     /// Return flag that is on road at given point. dir will be set to the direction of the road from the returned flag
     /// prevDir (if set) will be skipped when searching for the road points
@@ -220,6 +238,7 @@ protected:
     void VisibilityChanged(MapPoint pt, unsigned player, Visibility oldVis, Visibility newVis) override;
     /// Called, when the altitude of a point was changed
     void AltitudeChanged(MapPoint pt) override;
+    void PassabilityChanged(MapPoint pt) override;
 
 private:
     /// Returns the harbor ID of the next matching harbor in the given direction (0 = None)
@@ -35,8 +35,11 @@
 #include "notifications/ExpeditionNote.h"
 #include "notifications/NodeNote.h"
 #include "notifications/RoadNote.h"
+#include "pathfinding/HierarchicalPathFinder.h"
+#include "pathfinding/HumanFlowFields.h"
 #include "pathfinding/PathConditionHuman.h"
 #include "pathfinding/PathConditionRoad.h"
+#include "pathfinding/PathConditionShip.h"
 #include "postSystem/PostMsgWithBuilding.h"
 #include "world/MapGeometry.h"
 #include "world/TerritoryRegion.h"
@@ -65,7 +68,7 @@ inline std::vector<GamePlayer> CreatePlayers(const std::vector<PlayerInfo>& play
 
 GameWorldGame::GameWorldGame(const std::vector<PlayerInfo>& players, const GlobalGameSettings& gameSettings,
                              EventManager& em)
-    : GameWorldBase(CreatePlayers(players, *this), gameSettings, em)
+    : GameWorldBase(CreatePlayers(players, *this), gameSettings, em), territoryChangeDepth_(0)
 {
     TradePathCache::inst().Clear();
     GameObject::AttachWorld(this);
@@ -291,7 +294,7 @@ bool GameWorldGame::HasRemovableObjForRoad(const MapPoint pt) const
 // tries to fix
 //#define PREVENT_BORDER_STONE_BLOCKING
 
-void GameWorldGame::RecalcBorderStones(Position startPt, Extent areaSize)
+void GameWorldGame::AddBorderStoneMargin(Position& startPt, Extent& areaSize) const
 {
     // Add a bit extra space as this influences also border stones around the region
     // But not so much we wrap completely around the map (+1 to round up, /2 to have extra space centered)
@@ -300,6 +303,11 @@ void GameWorldGame::RecalcBorderStones(Position startPt, Extent areaSize)
     areaSize += 2u * Extent(EXTRA_SPACE);
     // We might still be 1 node to big, make sure we have don't exceed the mapsize
     areaSize = elMin(areaSize, Extent(GetSize()));
+}
+
+void GameWorldGame::RecalcBorderStones(Position startPt, Extent areaSize)
+{
+    AddBorderStoneMargin(startPt, areaSize);
 
 #ifdef PREVENT_BORDER_STONE_BLOCKING
     // Store how many neighbors a border stone has
@@ -390,6 +398,9 @@ void GameWorldGame::RecalcTerritory(const noBaseBuilding& building, TerritoryCha
     const unsigned militaryRadius = building.GetMilitaryRadius();
     RTTR_Assert(militaryRadius > 0u);
 
+    // Changes triggered by this one or done during a TerritoryChangeBatch are merged
+    ++territoryChangeDepth_;
+
     const TerritoryRegion region = CreateTerritoryRegion(building, militaryRadius + ADD_RADIUS, reason);
 
     std::vector<MapPoint> ptsWithChangedOwners;
@@ -451,17 +462,12 @@ void GameWorldGame::RecalcTerritory(const noBaseBuilding& building, TerritoryCha
     for(const MapPoint& curMapPt : ptsWithChangedOwners)
         GetNotifications().publish(NodeNote(NodeNote::Owner, curMapPt));
 
-    for(const MapPoint& pt : ptsHandled)
-    {
-        // BQ neu berechnen
-        RecalcBQ(pt);
-        // ggf den noch darüber, falls es eine Flagge war (kann ja ein Gebäude entstehen)
-        const MapPoint neighbourPt = GetNeighbour(pt, Direction::NORTHWEST);
-        if(GetNode(neighbourPt).bq != BQ_NOTHING)
-            RecalcBQ(neighbourPt);
-    }
-
-    RecalcBorderStones(region.startPt, region.size);
+    // BQ and border stones only depend on the final owners, so calculate them once for all merged changes
+    pendingBQPts_.insert(ptsHandled.begin(), ptsHandled.end());
+    AddPendingBorderStones(region.startPt, region.size);
+    // Not merged -> Update before the visibilities as usual
+    if(territoryChangeDepth_ == 1)
+        UpdatePendingTerritoryData();
 
     // Recalc visibilities if building was destroyed
     // Otherwise just set everything to visible
@@ -495,9 +501,110 @@ void GameWorldGame::RecalcTerritory(const noBaseBuilding& building, TerritoryCha
             const uint8_t newOwner = GetNode(pt).owner;
             // Event for map scripting
             if(newOwner != 0)
-                GetLua().EventOccupied(newOwner - 1, pt);
+                pendingOccupiedEvents_.emplace_back(newOwner - 1, pt);
         }
     }
+
+    FinishTerritoryChange();
+}
+
+GameWorldGame::TerritoryChangeBatch::TerritoryChangeBatch(GameWorldGame& world) : world_(world), isFinished_(false)
+{
+    ++world_.territoryChangeDepth_;
+}
+
+GameWorldGame::TerritoryChangeBatch::~TerritoryChangeBatch()
+{
+    // No updates here as they would run script events during stack unwinding
+    if(!isFinished_)
+        --world_.territoryChangeDepth_;
+}
+
+void GameWorldGame::TerritoryChangeBatch::Finish()
+{
+    RTTR_Assert(!isFinished_);
+    isFinished_ = true;
+    world_.FinishTerritoryChange();
+}
+
+void GameWorldGame::FinishTerritoryChange()
+{
+    RTTR_Assert(territoryChangeDepth_ > 0);
+    if(--territoryChangeDepth_ > 0)
+        return;
+    UpdatePendingTerritoryData();
+    // Send script events only after everything is updated
+    std::vector<std::pair<unsigned char, MapPoint>> occupiedEvents;
+    std::swap(occupiedEvents, pendingOccupiedEvents_);
+    for(const auto& occupiedEvent : occupiedEvents)
+        GetLua().EventOccupied(occupiedEvent.first, occupiedEvent.second);
+}
+
+void GameWorldGame::AddPendingBorderStones(Position startPt, Extent areaSize)
+{
+    // Merge with overlapping regions so each node is only calculated once.
+    // Coordinates are not wrapped, so regions overlapping across the map border stay separate which is just slower
+    Position endPt = startPt + Position(areaSize);
+    for(auto it = pendingBorderStones_.begin(); it != pendingBorderStones_.end();)
+    {
+        const Position otherEndPt = it->startPt + Position(it->size);
+        if(startPt.x <= otherEndPt.x && it->startPt.x <= endPt.x && startPt.y <= otherEndPt.y
+           && it->startPt.y <= endPt.y)
+        {
+            startPt = elMin(startPt, it->startPt);
+            endPt = elMax(endPt, otherEndPt);
+            it = pendingBorderStones_.erase(it);
+        } else
+            ++it;
+    }
+    // A region spanning the whole map in one direction covers every node there regardless of its start
+    pendingBorderStones_.push_back({startPt, elMin(Extent(endPt - startPt), Extent(GetSize()))});
+}
+
+bool GameWorldGame::IsInPendingBorderStones(const MapPoint pt) const
+{
+    const int width = GetWidth();
+    const int height = GetHeight();
+    for(const BorderStoneRegion& region : pendingBorderStones_)
+    {
+        Position startPt = region.startPt;
+        Extent areaSize = region.size;
+        AddBorderStoneMargin(startPt, areaSize);
+        // Offset from the start of the region with wrapping as done by RecalcBorderStones
+        const int offsetX = ((pt.x - startPt.x) % width + width) % width;
+        const int offsetY = ((pt.y - startPt.y) % height + height) % height;
+        if(offsetX < static_cast<int>(areaSize.x) && offsetY < static_cast<int>(areaSize.y))
+            return true;
+    }
+    return false;
+}
+
+void GameWorldGame::UpdatePendingTerritoryData()
+{
+    for(const MapPoint& pt : pendingBQPts_)
+    {
+        // BQ neu berechnen
+        RecalcBQ(pt);
+        // ggf den noch darüber, falls es eine Flagge war (kann ja ein Gebäude entstehen)
+        const MapPoint neighbourPt = GetNeighbour(pt, Direction::NORTHWEST);
+        if(GetNode(neighbourPt).bq != BQ_NOTHING)
+            RecalcBQ(neighbourPt);
+    }
+    pendingBQPts_.clear();
+
+    for(const BorderStoneRegion& region : pendingBorderStones_)
+        RecalcBorderStones(region.startPt, region.size);
+    pendingBorderStones_.clear();
+
+    // Store the new border stones for nodes which got FoW while the update was pending
+    for(const auto& fowNode : pendingFoWNodes_)
+    {
+        MapNode& node = GetNodeInt(fowNode.first);
+        FoWNode& fow = node.fow[fowNode.second];
+        if(fow.visibility == VIS_FOW)
+            fow.boundary_stones = node.boundary_stones;
+    }
+    pendingFoWNodes_.clear();
 }
 
 bool GameWorldGame::DoesDestructionChangeTerritory(const noBaseBuilding& building) const
@@ -1032,24 +1139,17 @@ bool GameWorldGame::ValidPointForFighting(const MapPoint pt, const bool avoid_mi
 bool GameWorldGame::IsPointCompletelyVisible(const MapPoint& pt, unsigned char player,
                                              const noBaseBuilding* exception) const
 {
-    sortedMilitaryBlds buildings = LookForMilitaryBuildings(pt, 3);
-
     // Sichtbereich von Militärgebäuden
-    for(const nobBaseMilitary* milBld : buildings)
-    {
-        if(milBld->GetPlayer() == player && milBld != exception)
-        {
-            // Prüfen, obs auch unbesetzt ist
-            if(milBld->GetGOT() == GOT_NOB_MILITARY)
-            {
-                if(static_cast<const nobMilitary*>(milBld)->IsNewBuilt())
-                    continue;
-            }
-
-            if(CalcDistance(pt, milBld->GetPos()) <= unsigned(milBld->GetMilitaryRadius() + VISUALRANGE_MILITARY))
-                return true;
-        }
-    }
+    const bool isVisibleByMilBld = CheckMilitaryBuildings(pt, 3, [&](const nobBaseMilitary* milBld) {
+        if(milBld->GetPlayer() != player || milBld == exception)
+            return false;
+        // Prüfen, obs auch unbesetzt ist
+        if(milBld->GetGOT() == GOT_NOB_MILITARY && static_cast<const nobMilitary*>(milBld)->IsNewBuilt())
+            return false;
+        return CalcDistance(pt, milBld->GetPos()) <= unsigned(milBld->GetMilitaryRadius() + VISUALRANGE_MILITARY);
+    });
+    if(isVisibleByMilBld)
+        return true;
 
     // Sichtbereich von Hafenbaustellen
     for(const noBuildingSite* bldSite : harbor_building_sites_from_sea)
@@ -1403,12 +1503,19 @@ std::vector<unsigned> GameWorldGame::GetUnexploredHarborPoints(const unsigned hb
 
 MapNode& GameWorldGame::GetNodeWriteable(const MapPoint pt)
 {
+    // The terrain might be changed
+    GetShipPathFinder().MarkChanged(pt);
+    ClearSeaRouteFields();
+    GetHumanFlowFields().MarkChanged(pt);
     return GetNodeInt(pt);
 }
 
 void GameWorldGame::VisibilityChanged(const MapPoint pt, unsigned player, Visibility oldVis, Visibility newVis)
 {
     GameWorldBase::VisibilityChanged(pt, player, oldVis, newVis);
+    // The stored border stones will be outdated after the pending update
+    if(newVis == VIS_FOW && IsInPendingBorderStones(pt))
+        pendingFoWNodes_.emplace_back(pt, player);
     if(oldVis == VIS_INVISIBLE && newVis == VIS_VISIBLE && HasLua())
         GetLua().EventExplored(player, pt, GetNode(pt).owner);
     // Minimap Bescheid sagen
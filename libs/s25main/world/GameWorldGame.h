@@ -21,6 +21,8 @@
 #include "world/GameWorldBase.h"
 #include "gameTypes/MapCoordinates.h"
 #include "gameTypes/RoadPathDirection.h"
+#include <set>
+#include <utility>
 #include <vector>
 
 class GameInterface;
@@ -70,11 +72,56 @@ class GameWorldGame : public GameWorldBase
     void CleanTerritoryRegion(TerritoryRegion& region, TerritoryChangeReason reason,
                               const noBaseBuilding& triggerBld) const;
 
+    /// Region whose border stones need to be recalculated
+    struct BorderStoneRegion
+    {
+        Position startPt;
+        Extent size;
+    };
+    /// Number of running RecalcTerritory calls and TerritoryChangeBatches. Changes are merged while this is > 1
+    unsigned territoryChangeDepth_;
+    /// Points whose BQ needs to be recalculated after the current territory change
+    std::set<MapPoint, MapPointLess> pendingBQPts_;
+    /// Regions needing new border stones after the current territory change
+    std::vector<BorderStoneRegion> pendingBorderStones_;
+    /// FoW nodes (point, player) saved inside a pending region. They stored border stones which are not updated yet
+    std::vector<std::pair<MapPoint, unsigned>> pendingFoWNodes_;
+    /// Script events (player, point) for occupied nodes to be sent after the current territory change
+    std::vector<std::pair<unsigned char, MapPoint>> pendingOccupiedEvents_;
+    /// Add a region to the pending border stone updates merging it with overlapping ones
+    void AddPendingBorderStones(Position startPt, Extent areaSize);
+    /// Return true if the border stones at the point might be changed by the pending updates
+    bool IsInPendingBorderStones(MapPoint pt) const;
+    /// Recalculate the BQ and border stones for all pending territory changes
+    void UpdatePendingTerritoryData();
+    /// End a territory change or batch and do all pending updates if it was the outermost one
+    void FinishTerritoryChange();
+    /// Extend the region by the nodes whose border stones might be influenced by changes in it
+    void AddBorderStoneMargin(Position& startPt, Extent& areaSize) const;
+
 protected:
     /// Create Trade graphs
     void CreateTradeGraphs();
 
 public:
+    /// Merges all territory changes while it exists (e.g. all captures of one GF): Owners are changed immediately
+    /// but BQ, border stones and script events are updated only once by Finish
+    class TerritoryChangeBatch
+    {
+        GameWorldGame& world_;
+        bool isFinished_;
+
+    public:
+        explicit TerritoryChangeBatch(GameWorldGame& world);
+        /// Only leaves the batch if Finish was not called (e.g. on exceptions). Updates are then done by the next
+        /// territory change
+        ~TerritoryChangeBatch();
+        /// Leave the batch and do all pending updates if it was the outermost one
+        void Finish();
+        TerritoryChangeBatch(const TerritoryChangeBatch&) = delete;
+        TerritoryChangeBatch& operator=(const TerritoryChangeBatch&) = delete;
+    };
+
     GameWorldGame(const std::vector<PlayerInfo>& players, const GlobalGameSettings& gameSettings, EventManager& em);
     ~GameWorldGame() override;
 
@@ -102,9 +149,11 @@ public:
     RoadPathDirection FindHumanPathOnRoads(const noRoadNode& start, const noRoadNode& goal, unsigned* length = nullptr,
                                            MapPoint* firstPt = nullptr, const RoadSegment* forbidden = nullptr);
     /// Find a path for wares using roads.
+    /// If segmentIds is given it receives the ids of all road segments used by the path
     RoadPathDirection FindPathForWareOnRoads(const noRoadNode& start, const noRoadNode& goal,
                                              unsigned* length = nullptr, MapPoint* firstPt = nullptr,
-                                             unsigned max = std::numeric_limits<unsigned>::max());
+                                             unsigned max = std::numeric_limits<unsigned>::max(),
+                                             std::vector<unsigned>* segmentIds = nullptr);
     /// Prüft, ob eine Schiffsroute noch Gültigkeit hat
     bool CheckShipRoute(MapPoint start, const std::vector<Direction>& route, unsigned pos, MapPoint* dest);
     /// Find a route for trade caravanes
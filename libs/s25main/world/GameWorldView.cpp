@@ -40,7 +40,6 @@
 #include "gameData/BuildingConsts.h"
 #include "gameData/GuiConsts.h"
 #include "gameData/MapConsts.h"
-#include "s25util/warningSuppression.h"
 #include <glad/glad.h>
 #include <boost/format.hpp>
 #include <cmath>
@@ -497,12 +496,14 @@ void GameWorldView::DrawObject(const MapPoint& pt, const DrawPoint& curPos)
 
     obj->Draw(curPos);
 
-    return;
-    // TODO: military aid - display icon overlay of attack possibility
-    RTTR_IGNORE_UNREACHABLE_CODE
-    if(gwv.GetNumSoldiersForAttack(pt) > 0) // soldiers available for attack?
+    // Military aid: Display icon overlay of attack possibility
+    if(!GetWorld().GetGGS().isEnabled(AddonId::MILITARY_AID))
+        return;
+    const GO_Type got = obj->GetGOT();
+    if(got != GOT_NOB_MILITARY && got != GOT_NOB_HQ && got != GOT_NOB_HARBORBUILDING)
+        return;
+    if(gwv.IsAttackPossible(pt)) // soldiers available for attack?
         LOADER.GetImageN("map_new", 20000)->DrawFull(curPos + DrawPoint(1, -5));
-    RTTR_POP_DIAGNOSTIC
 }
 
 void GameWorldView::DrawBoundaryStone(const MapPoint& pt, const DrawPoint pos, Visibility vis)
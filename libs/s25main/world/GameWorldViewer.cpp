@@ -21,6 +21,7 @@
 #include "RttrForeachPt.h"
 #include "buildings/nobMilitary.h"
 #include "network/GameClient.h"
+#include "notifications/BuildingNote.h"
 #include "notifications/NodeNote.h"
 #include "notifications/PlayerNodeNote.h"
 #include "notifications/RoadNote.h"
@@ -29,10 +30,13 @@
 #include "nodeObjs/noShip.h"
 #include "gameTypes/MapCoordinates.h"
 #include "gameData/BuildingProperties.h"
+#include "gameData/MilitaryConsts.h"
 
-GameWorldViewer::GameWorldViewer(unsigned playerId, GameWorldBase& gwb) : playerId_(playerId), gwb(gwb)
+GameWorldViewer::GameWorldViewer(unsigned playerId, GameWorldBase& gwb)
+    : playerId_(playerId), gwb(gwb), attackSettingOfCache(0), isTerrainRendererDetached_(false)
 {
     InitVisualData();
+    SubscribeAttackCache();
 }
 
 void GameWorldViewer::InitVisualData()
@@ -54,9 +58,54 @@ void GameWorldViewer::InitVisualData()
     });
 }
 
+void GameWorldViewer::SubscribeAttackCache()
+{
+    // Any building event might change the soldiers available for an attack
+    evMilitaryChanged =
+      gwb.GetNotifications().subscribe<BuildingNote>([this](const BuildingNote&) { attackPossibleCache.clear(); });
+    // Attackers walk at most MAX_ATTACKING_RUN_DISTANCE, so only targets that close can get or lose a path
+    evPassabilityChanged = gwb.GetNotifications().subscribe<NodeNote>([this](const NodeNote& note) {
+        if(note.type != NodeNote::Passability)
+            return;
+        for(auto it = attackPossibleCache.begin(); it != attackPossibleCache.end();)
+        {
+            if(GetWorld().CalcDistance(it->second.target, note.pos) <= MAX_ATTACKING_RUN_DISTANCE + 1)
+                it = attackPossibleCache.erase(it);
+            else
+                ++it;
+        }
+    });
+}
+
 void GameWorldViewer::InitTerrainRenderer()
 {
     tr.GenerateOpenGL(*this);
+    isTerrainRendererDetached_ = false;
+    SubscribeTerrainRenderer();
+}
+
+void GameWorldViewer::DetachTerrainRenderer()
+{
+    // Not initialized (e.g. no OpenGL) or already detached
+    if(!evAltitudeChanged)
+        return;
+    evAltitudeChanged.reset();
+    evVisibilityChanged.reset();
+    isTerrainRendererDetached_ = true;
+}
+
+void GameWorldViewer::ReattachTerrainRenderer()
+{
+    if(!isTerrainRendererDetached_)
+        return;
+    isTerrainRendererDetached_ = false;
+    // Rebuild everything at once instead of many small updates for each change
+    tr.UpdateAll(*this);
+    SubscribeTerrainRenderer();
+}
+
+void GameWorldViewer::SubscribeTerrainRenderer()
+{
     // Notify renderer about altitude changes
     evAltitudeChanged = gwb.GetNotifications().subscribe<NodeNote>([this](const NodeNote& note) {
         if(note.type == NodeNote::Altitude)
@@ -89,17 +138,45 @@ unsigned GameWorldViewer::GetNumSoldiersForAttack(const MapPoint pt) const
     // Militärgebäude in der Nähe finden
     unsigned total_count = 0;
 
-    sortedMilitaryBlds buildings = GetWorld().LookForMilitaryBuildings(pt, 3);
-    for(auto& building : buildings)
-    {
+    GetWorld().CheckMilitaryBuildings(pt, 3, [this, pt, &total_count](const nobBaseMilitary* building) {
         // Muss ein Gebäude von uns sein und darf nur ein "normales Militärgebäude" sein (kein HQ etc.)
         if(building->GetPlayer() == playerId_ && BuildingProperties::IsMilitary(building->GetBuildingType()))
-            total_count += static_cast<nobMilitary*>(building)->GetNumSoldiersForAttack(pt);
-    }
+            total_count += static_cast<const nobMilitary*>(building)->GetNumSoldiersForAttack(pt);
+        return false;
+    });
 
     return total_count;
 }
 
+bool GameWorldViewer::IsAttackPossible(const MapPoint pt) const
+{
+    // Team settings and visibility change without a notification, but are cheap to check
+    const auto* attacked_building = GetWorld().GetSpecObj<nobBaseMilitary>(pt);
+    if(!attacked_building || !attacked_building->IsAttackable(playerId_))
+        return false;
+
+    const unsigned char attackSetting = GetPlayer().GetMilitarySetting(3);
+    if(attackSetting != attackSettingOfCache)
+    {
+        attackPossibleCache.clear();
+        attackSettingOfCache = attackSetting;
+    }
+    const unsigned idx = GetWorld().GetIdx(pt);
+    const auto it = attackPossibleCache.find(idx);
+    if(it != attackPossibleCache.end())
+        return it->second.isPossible;
+    // Same as GetNumSoldiersForAttack > 0 but stops at the first building which can attack
+    bool isPossible = false;
+    GetWorld().CheckMilitaryBuildings(pt, 3, [this, pt, &isPossible](const nobBaseMilitary* building) {
+        if(building->GetPlayer() == playerId_ && BuildingProperties::IsMilitary(building->GetBuildingType())
+           && static_cast<const nobMilitary*>(building)->GetNumSoldiersForAttack(pt) > 0)
+            isPossible = true;
+        return isPossible;
+    });
+    attackPossibleCache[idx] = AttackPossibleEntry{pt, isPossible};
+    return isPossible;
+}
+
 BuildingQuality GameWorldViewer::GetBQ(const MapPoint& pt) const
 {
     return GetWorld().AdjustBQ(pt, playerId_, visualNodes[pt].bq);
@@ -231,6 +308,7 @@ void GameWorldViewer::ChangePlayer(unsigned player, bool updateVisualData /* = t
     if(player == playerId_)
         return;
     playerId_ = player;
+    attackPossibleCache.clear();
     if(updateVisualData)
     {
         RecalcAllColors();
@@ -25,6 +25,8 @@
 #include "gameTypes/Direction.h"
 #include "gameTypes/MapCoordinates.h"
 #include "gameTypes/MapTypes.h"
+#include <unordered_map>
+#include <vector>
 
 class GamePlayer;
 class FOWObject;
@@ -42,6 +44,10 @@ public:
 
     /// Init the terrain renderer. Must be done before first call to GetTerrainRenderer!
     void InitTerrainRenderer();
+    /// Stop updating the terrain renderer on changes of the world (e.g. while fast forwarding)
+    void DetachTerrainRenderer();
+    /// Update the terrain renderer to the current world state and keep it updated again
+    void ReattachTerrainRenderer();
 
     /// Return the world itself
     const GameWorldBase& GetWorld() const { return gwb; }
@@ -56,6 +62,10 @@ public:
 
     /// Get number of soldiers that can attack bld at that point
     unsigned GetNumSoldiersForAttack(MapPoint pt) const;
+    /// Return true if at least one soldier can attack the bld at that point.
+    /// Only the own buildings with soldiers available are cached (until a building, its troops or the attack setting
+    /// change). Team settings, visibility and the paths of the soldiers are checked on every call
+    bool IsAttackPossible(MapPoint pt) const;
     /// Get number of soldiers for attacking a point via sea
     unsigned GetNumSoldiersForSeaAttack(MapPoint pt) const;
 
@@ -112,9 +122,23 @@ private:
     GameWorldBase& gwb;
     TerrainRenderer tr;
     Subscription evVisibilityChanged, evAltitudeChanged, evRoadConstruction, evBQChanged;
+    Subscription evMilitaryChanged, evPassabilityChanged;
+    struct AttackPossibleEntry
+    {
+        MapPoint target;
+        /// Own soldiers are available for attacking the target and can walk there
+        bool isPossible;
+    };
+    /// Entries by map index of the target
+    mutable std::unordered_map<unsigned, AttackPossibleEntry> attackPossibleCache;
+    /// Attack setting (military setting 3) the cache was filled with
+    mutable unsigned char attackSettingOfCache;
+    bool isTerrainRendererDetached_;
     NodeMapBase<VisualMapNode> visualNodes;
 
     void InitVisualData();
+    void SubscribeAttackCache();
+    void SubscribeTerrainRenderer();
     inline void VisibilityChanged(const MapPoint& pt, unsigned player);
     inline void RoadConstructionEnded(const RoadNote& note);
     void RecalcBQ(const MapPoint& pt);
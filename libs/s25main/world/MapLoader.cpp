@@ -623,6 +623,8 @@ void MapLoader::CalcHarborPosNeighbors(World& world)
             }
         }
     }
+    // Now the coastal points are final and the routes to them can be calculated
+    world.CalcSeaRouteFields();
 }
 
 /// Vermisst ein neues Weltmeer von einem Punkt aus, indem es alle mit diesem Punkt verbundenen
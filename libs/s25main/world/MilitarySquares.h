@@ -18,7 +18,8 @@
 #pragma once
 
 #include "gameTypes/MapCoordinates.h"
-#include <list>
+#include <boost/container/small_vector.hpp>
+#include <algorithm>
 #include <vector>
 
 class nobBaseMilitary;
@@ -26,11 +27,15 @@ class sortedMilitaryBlds;
 
 class MilitarySquares
 {
+    /// Buildings of one square. Unordered, removal swaps with the last one (see nobBaseMilitary::militarySquareIdx_)
+    using Square = boost::container::small_vector<nobBaseMilitary*, 4>;
     /// military buildings (including HQs and harbors) per military square
-    std::vector<std::list<nobBaseMilitary*>> squares;
+    std::vector<Square> squares;
     MapExtent size_;
     // Liefert das entsprechende Militärquadrat für einen bestimmten Punkt auf der Karte zurück (normale Koordinaten)
-    std::list<nobBaseMilitary*>& GetSquare(MapPoint pt);
+    Square& GetSquare(MapPoint pt);
+    /// Return the military square coordinates containing the point
+    static Position GetSquarePos(MapPoint pt);
 
 public:
     MilitarySquares();
@@ -38,5 +43,35 @@ public:
     void Clear();
     void Add(nobBaseMilitary* bld);
     void Remove(nobBaseMilitary* bld);
+    /// Return all buildings in the squares around pt sorted by age
     sortedMilitaryBlds GetBuildingsInRange(MapPoint pt, unsigned short radius) const;
+    /// Call func(nobBaseMilitary*) for all buildings in the squares around pt until it returns true.
+    /// Return true if it did so. The order is unspecified, so use this only if the result does not depend on it
+    template<class T_Func>
+    bool CheckBuildingsInRange(MapPoint pt, unsigned short radius, T_Func&& func) const;
 };
+
+template<class T_Func>
+bool MilitarySquares::CheckBuildingsInRange(const MapPoint pt, unsigned short radius, T_Func&& func) const
+{
+    const Position milPos = GetSquarePos(pt);
+    // Visit each square at most once even if the range is bigger than the map
+    const Position numSquares(std::min<int>(2 * radius + 1, size_.x), std::min<int>(2 * radius + 1, size_.y));
+    const Position firstPt = milPos - Position::all(radius);
+
+    for(int dy = 0; dy < numSquares.y; ++dy)
+    {
+        // Handle wrap-around
+        const int realY = ((firstPt.y + dy) % size_.y + size_.y) % size_.y;
+        for(int dx = 0; dx < numSquares.x; ++dx)
+        {
+            const int realX = ((firstPt.x + dx) % size_.x + size_.x) % size_.x;
+            for(nobBaseMilitary* bld : squares[realY * size_.x + realX])
+            {
+                if(func(bld))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
@@ -31,6 +31,11 @@
 #include <set>
 #include <stdexcept>
 
+namespace {
+/// Max number of bytes used for all ship routes to harbors
+constexpr uint64_t MAX_SEA_ROUTE_FIELDS_SIZE = 64 * 1024 * 1024;
+} // namespace
+
 World::World() : noNodeObj(nullptr) {}
 
 World::~World()
@@ -96,6 +101,7 @@ void World::Unload()
 
     catapult_stones.clear();
     harbor_pos.clear();
+    seaRouteFields.clear();
     noNodeObj.reset();
     Resize(MapExtent::all(0));
 }
@@ -159,6 +165,7 @@ void World::SetNO(const MapPoint pt, noBase* obj, const bool replace /* = false*
     RTTR_Assert(!dynamic_cast<noMovable*>(obj)); // It should be a static, non-movable object
 #endif
     GetNodeInt(pt).obj = obj;
+    PassabilityChanged(pt);
 }
 
 void World::DestroyNO(const MapPoint pt, const bool checkExists /* = true*/)
@@ -169,6 +176,7 @@ void World::DestroyNO(const MapPoint pt, const bool checkExists /* = true*/)
         // Destroy may remove the NO already from the map or replace it (e.g. building -> fire)
         // So remove from map, then destroy and free
         GetNodeInt(pt).obj = nullptr;
+        PassabilityChanged(pt);
         obj->Destroy();
         deletePtr(obj);
     } else
@@ -436,9 +444,65 @@ unsigned short World::GetSeaFromCoastalPoint(const MapPoint pt) const
     return 0;
 }
 
+void World::InitSeaRouteFields()
+{
+    seaRouteFields.clear();
+    seaRouteFields.resize(harbor_pos.size());
+    // Decide by the worst case size only, so all players make the same decision independent of calculated fields
+    unsigned numCoastalPoints = 0;
+    for(const HarborPos& harbor : harbor_pos)
+    {
+        for(const HarborPos::CoastalPoint& cp : harbor.cps)
+        {
+            if(cp.seaId)
+                numCoastalPoints++;
+        }
+    }
+    useSeaRouteFields = uint64_t(numCoastalPoints) * ((nodes.size() + 1) / 2) <= MAX_SEA_ROUTE_FIELDS_SIZE;
+}
+
+const SeaRouteField* World::GetSeaRouteField(const unsigned harborId, const unsigned short seaId)
+{
+    RTTR_Assert(harborId);
+    RTTR_Assert(seaId);
+    if(seaRouteFields.size() != harbor_pos.size())
+        InitSeaRouteFields();
+    if(!useSeaRouteFields)
+        return nullptr;
+    const MapPoint coastPt = GetCoastalPoint(harborId, seaId);
+    if(!coastPt.isValid())
+        return nullptr;
+    for(const auto dir : helpers::EnumRange<Direction>{})
+    {
+        if(GetNeighbour(harbor_pos[harborId].pos, dir) != coastPt)
+            continue;
+        SeaRouteField& field = seaRouteFields[harborId][dir];
+        if(!field.IsCalculated())
+            field.Calc(*this, coastPt);
+        return &field;
+    }
+    return nullptr;
+}
+
+void World::CalcSeaRouteFields()
+{
+    InitSeaRouteFields();
+    if(!useSeaRouteFields)
+        return;
+    for(unsigned harborId = 1; harborId < harbor_pos.size(); harborId++)
+    {
+        for(const auto dir : helpers::EnumRange<Direction>{})
+        {
+            if(harbor_pos[harborId].cps[dir].seaId)
+                seaRouteFields[harborId][dir].Calc(*this, GetNeighbour(harbor_pos[harborId].pos, dir));
+        }
+    }
+}
+
 void World::SetRoad(const MapPoint pt, RoadDir roadDir, PointRoad type)
 {
     GetNodeInt(pt).roads[roadDir] = type;
+    PassabilityChanged(pt);
 }
 
 bool World::SetBQ(const MapPoint pt, BuildingQuality bq)
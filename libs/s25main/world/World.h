@@ -18,6 +18,8 @@
 #pragma once
 
 #include "enum_cast.hpp"
+#include "helpers/EnumArray.h"
+#include "pathfinding/SeaRouteField.h"
 #include "world/MapBase.h"
 #include "world/MilitarySquares.h"
 #include "gameTypes/Direction.h"
@@ -62,11 +64,16 @@ class World : public MapBase
 
     /// Alle Hafenpositionen
     std::vector<HarborPos> harbor_pos;
+    /// Ship routes to the coastal points of the harbors (by harbor id and direction). Calculated on demand
+    std::vector<helpers::EnumArray<SeaRouteField, Direction>> seaRouteFields;
+    /// False if the fields would need too much memory
+    bool useSeaRouteFields = false;
 
     WorldDescription description_;
 
     std::unique_ptr<noBase> noNodeObj;
     void Resize(const MapExtent& newSize) override final;
+    void InitSeaRouteFields();
 
 public:
     /// Currently flying catapult stones
@@ -178,6 +185,10 @@ public:
     unsigned CalcHarborDistance(unsigned habor_id1, unsigned harborId2) const;
     /// Return the sea id if this is a point at a coast to a sea where ships can go. Else returns 0
     unsigned short GetSeaFromCoastalPoint(MapPoint pt) const;
+    /// Return the ship routes to the coastal point of the harbor at the sea or nullptr if they are not available
+    const SeaRouteField* GetSeaRouteField(unsigned harborId, unsigned short seaId);
+    /// Calculate the ship routes to all coastal points
+    void CalcSeaRouteFields();
 
     RoadDir toRoadDir(MapPoint& pt, const Direction dir) const
     {
@@ -221,6 +232,8 @@ protected:
 
     /// Notify derived classes of changed altitude
     virtual void AltitudeChanged(MapPoint pt) = 0;
+    /// Notify derived classes that the object or a road at the point changed, so figures might walk differently
+    virtual void PassabilityChanged(MapPoint pt) = 0;
     /// Notify derived classes of changed visibility
     virtual void VisibilityChanged(MapPoint pt, unsigned player, Visibility oldVis, Visibility newVis) = 0;
     /// Sets the road for the given (road) direction
@@ -231,6 +244,8 @@ protected:
 
     /// Recalculates the shade of a point
     void RecalcShadow(MapPoint pt);
+    /// Remove the ship routes. Must be called when the terrain changes
+    void ClearSeaRouteFields() { seaRouteFields.clear(); }
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,224 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "RTTR_AssertError.h"
+#include "RTTR_Version.h"
+#include "RttrConfig.h"
+#include "Settings.h"
+#include "files.h"
+#include "network/CreateServerInfo.h"
+#include "network/GameServer.h"
+#include "ogl/glAllocator.h"
+#include "gameTypes/MapType.h"
+#include "libsiedler2/libsiedler2.h"
+#include "s25util/LocaleHelper.h"
+#include "s25util/Log.h"
+#include "s25util/Socket.h"
+#include "s25util/System.h"
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/args.hpp>
+#include <boost/nowide/iostream.hpp>
+#include <boost/program_options.hpp>
+#include <csignal>
+#include <sstream>
+
+/// Headless dedicated server: Runs only the GameServer without any video or audio driver.
+/// The server sleeps till a message arrives or the next GF is due, so its latency does not depend on a frame rate.
+/// Players (including the host, identified by the host password) connect with regular clients.
+
+namespace bfs = boost::filesystem;
+namespace bnw = boost::nowide;
+namespace po = boost::program_options;
+
+namespace {
+volatile std::sig_atomic_t stopRequested = 0;
+
+void HandleStopSignal(int /*signal*/)
+{
+    stopRequested = 1;
+}
+
+std::string GetProgramDescription()
+{
+    std::stringstream s;
+    s << RTTR_Version::GetTitle() << " dedicated server v" << RTTR_Version::GetVersionDate() << "-"
+      << RTTR_Version::GetRevision() << "\n"
+      << "Compiled with " << System::getCompilerName() << " for " << System::getOSName();
+    return s.str();
+}
+
+bool InitLog()
+{
+    const bfs::path logDir = RTTRCONFIG.ExpandPath(s25::folders::logs);
+    boost::system::error_code ec;
+    bfs::create_directories(logDir, ec);
+    if(ec != boost::system::errc::success)
+    {
+        LOG.write("Directory %1% could not be created\n", LogTarget::Stderr) % logDir;
+        return false;
+    }
+    LOG.setLogFilepath(logDir);
+    try
+    {
+        LOG.open();
+        LOG.write("%1%\n\n", LogTarget::File) % GetProgramDescription();
+    } catch(const std::exception& e)
+    {
+        LOG.write("Error initializing log: %1%\nSystem reports: %2%\n", LogTarget::Stderr) % e.what()
+          % LOG.getLastError();
+        return false;
+    }
+    return true;
+}
+
+int RunServer(const po::variables_map& options)
+{
+    const bfs::path mapPath = options["map"].as<std::string>();
+    if(!bfs::is_regular_file(mapPath))
+    {
+        LOG.write("Map %1% does not exist\n", LogTarget::Stderr) % mapPath;
+        return 1;
+    }
+    const std::string extension = boost::algorithm::to_lower_copy(mapPath.extension().string());
+    const MapType mapType = (extension == ".sav") ? MAPTYPE_SAVEGAME : MAPTYPE_OLDMAP;
+
+    const CreateServerInfo csi(options.count("lan") ? ServerType::LAN : ServerType::DIRECT,
+                               options["port"].as<uint16_t>(), options["name"].as<std::string>(),
+                               options["password"].as<std::string>(), options.count("ipv6") > 0,
+                               options.count("upnp") > 0, options["spectator-port"].as<uint16_t>(),
+                               options["spectator-delay"].as<unsigned>());
+    if(!GAMESERVER.Start(csi, mapPath, mapType, options["host-password"].as<std::string>()))
+    {
+        LOG.write("Failed to start the server\n", LogTarget::Stderr);
+        return 1;
+    }
+    LOG.write("Server \"%1%\" started on port %2% with map %3%\n") % csi.gameName % csi.port % mapPath;
+
+    while(GAMESERVER.IsRunning() && !stopRequested)
+    {
+        GAMESERVER.WaitForEvents(GAMESERVER.GetTimeToNextEvent());
+        GAMESERVER.Run();
+    }
+    GAMESERVER.Stop();
+    return 0;
+}
+
+int RunProgram(const po::variables_map& options)
+{
+    LOG.write("%1%\n\n", LogTarget::Stdout) % GetProgramDescription();
+    if(!LocaleHelper::init())
+        return 1;
+    if(!RTTRCONFIG.Init())
+        return 1;
+    if(!InitLog())
+        return 1;
+    // Nobody to ask
+    SETTINGS.global.submit_debug_data = 2;
+
+    std::signal(SIGINT, HandleStopSignal);
+    std::signal(SIGTERM, HandleStopSignal);
+
+    // Required to read the map headers
+    libsiedler2::setAllocator(new GlAllocator());
+    if(!Socket::Initialize())
+    {
+        LOG.write("Could not init sockets!\n", LogTarget::Stderr);
+        return 1;
+    }
+
+    int result;
+    try
+    {
+        result = RunServer(options);
+    } catch(RTTR_AssertError& error)
+    {
+        // Write to log file, but don't throw any errors if this fails too
+        try
+        {
+            LOG.writeToFile(error.what());
+        } catch(...)
+        { //-V565
+        }
+        result = 42;
+    }
+    Socket::Shutdown();
+    libsiedler2::setAllocator(nullptr);
+    return result;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bnw::args _(argc, argv);
+
+    po::options_description desc("Allowed options");
+    // clang-format off
+    desc.add_options()
+        ("help,h", "Show help")
+        ("version", "Show version information and exit")
+        ("map,m", po::value<std::string>(), "Map or savegame to host")
+        ("port,p", po::value<uint16_t>()->default_value(3665), "Port to listen on")
+        ("name,n", po::value<std::string>()->default_value("Dedicated server"), "Name of the game")
+        ("password", po::value<std::string>()->default_value(""), "Password required to join")
+        ("host-password", po::value<std::string>()->default_value(""), "Password to join as the host (game admin)")
+        ("lan", "Announce the game in the LAN")
+        ("ipv6", "Use IPv6")
+        ("upnp", "Use UPnP to forward the port")
+        ("spectator-port", po::value<uint16_t>()->default_value(0), "Port for spectators (0 = no spectators)")
+        ("spectator-delay", po::value<unsigned>()->default_value(60), "Delay of the spectator stream in seconds")
+        ;
+    // clang-format on
+    po::positional_options_description positionalOptions;
+    positionalOptions.add("map", 1);
+
+    po::variables_map options;
+    try
+    {
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(positionalOptions).run(), options);
+        po::notify(options);
+    } catch(const po::error& e)
+    {
+        bnw::cerr << "Error: " << e.what() << "\n\n";
+        bnw::cerr << desc << "\n";
+        return 1;
+    }
+
+    if(options.count("help"))
+    {
+        bnw::cout << desc << "\n";
+        return 0;
+    }
+    if(options.count("version"))
+    {
+        bnw::cout << GetProgramDescription() << std::endl;
+        return 0;
+    }
+    if(!options.count("map"))
+    {
+        bnw::cerr << "Error: No map given\n\n";
+        bnw::cerr << desc << "\n";
+        return 1;
+    }
+    if(options["host-password"].as<std::string>().empty())
+    {
+        bnw::cerr << "Error: A host password is required to be able to configure and start the game\n";
+        return 1;
+    }
+
+    return RunProgram(options);
+}
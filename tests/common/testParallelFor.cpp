@@ -0,0 +1,51 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "helpers/parallelFor.h"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(ParallelFor)
+
+BOOST_AUTO_TEST_CASE(AllIndicesVisitedOnce)
+{
+    for(unsigned numThreads : {0u, 1u, 2u, 7u})
+    {
+        std::vector<int> numCalls(1000, 0);
+        helpers::parallelFor(
+          numCalls.size(), [&numCalls](size_t i) { numCalls[i]++; }, numThreads);
+        BOOST_TEST(std::count(numCalls.begin(), numCalls.end(), 1) == static_cast<long>(numCalls.size()));
+    }
+    // Nothing to do
+    helpers::parallelFor(0, [](size_t) { BOOST_FAIL("Must not be called"); });
+}
+
+BOOST_AUTO_TEST_CASE(ExceptionIsForwarded)
+{
+    BOOST_CHECK_THROW(helpers::parallelFor(
+                        100,
+                        [](size_t i) {
+                            if(i == 42)
+                                throw std::runtime_error("Failed");
+                        },
+                        4),
+                      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
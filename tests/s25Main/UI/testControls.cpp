@@ -250,6 +250,38 @@ BOOST_AUTO_TEST_CASE(AdjustWidthForMaxChars_SetsCorrectSize)
     }
 }
 
+BOOST_AUTO_TEST_CASE(FontLayoutIsCached)
+{
+    auto font = createMockFont({'?', '.', 'a', 'b'});
+    const auto layout = font->GetLayout("ab");
+    BOOST_TEST_REQUIRE(layout);
+    BOOST_TEST(!layout->empty());
+    BOOST_TEST(layout->getWidth() == font->getWidth("ab"));
+    // Same parameters -> Same layout
+    BOOST_TEST(font->GetLayout("ab") == layout);
+    // End string is only used with a width limit
+    BOOST_TEST(font->GetLayout("ab", 0xFFFF, "") == layout);
+    BOOST_TEST(font->GetLayout("ab", 100) != layout);
+
+    // Truncated text includes the end string
+    const std::string longText(20, 'a');
+    const unsigned maxWidth = font->getWidth(longText) / 2;
+    const auto shortLayout = font->GetLayout(longText, maxWidth);
+    BOOST_TEST(shortLayout->getWidth() <= maxWidth);
+    BOOST_TEST(shortLayout->getWidth() > 0u);
+    BOOST_TEST(font->GetLayout(longText, maxWidth) == shortLayout);
+    // End string does not fit -> Nothing to draw
+    BOOST_TEST(font->GetLayout(longText, 1)->empty());
+    BOOST_TEST(font->GetLayout("")->empty());
+
+    // Adding a lot of other layouts eventually evicts the old ones
+    for(unsigned i = 0; i < 5000; i++)
+        font->GetLayout(std::to_string(i));
+    const auto newLayout = font->GetLayout("ab");
+    BOOST_TEST(newLayout != layout);
+    BOOST_TEST(newLayout->getWidth() == layout->getWidth());
+}
+
 static std::vector<std::string> getRow(const ctrlTable& table, unsigned row)
 {
     std::vector<std::string> values(table.GetNumColumns());
@@ -314,4 +346,46 @@ BOOST_AUTO_TEST_CASE(TableSorting)
     BOOST_TEST_CONTEXT("Date column") testRowsEqual({&r6, &r5, &r3, &r2, &r1, &r4});
 }
 
+BOOST_AUTO_TEST_CASE(TableUpdateRows)
+{
+    auto font = createMockFont({'?', 'a', 'z'});
+    ctrlTable table(nullptr, 0, DrawPoint::all(0), Extent(400, 300), TC_GREEN1, font.get(),
+                    ctrlTable::Columns{{"Id", 1, TableSortType::Number}, {"Name", 1, TableSortType::String}});
+    using Rows = std::vector<std::vector<std::string>>;
+    const auto getRows = [&table]() {
+        Rows rows;
+        for(unsigned i = 0; i < table.GetNumRows(); i++)
+            rows.push_back(getRow(table, i));
+        return rows;
+    };
+
+    // Unsorted: Rows are added in the given order
+    BOOST_TEST(table.UpdateRows({{"3", "c"}, {"1", "a"}}, 0));
+    BOOST_TEST((getRows() == Rows{{"3", "c"}, {"1", "a"}}));
+    BOOST_TEST(!table.UpdateRows({{"3", "c"}, {"1", "a"}}, 0));
+    // Missing columns are filled
+    BOOST_TEST(table.UpdateRows({{"3", "c"}, {"1"}}, 0));
+    BOOST_TEST((getRows() == Rows{{"3", "c"}, {"1", ""}}));
+
+    table.SortRows(1, TableSortDir::Descending);
+    table.SetSelection(0u);
+    BOOST_TEST(table.GetItemText(0, 0) == "3");
+    // Existing rows are updated, missing removed, new ones added, duplicates ignored and the order is kept
+    BOOST_TEST(table.UpdateRows({{"2", "b"}, {"3", "c"}, {"4", "z"}, {"2", "a"}}, 0));
+    BOOST_TEST((getRows() == Rows{{"4", "z"}, {"3", "c"}, {"2", "b"}}));
+    // Selection stays on the same key
+    BOOST_TEST((table.GetSelection() == 1u));
+    BOOST_TEST(table.UpdateRows({{"2", "b"}, {"3", "d"}, {"4", "a"}}, 0));
+    BOOST_TEST((getRows() == Rows{{"3", "d"}, {"2", "b"}, {"4", "a"}}));
+    BOOST_TEST((table.GetSelection() == 0u));
+    // Selected row removed
+    BOOST_TEST(table.UpdateRows({{"2", "b"}, {"4", "a"}}, 0));
+    BOOST_TEST(!table.GetSelection());
+    BOOST_TEST(table.UpdateRows({}, 0));
+    BOOST_TEST(table.GetNumRows() == 0u);
+
+    BOOST_CHECK_THROW(table.UpdateRows({}, 2), std::logic_error);
+    BOOST_CHECK_THROW(table.UpdateRows({{"1", "a", "b"}}, 0), std::logic_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "ogl/DummyRenderer.h"
+#include "ogl/glArchivItem_Bitmap_Direct.h"
+#include "uiHelper/uiHelpers.hpp"
+#include <libsiedler2/PixelBufferBGRA.h>
+#include <rttr/test/random.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace libsiedler2;
+
+namespace {
+/// Return the texture content the bitmap would get from a full upload
+std::vector<uint8_t> getFullUpload(const PixelBufferBGRA& buffer)
+{
+    glArchivItem_Bitmap_Direct bmp;
+    bmp.setInterpolateTexture(false);
+    bmp.create(buffer);
+    const DummyRenderer::TextureData* data = DummyRenderer::getTextureData(bmp.GetTexture());
+    BOOST_TEST_REQUIRE(data);
+    return data->pixels;
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(MinimapTexture, uiHelper::Fixture)
+
+BOOST_AUTO_TEST_CASE(DirtyTilesMatchFullUpload)
+{
+    // Multiple tiles in each direction, the last ones only partially used
+    const Extent size(150, 97);
+    PixelBufferBGRA pixels(size.x, size.y, ColorBGRA(0xFF000000));
+    glArchivItem_Bitmap_Direct bmp;
+    bmp.setInterpolateTexture(false);
+    bmp.create(pixels);
+    const unsigned texture = bmp.GetTexture();
+    BOOST_TEST_REQUIRE(DummyRenderer::getTextureData(texture));
+    BOOST_TEST(DummyRenderer::getTextureData(texture)->pixels == getFullUpload(pixels));
+
+    const auto setPixel = [&](const DrawPoint& pos, const ColorBGRA& color) {
+        bmp.updatePixel(pos, color);
+        pixels.set(pos.x, pos.y, color);
+    };
+    for(unsigned round = 0; round < 5; round++)
+    {
+        bmp.beginUpdate();
+        // Single pixels in random tiles, some tiles with multiple pixels
+        for(unsigned i = 0; i < 20; i++)
+        {
+            const DrawPoint pos(rttr::test::randomValue(0u, size.x - 1u), rttr::test::randomValue(0u, size.y - 1u));
+            setPixel(pos, ColorBGRA(rttr::test::randomValue<uint32_t>() | 0xFF000000));
+        }
+        // A line crossing the tile borders
+        for(int x = 60; x < 70; x++)
+            setPixel(DrawPoint(x, 63 + x % 2), ColorBGRA(0xFF00FF00 + round));
+        // Corner pixels
+        setPixel(DrawPoint(0, 0), ColorBGRA(0xFF0000FF + round));
+        setPixel(DrawPoint(size.x - 1, size.y - 1), ColorBGRA(0xFFFF0000 + round));
+        bmp.endUpdate();
+        BOOST_TEST(DummyRenderer::getTextureData(texture)->pixels == getFullUpload(pixels));
+    }
+
+    // Empty update changes nothing
+    bmp.beginUpdate();
+    bmp.endUpdate();
+    BOOST_TEST(DummyRenderer::getTextureData(texture)->pixels == getFullUpload(pixels));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -16,11 +16,14 @@
 // along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
 
 #include "CollisionDetection.h"
+#include "PointOutput.h"
 #include "ogl/glSmartBitmap.h"
 #include "ogl/glTexturePacker.h"
 #include "uiHelper/uiHelpers.hpp"
 #include "libsiedler2/ArchivItem_Bitmap_Raw.h"
 #include "libsiedler2/PixelBufferBGRA.h"
+#include "rttr/test/TmpFolder.hpp"
+#include <boost/nowide/fstream.hpp>
 #include <boost/test/unit_test.hpp>
 #include <Rect.h>
 #include <array>
@@ -74,4 +77,70 @@ BOOST_AUTO_TEST_CASE(SizeAndPosCorrect)
     }
 }
 
+BOOST_AUTO_TEST_CASE(CacheRestoresTexCoords)
+{
+    rttr::test::TmpFolder tmpFolder;
+    const boost::filesystem::path cacheFile = tmpFolder.get() / "sprites.cache";
+    std::array<libsiedler2::ArchivItem_Bitmap_Raw, 4> bmps;
+    std::array<glSmartBitmap, 4> smartBmps, smartBmps2;
+    glTexturePacker packer, packer2;
+    for(unsigned i = 0; i < bmps.size(); ++i)
+    {
+        libsiedler2::PixelBufferBGRA buffer(5 + i * 2, 11 - i, libsiedler2::ColorBGRA(0xFFFFFFFF));
+        bmps[i].create(buffer);
+        smartBmps[i].add(&bmps[i]);
+        smartBmps2[i].add(&bmps[i]);
+        packer.add(smartBmps[i]);
+        packer2.add(smartBmps2[i]);
+    }
+    // Nothing saved yet
+    BOOST_TEST(!packer2.loadCache(cacheFile, 42));
+    // Pixels must be kept for saving
+    BOOST_TEST_REQUIRE(packer.pack());
+    BOOST_TEST(!packer.saveCache(cacheFile, 42));
+    BOOST_TEST_REQUIRE(packer.pack(true));
+    BOOST_TEST_REQUIRE(packer.saveCache(cacheFile, 42));
+
+    // Wrong key -> outdated
+    BOOST_TEST(!packer2.loadCache(cacheFile, 43));
+    BOOST_TEST_REQUIRE(packer2.loadCache(cacheFile, 42));
+    BOOST_TEST_REQUIRE(packer2.getTextures().size() == packer.getTextures().size());
+    BOOST_TEST(packer2.getTextures()[0].getSize() == packer.getTextures()[0].getSize());
+    for(unsigned i = 0; i < smartBmps.size(); ++i)
+    {
+        BOOST_TEST(smartBmps2[i].isGenerated());
+        BOOST_TEST(smartBmps2[i].getTexture() == packer2.getTextures()[0].get());
+        for(unsigned j = 0; j < smartBmps[i].texCoords.size(); j++)
+            BOOST_TEST(smartBmps2[i].texCoords[j] == smartBmps[i].texCoords[j]);
+    }
+
+    // Changed bitmaps -> Cache invalid
+    glSmartBitmap otherBmp;
+    otherBmp.add(&bmps[0]);
+    glTexturePacker packer3;
+    packer3.add(otherBmp);
+    BOOST_TEST(!packer3.loadCache(cacheFile, 42));
+
+    // Corrupt counts or sizes -> Cache invalid without allocating memory for them
+    const auto patchCache = [&cacheFile](std::streamoff offset, uint32_t value) {
+        boost::nowide::fstream file(cacheFile, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        return static_cast<bool>(file);
+    };
+    const std::streamoff numTexturesOffset = 20, firstTexWidthOffset = 24;
+    for(const auto offset : {numTexturesOffset, firstTexWidthOffset})
+    {
+        for(const uint32_t value : {0xFFFFFFFFu, 0x10000000u})
+        {
+            BOOST_TEST_REQUIRE(packer.saveCache(cacheFile, 42));
+            BOOST_TEST_REQUIRE(patchCache(offset, value));
+            BOOST_TEST(!packer2.loadCache(cacheFile, 42));
+        }
+    }
+    // Still works after a rewrite
+    BOOST_TEST_REQUIRE(packer.saveCache(cacheFile, 42));
+    BOOST_TEST(packer2.loadCache(cacheFile, 42));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -31,6 +31,7 @@
 #include "worldFixtures/initGameRNG.hpp"
 #include "world/GameWorldViewer.h"
 #include "nodeObjs/noFlag.h"
+#include "nodeObjs/noGranite.h"
 #include "gameTypes/GameTypesOutput.h"
 #include "gameData/SettingTypeConv.h"
 #include <boost/test/unit_test.hpp>
@@ -289,6 +290,69 @@ BOOST_FIXTURE_TEST_CASE(NumSoldiersForAttack, NumSoldierTestFixture)
     BOOST_REQUIRE_GT(milBld1Near->GetSoldiersStrength(), milBld1Far->GetSoldiersStrength());
 }
 
+BOOST_FIXTURE_TEST_CASE(AttackPossibleIsUpdated, NumSoldierTestFixture)
+{
+    initGameRNG();
+
+    AddSoldiers(milBld0->GetPos(), 6, 0);
+    AddSoldiers(milBld1Far->GetPos(), 6, 0);
+    SetCurPlayer(0);
+    const MapPoint farPos = milBld1Far->GetPos();
+    BOOST_TEST_REQUIRE(gwv.GetNumSoldiersForAttack(farPos) > 0u);
+    BOOST_TEST(gwv.IsAttackPossible(farPos));
+    // No self attack
+    BOOST_TEST(!gwv.IsAttackPossible(milBld0->GetPos()));
+
+    // Changing the attack setting must be reflected
+    MilitarySettings milSettings = MILITARY_SETTINGS_SCALE;
+    milSettings[3] = 0;
+    ChangeMilitary(milSettings);
+    BOOST_TEST(!gwv.IsAttackPossible(farPos));
+    ChangeMilitary(MILITARY_SETTINGS_SCALE);
+    BOOST_TEST(gwv.IsAttackPossible(farPos));
+
+    // Losing soldiers must be reflected
+    auto* attackerBld = world.GetSpecObj<nobMilitary>(milBld0Pos);
+    while(attackerBld->GetNumTroops() > 1u)
+        attackerBld->HitOfCatapultStone();
+    BOOST_TEST(gwv.GetNumSoldiersForAttack(farPos) == 0u);
+    BOOST_TEST(!gwv.IsAttackPossible(farPos));
+    // And so must new ones
+    AddSoldiers(milBld0->GetPos(), 5, 0);
+    BOOST_TEST(gwv.IsAttackPossible(farPos));
+
+    // Blocking the paths must be reflected: Enclose the target with stones
+    std::vector<MapPoint> stonePts;
+    for(const MapPoint pt : world.GetPointsInRadius(farPos, 2))
+    {
+        if(world.GetNO(pt)->GetType() == NOP_NOTHING)
+        {
+            world.SetNO(pt, new noGranite(GT_1, 1));
+            stonePts.push_back(pt);
+        }
+    }
+    BOOST_TEST(gwv.GetNumSoldiersForAttack(farPos) == 0u);
+    BOOST_TEST(!gwv.IsAttackPossible(farPos));
+    for(const MapPoint pt : stonePts)
+        world.DestroyNO(pt);
+    BOOST_TEST(gwv.IsAttackPossible(farPos));
+
+    // Cache is per player
+    SetCurPlayer(1);
+    BOOST_TEST(!gwv.IsAttackPossible(farPos));
+    BOOST_TEST(gwv.IsAttackPossible(milBld0->GetPos()) == (gwv.GetNumSoldiersForAttack(milBld0->GetPos()) > 0u));
+
+    // Allies can't be attacked
+    SetCurPlayer(0);
+    BOOST_TEST_REQUIRE(gwv.IsAttackPossible(farPos));
+    world.GetPlayer(0).team = TM_TEAM1;
+    world.GetPlayer(1).team = TM_TEAM1;
+    world.GetPlayer(0).MakeStartPacts();
+    world.GetPlayer(1).MakeStartPacts();
+    BOOST_TEST_REQUIRE(world.GetPlayer(0).IsAlly(1));
+    BOOST_TEST(!gwv.IsAttackPossible(farPos));
+}
+
 BOOST_FIXTURE_TEST_CASE(StartAttack, AttackFixture<>)
 {
     initGameRNG();
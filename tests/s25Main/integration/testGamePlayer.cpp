@@ -16,14 +16,20 @@
 // along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
 
 #include "GamePlayer.h"
+#include "RoadSegment.h"
+#include "Ware.h"
 #include "buildings/nobBaseWarehouse.h"
 #include "buildings/nobMilitary.h"
+#include "buildings/nobUsual.h"
 #include "factories/BuildingFactory.h"
 #include "figures/nofPassiveSoldier.h"
 #include "worldFixtures/CreateEmptyWorld.h"
 #include "worldFixtures/WorldFixture.h"
+#include "nodeObjs/noFlag.h"
 #include <boost/test/unit_test.hpp>
+#include <array>
 
+using WorldFixtureEmpty1P = WorldFixture<CreateEmptyWorld, 1>;
 using WorldFixtureEmpty2P = WorldFixture<CreateEmptyWorld, 2>;
 
 BOOST_FIXTURE_TEST_CASE(Defeat, WorldFixtureEmpty2P)
@@ -48,3 +54,115 @@ BOOST_FIXTURE_TEST_CASE(Defeat, WorldFixtureEmpty2P)
     world.DestroyNO(milBldPos);
     BOOST_REQUIRE(world.GetPlayer(0).IsDefeated());
 }
+
+BOOST_FIXTURE_TEST_CASE(RoadDestroyedOnlyReroutesAffectedWares, WorldFixtureEmpty1P)
+{
+    GamePlayer& player = world.GetPlayer(0);
+    const MapPoint hqPos = player.GetHQPos();
+    auto* hq = world.GetSpecObj<nobBaseWarehouse>(hqPos);
+    const MapPoint hqFlagPos = hq->GetFlagPos(); //-V522
+    auto* bld = static_cast<nobUsual*>(
+      BuildingFactory::CreateBuilding(world, BLD_BAKERY, world.MakeMapPoint(hqPos + Position(6, 0)), 0, NAT_VIKINGS));
+    // West flag - HQ flag - east flag - building flag and a branch to the south west
+    const MapPoint westFlagPos = world.MakeMapPoint(hqFlagPos - Position(2, 0));
+    const MapPoint eastFlagPos = world.MakeMapPoint(hqFlagPos + Position(4, 0));
+    world.BuildRoad(0, false, hqFlagPos, std::vector<Direction>(2, Direction::WEST));
+    world.BuildRoad(0, false, hqFlagPos, std::vector<Direction>(6, Direction::EAST));
+    world.SetFlag(eastFlagPos, 0);
+    world.BuildRoad(0, false, hqFlagPos, std::vector<Direction>(2, Direction::SOUTHWEST));
+    auto* westFlag = world.GetSpecObj<noFlag>(westFlagPos);
+    auto* eastFlag = world.GetSpecObj<noFlag>(eastFlagPos);
+    BOOST_TEST_REQUIRE(westFlag);
+    BOOST_TEST_REQUIRE(eastFlag);
+    BOOST_TEST(player.AreConnectedByRoads(*westFlag, *bld));
+    BOOST_TEST(player.AreConnectedByRoads(*hq, *bld));
+
+    auto* eastWare = new Ware(GD_FLOUR, bld, eastFlag);
+    eastWare->WaitAtFlag(eastFlag);
+    eastWare->RecalcRoute();
+    eastFlag->AddWare(eastWare);
+    auto* westWare = new Ware(GD_FLOUR, bld, westFlag);
+    westWare->WaitAtFlag(westFlag);
+    westWare->RecalcRoute();
+    westFlag->AddWare(westWare);
+    BOOST_TEST_REQUIRE((eastWare->GetNextDir() == RoadPathDirection::East));
+    BOOST_TEST_REQUIRE((westWare->GetNextDir() == RoadPathDirection::East));
+
+    const unsigned hqEastRoadId = world.GetSpecObj<noFlag>(hqFlagPos)->GetRoute(Direction::EAST)->GetObjId();
+    const unsigned branchRoadId = world.GetSpecObj<noFlag>(hqFlagPos)->GetRoute(Direction::SOUTHWEST)->GetObjId();
+    BOOST_TEST(!eastWare->IsRouteAffectedBy(hqEastRoadId));
+    BOOST_TEST(westWare->IsRouteAffectedBy(hqEastRoadId));
+    BOOST_TEST(!eastWare->IsRouteAffectedBy(branchRoadId));
+    BOOST_TEST(!westWare->IsRouteAffectedBy(branchRoadId));
+
+    // Splitting a used road adds the new part to the route
+    const MapPoint splitPos = world.MakeMapPoint(hqFlagPos + Position(2, 0));
+    world.SetFlag(splitPos, 0);
+    const unsigned splitRoadId = world.GetSpecObj<noFlag>(splitPos)->GetRoute(Direction::EAST)->GetObjId();
+    BOOST_TEST(westWare->IsRouteAffectedBy(splitRoadId));
+    BOOST_TEST(!eastWare->IsRouteAffectedBy(splitRoadId));
+
+    // Removing the unused branch keeps the routes
+    world.DestroyFlag(world.GetNeighbour(world.GetNeighbour(hqFlagPos, Direction::SOUTHWEST), Direction::SOUTHWEST), 0);
+    BOOST_TEST(westWare->IsRouteAffectedBy(splitRoadId));
+    BOOST_TEST((westWare->GetNextDir() == RoadPathDirection::East));
+    BOOST_TEST((eastWare->GetNextDir() == RoadPathDirection::East));
+    BOOST_TEST(player.AreConnectedByRoads(*westFlag, *bld));
+
+    // Disconnecting the west flag makes the west ware lost but keeps the east ware going
+    westFlag->DestroyRoad(Direction::EAST);
+    BOOST_TEST(!player.AreConnectedByRoads(*westFlag, *bld));
+    BOOST_TEST(player.AreConnectedByRoads(*hq, *bld));
+    BOOST_TEST(westWare->IsLostWare());
+    BOOST_TEST((westWare->GetNextDir() == RoadPathDirection::None));
+    BOOST_TEST(eastWare->GetGoal() == bld);
+    BOOST_TEST((eastWare->GetNextDir() == RoadPathDirection::East));
+}
+
+BOOST_FIXTURE_TEST_CASE(LostWaresAreFound, WorldFixtureEmpty1P)
+{
+    GamePlayer& player = world.GetPlayer(0);
+    auto* hq = world.GetSpecObj<nobBaseWarehouse>(player.GetHQPos());
+    const MapPoint hqFlagPos = hq->GetFlagPos(); //-V522
+    // Flag not connected to the HQ but to a building which has no flour
+    const MapPoint flagPos = world.MakeMapPoint(hqFlagPos + Position(4, 0));
+    auto* bld = static_cast<nobUsual*>(BuildingFactory::CreateBuilding(
+      world, BLD_BAKERY, world.MakeMapPoint(player.GetHQPos() + Position(8, 0)), 0, NAT_VIKINGS));
+    world.SetFlag(flagPos, 0);
+    world.BuildRoad(0, false, flagPos, std::vector<Direction>(4, Direction::EAST));
+    auto* flag = world.GetSpecObj<noFlag>(flagPos);
+    BOOST_TEST_REQUIRE(flag);
+    BOOST_TEST_REQUIRE(!player.AreConnectedByRoads(*flag, *hq));
+    BOOST_TEST_REQUIRE(player.AreConnectedByRoads(*flag, *bld));
+
+    std::array<Ware*, 3> wares;
+    for(Ware*& ware : wares)
+    {
+        ware = new Ware(GD_FLOUR, nullptr, flag);
+        ware->WaitAtFlag(flag);
+        flag->AddWare(ware);
+        BOOST_TEST(ware->IsLostWare());
+    }
+    // No warehouse reachable
+    player.FindClientForLostWares();
+    for(Ware* ware : wares)
+        BOOST_TEST(ware->IsLostWare());
+    // No warehouse has flour -> Lost wares are used in order of creation
+    BOOST_TEST(hq->GetNumRealWares(GD_FLOUR) == 0u);
+    BOOST_TEST(player.OrderWare(GD_FLOUR, bld) == wares[0]);
+    BOOST_TEST(wares[0]->GetGoal() == bld);
+    BOOST_TEST(!player.OrderWare(GD_BREAD, bld));
+    // Disconnected building can't get the lost wares
+    flag->DestroyRoad(Direction::EAST);
+    BOOST_TEST(!player.OrderWare(GD_FLOUR, bld));
+    BOOST_TEST(wares[0]->IsLostWare());
+    BOOST_TEST(wares[1]->IsLostWare());
+    // Once connected all of them go to the HQ
+    world.BuildRoad(0, false, hqFlagPos, std::vector<Direction>(4, Direction::EAST));
+    player.FindClientForLostWares();
+    for(Ware* ware : wares)
+    {
+        BOOST_TEST(!ware->IsLostWare());
+        BOOST_TEST(ware->GetGoal() == hq);
+    }
+}
@@ -55,4 +55,34 @@ BOOST_FIXTURE_TEST_CASE(Ping, rttr::test::MockClockFixture)
     BOOST_REQUIRE_EQUAL(player.calcPingTime(), (2000u + 15u) / 2u); // Smoothed value
 }
 
+BOOST_FIXTURE_TEST_CASE(LagTimeout, rttr::test::MockClockFixture)
+{
+    using namespace std::chrono;
+    Socket sock;
+    GameServerPlayer player(1, sock);
+    player.setActive();
+    BOOST_TEST(player.getLagTimeOut() == LAG_TIMEOUT);
+    player.setLagging();
+    currentTime += seconds(10);
+    BOOST_TEST(player.getLagTimeOut() == LAG_TIMEOUT - 10u);
+    // Lagging is set on every check but the timeout counts from the first time
+    player.setLagging();
+    currentTime += seconds(LAG_TIMEOUT - 20);
+    player.setLagging();
+    BOOST_TEST(player.getLagTimeOut() == 10u);
+    currentTime += seconds(10);
+    player.setLagging();
+    BOOST_TEST(player.getLagTimeOut() == 0u);
+    currentTime += seconds(10);
+    BOOST_TEST(player.getLagTimeOut() == 0u);
+    // Player sent commands again -> Timeout starts again on the next lag
+    player.setNotLagging();
+    BOOST_TEST(player.getLagTimeOut() == LAG_TIMEOUT);
+    currentTime += seconds(10);
+    BOOST_TEST(player.getLagTimeOut() == LAG_TIMEOUT);
+    player.setLagging();
+    currentTime += seconds(1);
+    BOOST_TEST(player.getLagTimeOut() == LAG_TIMEOUT - 1u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -15,16 +15,35 @@
 // You should have received a copy of the GNU General Public License
 // along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
 
+#include "GamePlayer.h"
+#include "RoadSegment.h"
 #include "RttrForeachPt.h"
+#include "Ware.h"
+#include "buildings/nobBaseWarehouse.h"
+#include "buildings/nobUsual.h"
+#include "factories/BuildingFactory.h"
+#include "helpers/containerUtils.h"
+#include "pathfinding/FreePathFinderImpl.h"
+#include "pathfinding/HierarchicalPathFinder.h"
+#include "pathfinding/HumanFlowFields.h"
+#include "pathfinding/PathConditionHuman.h"
+#include "pathfinding/PathConditionShip.h"
+#include "pathfinding/RoadPathFinder.h"
 #include "worldFixtures/CreateEmptyWorld.h"
 #include "worldFixtures/WorldFixture.h"
+#include "nodeObjs/noFlag.h"
 #include "nodeObjs/noGranite.h"
 #include "gameTypes/GameTypesOutput.h"
 #include "gameData/GameConsts.h"
+#include "gameData/MilitaryConsts.h"
 #include "gameData/TerrainDesc.h"
 #include <rttr/test/testHelpers.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 #include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <limits>
+#include <set>
+#include <utility>
 #include <vector>
 
 // Tests are designed to check for every possible direction and terrain distribution
@@ -36,6 +55,7 @@ BOOST_AUTO_TEST_SUITE(PathfindingSuite)
 namespace {
 using WorldFixtureEmpty0P = WorldFixture<CreateEmptyWorld, 0>;
 using WorldFixtureEmpty1P = WorldFixture<CreateEmptyWorld, 1>;
+using WorldFixtureLarge0P = WorldFixture<CreateEmptyWorld, 0, 128, 128>;
 
 /// Sets all terrain to the given terrain
 void clearWorld(GameWorldGame& world, DescIdx<TerrainDesc> terrain)
@@ -82,6 +102,62 @@ void setupTestcase2to4(GameWorldGame& world, const MapPoint& startPt, DescIdx<Te
     if(bothTerrain)
         setRightTerrain(world, terrainPt, dir, tOther);
 }
+
+DescIdx<TerrainDesc> findTerrain(const GameWorldGame& world, TerrainKind kind, ETerrain property)
+{
+    DescIdx<TerrainDesc> t(0);
+    for(; t.value < world.GetDescription().terrain.size(); t.value++)
+    {
+        if(world.GetDescription().get(t).kind == kind && world.GetDescription().get(t).Is(property))
+            break;
+    }
+    return t;
+}
+
+using Routes = std::vector<std::pair<MapPoint, MapPoint>>;
+
+/// Find all routes with the given open list. Returns the lengths (max. value if no route was found)
+template<class T_OpenList, class T_Condition>
+std::vector<unsigned> findFreePaths(const GameWorldGame& world, const Routes& routes, bool randomRoute,
+                                    const T_Condition& condition, std::chrono::steady_clock::duration& duration)
+{
+    std::vector<unsigned> lengths;
+    const auto startTime = std::chrono::steady_clock::now();
+    for(const auto& route : routes)
+    {
+        unsigned length;
+        if(!world.GetFreePathFinder().FindPathWithOpenList<T_OpenList>(route.first, route.second, randomRoute,
+                                                                       std::numeric_limits<unsigned>::max(), nullptr,
+                                                                       &length, nullptr, condition))
+            length = std::numeric_limits<unsigned>::max();
+        lengths.push_back(length);
+    }
+    duration = std::chrono::steady_clock::now() - startTime;
+    return lengths;
+}
+
+/// Compare the binary heap and the bucket queue on the routes. Both must find routes of the same length
+template<class T_Condition>
+void benchmarkFreePaths(const char* name, const GameWorldGame& world, const Routes& routes, bool randomRoute,
+                        const T_Condition& condition)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    constexpr unsigned numRuns = 5;
+    std::chrono::steady_clock::duration heapTime{}, bucketTime{}, curTime;
+    for(unsigned i = 0; i < numRuns; i++)
+    {
+        const auto heapLengths = findFreePaths<QueueImpl>(world, routes, randomRoute, condition, curTime);
+        heapTime += curTime;
+        const auto bucketLengths = findFreePaths<BucketQueueImpl>(world, routes, randomRoute, condition, curTime);
+        bucketTime += curTime;
+        BOOST_TEST(heapLengths == bucketLengths, boost::test_tools::per_element());
+        BOOST_TEST(!helpers::contains(heapLengths, std::numeric_limits<unsigned>::max()));
+    }
+    BOOST_TEST_MESSAGE(name << " (" << routes.size() << " routes): binary heap "
+                            << duration_cast<microseconds>(heapTime).count() / numRuns << "us, bucket queue "
+                            << duration_cast<microseconds>(bucketTime).count() / numRuns << "us");
+}
 } // namespace
 
 BOOST_FIXTURE_TEST_CASE(WalkStraight, WorldFixtureEmpty0P)
@@ -303,4 +379,320 @@ BOOST_FIXTURE_TEST_CASE(BlockedPaths, WorldFixtureEmpty0P)
     BOOST_REQUIRE(world.FindHumanPath(startPt, surroundingPts2[0]));
 }
 
+BOOST_FIXTURE_TEST_CASE(WareRouteTables, WorldFixtureEmpty1P)
+{
+    RoadPathFinder& pathFinder = world.GetRoadPathFinder();
+    pathFinder.SetVerifyWarePaths(true);
+    GamePlayer& player = world.GetPlayer(0);
+    WareRouteTables& tables = player.GetWareRouteTables();
+    const MapPoint hqPos = player.GetHQPos();
+    const MapPoint hqFlagPos = world.GetNeighbour(hqPos, Direction::SOUTHEAST);
+    auto* goal = static_cast<nobUsual*>(
+      BuildingFactory::CreateBuilding(world, BLD_BAKERY, world.MakeMapPoint(hqPos + Position(6, 0)), 0, NAT_VIKINGS));
+    // Direct road of length 6 and a detour of length 8 (+1 for the building entrance)
+    world.BuildRoad(0, false, hqFlagPos, std::vector<Direction>(6, Direction::EAST));
+    world.BuildRoad(0, false, hqFlagPos, {Direction::SOUTHEAST, Direction::SOUTHEAST});
+    const MapPoint detourStartPos = world.GetNeighbour(world.GetNeighbour(hqFlagPos, Direction::SOUTHEAST), //-V807
+                                                       Direction::SOUTHEAST);
+    world.BuildRoad(0, false, detourStartPos, std::vector<Direction>(4, Direction::EAST));
+    const MapPoint detourEndPos = world.MakeMapPoint(detourStartPos + Position(4, 0));
+    world.BuildRoad(0, false, detourEndPos, {Direction::NORTHEAST, Direction::NORTHEAST});
+    BOOST_TEST(tables.GetNumTables() == 0u);
+
+    auto* hqFlag = world.GetSpecObj<noFlag>(hqFlagPos);
+    auto* detourStart = world.GetSpecObj<noFlag>(detourStartPos);
+    auto* detourEnd = world.GetSpecObj<noFlag>(detourEndPos);
+    BOOST_TEST_REQUIRE(detourStart);
+    BOOST_TEST_REQUIRE(detourEnd);
+    // Wait till all carriers are at their roads so there is no congestion
+    RTTR_EXEC_TILL(1000, hqFlag->GetPunishmentPoints(Direction::EAST) == 0u
+                           && hqFlag->GetPunishmentPoints(Direction::SOUTHEAST) == 0u
+                           && detourStart->GetPunishmentPoints(Direction::EAST) == 0u
+                           && detourEnd->GetPunishmentPoints(Direction::NORTHEAST) == 0u);
+
+    unsigned length;
+    RoadPathDirection firstDir;
+    std::vector<unsigned> segmentIds;
+    BOOST_TEST_REQUIRE(
+      pathFinder.FindWarePath(*hqFlag, *goal, tables, 100, &length, &firstDir, nullptr, &segmentIds));
+    BOOST_TEST(tables.GetNumTables() == 1u);
+    BOOST_TEST(length == 7u);
+    BOOST_TEST((firstDir == RoadPathDirection::East));
+    // Road and building entrance
+    BOOST_TEST(segmentIds.size() == 2u);
+    // Lower bound exceeds the maximum
+    BOOST_TEST(!pathFinder.FindWarePath(*hqFlag, *goal, tables, 6, &length));
+    // Unconnected node
+    const MapPoint lonelyFlagPos = world.MakeMapPoint(hqFlagPos - Position(4, 0));
+    world.SetFlag(lonelyFlagPos, 0);
+    BOOST_TEST(!pathFinder.FindWarePath(*world.GetSpecObj<noFlag>(lonelyFlagPos), *goal, tables, 100, &length));
+    // A building at an existing flag does not change the road network, so the table is kept
+    // but the results must be the same as with a new table
+    const MapPoint newBldPos = world.GetNeighbour(detourEndPos, Direction::NORTHWEST);
+    noBaseBuilding* newBld = BuildingFactory::CreateBuilding(world, BLD_WOODCUTTER, newBldPos, 0, NAT_VIKINGS);
+    BOOST_TEST_REQUIRE(pathFinder.FindWarePath(*newBld, *goal, tables, 100, &length, &firstDir, nullptr, &segmentIds));
+    BOOST_TEST(tables.GetNumTables() == 1u);
+    BOOST_TEST(length == 4u);
+    BOOST_TEST((firstDir == RoadPathDirection::SouthEast));
+    BOOST_TEST(segmentIds.size() == 3u);
+    BOOST_TEST(pathFinder.GetNumWarePathMismatches() == 0u);
+
+    // Congestion on the direct road makes the detour better
+    for(unsigned i = 0; i < 2; i++)
+    {
+        auto* ware = new Ware(GD_FLOUR, goal, hqFlag);
+        ware->WaitAtFlag(hqFlag);
+        ware->SetNextDir(Direction::EAST);
+        hqFlag->AddWare(ware);
+    }
+    BOOST_TEST_REQUIRE(hqFlag->GetPunishmentPoints(Direction::EAST) == 4u);
+    BOOST_TEST_REQUIRE(pathFinder.FindWarePath(*hqFlag, *goal, tables, 100, &length, &firstDir));
+    BOOST_TEST(length == 9u);
+    BOOST_TEST((firstDir == RoadPathDirection::SouthEast));
+
+    // Changing the road network invalidates the tables
+    world.SetFlag(world.MakeMapPoint(hqFlagPos + Position(3, 0)), 0);
+    BOOST_TEST(tables.GetNumTables() == 0u);
+
+    // Let the wares be delivered while checking every path against the plain A* and a new table
+    RTTR_EXEC_TILL(2000, goal->GetNumWares(0) == 2u);
+    BOOST_TEST(pathFinder.GetNumWarePathMismatches() == 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(BucketQueueFindsShortestPaths, WorldFixtureEmpty0P)
+{
+    const DescIdx<TerrainDesc> tWater = findTerrain(world, TerrainKind::WATER, ETerrain::Shippable);
+    const DescIdx<TerrainDesc> tLand = findTerrain(world, TerrainKind::LAND, ETerrain::Walkable);
+    const MapExtent size = world.GetSize();
+    // Wall of water with a gap at the bottom
+    clearWorld(world, tLand);
+    for(unsigned y = 0; y + 3 < size.y; y++)
+    {
+        MapNode& node = world.GetNodeWriteable(MapPoint(size.x / 2, y));
+        node.t1 = node.t2 = tWater;
+    }
+    Routes routes;
+    for(unsigned y = 0; y < size.y; y += 3)
+        routes.emplace_back(MapPoint(2, y), MapPoint(size.x / 2 + 3, size.y - 1 - y));
+    const PathConditionHuman humanCondition(world);
+    std::chrono::steady_clock::duration duration;
+    for(bool randomRoute : {false, true})
+    {
+        const auto heapLengths = findFreePaths<QueueImpl>(world, routes, randomRoute, humanCondition, duration);
+        const auto bucketLengths =
+          findFreePaths<BucketQueueImpl>(world, routes, randomRoute, humanCondition, duration);
+        BOOST_TEST(heapLengths == bucketLengths, boost::test_tools::per_element());
+        BOOST_TEST(!helpers::contains(heapLengths, std::numeric_limits<unsigned>::max()));
+    }
+}
+
+// Only a benchmark, run it explicitly with --run_test=PathfindingSuite/BenchmarkFreePathOpenLists
+BOOST_FIXTURE_TEST_CASE(BenchmarkFreePathOpenLists, WorldFixtureLarge0P, *boost::unit_test::disabled())
+{
+    const DescIdx<TerrainDesc> tWater = findTerrain(world, TerrainKind::WATER, ETerrain::Shippable);
+    const DescIdx<TerrainDesc> tLand = findTerrain(world, TerrainKind::LAND, ETerrain::Walkable);
+    const MapExtent size = world.GetSize();
+    const auto setTerrain = [this](const MapPoint pt, DescIdx<TerrainDesc> t) {
+        MapNode& node = world.GetNodeWriteable(pt);
+        node.t1 = node.t2 = t;
+    };
+
+    // Land with walls of water, gaps alternating at 1/4 and 3/4 of the height -> Long zig-zag routes
+    // A closed wall at the right prevents shortcuts over the map border
+    clearWorld(world, tLand);
+    for(unsigned x = 10; x < size.x; x += 12)
+    {
+        const unsigned gapY = ((x / 12) % 2u) ? size.y / 4 : size.y * 3 / 4;
+        const bool isBorder = x + 12 >= size.x;
+        for(unsigned y = 0; y < size.y; y++)
+        {
+            if(!isBorder && y >= gapY && y < gapY + 4)
+                continue;
+            for(unsigned dx = 0; dx < 3; dx++)
+                setTerrain(MapPoint(x + dx, y), tWater);
+        }
+    }
+    const PathConditionHuman humanCondition(world);
+    // Soldiers: Long random routes through the whole map
+    Routes soldierRoutes;
+    for(unsigned y = 8; y < size.y; y += 24)
+        soldierRoutes.emplace_back(MapPoint(2, y), MapPoint(size.x - 14, size.y - y));
+    benchmarkFreePaths("Soldier", world, soldierRoutes, true, humanCondition);
+    // Geologists: Many shorter routes around a flag
+    Routes geologistRoutes;
+    const MapPoint flagPos(size.x / 2, size.y / 2);
+    for(const MapPoint& pt : world.GetPointsInRadius(flagPos, 10))
+    {
+        if(humanCondition.IsNodeOk(pt))
+            geologistRoutes.emplace_back(flagPos, pt);
+    }
+    benchmarkFreePaths("Geologist", world, geologistRoutes, false, humanCondition);
+
+    // Ships: Sea with small islands
+    clearWorld(world, tWater);
+    RTTR_FOREACH_PT(MapPoint, size)
+    {
+        if(pt.x % 16u >= 8u && pt.x % 16u < 12u && pt.y % 16u >= 8u && pt.y % 16u < 12u)
+            setTerrain(pt, tLand);
+    }
+    Routes shipRoutes;
+    for(unsigned i = 0; i < 6; i++)
+        shipRoutes.emplace_back(MapPoint(2 + i * 16, 2), MapPoint(size.x - 14 - i * 16, size.y - 14));
+    benchmarkFreePaths("Ship", world, shipRoutes, true, PathConditionShip(world));
+}
+
+BOOST_FIXTURE_TEST_CASE(HierarchicalShipPaths, WorldFixtureLarge0P)
+{
+    using ShipPathFinder = HierarchicalPathFinder<PathConditionShip>;
+    const DescIdx<TerrainDesc> tWater = findTerrain(world, TerrainKind::WATER, ETerrain::Shippable);
+    const DescIdx<TerrainDesc> tLand = findTerrain(world, TerrainKind::LAND, ETerrain::Walkable);
+    const MapExtent size = world.GetSize();
+    const auto setTerrain = [this](const MapPoint pt, DescIdx<TerrainDesc> t) {
+        MapNode& node = world.GetNodeWriteable(pt);
+        node.t1 = node.t2 = t;
+    };
+    ShipPathFinder& pathFinder = world.GetShipPathFinder();
+    const PathConditionShip condition(world);
+    // Same length as the regular path finder and the route is valid
+    const auto checkPath = [&](const MapPoint start, const MapPoint dest) {
+        unsigned length;
+        BOOST_TEST_REQUIRE(world.GetFreePathFinder().FindPath(start, dest, false, 9999, nullptr, &length, nullptr,
+                                                              condition));
+        std::vector<Direction> route;
+        unsigned hpaLength;
+        BOOST_TEST_REQUIRE(pathFinder.FindPath(start, dest, 9999, &route, &hpaLength));
+        BOOST_TEST(hpaLength == route.size());
+        BOOST_TEST(hpaLength == length);
+        MapPoint routeDest;
+        BOOST_TEST(world.GetFreePathFinder().CheckRoute(start, route, 0, condition, &routeDest));
+        BOOST_TEST(routeDest == dest);
+        // Length limit is respected
+        BOOST_TEST(pathFinder.FindPath(start, dest, length, nullptr, nullptr));
+        BOOST_TEST(!pathFinder.FindPath(start, dest, length - 1u, nullptr, nullptr));
+        unsigned shipLength;
+        BOOST_TEST_REQUIRE(world.FindShipPath(start, dest, 9999, nullptr, &shipLength));
+        BOOST_TEST(shipLength == length);
+    };
+
+    // Sea with small islands
+    clearWorld(world, tWater);
+    RTTR_FOREACH_PT(MapPoint, size)
+    {
+        if(pt.x % 16u >= 8u && pt.x % 16u < 12u && pt.y % 16u >= 8u && pt.y % 16u < 12u)
+            setTerrain(pt, tLand);
+    }
+    BOOST_TEST(pathFinder.GetNumValidSectors() == 0u);
+    for(unsigned i = 0; i < 6; i++)
+        checkPath(MapPoint(2 + i * 16, 2), MapPoint(size.x - 14 - i * 16, size.y - 14));
+    // Sectors are only calculated on demand
+    BOOST_TEST(pathFinder.GetNumValidSectors() > 0u);
+
+    // Split the sea into 2 parts with land walls
+    const MapPoint start(20, 20), dest(80, 100);
+    checkPath(start, dest);
+    const unsigned numValidSectors = pathFinder.GetNumValidSectors();
+    for(MapCoord y = 0; y < size.y; y++)
+    {
+        for(MapCoord x = 0; x < 4; x++)
+        {
+            setTerrain(MapPoint(40 + x, y), tLand);
+            setTerrain(MapPoint(104 + x, y), tLand);
+        }
+    }
+    BOOST_TEST(pathFinder.GetNumValidSectors() < numValidSectors);
+    BOOST_TEST(!pathFinder.FindPath(start, dest, 9999, nullptr, nullptr));
+    BOOST_TEST(!world.FindShipPath(start, dest, 9999, nullptr, nullptr));
+    // Open a gap
+    for(MapCoord y = 60; y < 68; y++)
+    {
+        for(MapCoord x = 0; x < 4; x++)
+            setTerrain(MapPoint(40 + x, y), tWater);
+    }
+    checkPath(start, dest);
+    std::vector<Direction> route;
+    BOOST_TEST_REQUIRE(world.FindShipPath(start, dest, 9999, &route, nullptr));
+    BOOST_TEST(world.CheckShipRoute(start, route, 0, nullptr));
+}
+
+BOOST_FIXTURE_TEST_CASE(SharedGoalPaths, WorldFixtureEmpty0P)
+{
+    HumanFlowFields& flowFields = world.GetHumanFlowFields();
+    const MapPoint goal(5, 5);
+    // Wall of stones with a gap
+    for(MapCoord y = 0; y < world.GetHeight(); y++)
+    {
+        if(y != 2)
+            world.SetNO(MapPoint(3, y), new noGranite(GT_1, 1));
+    }
+    // Following the directions must result in shortest paths
+    const auto checkPaths = [&]() {
+        RTTR_FOREACH_PT(MapPoint, world.GetSize())
+        {
+            if(pt == goal)
+                continue;
+            unsigned expectedLength;
+            const bool found = !!world.FindHumanPath(pt, goal, MAX_ATTACKING_RUN_DISTANCE, false, &expectedLength);
+            BOOST_TEST_REQUIRE(!!world.FindHumanPathToSharedGoal(pt, goal, MAX_ATTACKING_RUN_DISTANCE) == found);
+            if(!found)
+                continue;
+            unsigned length = 0;
+            for(MapPoint curPt = pt; curPt != goal; length++)
+            {
+                const auto dir = world.FindHumanPathToSharedGoal(curPt, goal, MAX_ATTACKING_RUN_DISTANCE);
+                BOOST_TEST_REQUIRE(!!dir);
+                curPt = world.GetNeighbour(curPt, *dir);
+            }
+            BOOST_TEST(length == expectedLength);
+            // Length limit is respected
+            BOOST_TEST(!world.FindHumanPathToSharedGoal(pt, goal, expectedLength - 1u));
+        }
+    };
+    checkPaths();
+    BOOST_TEST(flowFields.GetNumFields() == 1u);
+    // Changing objects nearby removes the field
+    world.DestroyNO(MapPoint(3, 5));
+    BOOST_TEST(flowFields.GetNumFields() == 0u);
+    checkPaths();
+    BOOST_TEST(flowFields.GetNumFields() == 1u);
+    flowFields.Remove(goal);
+    BOOST_TEST(flowFields.GetNumFields() == 0u);
+
+    // Unused fields are removed after some time
+    const MapPoint otherGoal(7, 7);
+    BOOST_TEST(flowFields.GetDir(MapPoint(1, 1), goal, MAX_ATTACKING_RUN_DISTANCE, 0).has_value());
+    BOOST_TEST(flowFields.GetDir(MapPoint(1, 1), otherGoal, MAX_ATTACKING_RUN_DISTANCE, 1).has_value());
+    BOOST_TEST(flowFields.GetNumFields() == 2u);
+    BOOST_TEST(flowFields.GetDir(MapPoint(1, 1), otherGoal, MAX_ATTACKING_RUN_DISTANCE, HumanFlowFields::MAX_UNUSED_GFS)
+                 .has_value());
+    BOOST_TEST(flowFields.GetNumFields() == 2u);
+    BOOST_TEST(
+      flowFields.GetDir(MapPoint(1, 1), otherGoal, MAX_ATTACKING_RUN_DISTANCE, HumanFlowFields::MAX_UNUSED_GFS + 1u)
+        .has_value());
+    BOOST_TEST(flowFields.GetNumFields() == 1u);
+}
+
+BOOST_FIXTURE_TEST_CASE(SharedGoalPathsVary, WorldFixtureEmpty0P)
+{
+    HumanFlowFields& flowFields = world.GetHumanFlowFields();
+    const MapPoint goal(5, 3);
+    // 2 rows straight up: Going north-west or north-east first are both shortest paths
+    const MapPoint start(5, 5);
+    unsigned length;
+    BOOST_TEST_REQUIRE(world.FindHumanPath(start, goal, MAX_ATTACKING_RUN_DISTANCE, false, &length));
+    std::set<Direction> usedDirs;
+    for(unsigned gf = 0; gf < 10; gf++)
+    {
+        const auto dir = flowFields.GetDir(start, goal, MAX_ATTACKING_RUN_DISTANCE, gf);
+        BOOST_TEST_REQUIRE(!!dir);
+        // Same result for the same GF
+        BOOST_TEST((flowFields.GetDir(start, goal, MAX_ATTACKING_RUN_DISTANCE, gf) == dir));
+        usedDirs.insert(*dir);
+        unsigned nextLength;
+        BOOST_TEST_REQUIRE(
+          world.FindHumanPath(world.GetNeighbour(start, *dir), goal, MAX_ATTACKING_RUN_DISTANCE, false, &nextLength));
+        BOOST_TEST(nextLength + 1u == length);
+    }
+    BOOST_TEST(usedDirs.size() > 1u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
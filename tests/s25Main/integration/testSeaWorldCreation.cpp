@@ -16,6 +16,8 @@
 // along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
 
 #include "RTTR_AssertError.h"
+#include "pathfinding/FreePathFinderImpl.h"
+#include "pathfinding/PathConditionShip.h"
 #include "worldFixtures/SeaWorldWithGCExecution.h"
 #include "gameTypes/ShipDirection.h"
 #include <rttr/test/LogAccessor.hpp>
@@ -187,4 +189,49 @@ BOOST_FIXTURE_TEST_CASE(HarborNeighbors, SeaWorldWithGCExecution<>)
     BOOST_REQUIRE_EQUAL(world.GetHarborNeighbors(7, ShipDirection::SOUTHWEST).size(), 0u);
 }
 
+BOOST_FIXTURE_TEST_CASE(ShipRoutesToHarbors, SeaWorldWithGCExecution<>)
+{
+    const PathConditionShip condition(world);
+    const auto checkRoutes = [&]() {
+        for(unsigned startHb = 1; startHb <= world.GetNumHarborPoints(); startHb++)
+        {
+            for(const auto dir : helpers::EnumRange<Direction>{})
+            {
+                const unsigned short seaId = world.GetSeaId(startHb, dir);
+                if(!seaId)
+                    continue;
+                BOOST_TEST_REQUIRE(world.GetSeaRouteField(startHb, seaId) != nullptr);
+                const MapPoint startPt = world.GetCoastalPoint(startHb, seaId);
+                for(unsigned targetHb = 1; targetHb <= world.GetNumHarborPoints(); targetHb++)
+                {
+                    const MapPoint destPt = world.GetCoastalPoint(targetHb, seaId);
+                    if(!destPt.isValid() || destPt == startPt)
+                        continue;
+                    // Same length as the regular path finder
+                    unsigned expectedLength;
+                    BOOST_TEST_REQUIRE(world.GetFreePathFinder().FindPath(startPt, destPt, false, 10000, nullptr,
+                                                                          &expectedLength, nullptr, condition));
+                    std::vector<Direction> route;
+                    unsigned length;
+                    BOOST_TEST_REQUIRE(world.FindShipPathToHarbor(startPt, targetHb, seaId, &route, &length));
+                    BOOST_TEST(length == expectedLength);
+                    BOOST_TEST(route.size() == length);
+                    MapPoint routeDest;
+                    BOOST_TEST(world.CheckShipRoute(startPt, route, 0, &routeDest));
+                    BOOST_TEST(routeDest == destPt);
+                    // Too long
+                    BOOST_TEST(!world.GetSeaRouteField(targetHb, seaId)->GetRoute(world, startPt, length - 1u, &route,
+                                                                                  nullptr));
+                    BOOST_TEST(route.size() == length);
+                }
+            }
+        }
+    };
+    checkRoutes();
+    // Changing the terrain removes the routes which get recalculated on demand
+    const MapPoint harborPt = world.GetHarborPoint(1);
+    world.GetNodeWriteable(harborPt);
+    checkRoutes();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
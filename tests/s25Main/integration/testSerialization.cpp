@@ -41,6 +41,7 @@
 #include <rttr/test/testHelpers.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/test/unit_test.hpp>
+#include <cstring>
 #include <memory>
 
 // LCOV_EXCL_START
@@ -202,6 +203,50 @@ BOOST_AUTO_TEST_CASE(Serializer)
     BOOST_TEST_REQUIRE(sgd.PopVarSize() == 0xFFFFFFFFu);
 }
 
+BOOST_FIXTURE_TEST_CASE(CompactGameCommands, RandWorldFixture)
+{
+    PlayerGameCommands cmds = GetTestCommands().create(*game).result;
+    Serializer ser;
+    cmds.Serialize(ser);
+
+    // Old format with full checksum and fixed size fields
+    Serializer legacySer;
+    cmds.checksum.Serialize(legacySer);
+    legacySer.PushUnsignedInt(cmds.gcs.size());
+    for(const gc::GameCommandPtr& gc : cmds.gcs)
+        gc->Serialize(legacySer);
+    BOOST_TEST(ser.GetLength() * 2u < legacySer.GetLength());
+
+    for(const bool legacy : {false, true})
+    {
+        PlayerGameCommands loadedCmds;
+        if(legacy)
+            loadedCmds.DeserializeLegacy(legacySer);
+        else
+            loadedCmds.Deserialize(ser);
+        BOOST_TEST(loadedCmds.checksum.isHashOnly() == !legacy);
+        BOOST_TEST(loadedCmds.checksum == cmds.checksum);
+        BOOST_TEST(loadedCmds.checksum != AsyncChecksum(1, 2, 3, 4, 5));
+        BOOST_TEST_REQUIRE(loadedCmds.gcs.size() == cmds.gcs.size());
+        for(unsigned i = 0; i < cmds.gcs.size(); i++)
+        {
+            Serializer expectedGC, loadedGC;
+            cmds.gcs[i]->Serialize(expectedGC);
+            loadedCmds.gcs[i]->Serialize(loadedGC);
+            BOOST_TEST_REQUIRE(loadedGC.GetLength() == expectedGC.GetLength());
+            BOOST_TEST(memcmp(loadedGC.GetData(), expectedGC.GetData(), expectedGC.GetLength()) == 0);
+        }
+    }
+
+    // Empty checksums stay empty
+    PlayerGameCommands emptyCmds, loadedEmptyCmds;
+    ser.Clear();
+    emptyCmds.Serialize(ser);
+    loadedEmptyCmds.Deserialize(ser);
+    BOOST_TEST(!loadedEmptyCmds.checksum.isValid());
+    BOOST_TEST(loadedEmptyCmds.gcs.empty());
+}
+
 BOOST_FIXTURE_TEST_CASE(BaseSaveLoad, RandWorldFixture)
 {
     const MapPoint hqPos = world.GetPlayer(0).GetHQPos();
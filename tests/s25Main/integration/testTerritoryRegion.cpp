@@ -18,6 +18,7 @@
 #include "GamePlayer.h"
 #include "PointOutput.h"
 #include "RttrForeachPt.h"
+#include "buildings/nobMilitary.h"
 #include "factories/BuildingFactory.h"
 #include "figures/nofPassiveSoldier.h"
 #include "helpers/containerUtils.h"
@@ -27,6 +28,7 @@
 #include "world/TerritoryRegion.h"
 #include <boost/range/algorithm_ext/push_back.hpp>
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
 #include <array>
 #include <iostream>
 #include <set>
@@ -321,4 +323,142 @@ BOOST_FIXTURE_TEST_CASE(CreateTerritoryRegion, WorldFixtureEmpty2P)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(MilitarySquaresAddRemove, WorldFixtureEmpty2P)
+{
+    const MapPoint hqPos = world.GetPlayer(0).GetHQPos();
+    std::vector<nobBaseMilitary*> milBlds;
+    for(const Position offset : {Position(-3, 2), Position(3, 2), Position(0, -3)})
+    {
+        const MapPoint pt = world.MakeMapPoint(hqPos + offset);
+        milBlds.push_back(
+          static_cast<nobBaseMilitary*>(BuildingFactory::CreateBuilding(world, BLD_BARRACKS, pt, 0, NAT_AFRICANS)));
+        BOOST_TEST_REQUIRE(milBlds.back());
+    }
+    const auto getBldsInRange = [this]() {
+        std::vector<const nobBaseMilitary*> result;
+        world.CheckMilitaryBuildings(MapPoint(0, 0), 99, [&result](const nobBaseMilitary* bld) {
+            result.push_back(bld);
+            return false;
+        });
+        return result;
+    };
+    // All 3 + both HQs, each one only once
+    std::vector<const nobBaseMilitary*> blds = getBldsInRange();
+    BOOST_TEST(blds.size() == 5u);
+    BOOST_TEST(world.LookForMilitaryBuildings(MapPoint(0, 0), 99).size() == 5u);
+    for(const nobBaseMilitary* bld : milBlds)
+        BOOST_TEST(std::count(blds.begin(), blds.end(), bld) == 1);
+    // Stops at the first match
+    unsigned numChecked = 0;
+    BOOST_TEST(world.CheckMilitaryBuildings(hqPos, 1, [&numChecked](const nobBaseMilitary*) {
+        ++numChecked;
+        return true;
+    }));
+    BOOST_TEST(numChecked == 1u);
+
+    // Remove the first added one, so the others get moved around
+    const MapPoint removedPos = milBlds.front()->GetPos();
+    world.DestroyNO(removedPos, false);
+    blds = getBldsInRange();
+    BOOST_TEST(blds.size() == 4u);
+    BOOST_TEST(world.LookForMilitaryBuildings(MapPoint(0, 0), 99).size() == 4u);
+    for(unsigned i = 1; i < milBlds.size(); i++)
+        BOOST_TEST(helpers::contains(blds, milBlds[i]));
+    // The remaining ones can still be removed
+    world.DestroyNO(milBlds.back()->GetPos(), false);
+    world.DestroyNO(milBlds[1]->GetPos(), false);
+    BOOST_TEST(getBldsInRange().size() == 2u);
+}
+
+namespace {
+using WorldFixtureEmpty1P = WorldFixture<CreateEmptyWorld, 1>;
+std::vector<uint8_t> getBoundaryStones(const GameWorldBase& world)
+{
+    std::vector<uint8_t> result;
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+        boost::push_back(result, world.GetNode(pt).boundary_stones);
+    return result;
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(BatchedTerritoryChanges, WorldFixtureEmpty1P)
+{
+    const MapPoint hqPos = world.GetPlayer(0).GetHQPos();
+    // Outside the HQs territory, so they gain land when occupied
+    std::array<MapPoint, 2> milBldPos = {world.MakeMapPoint(hqPos - Position(12, 0)),
+                                         world.MakeMapPoint(hqPos + Position(12, 0))};
+    std::array<nobMilitary*, 2> milBlds;
+    for(unsigned i = 0; i < milBldPos.size(); i++)
+    {
+        BOOST_TEST_REQUIRE(world.GetNode(milBldPos[i]).owner == 0u);
+        milBlds[i] = static_cast<nobMilitary*>(
+          BuildingFactory::CreateBuilding(world, BLD_BARRACKS, milBldPos[i], 0, NAT_ROMANS));
+        BOOST_TEST_REQUIRE(milBlds[i]);
+    }
+    const std::vector<uint8_t> stonesBefore = getBoundaryStones(world);
+    {
+        GameWorldGame::TerritoryChangeBatch batch(world);
+        for(nobMilitary* bld : milBlds)
+        {
+            auto* soldier = new nofPassiveSoldier(bld->GetPos(), 0, bld, bld, 0);
+            world.GetPlayer(0).IncreaseInventoryJob(soldier->GetJobType(), 1);
+            world.AddFigure(bld->GetPos(), soldier);
+            // Already at goal -> Occupies the building
+            soldier->WalkToGoal();
+            BOOST_TEST_REQUIRE(!bld->IsNewBuilt());
+        }
+        // Owners are changed immediately
+        for(const MapPoint pt : milBldPos)
+            BOOST_TEST(world.GetNode(pt).owner == 1u);
+        // But border stones not yet
+        BOOST_TEST((getBoundaryStones(world) == stonesBefore));
+        batch.Finish();
+    }
+    // Updated after the batch and the same as when recalculating everything
+    const std::vector<uint8_t> stonesAfter = getBoundaryStones(world);
+    BOOST_TEST((stonesAfter != stonesBefore));
+    world.RecalcBorderStones(Position(0, 0), Extent(world.GetSize()));
+    BOOST_TEST((getBoundaryStones(world) == stonesAfter));
+    for(const MapPoint pt : milBldPos)
+        BOOST_TEST(world.GetNode(pt).boundary_stones[BorderStonePos::OnPoint] == 0u);
+}
+
+using WorldFixtureEmpty2PWide = WorldFixture<CreateEmptyWorld, 2, 80, 40>;
+
+BOOST_FIXTURE_TEST_CASE(BatchedTerritoryChangesFoW, WorldFixtureEmpty2PWide)
+{
+    const MapPoint milBldPos = world.MakeMapPoint(world.GetPlayer(0).GetHQPos() - Position(12, 0));
+    BOOST_TEST_REQUIRE(world.GetNode(milBldPos).owner == 0u);
+    auto* milBld =
+      static_cast<nobMilitary*>(BuildingFactory::CreateBuilding(world, BLD_BARRACKS, milBldPos, 0, NAT_ROMANS));
+    BOOST_TEST_REQUIRE(milBld);
+    // Nodes at the border of the new territory which player 1 sees for the last time in this GF
+    const int radius = static_cast<int>(milBld->GetMilitaryRadius());
+    const MapPoint fowPtBefore = world.MakeMapPoint(milBldPos - Position(radius, 0));
+    const MapPoint fowPtAfter = world.MakeMapPoint(milBldPos + Position(0, radius));
+    const unsigned curGF = em.GetCurrentGF();
+    for(const MapPoint pt : {fowPtBefore, fowPtAfter})
+    {
+        BOOST_TEST_REQUIRE(world.GetNode(pt).boundary_stones[BorderStonePos::OnPoint] == 0u);
+        world.SetVisibility(pt, 1, VIS_VISIBLE);
+    }
+    {
+        GameWorldGame::TerritoryChangeBatch batch(world);
+        world.SetVisibility(fowPtBefore, 1, VIS_FOW, curGF);
+        auto* soldier = new nofPassiveSoldier(milBldPos, 0, milBld, milBld, 0);
+        world.GetPlayer(0).IncreaseInventoryJob(soldier->GetJobType(), 1);
+        world.AddFigure(milBldPos, soldier);
+        soldier->WalkToGoal();
+        BOOST_TEST_REQUIRE(!milBld->IsNewBuilt());
+        world.SetVisibility(fowPtAfter, 1, VIS_FOW, curGF);
+        batch.Finish();
+    }
+    for(const MapPoint pt : {fowPtBefore, fowPtAfter})
+        BOOST_TEST_REQUIRE(world.GetNode(pt).boundary_stones[BorderStonePos::OnPoint] != 0u);
+    // Saved before the change -> Old border stones
+    BOOST_TEST(world.GetNode(fowPtBefore).fow[1].boundary_stones[BorderStonePos::OnPoint] == 0u);
+    // Saved after the change but before the border stones were updated -> New border stones
+    BOOST_TEST((world.GetNode(fowPtAfter).fow[1].boundary_stones == world.GetNode(fowPtAfter).boundary_stones));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
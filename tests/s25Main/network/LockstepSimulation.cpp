@@ -0,0 +1,191 @@
+// Copyright (c) 2016 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "LockstepSimulation.h"
+#include "TestServer.h"
+#include "network/CreateServerInfo.h"
+#include "network/GameMessages.h"
+#include "network/GameServer.h"
+#include "test/testConfig.h"
+#include "gameTypes/MapType.h"
+#include "gameTypes/ServerType.h"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <thread>
+
+SimulationConfig SimulationConfig::create(unsigned numPlayers, const LinkProperties& uplink,
+                                          const LinkProperties& downlink)
+{
+    SimulationConfig config;
+    config.uplinks.assign(numPlayers, uplink);
+    config.downlinks.assign(numPlayers, downlink);
+    // The host runs the server
+    if(numPlayers > 0)
+        config.uplinks[0] = config.downlinks[0] = LinkProperties();
+    return config;
+}
+
+double SimulationResult::getRelativeGFRate() const
+{
+    if(!duration)
+        return 0;
+    return (static_cast<double>(numGFs) * gfLength) / duration;
+}
+
+unsigned SimulationResult::getCmdLatency(unsigned percentile) const
+{
+    if(cmdLatencies.empty())
+        return 0;
+    std::vector<unsigned> sorted = cmdLatencies;
+    const size_t idx = std::min(sorted.size() - 1, sorted.size() * std::min(percentile, 100u) / 100u);
+    std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+    return sorted[idx];
+}
+
+unsigned SimulationResult::getMaxStallTime() const
+{
+    return stallTimes.empty() ? 0u : *std::max_element(stallTimes.begin(), stallTimes.end());
+}
+
+std::ostream& operator<<(std::ostream& os, const SimulationResult& result)
+{
+    os << result.numGFs << " GFs of " << result.gfLength << "ms in " << result.duration << "ms, cmdDelay "
+       << result.cmdDelay << ", NWF length " << result.minNWFLength << "-" << result.maxNWFLength << " GFs\n";
+    os << "Stall time:";
+    for(unsigned stallTime : result.stallTimes)
+        os << " " << stallTime << "ms";
+    os << "\nCommand latency: p50 " << result.getCmdLatency(50) << "ms, p90 " << result.getCmdLatency(90)
+       << "ms, p99 " << result.getCmdLatency(99) << "ms, max " << result.getCmdLatency(100) << "ms\n";
+    os << "Lag kicks: " << result.lagKicks.size() << ", async detected: ";
+    if(result.asyncDetectedGF)
+        os << "GF " << *result.asyncDetectedGF;
+    else
+        os << "no";
+    os << "\nBytes to server: " << result.bytesToServer << ", from server: " << result.bytesFromServer << "\n";
+    return os;
+}
+
+LockstepSimulation::LockstepSimulation(SimulationConfig config)
+    : config_(std::move(config)), mapPath_(rttr::test::rttrBaseDir / "tests/testData/maps/LuaFunctions.SWD")
+{
+    const unsigned numPlayers = config_.getNumPlayers();
+    BOOST_TEST_REQUIRE(numPlayers > 0u);
+    BOOST_TEST_REQUIRE(config_.downlinks.size() == numPlayers);
+    for(unsigned id = 0; id < numPlayers; id++)
+    {
+        const bool isHost = id == 0;
+        clients_.push_back(
+          std::make_unique<TestGameClient>(mapPath_, "Player" + std::to_string(id), isHost ? "HostPw" : "", isHost));
+        TestGameClient& client = *clients_.back();
+        client.setLinks(config_.uplinks[id], config_.downlinks[id], config_.seed * 1000 + id * 2);
+        client.setRealTime(true);
+        if(id < config_.minGFLengths.size())
+            client.setMinGFLength(config_.minGFLengths[id]);
+        if(config_.asyncPlayer == static_cast<int>(id))
+            client.setAsyncFromGF(config_.asyncGF);
+    }
+
+    const uint16_t port = listenOnFreePort([this](uint16_t curPort) {
+        return GAMESERVER.Start(CreateServerInfo(ServerType::DIRECT, curPort, "Simulation"), mapPath_, MAPTYPE_OLDMAP,
+                                "HostPw");
+    });
+    BOOST_TEST_REQUIRE(port != 0u);
+    // One after the other so the player ids match
+    for(unsigned id = 0; id < numPlayers; id++)
+    {
+        TestGameClient& client = getClient(id);
+        BOOST_TEST_REQUIRE(client.connect("localhost", port));
+        BOOST_TEST_REQUIRE(runUntil([&client]() { return client.hasJoined(); }));
+        BOOST_TEST_REQUIRE(client.getPlayerId() == id);
+    }
+
+    TestGameClient& host = getClient(0);
+    BOOST_TEST_REQUIRE(host.getNumPlayers() >= numPlayers);
+    host.lockFreeSlots();
+    // The command delay and NWF length are chosen from the pings at the start
+    BOOST_TEST_REQUIRE(runUntil([&host, numPlayers]() {
+        for(unsigned id = 0; id < host.getNumPlayers(); id++)
+        {
+            const PlayerState ps = host.getPlayerState(id);
+            if(ps == PS_FREE)
+                return false;
+            if(id < numPlayers && (ps != PS_OCCUPIED || !host.isPlayerReady(id) || host.getPing(id) == 0u))
+                return false;
+        }
+        return true;
+    }));
+    host.send(new GameMessage_Countdown(0));
+    BOOST_TEST_REQUIRE(runUntil([this]() {
+        return std::all_of(clients_.begin(), clients_.end(),
+                           [](const auto& client) { return client->isGameRunning(); });
+    }));
+}
+
+LockstepSimulation::~LockstepSimulation()
+{
+    for(auto& client : clients_)
+        client->drop();
+    GAMESERVER.Stop();
+}
+
+SimulationResult LockstepSimulation::run()
+{
+    TestGameClient& host = getClient(0);
+    // Only measure the game itself, not the start
+    std::vector<unsigned> startStallTimes, startNumCmdLatencies;
+    for(const auto& client : clients_)
+    {
+        startStallTimes.push_back(client->getStallTime());
+        startNumCmdLatencies.push_back(client->getCmdLatencies().size());
+    }
+    const auto startTime = FramesInfo::UsedClock::now();
+    const unsigned startGF = host.getGF();
+    const unsigned endGF = startGF + config_.numGFs;
+    BOOST_TEST(runUntil([&host, endGF]() { return host.getGF() >= endGF || host.isAsync(); }));
+
+    SimulationResult result;
+    result.duration =
+      std::chrono::duration_cast<std::chrono::milliseconds>(FramesInfo::UsedClock::now() - startTime).count();
+    result.numGFs = host.getGF() - startGF;
+    result.gfLength = host.getGFLength();
+    result.cmdDelay = host.getCmdDelay();
+    result.minNWFLength = host.getMinNWFLength();
+    result.maxNWFLength = host.getMaxNWFLength();
+    result.lagKicks = host.getKickedPlayers();
+    result.asyncDetectedGF = host.getAsyncGF();
+    for(unsigned id = 0; id < clients_.size(); id++)
+    {
+        TestGameClient& client = getClient(id);
+        result.stallTimes.push_back(client.getStallTime() - startStallTimes[id]);
+        const std::vector<unsigned>& cmdLatencies = client.getCmdLatencies();
+        result.cmdLatencies.insert(result.cmdLatencies.end(), cmdLatencies.begin() + startNumCmdLatencies[id],
+                                   cmdLatencies.end());
+        result.bytesToServer += client.getUplink()->getNumBytesSent();
+        result.bytesFromServer += client.getDownlink()->getNumBytesSent();
+    }
+    return result;
+}
+
+void LockstepSimulation::runOnce()
+{
+    GAMESERVER.Run();
+    for(auto& client : clients_)
+        client->run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
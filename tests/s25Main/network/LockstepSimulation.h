@@ -0,0 +1,118 @@
+// Copyright (c) 2016 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "NetworkEmulator.h"
+#include "TestGameClient.h"
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+/// Setup of a multiplayer game over emulated links
+struct SimulationConfig
+{
+    /// Links to and from the server for each player. Player 0 is the host which usually has no latency.
+    /// At most 3 players as this is the size of the map used
+    std::vector<LinkProperties> uplinks, downlinks;
+    /// Number of GFs the host has to execute
+    unsigned numGFs = 100;
+    /// Minimum time in ms a player needs for a GF. Empty or 0 = as fast as the game speed
+    std::vector<unsigned> minGFLengths;
+    /// Player whose checksum differs from all others starting at asyncGF (-1 = none)
+    int asyncPlayer = -1;
+    unsigned asyncGF = 0;
+    /// Stop waiting for a condition after this time in ms
+    unsigned maxDuration = 30 * 1000;
+    /// Seed for the jitter and loss of the links
+    unsigned seed = 1;
+
+    /// Create a config for numPlayers players all having the given links
+    static SimulationConfig create(unsigned numPlayers, const LinkProperties& uplink, const LinkProperties& downlink);
+    unsigned getNumPlayers() const { return uplinks.size(); }
+};
+
+/// Measurements of a game. All times are in ms
+struct SimulationResult
+{
+    /// Time the host needed for the GFs
+    unsigned duration = 0;
+    /// GFs executed by the host
+    unsigned numGFs = 0;
+    /// GF length of the game
+    unsigned gfLength = 0;
+    unsigned cmdDelay = 0;
+    /// Shortest and longest NWF (in GFs) announced by the server
+    unsigned minNWFLength = 0, maxNWFLength = 0;
+    /// Time each client waited at a NWF for commands or the NWF info of the server
+    std::vector<unsigned> stallTimes;
+    /// Players kicked in the order they were kicked
+    std::vector<unsigned> lagKicks;
+    /// Time from sending a command till it was executed, one entry per command and client
+    std::vector<unsigned> cmdLatencies;
+    /// GF of the host when the server reported the first async
+    boost::optional<unsigned> asyncDetectedGF;
+    /// Bytes sent to and from the server over all links since connecting
+    unsigned bytesToServer = 0, bytesFromServer = 0;
+
+    /// GF rate relative to the nominal one (1 = game runs at full speed)
+    double getRelativeGFRate() const;
+    /// Command latency at the given percentile (0-100)
+    unsigned getCmdLatency(unsigned percentile) const;
+    unsigned getMaxStallTime() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const SimulationResult& result);
+
+/// Game on the real server (GAMESERVER) with a TestGameClient per player. The clients execute the GFs in real time
+/// and send all messages over emulated links. So the lockstep protocol of the server (NWF infos, command delay,
+/// adaptive NWF length, lag kicks and async detection) can be measured under latency and loss.
+/// As this runs in real time the results vary a bit from run to run.
+class LockstepSimulation
+{
+public:
+    /// Start the server, let all players join and start the game once the pings are known
+    explicit LockstepSimulation(SimulationConfig config);
+    ~LockstepSimulation();
+
+    /// Run the server and all clients until the condition is true or maxDuration passed. Return the condition
+    template<class T_Cond>
+    bool runUntil(T_Cond&& cond);
+    /// Run till the host executed numGFs more GFs (or an async occurred) and return the measurements
+    SimulationResult run();
+    TestGameClient& getClient(unsigned playerId) { return *clients_.at(playerId); }
+
+private:
+    /// Run the server and all clients once
+    void runOnce();
+
+    SimulationConfig config_;
+    boost::filesystem::path mapPath_;
+    std::vector<std::unique_ptr<TestGameClient>> clients_;
+};
+
+template<class T_Cond>
+bool LockstepSimulation::runUntil(T_Cond&& cond)
+{
+    const auto endTime = FramesInfo::UsedClock::now() + std::chrono::milliseconds(config_.maxDuration);
+    while(!cond() && FramesInfo::UsedClock::now() < endTime)
+        runOnce();
+    return cond();
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2016 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "NetworkEmulator.h"
+#include "network/GameMessage.h"
+#include "s25util/Serializer.h"
+#include <algorithm>
+#include <stdexcept>
+
+EmulatedLink::EmulatedLink(LinkProperties props, unsigned seed)
+    : props_(std::move(props)), rng_(seed), lastSendEnd_(0), lastArrival_(0), isCut_(false), numMsgsSent_(0),
+      numBytesSent_(0), numLostPackets_(0)
+{
+    // Every packet would be lost forever
+    if(props_.lossPerMille >= 1000)
+        throw std::invalid_argument("Loss must be below 100%");
+}
+
+void EmulatedLink::send(unsigned now, const GameMessage& msg)
+{
+    if(isCut_)
+        return;
+    Serializer ser;
+    msg.Serialize(ser);
+    const auto* msgData = reinterpret_cast<const char*>(ser.GetData());
+    Packet packet{0, msg.getId(), std::vector<char>(msgData, msgData + ser.GetLength())};
+
+    const unsigned size = ser.GetLength() + MSG_HEADER_SIZE;
+    ++numMsgsSent_;
+    numBytesSent_ += size;
+
+    unsigned sendEnd = std::max(now, lastSendEnd_);
+    if(props_.bandwidth)
+        sendEnd += (size + props_.bandwidth - 1) / props_.bandwidth;
+    lastSendEnd_ = sendEnd;
+    // Note: Use the raw generator values as the distributions are implementation defined
+    unsigned arrival = getUpTime(sendEnd) + props_.latency;
+    if(props_.jitter)
+        arrival += rng_() % (props_.jitter + 1);
+    while(props_.lossPerMille && rng_() % 1000 < props_.lossPerMille)
+    {
+        ++numLostPackets_;
+        arrival = getUpTime(arrival + props_.retransmitTimeout);
+    }
+    packet.arrivalTime = lastArrival_ = std::max(arrival, lastArrival_);
+    inFlight_.emplace_back(std::move(packet));
+}
+
+std::vector<std::unique_ptr<GameMessage>> EmulatedLink::receive(unsigned now)
+{
+    std::vector<std::unique_ptr<GameMessage>> result;
+    while(!inFlight_.empty() && inFlight_.front().arrivalTime <= now)
+    {
+        const Packet& packet = inFlight_.front();
+        std::unique_ptr<GameMessage> msg(static_cast<GameMessage*>(GameMessage::create_game(packet.msgId)));
+        Serializer ser(packet.data.data(), packet.data.size());
+        msg->Deserialize(ser);
+        result.emplace_back(std::move(msg));
+        inFlight_.pop_front();
+    }
+    return result;
+}
+
+void EmulatedLink::cut()
+{
+    isCut_ = true;
+    inFlight_.clear();
+}
+
+unsigned EmulatedLink::getUpTime(unsigned time) const
+{
+    for(const auto& outage : props_.outages)
+    {
+        if(time >= outage.first && time < outage.second)
+            time = outage.second;
+    }
+    return time;
+}
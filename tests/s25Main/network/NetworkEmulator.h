@@ -0,0 +1,93 @@
+// Copyright (c) 2016 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+class GameMessage;
+
+/// Properties of one direction of an emulated connection. All times are in ms
+struct LinkProperties
+{
+    /// One-way latency
+    unsigned latency = 0;
+    /// Maximum additional random latency per packet
+    unsigned jitter = 0;
+    /// Bytes per ms. 0 = unlimited
+    unsigned bandwidth = 0;
+    /// Chance of a packet getting lost in 1/1000. The connection is reliable (TCP) so the packet and all following
+    /// ones are delayed by the retransmit timeout
+    unsigned lossPerMille = 0;
+    unsigned retransmitTimeout = 200;
+    /// Sorted intervals [start, end) in which the link is down. Packets are delivered after it is up again
+    std::vector<std::pair<unsigned, unsigned>> outages;
+
+    LinkProperties() = default;
+    LinkProperties(unsigned latency, unsigned jitter = 0, unsigned bandwidth = 0)
+        : latency(latency), jitter(jitter), bandwidth(bandwidth)
+    {}
+};
+
+/// One direction of a connection with emulated latency, bandwidth and packet loss.
+/// Messages are really serialized, so sizes are exact and the receiver gets its own copy.
+/// The result only depends on the properties, the seed and the sent messages.
+class EmulatedLink
+{
+public:
+    /// Size of the message header (id and length) added by the message queue
+    static constexpr unsigned MSG_HEADER_SIZE = 6;
+
+    EmulatedLink(LinkProperties props, unsigned seed);
+
+    /// Send the message at the given time
+    void send(unsigned now, const GameMessage& msg);
+    /// Return all messages that arrived till now in the order they were sent
+    std::vector<std::unique_ptr<GameMessage>> receive(unsigned now);
+    /// Drop everything in flight and ignore further messages
+    void cut();
+
+    bool empty() const { return inFlight_.empty(); }
+    unsigned getNumMsgsSent() const { return numMsgsSent_; }
+    unsigned getNumBytesSent() const { return numBytesSent_; }
+    unsigned getNumLostPackets() const { return numLostPackets_; }
+
+private:
+    struct Packet
+    {
+        unsigned arrivalTime;
+        uint16_t msgId;
+        std::vector<char> data;
+    };
+    /// Time the link is up again if it is down at the given time
+    unsigned getUpTime(unsigned time) const;
+
+    LinkProperties props_;
+    std::mt19937 rng_;
+    std::deque<Packet> inFlight_;
+    /// Time at which the last packet was completely put on the wire (bandwidth limit)
+    unsigned lastSendEnd_;
+    /// TCP keeps the order, so no packet arrives before the previous one
+    unsigned lastArrival_;
+    bool isCut_;
+    unsigned numMsgsSent_, numBytesSent_, numLostPackets_;
+};
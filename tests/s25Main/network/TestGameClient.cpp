@@ -0,0 +1,522 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "TestGameClient.h"
+#include "AsyncChecksum.h"
+#include "JoinPlayerInfo.h"
+#include "RTTR_Version.h"
+#include "helpers/containerUtils.h"
+#include "network/GameMessage_GameCommand.h"
+#include "network/GameMessages.h"
+#include "network/GameProtocol.h"
+#include "network/SerializedGameMessage.h"
+#include "gameTypes/CompressedData.h"
+#include "gameTypes/ServerType.h"
+#include "s25util/SocketSet.h"
+#include <boost/filesystem/operations.hpp>
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace bfs = boost::filesystem;
+
+TestGameClient::TestGameClient(bfs::path mapPath, std::string name, std::string password, bool isHost)
+    : mapPath_(std::move(mapPath)), name_(std::move(name)), password_(std::move(password)), isHost_(isHost),
+      player_(0)
+{}
+
+TestGameClient::~TestGameClient() = default;
+
+void TestGameClient::setLinks(const LinkProperties& uplink, const LinkProperties& downlink, unsigned seed)
+{
+    linkSetup_ = LinkSetup{uplink, downlink, seed};
+}
+
+bool TestGameClient::connect(const std::string& host, uint16_t port)
+{
+    drop();
+    players_.clear();
+    readyPlayers_.clear();
+    pings_.clear();
+    hasJoined_ = false;
+    nwfInfo_.reset();
+    framesInfo_.Clear();
+    isGameRunning_ = false;
+    curGF_ = numExecutedNWFs_ = 0;
+    minNWFLength_ = maxNWFLength_ = 0;
+    stallStart_.reset();
+    stallTime_ = 0;
+    cmdSendTimes_.clear();
+    cmdLatencies_.clear();
+    kickedPlayers_.clear();
+    asyncGF_.reset();
+    aiSlots_.clear();
+    requestedSnapshotGF_.reset();
+    isRejoining_ = isCatchingUp_ = hasTakenOver_ = false;
+    snapshot_.clear();
+    pendingRejoins_.clear();
+    // Nothing of a previous connection is still in flight
+    if(linkSetup_)
+    {
+        uplink_ = std::make_unique<EmulatedLink>(linkSetup_->uplink, linkSetup_->seed);
+        downlink_ = std::make_unique<EmulatedLink>(linkSetup_->downlink, linkSetup_->seed + 1);
+    }
+    connectTime_ = FramesInfo::UsedClock::now();
+    return player_.socket.Connect(host, port, false);
+}
+
+void TestGameClient::drop()
+{
+    player_.closeConnection();
+}
+
+bool TestGameClient::run()
+{
+    if(!isConnected())
+        return false;
+    SocketSet set;
+    set.Add(player_.socket);
+    if(set.Select(0, 0) > 0 && !player_.receiveMsgs())
+    {
+        drop();
+        return false;
+    }
+    if(downlink_)
+        delayReceivedMsgs();
+    player_.executeMsgs(*this);
+    if(!isConnected())
+        return false;
+    runLockstep();
+    if(uplink_)
+        delaySentMsgs();
+    if(!player_.sendMsgs(-1))
+        drop();
+    return isConnected();
+}
+
+void TestGameClient::send(GameMessage* msg)
+{
+    player_.sendMsgAsync(msg);
+}
+
+unsigned TestGameClient::getPing(unsigned playerId) const
+{
+    const auto it = pings_.find(playerId);
+    return it == pings_.end() ? 0u : it->second;
+}
+
+unsigned TestGameClient::getCurrentStallTime() const
+{
+    if(!stallStart_)
+        return 0u;
+    return std::chrono::duration_cast<FramesInfo::milliseconds32_t>(FramesInfo::UsedClock::now() - *stallStart_)
+      .count();
+}
+
+void TestGameClient::lockFreeSlots()
+{
+    BOOST_TEST_REQUIRE(isHost_);
+    for(unsigned id = 0; id < players_.size(); id++)
+    {
+        if(players_[id] == PS_FREE)
+            send(new GameMessage_Player_State(id, PS_LOCKED, AI::Info()));
+    }
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Ping&)
+{
+    send(new GameMessage_Pong());
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Player_Id& msg)
+{
+    BOOST_TEST_REQUIRE(msg.player != 0xFF);
+    player_.playerId = msg.player;
+    send(new GameMessage_Server_Type(ServerType::DIRECT, RTTR_Version::GetRevision()));
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Server_TypeOK& msg)
+{
+    BOOST_TEST_REQUIRE(msg.err_code == 0u);
+    send(new GameMessage_Server_Password(password_));
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Server_Password& msg)
+{
+    BOOST_TEST_REQUIRE(msg.password == "true");
+    // Same order as GameClient
+    if(!rejoinToken_.empty())
+        send(new GameMessage_Rejoin_Token(rejoinToken_));
+    send(new GameMessage_Player_Name(0xFF, name_));
+    send(new GameMessage_MapRequest(true));
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Map_Info&)
+{
+    // We have the map already
+    CompressedData mapData, luaData;
+    unsigned mapChecksum = 0, luaChecksum = 0;
+    BOOST_TEST_REQUIRE(mapData.CompressFromFile(mapPath_, &mapChecksum));
+    const bfs::path luaPath = bfs::path(mapPath_).replace_extension("lua");
+    if(bfs::exists(luaPath))
+        BOOST_TEST_REQUIRE(luaData.CompressFromFile(luaPath, &luaChecksum));
+    send(new GameMessage_Map_Checksum(mapChecksum, luaChecksum));
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Map_ChecksumOK& msg)
+{
+    BOOST_TEST_REQUIRE(msg.correct);
+    hasJoined_ = true;
+    send(new GameMessage_Player_Ready(0xFF, true));
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Map_Data& msg)
+{
+    // Only the snapshot of a rejoin is transferred
+    BOOST_TEST_REQUIRE(isRejoining_);
+    BOOST_TEST_REQUIRE(msg.isMapData);
+    BOOST_TEST_REQUIRE(msg.offset + msg.data.size() <= snapshot_.size());
+    std::copy(msg.data.begin(), msg.data.end(), snapshot_.begin() + msg.offset);
+    snapshotLength_ = std::max<unsigned>(snapshotLength_, msg.offset + msg.data.size());
+    send(new GameMessage_Map_DataAck(snapshotLength_));
+    if(snapshotLength_ == snapshot_.size())
+        loadSnapshot();
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Player_List& msg)
+{
+    players_.clear();
+    for(const JoinPlayerInfo& player : msg.playerInfos)
+        players_.push_back(player.ps);
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Player_New& msg)
+{
+    if(msg.player < players_.size())
+        players_[msg.player] = PS_OCCUPIED;
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Player_State& msg)
+{
+    if(msg.player < players_.size())
+        players_[msg.player] = msg.ps;
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Player_Ready& msg)
+{
+    if(msg.ready)
+        readyPlayers_.insert(msg.player);
+    else
+        readyPlayers_.erase(msg.player);
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Player_Kicked& msg)
+{
+    if(msg.player >= players_.size())
+        return true;
+    if(!nwfInfo_)
+    {
+        players_[msg.player] = PS_FREE;
+        return true;
+    }
+    kickedPlayers_.push_back(msg.player);
+    // Like GameClient: The slot is played by the AI of the host from now on
+    helpers::remove_if(pendingRejoins_, [&msg](const auto& rejoin) { return rejoin.first == msg.player; });
+    if(players_[msg.player] != PS_AI)
+    {
+        players_[msg.player] = PS_AI;
+        if(isHost_)
+        {
+            aiSlots_.insert(msg.player);
+            sendNothingNC(msg.player);
+        }
+    }
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Player_Ping& msg)
+{
+    pings_[msg.player] = msg.ping;
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Player_Rejoined& msg)
+{
+    pendingRejoins_.emplace_back(msg.player, msg.gf);
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Server_Start& msg)
+{
+    nwfInfo_ = std::make_unique<NWFInfo>();
+    nwfInfo_->init(msg.firstNwf, msg.cmdDelay);
+    curGF_ = msg.firstNwf;
+    for(unsigned id = 0; id < players_.size(); id++)
+    {
+        if(players_[id] != PS_AI && players_[id] != PS_OCCUPIED)
+            continue;
+        nwfInfo_->addPlayer(id);
+        if(isHost_ && players_[id] == PS_AI)
+            aiSlots_.insert(id);
+    }
+    // Loading is instant: Commands for the first NWF signal that we are ready
+    for(unsigned id : aiSlots_)
+        sendNothingNC(id);
+    sendNothingNC(0xFF);
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Server_Async&)
+{
+    if(!asyncGF_)
+        asyncGF_ = getGF();
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Server_NWFDone& msg)
+{
+    if(!nwfInfo_)
+        return true;
+    BOOST_TEST(nwfInfo_->addServerInfo(NWFServerInfo(msg.gf, msg.gf_length, msg.nextNWF)));
+    const unsigned nwfLength = msg.nextNWF - msg.gf;
+    if(minNWFLength_ == 0u || nwfLength < minNWFLength_)
+        minNWFLength_ = nwfLength;
+    maxNWFLength_ = std::max(maxNWFLength_, nwfLength);
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_GameCommand& msg)
+{
+    if(nwfInfo_)
+        BOOST_TEST(nwfInfo_->addPlayerCmds(msg.player, msg.cmds));
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Rejoin_RequestSnapshot& msg)
+{
+    // The NWF was not announced yet, so we cannot have executed it
+    BOOST_TEST_REQUIRE(static_cast<bool>(nwfInfo_));
+    BOOST_TEST(msg.gf >= getGF());
+    requestedSnapshotGF_ = msg.gf;
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Rejoin_Start& msg)
+{
+    player_.playerId = msg.player;
+    nwfInfo_ = std::make_unique<NWFInfo>();
+    nwfInfo_->init(msg.snapshotGF, msg.cmdDelay);
+    nwfInfo_->setBacklogAllowed(true);
+    curGF_ = msg.snapshotGF;
+    BOOST_TEST(msg.length == msg.compressedLength);
+    snapshot_.resize(msg.compressedLength);
+    snapshotLength_ = 0;
+    isRejoining_ = isCatchingUp_ = true;
+    return true;
+}
+
+bool TestGameClient::OnGameMessage(const GameMessage_Rejoin_Token& msg)
+{
+    rejoinToken_ = msg.token;
+    return true;
+}
+
+void TestGameClient::runLockstep()
+{
+    if(!nwfInfo_ || (isRejoining_ && players_.empty()))
+        return;
+    const FramesInfo::UsedClock::time_point now = FramesInfo::UsedClock::now();
+    if(!isGameRunning_)
+    {
+        // Like the loading screen: Start when the first NWF is ready
+        if(!nwfInfo_->isReady())
+            return;
+        isGameRunning_ = true;
+        framesInfo_.lastTime = now;
+    }
+    if(isRealTime_ && !isCatchingUp_)
+        framesInfo_.runDueGFs(now, MAX_GFS_PER_RUN, [this]() { return executeGF(); });
+    else
+    {
+        while(executeGF()) {}
+    }
+}
+
+bool TestGameClient::executeGF()
+{
+    if(getGF() == nwfInfo_->getNextNWF())
+    {
+        // The snapshot must not contain the commands of this NWF
+        if(requestedSnapshotGF_ == getGF())
+            sendSnapshot(*requestedSnapshotGF_);
+        if(!nwfInfo_->isReady())
+        {
+            // Reached the first NWF not yet announced after a rejoin -> Ready to take over
+            if(isCatchingUp_ && nwfInfo_->getNumPendingNWFs() == 0u)
+            {
+                isCatchingUp_ = false;
+                nwfInfo_->setBacklogAllowed(false);
+                send(new GameMessage_Rejoin_Ready());
+            }
+            if(!stallStart_)
+                stallStart_ = FramesInfo::UsedClock::now();
+            return false;
+        }
+        if(stallStart_)
+        {
+            stallTime_ += getCurrentStallTime();
+            stallStart_.reset();
+        }
+        executeNWF();
+    }
+    ++curGF_;
+    return true;
+}
+
+void TestGameClient::executeNWF()
+{
+    const unsigned curGF = getGF();
+    for(auto it = pendingRejoins_.begin(); it != pendingRejoins_.end();)
+    {
+        if(it->second > curGF)
+        {
+            ++it;
+            continue;
+        }
+        const unsigned playerId = it->first;
+        it = pendingRejoins_.erase(it);
+        players_.at(playerId) = PS_OCCUPIED;
+        aiSlots_.erase(playerId);
+        if(playerId == getPlayerId())
+        {
+            isRejoining_ = false;
+            hasTakenOver_ = true;
+        }
+    }
+    // Our commands are executed in the order they were sent
+    if(!cmdSendTimes_.empty())
+    {
+        cmdLatencies_.push_back(std::chrono::duration_cast<FramesInfo::milliseconds32_t>(FramesInfo::UsedClock::now()
+                                                                                          - cmdSendTimes_.front())
+                                  .count());
+        cmdSendTimes_.pop_front();
+    }
+    // Send the commands for the NWF cmdDelay NWFs ahead
+    for(unsigned id : aiSlots_)
+        sendNothingNC(id);
+    // Till the hand over our slot is played by the AI of the host
+    if(!isRejoining_)
+        sendNothingNC(0xFF);
+    nwfInfo_->execute(framesInfo_);
+    // A slow machine cannot run at the speed of the game
+    framesInfo_.gf_length = std::max(framesInfo_.gf_length, minGFLength_);
+    ++numExecutedNWFs_;
+}
+
+void TestGameClient::sendNothingNC(uint8_t playerId)
+{
+    const bool isOwnCmd = playerId == 0xFF;
+    // The commands of a rejoined player were partly sent by the host, so the latencies would be wrong
+    if(isOwnCmd && !hasTakenOver_)
+        cmdSendTimes_.push_back(FramesInfo::UsedClock::now());
+    const bool isAsync = isOwnCmd && asyncFromGF_ && getGF() >= *asyncFromGF_;
+    send(new GameMessage_GameCommand(playerId, isAsync ? AsyncChecksum(1, 0, 0, 0, 0) : AsyncChecksum(),
+                                     std::vector<gc::GameCommandPtr>()));
+}
+
+void TestGameClient::sendSnapshot(unsigned gf)
+{
+    requestedSnapshotGF_.reset();
+    // The game state is the state of the slots. Padded to require multiple parts and transfer windows
+    std::vector<char> snapshot(players_.size() + 2 * MAP_TRANSFER_WINDOW);
+    std::transform(players_.begin(), players_.end(), snapshot.begin(),
+                   [](PlayerState ps) { return static_cast<char>(ps); });
+    snapshot[players_.size()] = static_cast<char>(0xFF);
+    const std::vector<char> randomState(4, 'r');
+
+    const unsigned length = snapshot.size();
+    for(unsigned offset = 0; offset < length; offset += REJOIN_SNAPSHOT_PART_SIZE)
+    {
+        const unsigned partSize = std::min(REJOIN_SNAPSHOT_PART_SIZE, length - offset);
+        std::vector<char> part(snapshot.begin() + offset, snapshot.begin() + offset + partSize);
+        send(new GameMessage_Rejoin_Snapshot(gf, length, length, offset, std::move(part),
+                                             offset == 0 ? randomState : std::vector<char>()));
+    }
+}
+
+void TestGameClient::loadSnapshot()
+{
+    const auto itEnd = std::find(snapshot_.begin(), snapshot_.end(), static_cast<char>(0xFF));
+    BOOST_TEST_REQUIRE((itEnd != snapshot_.end()));
+    players_.clear();
+    for(auto it = snapshot_.begin(); it != itEnd; ++it)
+    {
+        players_.push_back(PlayerState(*it));
+        if(players_.back() == PS_AI || players_.back() == PS_OCCUPIED)
+            nwfInfo_->addPlayer(players_.size() - 1);
+    }
+    BOOST_TEST_REQUIRE(getPlayerId() < players_.size());
+    BOOST_TEST(players_[getPlayerId()] == PS_AI);
+}
+
+void TestGameClient::delayReceivedMsgs()
+{
+    const unsigned now = getLinkTime();
+    while(!player_.recvQueue.empty())
+    {
+        std::unique_ptr<Message> msg(player_.recvQueue.popFront());
+        auto* batch = dynamic_cast<GameMessage_Batch*>(msg.get());
+        if(!batch)
+        {
+            downlink_->send(now, static_cast<const GameMessage&>(*msg));
+            continue;
+        }
+        for(const auto& subMsg : batch->releaseMsgs())
+            downlink_->send(now, static_cast<const GameMessage&>(*subMsg));
+    }
+    for(auto& msg : downlink_->receive(now))
+        player_.recvQueue.push(msg.release());
+}
+
+void TestGameClient::delaySentMsgs()
+{
+    const unsigned now = getLinkTime();
+    while(!player_.sendQueue.empty())
+    {
+        std::unique_ptr<Message> msg(player_.sendQueue.popFront());
+        uplink_->send(now, static_cast<const GameMessage&>(*msg));
+    }
+    for(auto& msg : uplink_->receive(now))
+        player_.sendQueue.push(msg.release());
+}
+
+unsigned TestGameClient::getLinkTime() const
+{
+    return std::chrono::duration_cast<FramesInfo::milliseconds32_t>(FramesInfo::UsedClock::now() - connectTime_)
+      .count();
+}
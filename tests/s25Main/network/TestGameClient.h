@@ -0,0 +1,195 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "FramesInfo.h"
+#include "NWFInfo.h"
+#include "NetworkEmulator.h"
+#include "network/GameMessageInterface.h"
+#include "network/NetworkPlayer.h"
+#include "gameTypes/PlayerState.h"
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class GameMessage;
+
+/// Client for tests against the real GameServer (GAMESERVER). It does the handshake and follows the lockstep protocol
+/// like GameClient but without a game: All commands are empty with the same checksum. The host plays the AI slots and
+/// provides rejoin snapshots which only contain the slot states.
+/// By default the GFs are executed as fast as possible, in real time mode they are paced by the GF length like in
+/// GameClient. Optionally all messages go through emulated links with latency, jitter and loss.
+class TestGameClient : public GameMessageInterface
+{
+public:
+    /// The map must be the one of the server so the client can join without a transfer
+    TestGameClient(boost::filesystem::path mapPath, std::string name, std::string password, bool isHost);
+    ~TestGameClient() override;
+
+    /// Send and receive all messages over emulated links. Must be set before connecting and is used for all following
+    /// connections. Note: Received batches are split, so the sizes are those of the single messages
+    void setLinks(const LinkProperties& uplink, const LinkProperties& downlink, unsigned seed);
+    /// Execute the GFs at the speed of the game instead of as fast as possible. Catching up after a rejoin is still
+    /// done as fast as possible
+    void setRealTime(bool realTime) { isRealTime_ = realTime; }
+    /// Emulate a slow machine which needs at least the given time in ms for a GF
+    void setMinGFLength(unsigned minGFLength) { minGFLength_ = FramesInfo::milliseconds32_t(minGFLength); }
+    /// Emulate an async by sending a different checksum starting at the given GF
+    void setAsyncFromGF(unsigned gf) { asyncFromGF_ = gf; }
+
+    /// Connect to the server and start the handshake. The rejoin token (if any) is kept
+    bool connect(const std::string& host, uint16_t port);
+    /// Close the connection without notifying the server (e.g. crash or network failure)
+    void drop();
+    /// Handle received messages, execute ready NWFs and send everything queued. Return false if not connected
+    bool run();
+    void send(GameMessage* msg);
+
+    /// Host only: Lock all free slots so the game can start with the connected players
+    void lockFreeSlots();
+    void setRejoinToken(std::string token) { rejoinToken_ = std::move(token); }
+
+    bool isConnected() const { return player_.socket.isValid(); }
+    /// Joined the lobby of the server
+    bool hasJoined() const { return hasJoined_; }
+    unsigned getPlayerId() const { return player_.playerId; }
+    PlayerState getPlayerState(unsigned playerId) const { return players_.at(playerId); }
+    bool isPlayerReady(unsigned playerId) const { return readyPlayers_.count(playerId) > 0u; }
+    unsigned getNumPlayers() const { return players_.size(); }
+    const std::string& getRejoinToken() const { return rejoinToken_; }
+    /// Last ping of the player sent by the server, 0 if none yet
+    unsigned getPing(unsigned playerId) const;
+    /// The first NWF was ready and the GFs are executed
+    bool isGameRunning() const { return isGameRunning_; }
+    /// Current GF, i.e. all GFs before were executed
+    unsigned getGF() const { return curGF_; }
+    unsigned getNumExecutedNWFs() const { return numExecutedNWFs_; }
+    unsigned getCmdDelay() const { return nwfInfo_ ? nwfInfo_->getCmdDelay() : 0u; }
+    /// GF length in ms as used for executing the GFs
+    unsigned getGFLength() const { return framesInfo_.gf_length.count(); }
+    /// Shortest and longest NWF in GFs announced by the server (0 if none)
+    unsigned getMinNWFLength() const { return minNWFLength_; }
+    unsigned getMaxNWFLength() const { return maxNWFLength_; }
+    /// Time in ms waited at NWFs for the commands of other players or the server. Only meaningful in real time mode
+    unsigned getStallTime() const { return stallTime_; }
+    /// Time in ms the current wait at a NWF takes so far, 0 if not waiting
+    unsigned getCurrentStallTime() const;
+    /// Time in ms from sending each own command till executing it. Only measured if the client did not rejoin
+    const std::vector<unsigned>& getCmdLatencies() const { return cmdLatencies_; }
+    /// Players kicked during the game in the order they were kicked
+    const std::vector<unsigned>& getKickedPlayers() const { return kickedPlayers_; }
+    /// Rejoined the game and took over the slot from the AI
+    bool hasTakenOver() const { return hasTakenOver_; }
+    bool isAsync() const { return asyncGF_.is_initialized(); }
+    /// GF at which the server reported an async
+    const boost::optional<unsigned>& getAsyncGF() const { return asyncGF_; }
+    /// Emulated links or nullptr if the messages are sent directly
+    EmulatedLink* getUplink() { return uplink_.get(); }
+    EmulatedLink* getDownlink() { return downlink_.get(); }
+
+    bool OnGameMessage(const GameMessage_Ping& msg) override;
+    bool OnGameMessage(const GameMessage_Player_Id& msg) override;
+    bool OnGameMessage(const GameMessage_Server_TypeOK& msg) override;
+    bool OnGameMessage(const GameMessage_Server_Password& msg) override;
+    bool OnGameMessage(const GameMessage_Map_Info& msg) override;
+    bool OnGameMessage(const GameMessage_Map_ChecksumOK& msg) override;
+    bool OnGameMessage(const GameMessage_Map_Data& msg) override;
+    bool OnGameMessage(const GameMessage_Player_List& msg) override;
+    bool OnGameMessage(const GameMessage_Player_New& msg) override;
+    bool OnGameMessage(const GameMessage_Player_State& msg) override;
+    bool OnGameMessage(const GameMessage_Player_Ready& msg) override;
+    bool OnGameMessage(const GameMessage_Player_Kicked& msg) override;
+    bool OnGameMessage(const GameMessage_Player_Ping& msg) override;
+    bool OnGameMessage(const GameMessage_Player_Rejoined& msg) override;
+    bool OnGameMessage(const GameMessage_Server_Start& msg) override;
+    bool OnGameMessage(const GameMessage_Server_Async& msg) override;
+    bool OnGameMessage(const GameMessage_Server_NWFDone& msg) override;
+    bool OnGameMessage(const GameMessage_GameCommand& msg) override;
+    bool OnGameMessage(const GameMessage_Rejoin_RequestSnapshot& msg) override;
+    bool OnGameMessage(const GameMessage_Rejoin_Start& msg) override;
+    bool OnGameMessage(const GameMessage_Rejoin_Token& msg) override;
+
+private:
+    /// Maximum number of GFs executed per run in real time mode
+    static constexpr unsigned MAX_GFS_PER_RUN = 4;
+
+    /// Execute the GFs that are due (all in fast mode)
+    void runLockstep();
+    /// Execute the current GF. Return false if it is a NWF that is not ready yet
+    bool executeGF();
+    void executeNWF();
+    void sendNothingNC(uint8_t playerId);
+    void sendSnapshot(unsigned gf);
+    /// Start the game from the received snapshot
+    void loadSnapshot();
+    /// Pass received messages through the downlink and sent ones through the uplink
+    void delayReceivedMsgs();
+    void delaySentMsgs();
+    /// Time in ms since connecting, used for the emulated links
+    unsigned getLinkTime() const;
+
+    boost::filesystem::path mapPath_;
+    std::string name_, password_;
+    bool isHost_;
+    NetworkPlayer player_;
+    std::vector<PlayerState> players_;
+    std::set<unsigned> readyPlayers_;
+    std::map<unsigned, unsigned> pings_;
+    bool hasJoined_ = false;
+    std::unique_ptr<NWFInfo> nwfInfo_;
+    FramesInfo framesInfo_;
+    bool isRealTime_ = false;
+    FramesInfo::milliseconds32_t minGFLength_{0};
+    /// All commands for the first NWF were received
+    bool isGameRunning_ = false;
+    unsigned curGF_ = 0, numExecutedNWFs_ = 0;
+    unsigned minNWFLength_ = 0, maxNWFLength_ = 0;
+    boost::optional<FramesInfo::UsedClock::time_point> stallStart_;
+    unsigned stallTime_ = 0;
+    /// Time each own command not yet executed was sent
+    std::deque<FramesInfo::UsedClock::time_point> cmdSendTimes_;
+    std::vector<unsigned> cmdLatencies_;
+    std::vector<unsigned> kickedPlayers_;
+    boost::optional<unsigned> asyncFromGF_, asyncGF_;
+    /// Slots the host sends the commands for
+    std::set<unsigned> aiSlots_;
+
+    std::string rejoinToken_;
+    boost::optional<unsigned> requestedSnapshotGF_;
+    bool isRejoining_ = false, isCatchingUp_ = false, hasTakenOver_ = false;
+    std::vector<char> snapshot_;
+    unsigned snapshotLength_ = 0;
+    /// Players that take over their slot again at the given GF
+    std::vector<std::pair<unsigned, unsigned>> pendingRejoins_;
+
+    struct LinkSetup
+    {
+        LinkProperties uplink, downlink;
+        unsigned seed;
+    };
+    boost::optional<LinkSetup> linkSetup_;
+    std::unique_ptr<EmulatedLink> uplink_, downlink_;
+    FramesInfo::UsedClock::time_point connectTime_;
+};
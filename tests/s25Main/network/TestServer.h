@@ -17,10 +17,26 @@
 
 #pragma once
 
+#include "rttr/test/random.hpp"
 #include "s25util/MessageQueue.h"
 #include "s25util/Socket.h"
+#include <cstdint>
 #include <vector>
 
+/// Call listen(port) with random ports until it succeeds, so tests running in parallel don't use the same port.
+/// Return the port used or 0 if none was found
+template<class T_Listen>
+uint16_t listenOnFreePort(T_Listen&& listen)
+{
+    for(unsigned i = 0; i < 100; i++)
+    {
+        const auto port = rttr::test::randomValue<uint16_t>(20000, 60000);
+        if(listen(port))
+            return port;
+    }
+    return 0;
+}
+
 struct Connection
 {
     Socket so;
@@ -0,0 +1,213 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "RTTR_Version.h"
+#include "TestServer.h"
+#include "Timer.h"
+#include "network/CreateServerInfo.h"
+#include "network/GameMessageInterface.h"
+#include "network/GameMessages.h"
+#include "network/GameProtocol.h"
+#include "network/GameServer.h"
+#include "network/NetworkPlayer.h"
+#include "test/testConfig.h"
+#include "gameTypes/MapType.h"
+#include "gameTypes/ServerType.h"
+#include "s25util/SocketSet.h"
+#include <rttr/test/TmpFolder.hpp>
+#include <rttr/test/random.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+
+namespace bfs = boost::filesystem;
+
+namespace {
+/// Client doing the handshake with the real server and collecting the map data
+struct MapTransferClient : GameMessageInterface
+{
+    NetworkPlayer player;
+    bool connected = true, gotPlayerId = false, typeOk = false, passwordOk = false;
+    unsigned mapCompressedLen = 0, totalCompressedLen = 0;
+    /// Number of bytes received in order (map data followed by lua data)
+    unsigned numBytesReceived = 0;
+
+    MapTransferClient() : player(0) {}
+
+    bool OnGameMessage(const GameMessage_Player_Id& msg) override
+    {
+        gotPlayerId = true;
+        player.playerId = msg.player;
+        return true;
+    }
+    bool OnGameMessage(const GameMessage_Server_TypeOK& msg) override
+    {
+        typeOk = msg.err_code == 0;
+        return true;
+    }
+    bool OnGameMessage(const GameMessage_Server_Password& msg) override
+    {
+        passwordOk = msg.password == "true";
+        return true;
+    }
+    bool OnGameMessage(const GameMessage_Map_Info& msg) override
+    {
+        mapCompressedLen = msg.mapCompressedLen;
+        totalCompressedLen = msg.mapCompressedLen + msg.luaCompressedLen;
+        return true;
+    }
+    bool OnGameMessage(const GameMessage_Map_Data& msg) override
+    {
+        // Chunks are sent in order without gaps or duplicates
+        const unsigned pos = msg.isMapData ? msg.offset : mapCompressedLen + msg.offset;
+        BOOST_TEST(pos == numBytesReceived);
+        numBytesReceived += msg.data.size();
+        return true;
+    }
+
+    void send(GameMessage* msg)
+    {
+        player.sendMsgAsync(msg);
+        BOOST_TEST_REQUIRE(player.sendMsgs(-1));
+    }
+
+    /// Let the server and client run once
+    void run()
+    {
+        GAMESERVER.Run();
+        SocketSet set;
+        set.Add(player.socket);
+        if(set.Select(10, 0) > 0 && !player.receiveMsgs())
+            connected = false;
+        player.executeMsgs(*this);
+    }
+
+    /// Run until the condition is true or the connection was lost. Return the condition
+    template<class T_Cond>
+    bool runUntil(T_Cond&& cond)
+    {
+        Timer timer(true);
+        while(connected && !cond() && timer.getElapsed() < std::chrono::seconds(10))
+            run();
+        return cond();
+    }
+
+    /// Run for the given time, e.g. to check that nothing gets sent
+    void runFor(std::chrono::milliseconds duration)
+    {
+        Timer timer(true);
+        while(connected && timer.getElapsed() < duration)
+            run();
+    }
+};
+
+struct MapTransferFixture
+{
+    rttr::test::TmpFolder tmpFolder;
+    bfs::path mapPath;
+    MapTransferClient client;
+
+    MapTransferFixture() : mapPath(tmpFolder.get() / "LuaFunctions.swd")
+    {
+        // Random data at the end does not compress, so the transfer needs multiple windows
+        const bfs::path srcMapPath = rttr::test::rttrBaseDir / "tests/testData/maps/LuaFunctions.SWD";
+        bfs::copy_file(srcMapPath, mapPath);
+        bfs::copy_file(bfs::path(srcMapPath).replace_extension("lua"), bfs::path(mapPath).replace_extension("lua"));
+        {
+            boost::nowide::ofstream mapFile(mapPath, std::ios::binary | std::ios::app);
+            for(unsigned i = 0; i < 4 * MAP_TRANSFER_WINDOW; i++)
+                mapFile.put(static_cast<char>(rttr::test::randomValue<uint8_t>()));
+        }
+
+        const uint16_t port = listenOnFreePort([this](uint16_t curPort) {
+            return GAMESERVER.Start(CreateServerInfo(ServerType::DIRECT, curPort, "MapTransfer"), mapPath,
+                                    MAPTYPE_OLDMAP, "");
+        });
+        BOOST_TEST_REQUIRE(port != 0u);
+        BOOST_TEST_REQUIRE(client.player.socket.Connect("localhost", port, false));
+        BOOST_TEST_REQUIRE(client.runUntil([this]() { return client.gotPlayerId; }));
+
+        client.send(new GameMessage_Server_Type(ServerType::DIRECT, RTTR_Version::GetRevision()));
+        client.send(new GameMessage_Server_Password(""));
+        BOOST_TEST_REQUIRE(client.runUntil([this]() { return client.typeOk && client.passwordOk; }));
+        client.send(new GameMessage_MapRequest(true));
+        BOOST_TEST_REQUIRE(client.runUntil([this]() { return client.totalCompressedLen > 0u; }));
+        BOOST_TEST_REQUIRE(client.totalCompressedLen > 3 * MAP_TRANSFER_WINDOW);
+    }
+    ~MapTransferFixture()
+    {
+        client.player.closeConnection();
+        GAMESERVER.Stop();
+    }
+
+    /// Wait until the given number of bytes was received and check that no more data arrives
+    void checkReceivesExactly(unsigned numBytes)
+    {
+        BOOST_TEST_REQUIRE(client.runUntil([this, numBytes]() { return client.numBytesReceived >= numBytes; }));
+        client.runFor(std::chrono::milliseconds(200));
+        BOOST_TEST_REQUIRE(client.connected);
+        BOOST_TEST_REQUIRE(client.numBytesReceived == numBytes);
+    }
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(MapTransfer, MapTransferFixture)
+
+BOOST_AUTO_TEST_CASE(WindowLimitsUnackedData)
+{
+    client.send(new GameMessage_MapRequest(false));
+    // Only one window is sent without acks
+    checkReceivesExactly(MAP_TRANSFER_WINDOW);
+
+    // Each ack allows as many new bytes as were acknowledged
+    client.send(new GameMessage_Map_DataAck(2 * MAP_PART_SIZE));
+    checkReceivesExactly(MAP_TRANSFER_WINDOW + 2 * MAP_PART_SIZE);
+    client.send(new GameMessage_Map_DataAck(MAP_TRANSFER_WINDOW));
+    checkReceivesExactly(2 * MAP_TRANSFER_WINDOW);
+
+    // A delayed ack older than the last one sends nothing
+    client.send(new GameMessage_Map_DataAck(MAP_PART_SIZE));
+    checkReceivesExactly(2 * MAP_TRANSFER_WINDOW);
+    // Neither does repeating the last ack
+    client.send(new GameMessage_Map_DataAck(MAP_TRANSFER_WINDOW));
+    checkReceivesExactly(2 * MAP_TRANSFER_WINDOW);
+
+    // Acking everything received completes the transfer
+    unsigned numBytesAcked = MAP_TRANSFER_WINDOW;
+    BOOST_TEST_REQUIRE(client.runUntil([this, &numBytesAcked]() {
+        if(client.numBytesReceived > numBytesAcked)
+        {
+            numBytesAcked = client.numBytesReceived;
+            client.send(new GameMessage_Map_DataAck(numBytesAcked));
+        }
+        return numBytesAcked == client.totalCompressedLen;
+    }));
+    client.runFor(std::chrono::milliseconds(200));
+    BOOST_TEST(client.connected);
+    BOOST_TEST(client.numBytesReceived == client.totalCompressedLen);
+}
+
+BOOST_AUTO_TEST_CASE(AckOfUnsentDataKicks)
+{
+    client.send(new GameMessage_MapRequest(false));
+    checkReceivesExactly(MAP_TRANSFER_WINDOW);
+    client.send(new GameMessage_Map_DataAck(MAP_TRANSFER_WINDOW + 1));
+    BOOST_TEST(client.runUntil([this]() { return !client.connected; }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
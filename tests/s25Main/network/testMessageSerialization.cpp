@@ -0,0 +1,195 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "TestServer.h"
+#include "Timer.h"
+#include "network/GameMessageInterface.h"
+#include "network/GameMessages.h"
+#include "network/GameProtocol.h"
+#include "network/NetworkPlayer.h"
+#include "network/SerializedGameMessage.h"
+#include "s25util/Serializer.h"
+#include "s25util/SocketSet.h"
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+struct ChatCollector : GameMessageInterface
+{
+    std::vector<std::string> texts;
+    bool OnGameMessage(const GameMessage_Chat& msg) override
+    {
+        texts.push_back(msg.text);
+        return true;
+    }
+};
+
+/// Closes the connection of the receiver on the first message like GameServer::KickPlayer does
+struct KickingCollector : ChatCollector
+{
+    NetworkPlayer& receiver;
+    explicit KickingCollector(NetworkPlayer& receiver) : receiver(receiver) {}
+    bool OnGameMessage(const GameMessage_Chat& msg) override
+    {
+        ChatCollector::OnGameMessage(msg);
+        receiver.closeConnection();
+        return true;
+    }
+};
+
+struct LoopbackFixture
+{
+    Socket serverSocket;
+    NetworkPlayer client, server;
+
+    LoopbackFixture() : client(0), server(1)
+    {
+        const uint16_t port =
+          listenOnFreePort([this](uint16_t curPort) { return serverSocket.Listen(curPort, false, false); });
+        BOOST_TEST_REQUIRE(port != 0u);
+        BOOST_TEST_REQUIRE(client.socket.Connect("localhost", port, false));
+        SocketSet set;
+        set.Add(serverSocket);
+        BOOST_TEST_REQUIRE(set.Select(10 * 1000, 0) > 0);
+        server.socket = serverSocket.Accept();
+        BOOST_TEST_REQUIRE(server.socket.isValid());
+    }
+    ~LoopbackFixture()
+    {
+        client.closeConnection();
+        server.closeConnection();
+        serverSocket.Close();
+    }
+
+    /// Receive messages until the queue is not empty or the timeout passed
+    static void waitForMsgs(NetworkPlayer& receiver)
+    {
+        Timer timer(true);
+        while(receiver.recvQueue.empty() && timer.getElapsed() < std::chrono::seconds(10))
+        {
+            SocketSet set;
+            set.Add(receiver.socket);
+            if(set.Select(100, 0) > 0)
+                BOOST_TEST_REQUIRE(receiver.receiveMsgs());
+        }
+    }
+
+    /// Receive and execute messages until numMsgs chat messages were received or the timeout passed
+    static void receiveChats(NetworkPlayer& receiver, ChatCollector& collector, unsigned numMsgs)
+    {
+        Timer timer(true);
+        while(collector.texts.size() < numMsgs && timer.getElapsed() < std::chrono::seconds(30))
+        {
+            waitForMsgs(receiver);
+            receiver.executeMsgs(collector);
+        }
+        BOOST_TEST_REQUIRE(collector.texts.size() == numMsgs);
+    }
+};
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(MessageSerialization)
+
+BOOST_AUTO_TEST_CASE(SerializedMsgEqualsOriginal)
+{
+    const GameMessage_Chat msg(1, CD_ALL, "Hello World");
+    Serializer ser;
+    msg.Serialize(ser);
+
+    const SerializedGameMessage serMsg(msg);
+    BOOST_TEST(serMsg.getId() == msg.getId());
+    BOOST_TEST_REQUIRE(serMsg.getSize() == ser.GetLength());
+    Serializer ser2;
+    serMsg.Serialize(ser2);
+    BOOST_TEST_REQUIRE(ser2.GetLength() == ser.GetLength());
+    BOOST_TEST(memcmp(ser2.GetData(), ser.GetData(), ser.GetLength()) == 0);
+
+    // Copies for other players share the data
+    const SerializedGameMessage serMsgCopy(serMsg.getId(), serMsg.getData());
+    BOOST_TEST(serMsgCopy.getData() == serMsg.getData());
+}
+
+BOOST_FIXTURE_TEST_CASE(SmallMsgsAreBatched, LoopbackFixture)
+{
+    ChatCollector collector;
+    std::vector<std::string> expectedTexts;
+    for(unsigned i = 0; i < 5; i++)
+    {
+        expectedTexts.push_back("Msg" + std::to_string(i));
+        client.sendMsgAsync(new GameMessage_Chat(0, CD_ALL, expectedTexts.back()));
+    }
+    BOOST_TEST_REQUIRE(client.sendMsgs(-1));
+    BOOST_TEST(client.sendQueue.empty());
+    waitForMsgs(server);
+    BOOST_TEST_REQUIRE(!server.recvQueue.empty());
+    BOOST_TEST(server.recvQueue.front()->getId() == NMS_BATCH);
+    receiveChats(server, collector, expectedTexts.size());
+    BOOST_TEST(collector.texts == expectedTexts, boost::test_tools::per_element());
+
+    // Order is kept with large messages in between
+    collector.texts.clear();
+    expectedTexts = {"Small1", std::string(2000, 'x'), "Small2", "Small3"};
+    for(const std::string& text : expectedTexts)
+        server.sendMsgAsync(new GameMessage_Chat(1, CD_ALL, text));
+    BOOST_TEST_REQUIRE(server.sendMsgs(-1));
+    receiveChats(client, collector, expectedTexts.size());
+    BOOST_TEST(collector.texts == expectedTexts, boost::test_tools::per_element());
+}
+
+BOOST_FIXTURE_TEST_CASE(KickDuringBatchStopsExecution, LoopbackFixture)
+{
+    for(unsigned i = 0; i < 3; i++)
+        client.sendMsgAsync(new GameMessage_Chat(0, CD_ALL, "Msg" + std::to_string(i)));
+    BOOST_TEST_REQUIRE(client.sendMsgs(-1));
+    waitForMsgs(server);
+    BOOST_TEST_REQUIRE(!server.recvQueue.empty());
+    BOOST_TEST_REQUIRE(server.recvQueue.front()->getId() == NMS_BATCH);
+
+    // Closing the connection destroys the received batch. The remaining messages must not be run
+    KickingCollector collector(server);
+    server.executeMsgs(collector);
+    BOOST_TEST_REQUIRE(collector.texts.size() == 1u);
+    BOOST_TEST(collector.texts.front() == "Msg0");
+    BOOST_TEST(!server.socket.isValid());
+    BOOST_TEST(server.recvQueue.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(LoopbackThroughput, LoopbackFixture)
+{
+    constexpr unsigned numRounds = 200;
+    constexpr unsigned msgsPerRound = 100;
+    ChatCollector collector;
+    Timer timer(true);
+    for(unsigned i = 0; i < numRounds; i++)
+    {
+        const GameMessage_Chat msg(0, CD_ALL, "Round " + std::to_string(i));
+        const SerializedGameMessage serMsg(msg);
+        // Like a relayed command: Serialized once, sent multiple times
+        for(unsigned j = 0; j < msgsPerRound; j++)
+            server.sendMsgAsync(new SerializedGameMessage(serMsg.getId(), serMsg.getData()));
+        BOOST_TEST_REQUIRE(server.sendMsgs(-1));
+        receiveChats(client, collector, (i + 1) * msgsPerRound);
+        BOOST_TEST(collector.texts.back() == msg.text);
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(timer.getElapsed());
+    BOOST_TEST_MESSAGE("Sent " << numRounds * msgsPerRound << " messages in " << elapsed.count() << "ms");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "FramesInfo.h"
+#include "NWFInfo.h"
+#include "network/GameServer.h"
+#include <boost/test/unit_test.hpp>
+
+namespace {
+using milliseconds32_t = FramesInfo::milliseconds32_t;
+
+/// Return the NWF length following an NWF of lastNWFLength GFs with the given GF length
+unsigned calcNextLength(unsigned lastNWFLength, unsigned lastGFLength, unsigned newGFLength, unsigned highestPing)
+{
+    const unsigned gf = 1000;
+    return GameServer::CalcAdaptiveNWFLength(NWFServerInfo(gf, lastGFLength, gf + lastNWFLength),
+                                             milliseconds32_t(newGFLength), highestPing);
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(NWFLength)
+
+BOOST_AUTO_TEST_CASE(NWFLengthCoversPing)
+{
+    BOOST_TEST(GameServer::CalcNWFLenght(milliseconds32_t(0), milliseconds32_t(20)) == 1u);
+    BOOST_TEST(GameServer::CalcNWFLenght(milliseconds32_t(20), milliseconds32_t(20)) == 1u);
+    BOOST_TEST(GameServer::CalcNWFLenght(milliseconds32_t(100), milliseconds32_t(20)) == 5u);
+    BOOST_TEST(GameServer::CalcNWFLenght(milliseconds32_t(101), milliseconds32_t(20)) == 6u);
+    // Limited
+    BOOST_TEST(GameServer::CalcNWFLenght(milliseconds32_t(10000), milliseconds32_t(20)) == 20u);
+}
+
+BOOST_AUTO_TEST_CASE(AdaptiveGrowsImmediately)
+{
+    // From the minimum to the full ping in one step
+    BOOST_TEST(calcNextLength(1, 20, 20, 200) == 10u);
+    BOOST_TEST(calcNextLength(3, 20, 20, 61) == 4u);
+    BOOST_TEST(calcNextLength(3, 20, 20, 1000) == 20u);
+}
+
+BOOST_AUTO_TEST_CASE(AdaptiveShrinksSlowly)
+{
+    // Unchanged if the ping still requires the length
+    BOOST_TEST(calcNextLength(5, 20, 20, 100) == 5u);
+    BOOST_TEST(calcNextLength(5, 20, 20, 81) == 5u);
+    // Ping dropped: Only 1 GF less per NWF
+    unsigned nwfLength = 10;
+    for(unsigned expectedLength = 9; expectedLength >= 1; expectedLength--)
+    {
+        nwfLength = calcNextLength(nwfLength, 20, 20, 0);
+        BOOST_TEST(nwfLength == expectedLength);
+    }
+    // Minimum reached
+    BOOST_TEST(calcNextLength(nwfLength, 20, 20, 0) == 1u);
+    // Stops shrinking at the length required by the ping
+    nwfLength = 10;
+    for(unsigned i = 0; i < 10; i++)
+        nwfLength = calcNextLength(nwfLength, 20, 20, 70);
+    BOOST_TEST(nwfLength == 4u);
+}
+
+BOOST_AUTO_TEST_CASE(AdaptiveSpeedChange)
+{
+    // The limit for shrinking is based on the duration of the last NWF
+    // Faster: 5 * 20ms = 100ms -> 1 GF less of 10ms = 90ms
+    BOOST_TEST(calcNextLength(5, 20, 10, 0) == 9u);
+    // Slower: 100ms - 40ms = 60ms -> 2 GFs (80ms)
+    BOOST_TEST(calcNextLength(5, 20, 40, 0) == 2u);
+    // Growing uses the new GF length
+    BOOST_TEST(calcNextLength(5, 20, 40, 150) == 4u);
+    BOOST_TEST(calcNextLength(5, 20, 10, 150) == 15u);
+    // Same duration is kept if the ping requires it
+    BOOST_TEST(calcNextLength(5, 20, 10, 100) == 10u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,218 @@
+// Copyright (c) 2016 - 2017 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "LockstepSimulation.h"
+#include "NetworkEmulator.h"
+#include "network/GameMessages.h"
+#include "network/GameProtocol.h"
+#include "gameTypes/ChatDestination.h"
+#include "s25util/Serializer.h"
+#include <rttr/test/MockClock.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+/// Receive all chat messages till the given time and return their texts with the arrival times
+std::vector<std::pair<std::string, unsigned>> receiveChats(EmulatedLink& link, unsigned endTime)
+{
+    std::vector<std::pair<std::string, unsigned>> result;
+    for(unsigned now = 0; now <= endTime; now++)
+    {
+        for(const auto& msg : link.receive(now))
+        {
+            const auto* chat = dynamic_cast<const GameMessage_Chat*>(msg.get());
+            BOOST_TEST_REQUIRE(chat);
+            result.emplace_back(chat->text, now);
+        }
+    }
+    return result;
+}
+
+unsigned getMsgSize(const GameMessage& msg)
+{
+    Serializer ser;
+    msg.Serialize(ser);
+    return ser.GetLength() + EmulatedLink::MSG_HEADER_SIZE;
+}
+
+/// A game on the internet: The host runs the server, the others have a noticeable ping
+SimulationConfig createInternetGame(unsigned numPlayers)
+{
+    return SimulationConfig::create(numPlayers, LinkProperties(80, 20), LinkProperties(80, 20));
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(NetworkEmulation)
+
+BOOST_AUTO_TEST_CASE(LinkKeepsOrderWithLatencyAndJitter)
+{
+    EmulatedLink link(LinkProperties(100, 50), 42);
+    for(unsigned i = 0; i < 10; i++)
+        link.send(i, GameMessage_Chat(0, CD_ALL, std::to_string(i)));
+    BOOST_TEST(link.getNumMsgsSent() == 10u);
+    BOOST_TEST(link.receive(99).empty());
+
+    const auto chats = receiveChats(link, 200);
+    BOOST_TEST_REQUIRE(chats.size() == 10u);
+    for(unsigned i = 0; i < chats.size(); i++)
+    {
+        BOOST_TEST(chats[i].first == std::to_string(i));
+        BOOST_TEST(chats[i].second >= i + 100);
+        BOOST_TEST(chats[i].second <= i + 150);
+    }
+    BOOST_TEST(link.empty());
+}
+
+BOOST_AUTO_TEST_CASE(LinkLimitsBandwidth)
+{
+    LinkProperties props(10);
+    props.bandwidth = 1;
+    EmulatedLink link(props, 42);
+    const GameMessage_Chat msg(0, CD_ALL, std::string(100, 'x'));
+    const unsigned msgSize = getMsgSize(msg);
+    link.send(0, msg);
+    link.send(0, msg);
+    BOOST_TEST(link.getNumBytesSent() == 2 * msgSize);
+
+    const auto chats = receiveChats(link, 2 * msgSize + 10);
+    BOOST_TEST_REQUIRE(chats.size() == 2u);
+    BOOST_TEST(chats[0].second == msgSize + 10);
+    BOOST_TEST(chats[1].second == 2 * msgSize + 10);
+}
+
+BOOST_AUTO_TEST_CASE(LinkDelaysDuringOutageAndLoss)
+{
+    LinkProperties props(5);
+    props.outages.emplace_back(10, 500);
+    EmulatedLink link(props, 42);
+    link.send(0, GameMessage_Chat(0, CD_ALL, "before"));
+    link.send(20, GameMessage_Chat(0, CD_ALL, "during"));
+    link.send(600, GameMessage_Chat(0, CD_ALL, "after"));
+    const auto chats = receiveChats(link, 1000);
+    BOOST_TEST_REQUIRE(chats.size() == 3u);
+    BOOST_TEST(chats[0].second == 5u);
+    BOOST_TEST(chats[1].second == 505u);
+    BOOST_TEST(chats[2].second == 605u);
+
+    LinkProperties lossyProps(5);
+    lossyProps.lossPerMille = 500;
+    lossyProps.retransmitTimeout = 100;
+    EmulatedLink lossyLink(lossyProps, 42);
+    for(unsigned i = 0; i < 20; i++)
+        lossyLink.send(0, GameMessage_Chat(0, CD_ALL, std::to_string(i)));
+    BOOST_TEST(lossyLink.getNumLostPackets() > 0u);
+    const auto lossyChats = receiveChats(lossyLink, 5 + lossyLink.getNumLostPackets() * 100);
+    BOOST_TEST_REQUIRE(lossyChats.size() == 20u);
+    BOOST_TEST(lossyChats.back().second > 5u);
+
+    lossyProps.lossPerMille = 1000;
+    BOOST_CHECK_THROW(EmulatedLink(lossyProps, 42), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(LANGameRunsWithoutStalls)
+{
+    const SimulationConfig config = SimulationConfig::create(3, LinkProperties(1), LinkProperties(1));
+    const SimulationResult result = LockstepSimulation(config).run();
+    BOOST_TEST_MESSAGE("LAN game:\n" << result);
+    BOOST_TEST(result.numGFs >= config.numGFs);
+    BOOST_TEST(result.cmdDelay == 2u);
+    BOOST_TEST(result.maxNWFLength == 1u);
+    BOOST_TEST(result.getRelativeGFRate() > 0.9);
+    BOOST_TEST(result.lagKicks.empty());
+    BOOST_TEST(!result.asyncDetectedGF);
+    // Commands are executed cmdDelay NWFs later
+    BOOST_TEST(result.getCmdLatency(50) <= (result.cmdDelay + 1) * result.gfLength);
+}
+
+BOOST_AUTO_TEST_CASE(InternetGameHidesLatency)
+{
+    const SimulationConfig config = createInternetGame(3);
+    const SimulationResult result = LockstepSimulation(config).run();
+    BOOST_TEST_MESSAGE("Internet game:\n" << result);
+    BOOST_TEST(result.numGFs >= config.numGFs);
+    BOOST_TEST(result.cmdDelay == 3u);
+    // NWFs are long enough for the round trip
+    BOOST_TEST(result.minNWFLength * result.gfLength >= 160u);
+    BOOST_TEST(result.getRelativeGFRate() > 0.9);
+    BOOST_TEST(result.lagKicks.empty());
+    BOOST_TEST(result.getCmdLatency(90) <= (result.cmdDelay + 1) * result.maxNWFLength * result.gfLength);
+}
+
+BOOST_AUTO_TEST_CASE(LossyGameKeepsRunning)
+{
+    SimulationConfig config = createInternetGame(3);
+    config.numGFs = 200;
+    for(unsigned id = 1; id < config.getNumPlayers(); id++)
+        config.uplinks[id].lossPerMille = config.downlinks[id].lossPerMille = 20;
+    const SimulationResult result = LockstepSimulation(config).run();
+    BOOST_TEST_MESSAGE("Lossy game:\n" << result);
+    BOOST_TEST(result.numGFs >= config.numGFs);
+    BOOST_TEST(result.getRelativeGFRate() > 0.6);
+    BOOST_TEST(result.lagKicks.empty());
+}
+
+BOOST_AUTO_TEST_CASE(SlowClientSlowsDownGame)
+{
+    SimulationConfig config = SimulationConfig::create(3, LinkProperties(1), LinkProperties(1));
+    config.minGFLengths = {0, 60, 0};
+    const SimulationResult result = LockstepSimulation(config).run();
+    BOOST_TEST_MESSAGE("Slow client:\n" << result);
+    BOOST_TEST(result.numGFs >= config.numGFs);
+    BOOST_TEST(result.getRelativeGFRate() < 0.95);
+    BOOST_TEST(result.getRelativeGFRate() > 0.7);
+    // The others wait for the slow one
+    BOOST_TEST(result.stallTimes[0] > 0u);
+    BOOST_TEST(result.lagKicks.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(DisconnectedPlayerIsKicked, rttr::test::MockClockFixture)
+{
+    // The mocked clock only affects the timers of the server (lag and ping timeouts), the game runs in real time
+    LockstepSimulation simulation(SimulationConfig::create(3, LinkProperties(1), LinkProperties(1)));
+    TestGameClient& host = simulation.getClient(0);
+    BOOST_TEST_REQUIRE(simulation.runUntil([&host]() { return host.getGF() >= 20u; }));
+    // The connection breaks without being closed
+    simulation.getClient(2).getUplink()->cut();
+    BOOST_TEST_REQUIRE(simulation.runUntil([&host]() { return host.getCurrentStallTime() >= 500u; }));
+    BOOST_TEST(host.getKickedPlayers().empty());
+
+    currentTime += std::chrono::seconds(LAG_TIMEOUT);
+    BOOST_TEST_REQUIRE(simulation.runUntil([&host]() { return !host.getKickedPlayers().empty(); }));
+    BOOST_TEST(host.getKickedPlayers() == std::vector<unsigned>{2}, boost::test_tools::per_element());
+    // Game continues after the kick
+    const unsigned kickGF = host.getGF();
+    BOOST_TEST(simulation.runUntil([&simulation, kickGF]() {
+        return simulation.getClient(0).getGF() > kickGF + 20u && simulation.getClient(1).getGF() > kickGF + 20u;
+    }));
+}
+
+BOOST_AUTO_TEST_CASE(AsyncIsDetectedWithinCmdDelay)
+{
+    SimulationConfig config = SimulationConfig::create(3, LinkProperties(1), LinkProperties(1));
+    config.asyncPlayer = 1;
+    config.asyncGF = 50;
+    const SimulationResult result = LockstepSimulation(config).run();
+    BOOST_TEST_REQUIRE(result.asyncDetectedGF);
+    BOOST_TEST(*result.asyncDetectedGF >= config.asyncGF);
+    // The command with the wrong checksum is executed cmdDelay NWFs later. The host may be up to cmdDelay NWFs ahead
+    BOOST_TEST(*result.asyncDetectedGF <= config.asyncGF + (2 * result.cmdDelay + 1) * result.maxNWFLength);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
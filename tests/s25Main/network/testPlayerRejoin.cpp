@@ -0,0 +1,276 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "NWFInfo.h"
+#include "TestGameClient.h"
+#include "TestServer.h"
+#include "Timer.h"
+#include "network/CreateServerInfo.h"
+#include "network/GameMessages.h"
+#include "network/GameProtocol.h"
+#include "network/GameServer.h"
+#include "network/NetworkPlayer.h"
+#include "network/PlayerGameCommands.h"
+#include "network/PlayerRejoin.h"
+#include "test/testConfig.h"
+#include "gameTypes/MapType.h"
+#include "gameTypes/ServerType.h"
+#include "s25util/Serializer.h"
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+struct RejoinFixture
+{
+    NWFInfo nwfInfo;
+
+    RejoinFixture()
+    {
+        nwfInfo.init(0, 2);
+        nwfInfo.addPlayer(0);
+        nwfInfo.addPlayer(1);
+        // NWF 0 is announced but not yet executed by the server
+        BOOST_TEST_REQUIRE(nwfInfo.addServerInfo(NWFServerInfo(0, 20, 5)));
+    }
+};
+
+/// Game of a host and another player on the real server over localhost
+struct LoopbackGameFixture
+{
+    const boost::filesystem::path mapPath = rttr::test::rttrBaseDir / "tests/testData/maps/LuaFunctions.SWD";
+    uint16_t port;
+    TestGameClient host, client;
+
+    LoopbackGameFixture() : host(mapPath, "Host", "HostPw", true), client(mapPath, "Client", "", false)
+    {
+        port = listenOnFreePort([this](uint16_t curPort) {
+            return GAMESERVER.Start(CreateServerInfo(ServerType::DIRECT, curPort, "Rejoin"), mapPath, MAPTYPE_OLDMAP,
+                                    "HostPw");
+        });
+        BOOST_TEST_REQUIRE(port != 0u);
+        BOOST_TEST_REQUIRE(host.connect("localhost", port));
+        BOOST_TEST_REQUIRE(runUntil([this]() { return host.hasJoined(); }));
+        BOOST_TEST_REQUIRE(client.connect("localhost", port));
+        BOOST_TEST_REQUIRE(runUntil([this]() { return client.hasJoined(); }));
+
+        host.lockFreeSlots();
+        BOOST_TEST_REQUIRE(runUntil([this]() {
+            for(unsigned id = 0; id < host.getNumPlayers(); id++)
+            {
+                const PlayerState ps = host.getPlayerState(id);
+                if(ps == PS_FREE || (ps == PS_OCCUPIED && !host.isPlayerReady(id)))
+                    return false;
+            }
+            return true;
+        }));
+        host.send(new GameMessage_Countdown(0));
+        BOOST_TEST_REQUIRE(
+          runUntil([this]() { return host.getNumExecutedNWFs() >= 10u && client.getNumExecutedNWFs() >= 10u; }));
+    }
+    ~LoopbackGameFixture()
+    {
+        host.drop();
+        client.drop();
+        GAMESERVER.Stop();
+    }
+
+    /// Run the server and all clients until the condition is true. Return the condition
+    template<class T_Cond>
+    bool runUntil(T_Cond&& cond, const std::vector<TestGameClient*>& otherClients = {})
+    {
+        Timer timer(true);
+        while(!cond() && timer.getElapsed() < std::chrono::seconds(10))
+        {
+            GAMESERVER.Run();
+            host.run();
+            client.run();
+            for(TestGameClient* otherClient : otherClients)
+                otherClient->run();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return cond();
+    }
+
+    /// Disconnect the client and wait till the host plays its slot
+    void dropClient()
+    {
+        const unsigned playerId = client.getPlayerId();
+        client.drop();
+        BOOST_TEST_REQUIRE(runUntil([this, playerId]() { return host.getPlayerState(playerId) == PS_AI; }));
+        // The game continues without the player
+        const unsigned dropGF = host.getGF();
+        BOOST_TEST_REQUIRE(runUntil([this, dropGF]() { return host.getGF() > dropGF + 10u; }));
+    }
+};
+
+GameMessage_Rejoin_Snapshot makePart(unsigned gf, unsigned offset, unsigned size, std::vector<char> randomState = {})
+{
+    return GameMessage_Rejoin_Snapshot(gf, 100, 10, offset, std::vector<char>(size, 'x'), std::move(randomState));
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(PlayerRejoinSuite)
+
+BOOST_FIXTURE_TEST_CASE(OnlyCmdsAfterSnapshotAreBuffered, RejoinFixture)
+{
+    // Player 0 already sent the commands for NWF 0 and 5, player 1 none
+    BOOST_TEST_REQUIRE(nwfInfo.addPlayerCmds(0, PlayerGameCommands()));
+    BOOST_TEST_REQUIRE(nwfInfo.addPlayerCmds(0, PlayerGameCommands()));
+
+    PlayerRejoin rejoin(1, 0, nwfInfo);
+    BOOST_TEST(rejoin.getPlayerId() == 1u);
+    BOOST_TEST(rejoin.getProviderId() == 0u);
+    // First NWF not announced
+    BOOST_TEST(rejoin.getSnapshotGF() == 5u);
+    BOOST_TEST(rejoin.isBuffering());
+    // Commands of player 0 for NWF 5
+    BOOST_TEST(rejoin.getNumBufferedMsgs() == 1u);
+
+    // Commands of player 1 for NWF 0 are already in the snapshot
+    rejoin.addPlayerCmds(1, PlayerGameCommands());
+    BOOST_TEST(rejoin.getNumBufferedMsgs() == 1u);
+    rejoin.addPlayerCmds(1, PlayerGameCommands());
+    BOOST_TEST(rejoin.getNumBufferedMsgs() == 2u);
+    rejoin.addServerInfo(NWFServerInfo(5, 20, 10));
+    rejoin.addMsg(std::make_unique<GameMessage_Player_Kicked>(0, NP_CONNECTIONLOST, 0));
+    BOOST_TEST(rejoin.getNumBufferedMsgs() == 4u);
+
+    NetworkPlayer player(1);
+    rejoin.sendBufferedMsgs(player);
+    BOOST_TEST(!rejoin.isBuffering());
+    BOOST_TEST(rejoin.getNumBufferedMsgs() == 0u);
+    BOOST_TEST(player.sendQueue.size() == 4u);
+    // Sent directly afterwards
+    rejoin.addServerInfo(NWFServerInfo(10, 20, 15));
+    rejoin.addPlayerCmds(0, PlayerGameCommands());
+    BOOST_TEST(rejoin.getNumBufferedMsgs() == 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(SnapshotPartsAreValidated, RejoinFixture)
+{
+    PlayerRejoin rejoin(1, 0, nwfInfo);
+    const std::vector<char> randomState(4, 'r');
+    // Wrong GF, missing random state or not starting at 0
+    BOOST_TEST(!rejoin.addSnapshotPart(makePart(0, 0, 4, randomState)));
+    BOOST_TEST(!rejoin.addSnapshotPart(makePart(5, 0, 4)));
+    BOOST_TEST(!rejoin.addSnapshotPart(makePart(5, 4, 4, randomState)));
+
+    BOOST_TEST(rejoin.addSnapshotPart(makePart(5, 0, 4, randomState)));
+    BOOST_TEST(!rejoin.hasSnapshot());
+    // Gap or overflow
+    BOOST_TEST(!rejoin.addSnapshotPart(makePart(5, 6, 4)));
+    BOOST_TEST(!rejoin.addSnapshotPart(makePart(5, 4, 7)));
+    // Changed length
+    BOOST_TEST(!rejoin.addSnapshotPart(GameMessage_Rejoin_Snapshot(5, 101, 10, 4, std::vector<char>(6, 'x'))));
+
+    BOOST_TEST(rejoin.addSnapshotPart(makePart(5, 4, 6)));
+    BOOST_TEST_REQUIRE(rejoin.hasSnapshot());
+    BOOST_TEST(rejoin.getSnapshot()->size() == 10u);
+    BOOST_TEST(rejoin.getSnapshotLength() == 100u);
+    BOOST_TEST(rejoin.getRandomState() == randomState);
+    // Nothing more accepted
+    BOOST_TEST(!rejoin.addSnapshotPart(makePart(5, 10, 1)));
+}
+
+BOOST_FIXTURE_TEST_CASE(OversizedSnapshotIsRejected, RejoinFixture)
+{
+    PlayerRejoin rejoin(1, 0, nwfInfo);
+    const std::vector<char> randomState(4, 'r');
+    const std::vector<char> data(4, 'x');
+    BOOST_TEST(!rejoin.addSnapshotPart(
+      GameMessage_Rejoin_Snapshot(5, 100, REJOIN_MAX_SNAPSHOT_SIZE + 1, 0, data, randomState)));
+    BOOST_TEST(!rejoin.addSnapshotPart(
+      GameMessage_Rejoin_Snapshot(5, REJOIN_MAX_SNAPSHOT_SIZE + 1, 10, 0, data, randomState)));
+    BOOST_TEST(rejoin.addSnapshotPart(
+      GameMessage_Rejoin_Snapshot(5, REJOIN_MAX_SNAPSHOT_SIZE, REJOIN_MAX_SNAPSHOT_SIZE, 0, data, randomState)));
+}
+
+BOOST_AUTO_TEST_CASE(RejoinMsgsAreSerialized)
+{
+    const GameMessage_Rejoin_Start msg(3, 42, 2, 1000, 500, std::vector<char>{1, 2, 3});
+    Serializer ser;
+    msg.Serialize(ser);
+    GameMessage_Rejoin_Start msg2;
+    msg2.Deserialize(ser);
+    BOOST_TEST(msg2.player == 3u);
+    BOOST_TEST(msg2.snapshotGF == 42u);
+    BOOST_TEST(msg2.cmdDelay == 2u);
+    BOOST_TEST(msg2.length == 1000u);
+    BOOST_TEST(msg2.compressedLength == 500u);
+    BOOST_TEST(msg2.randomState == msg.randomState);
+
+    const GameMessage_Rejoin_Snapshot part(42, 1000, 500, 100, std::vector<char>(7, 'a'));
+    Serializer ser2;
+    part.Serialize(ser2);
+    GameMessage_Rejoin_Snapshot part2;
+    part2.Deserialize(ser2);
+    BOOST_TEST(part2.gf == 42u);
+    BOOST_TEST(part2.offset == 100u);
+    BOOST_TEST(part2.data == part.data);
+    BOOST_TEST(part2.randomState.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(DroppedPlayerRejoinsRunningGame, LoopbackGameFixture)
+{
+    const unsigned playerId = client.getPlayerId();
+    BOOST_TEST_REQUIRE(playerId != host.getPlayerId());
+    // Each player got its own token at game start
+    BOOST_TEST_REQUIRE(!client.getRejoinToken().empty());
+    BOOST_TEST(client.getRejoinToken() != host.getRejoinToken());
+    dropClient();
+
+    BOOST_TEST_REQUIRE(client.connect("localhost", port));
+    BOOST_TEST_REQUIRE(runUntil([this]() { return client.hasTakenOver(); }));
+    BOOST_TEST(client.getPlayerId() == playerId);
+    BOOST_TEST_REQUIRE(runUntil([this, playerId]() { return host.getPlayerState(playerId) == PS_OCCUPIED; }));
+
+    // The host no longer sends commands for the slot, so the game only continues with those of the rejoined player
+    const unsigned takeOverGF = client.getGF();
+    BOOST_TEST(runUntil([this, takeOverGF]() { return host.getGF() > takeOverGF + 10u; }));
+    BOOST_TEST(runUntil([this, takeOverGF]() { return client.getGF() > takeOverGF + 10u; }));
+    BOOST_TEST(host.isConnected());
+    BOOST_TEST(client.isConnected());
+    BOOST_TEST(!host.isAsync());
+    BOOST_TEST(!client.isAsync());
+}
+
+BOOST_FIXTURE_TEST_CASE(RejoinRequiresToken, LoopbackGameFixture)
+{
+    const unsigned playerId = client.getPlayerId();
+    dropClient();
+
+    // Using the name of the player is not enough
+    TestGameClient impostor(mapPath, "Client", "", false);
+    BOOST_TEST_REQUIRE(impostor.connect("localhost", port));
+    BOOST_TEST(runUntil([&impostor]() { return !impostor.isConnected(); }, {&impostor}));
+    // Neither is a wrong token
+    impostor.setRejoinToken("0123456789abcdef0123456789abcdef");
+    BOOST_TEST_REQUIRE(impostor.connect("localhost", port));
+    BOOST_TEST(runUntil([&impostor]() { return !impostor.isConnected(); }, {&impostor}));
+    BOOST_TEST(!impostor.hasTakenOver());
+    BOOST_TEST(host.getPlayerState(playerId) == PS_AI);
+
+    // The owner of the slot can still rejoin
+    BOOST_TEST_REQUIRE(client.connect("localhost", port));
+    BOOST_TEST(runUntil([this]() { return client.hasTakenOver(); }));
+    BOOST_TEST(client.getPlayerId() == playerId);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
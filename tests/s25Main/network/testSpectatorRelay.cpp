@@ -0,0 +1,219 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "JoinPlayerInfo.h"
+#include "Replay.h"
+#include "TestServer.h"
+#include "Timer.h"
+#include "network/GameMessageInterface.h"
+#include "network/GameMessages.h"
+#include "network/GameProtocol.h"
+#include "network/NetworkPlayer.h"
+#include "network/SpectatorRelay.h"
+#include "gameTypes/ChatDestination.h"
+#include "gameTypes/MapInfo.h"
+#include "s25util/SocketSet.h"
+#include <rttr/test/TmpFolder.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+struct StreamCollector : GameMessageInterface
+{
+    bool started = false;
+    unsigned headerSize = 0, startGF = 0, endGF = 0;
+    std::vector<char> data;
+
+    bool OnGameMessage(const GameMessage_Spectator_Start& msg) override
+    {
+        started = true;
+        headerSize = msg.headerSize;
+        startGF = msg.startGF;
+        return true;
+    }
+    bool OnGameMessage(const GameMessage_Spectator_Data& msg) override
+    {
+        data.insert(data.end(), msg.data.begin(), msg.data.end());
+        endGF = msg.endGF;
+        return true;
+    }
+};
+
+struct RelayFixture
+{
+    rttr::test::TmpFolder tmpFolder;
+    SpectatorRelay relay;
+    NetworkPlayer spectator;
+    StreamCollector collector;
+
+    RelayFixture() : spectator(0)
+    {
+        const uint16_t port = listenOnFreePort([this](uint16_t curPort) { return relay.Start(curPort, false, 10); });
+        BOOST_TEST_REQUIRE(port != 0u);
+
+        MapInfo map;
+        map.type = MAPTYPE_OLDMAP;
+        map.title = "MapTitle";
+        map.filepath = "Map.swd";
+        map.mapData.data = std::vector<char>(42, 0x42);
+        map.mapData.length = 50;
+        std::vector<JoinPlayerInfo> players(2);
+        players[0].ps = PS_OCCUPIED;
+        players[0].name = "Human";
+        players[1].ps = PS_AI;
+        players[1].name = "PlAI";
+        Replay& replay = relay.GetReplay();
+        for(const JoinPlayerInfo& player : players)
+            replay.AddPlayer(player);
+        replay.random_init = 815;
+        BOOST_TEST_REQUIRE(relay.StartStream(tmpFolder.get() / "stream.rpl", map, 0));
+
+        BOOST_TEST_REQUIRE(spectator.socket.Connect("localhost", port, false));
+    }
+    ~RelayFixture()
+    {
+        spectator.closeConnection();
+        relay.Stop();
+    }
+
+    /// Run the relay and receive the stream until the condition is true or the timeout passed
+    void runUntil(unsigned currentGF, const std::function<bool()>& condition)
+    {
+        Timer timer(true);
+        while(!condition() && timer.getElapsed() < std::chrono::seconds(10))
+        {
+            relay.Run(currentGF);
+            SocketSet set;
+            set.Add(spectator.socket);
+            if(set.Select(10, 0) > 0)
+                BOOST_TEST_REQUIRE(spectator.receiveMsgs());
+            spectator.executeMsgs(collector);
+        }
+        BOOST_TEST_REQUIRE(condition());
+    }
+
+    /// Load the received stream as a replay and return the chat messages in it
+    std::vector<std::string> readReceivedChats()
+    {
+        const boost::filesystem::path filepath = tmpFolder.get() / "received.rpl";
+        {
+            boost::nowide::ofstream file(filepath, std::ios::binary);
+            file.write(collector.data.data(), collector.data.size());
+        }
+        Replay replay;
+        MapInfo map;
+        BOOST_TEST_REQUIRE(replay.LoadHeader(filepath, true));
+        BOOST_TEST_REQUIRE(replay.LoadGameData(map));
+        BOOST_TEST(replay.GetMapName() == "MapTitle");
+        BOOST_TEST(replay.random_init == 815u);
+        BOOST_TEST(map.mapData.data == std::vector<char>(42, 0x42));
+        std::vector<std::string> chats;
+        unsigned gf;
+        while(replay.ReadGF(&gf))
+        {
+            BOOST_TEST_REQUIRE(gf < collector.endGF);
+            BOOST_TEST_REQUIRE((replay.ReadRCType() == ReplayCommand::Chat));
+            uint8_t player, dest;
+            std::string text;
+            replay.ReadChatCommand(player, dest, text);
+            chats.push_back(text);
+        }
+        return chats;
+    }
+};
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(SpectatorRelayTests)
+
+BOOST_FIXTURE_TEST_CASE(StreamIsDelayed, RelayFixture)
+{
+    relay.AddChatCommand(0, 0, CD_ALL, "A");
+    relay.AddChatCommand(5, 1, CD_ALL, "B");
+    relay.AddChatCommand(20, 0, CD_ALL, "C");
+
+    // Only the commands older than the delay of 10 GFs get sent
+    runUntil(15, [this]() { return collector.endGF == 5u; });
+    BOOST_TEST(relay.GetNumSpectators() == 1u);
+    BOOST_TEST(collector.started);
+    BOOST_TEST(collector.startGF == 0u);
+    BOOST_TEST_REQUIRE(collector.data.size() > collector.headerSize);
+    BOOST_TEST(readReceivedChats() == std::vector<std::string>{"A"}, boost::test_tools::per_element());
+
+    runUntil(25, [this]() { return collector.endGF == 15u; });
+    BOOST_TEST(readReceivedChats() == (std::vector<std::string>{"A", "B"}), boost::test_tools::per_element());
+
+    runUntil(40, [this]() { return collector.endGF == 30u; });
+    BOOST_TEST(readReceivedChats() == (std::vector<std::string>{"A", "B", "C"}), boost::test_tools::per_element());
+}
+
+BOOST_FIXTURE_TEST_CASE(LargeStreamIsSentInParts, RelayFixture)
+{
+    std::vector<std::string> expectedChats;
+    for(unsigned gf = 0; gf < 100; gf++)
+    {
+        expectedChats.push_back(std::string(1000, static_cast<char>('a' + gf % 26)));
+        relay.AddChatCommand(gf, 0, CD_ALL, expectedChats.back());
+    }
+    runUntil(200, [this]() { return collector.endGF == 190u; });
+    BOOST_TEST(readReceivedChats() == expectedChats, boost::test_tools::per_element());
+
+    // A disconnected spectator gets removed
+    spectator.closeConnection();
+    Timer timer(true);
+    while(relay.GetNumSpectators() > 0u && timer.getElapsed() < std::chrono::seconds(10))
+        relay.Run(200);
+    BOOST_TEST(relay.GetNumSpectators() == 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(LateSpectatorWaitsForSnapshot, RelayFixture)
+{
+    relay.AddChatCommand(0, 0, CD_ALL, "A");
+    const unsigned currentGF = SPECTATOR_SNAPSHOT_INTERVAL + 100;
+    // No snapshots without spectators
+    BOOST_TEST(!relay.IsSnapshotDue(currentGF));
+
+    // Stream start is too old -> Spectator waits for a snapshot and gets nothing till then
+    Timer timer(true);
+    while(!relay.IsSnapshotDue(currentGF) && timer.getElapsed() < std::chrono::seconds(10))
+        relay.Run(currentGF);
+    BOOST_TEST_REQUIRE(relay.IsSnapshotDue(currentGF));
+    BOOST_TEST(relay.GetNumSpectators() == 1u);
+    for(unsigned i = 0; i < 10; i++)
+    {
+        relay.Run(currentGF);
+        SocketSet set;
+        set.Add(spectator.socket);
+        if(set.Select(10, 0) > 0)
+            BOOST_TEST_REQUIRE(spectator.receiveMsgs());
+        spectator.executeMsgs(collector);
+    }
+    BOOST_TEST(!collector.started);
+
+    // Snapshot failed -> Start from the beginning
+    relay.AddSnapshot(nullptr);
+    BOOST_TEST(!relay.IsSnapshotDue(currentGF));
+    runUntil(currentGF, [this, currentGF]() { return collector.endGF == currentGF - 10; });
+    BOOST_TEST(collector.startGF == 0u);
+    BOOST_TEST(readReceivedChats() == std::vector<std::string>{"A"}, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,128 @@
+// Copyright (c) 2005 - 2020 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "FramesInfo.h"
+#include <boost/test/unit_test.hpp>
+#include <helpers/chronoIO.h>
+
+using namespace std::chrono;
+
+namespace {
+struct FramesInfoFixture
+{
+    FramesInfo framesInfo;
+    FramesInfo::UsedClock::time_point startTime;
+    unsigned numGFs = 0;
+    /// Number of GFs that can be executed before the next one fails (lagging player)
+    unsigned numGFsTillLag = 1000;
+
+    FramesInfoFixture() : startTime(FramesInfo::UsedClock::now())
+    {
+        framesInfo.gf_length = FramesInfo::milliseconds32_t(20);
+        framesInfo.lastTime = startTime;
+    }
+
+    unsigned run(milliseconds timeSinceStart, unsigned maxGFs = 4)
+    {
+        return framesInfo.runDueGFs(startTime + timeSinceStart, maxGFs, [this]() {
+            if(numGFsTillLag == 0)
+                return false;
+            --numGFsTillLag;
+            ++numGFs;
+            return true;
+        });
+    }
+    milliseconds getLastTime() const { return duration_cast<milliseconds>(framesInfo.lastTime - startTime); }
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(FramesInfoSuite, FramesInfoFixture)
+
+BOOST_AUTO_TEST_CASE(RunsAllDueGFs)
+{
+    // Not yet due
+    BOOST_TEST(run(milliseconds(19)) == 0u);
+    BOOST_TEST(framesInfo.frameTime == milliseconds(19));
+    // Timeline advances in steps of 1 GF, the remainder is kept for interpolation
+    BOOST_TEST(run(milliseconds(50)) == 2u);
+    BOOST_TEST(getLastTime() == milliseconds(40));
+    BOOST_TEST(framesInfo.frameTime == milliseconds(10));
+    // The slow frame is compensated in the next call
+    BOOST_TEST(run(milliseconds(61)) == 1u);
+    BOOST_TEST(getLastTime() == milliseconds(60));
+    BOOST_TEST(framesInfo.frameTime == milliseconds(1));
+    BOOST_TEST(numGFs == 3u);
+}
+
+BOOST_AUTO_TEST_CASE(DropsBacklog)
+{
+    BOOST_TEST(run(milliseconds(205), 4) == 4u);
+    // The remaining GFs are not caught up
+    BOOST_TEST(getLastTime() == milliseconds(205));
+    BOOST_TEST(framesInfo.frameTime == milliseconds(0));
+    BOOST_TEST(run(milliseconds(220)) == 0u);
+    BOOST_TEST(run(milliseconds(225)) == 1u);
+    BOOST_TEST(numGFs == 5u);
+}
+
+BOOST_AUTO_TEST_CASE(NoBurstAfterLag)
+{
+    BOOST_TEST(run(milliseconds(30)) == 1u);
+    BOOST_TEST(framesInfo.frameTime == milliseconds(10));
+    // Lagging: No GF is executed and the interpolation state is kept
+    numGFsTillLag = 0;
+    for(unsigned i = 45; i <= 500; i += 15)
+    {
+        BOOST_TEST(run(milliseconds(i)) == 0u);
+        BOOST_TEST(framesInfo.frameTime == milliseconds(10));
+    }
+    BOOST_TEST(getLastTime() == milliseconds(485));
+    // Lag resolved: The waiting time is not caught up
+    numGFsTillLag = 1000;
+    BOOST_TEST(run(milliseconds(500)) == 0u);
+    BOOST_TEST(run(milliseconds(505)) == 1u);
+    BOOST_TEST(framesInfo.frameTime == milliseconds(0));
+    BOOST_TEST(run(milliseconds(530)) == 1u);
+    BOOST_TEST(numGFs == 3u);
+}
+
+BOOST_AUTO_TEST_CASE(LagDuringCatchUp)
+{
+    numGFsTillLag = 2;
+    BOOST_TEST(run(milliseconds(75)) == 2u);
+    // Interpolation starts at the last executed GF
+    BOOST_TEST(framesInfo.frameTime == milliseconds(0));
+    BOOST_TEST(getLastTime() == milliseconds(75));
+    numGFsTillLag = 1000;
+    BOOST_TEST(run(milliseconds(95)) == 1u);
+    BOOST_TEST(numGFs == 3u);
+}
+
+BOOST_AUTO_TEST_CASE(PauseStopsCatchUp)
+{
+    const auto pauseGame = [this]() {
+        ++numGFs;
+        framesInfo.isPaused = true;
+        return true;
+    };
+    BOOST_TEST(framesInfo.runDueGFs(startTime + milliseconds(70), 4, pauseGame) == 1u);
+    BOOST_TEST(numGFs == 1u);
+    BOOST_TEST(getLastTime() == milliseconds(70));
+    BOOST_TEST(framesInfo.frameTime == milliseconds(0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()